@@ -0,0 +1,198 @@
+/********************************************************************************************
+ *  Filename: sht21_bench.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Micro and bulk benchmarks of the core parsers. Single runs the function on the same
+ *  frame over and over, bulk runs it over an array of different frames. Reports ns/op,
+ *  frames/s and instructions per frame. Instructions are counted with perf_event_open
+ *  and show as n/a where the kernel does not allow it.
+ *
+ *      make bench && build/sht21_bench
+ *
+ *******************************************************************************************/
+#define _GNU_SOURCE
+#include "sht21_core.h"
+#include "sht21_batch.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define BENCH_FRAMES        (4096U)
+#define BENCH_ROUNDS        (500U)
+
+typedef void (*Bench_Fn)(UInt8* frames, UInt32 count);
+
+static UInt8 bench_frames[BENCH_FRAMES * SHT21_FRAME_SIZE];
+static float bench_values[BENCH_FRAMES];
+static UInt8 bench_status[BENCH_FRAMES];
+static volatile float bench_sink_f;
+static volatile UInt32 bench_sink_u;
+static int bench_perf_fd = -1;
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/********************************************************************************************
+ *  Opens an instruction counter for this thread, user space only
+ *******************************************************************************************/
+static void bench_perf_open(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    bench_perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void bench_perf_start(void)
+{
+    if (bench_perf_fd < 0)
+        return;
+    ioctl(bench_perf_fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(bench_perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+static long long bench_perf_stop(void)
+{
+    long long count = -1;
+    if (bench_perf_fd < 0)
+        return -1;
+    ioctl(bench_perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(bench_perf_fd, &count, sizeof(count)) != sizeof(count))
+        return -1;
+    return count;
+}
+
+// Frames with valid checksums, every 64th one corrupted
+static void bench_fill_frames(void)
+{
+    UInt32 seed = 1U;
+    for (UInt32 i = 0; i < BENCH_FRAMES; i++)
+    {
+        UInt8* frame = &bench_frames[i * SHT21_FRAME_SIZE];
+        seed = seed * 1103515245U + 12345U;
+        frame[0] = (UInt8)(seed >> 16);
+        frame[1] = (UInt8)(seed >> 24) & 0xFCU;
+        frame[2] = 0;
+        while (SHT21_Check_Crc(frame, 2, frame[2]) != 0)
+            frame[2]++;
+        if ((i % 64U) == 63U)
+            frame[2] ^= 0x01U;
+    }
+}
+
+static void bench_crc(UInt8* frames, UInt32 count)
+{
+    for (UInt32 i = 0; i < count; i++, frames += SHT21_FRAME_SIZE)
+        bench_sink_u = SHT21_Check_Crc(frames, 2, frames[2]);
+}
+
+static void bench_temp(UInt8* frames, UInt32 count)
+{
+    for (UInt32 i = 0; i < count; i++, frames += SHT21_FRAME_SIZE)
+        bench_sink_f = SHT21_Parse_Temp(frames);
+}
+
+static void bench_rh(UInt8* frames, UInt32 count)
+{
+    for (UInt32 i = 0; i < count; i++, frames += SHT21_FRAME_SIZE)
+        bench_sink_f = SHT21_Parse_RH(frames);
+}
+
+static void bench_user_reg(UInt8* frames, UInt32 count)
+{
+    for (UInt32 i = 0; i < count; i++, frames += SHT21_FRAME_SIZE)
+        bench_sink_u = SHT21_Parse_User_Reg(frames).reg;
+}
+
+static void bench_request(UInt8* frames, UInt32 count)
+{
+    for (UInt32 i = 0; i < count; i++, frames += SHT21_FRAME_SIZE)
+        bench_sink_u = SHT21_Request_Buf((SHT21_Commands_TypeDef)frames[0]).reg;
+}
+
+static void bench_temp_batch(UInt8* frames, UInt32 count)
+{
+    bench_sink_u = SHT21_Parse_Temp_Batch(frames, count, bench_values, bench_status);
+}
+
+static void bench_rh_batch(UInt8* frames, UInt32 count)
+{
+    bench_sink_u = SHT21_Parse_RH_Batch(frames, count, bench_values, bench_status);
+}
+
+/********************************************************************************************
+ *  Runs fn BENCH_ROUNDS times over BENCH_FRAMES frames. Single passes copies of the
+ *  first frame so every call sees the same input, bulk passes the varied frames.
+ *******************************************************************************************/
+static void bench_run(const char* name, Bench_Fn fn, int bulk)
+{
+    UInt8 single[BENCH_FRAMES * SHT21_FRAME_SIZE];
+    UInt8* frames = bench_frames;
+    if (!bulk)
+    {
+        for (UInt32 i = 0; i < BENCH_FRAMES; i++)
+            memcpy(&single[i * SHT21_FRAME_SIZE], bench_frames, SHT21_FRAME_SIZE);
+        frames = single;
+    }
+
+    fn(frames, BENCH_FRAMES); // Warm up
+
+    bench_perf_start();
+    double start = bench_now_ns();
+    for (UInt32 round = 0; round < BENCH_ROUNDS; round++)
+        fn(frames, BENCH_FRAMES);
+    double ns = bench_now_ns() - start;
+    long long instructions = bench_perf_stop();
+
+    double ops = (double)BENCH_ROUNDS * BENCH_FRAMES;
+    printf("%-22s %-6s %8.2f ns/op %10.2f Mframes/s", name, bulk ? "bulk" : "single",
+           ns / ops, ops / ns * 1e3);
+    if (instructions >= 0)
+        printf(" %8.1f instr/frame\n", (double)instructions / ops);
+    else
+        printf("      n/a instr/frame\n");
+}
+
+int main(void)
+{
+    static const char* kernels[] = { "auto", "scalar", "sse2", "avx2" };
+
+    bench_fill_frames();
+    bench_perf_open();
+
+    for (int bulk = 0; bulk <= 1; bulk++)
+    {
+        bench_run("SHT21_Check_Crc", bench_crc, bulk);
+        bench_run("SHT21_Parse_Temp", bench_temp, bulk);
+        bench_run("SHT21_Parse_RH", bench_rh, bulk);
+        bench_run("SHT21_Parse_User_Reg", bench_user_reg, bulk);
+        bench_run("SHT21_Request_Buf", bench_request, bulk);
+    }
+
+    for (int k = SHT21_BATCH_KERNEL_SCALAR; k <= SHT21_BATCH_KERNEL_AVX2; k++)
+    {
+        SHT21_Batch_Kernel_TypeDef kernel = SHT21_Batch_Select_Kernel((SHT21_Batch_Kernel_TypeDef)k);
+        if ((int)kernel != k)
+            continue;
+        printf("batch kernel: %s\n", kernels[kernel]);
+        bench_run("SHT21_Parse_Temp_Batch", bench_temp_batch, 1);
+        bench_run("SHT21_Parse_RH_Batch", bench_rh_batch, 1);
+    }
+    return 0;
+}
@@ -0,0 +1,223 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_adaptive.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Runs 12 hours of a mostly flat room against the simulator, once at a fixed 1 s with
+ *  RH12/T14 and once with the adaptive controller, and compares the bus time, the
+ *  conversion time and the number of measurements. The bus time includes the user
+ *  register read and write of every resolution change, shown on its own. Most of the
+ *  saving comes from the longer interval, the lower resolutions only shorten the
+ *  conversions. The room gets temperature and humidity steps and a slow ramp. Exits
+ *  with 1 if the controller does not go back to the fine setting at the first sample
+ *  after a step.
+ *
+ *      make bench && build/sht21_bench_adaptive
+ *
+ *******************************************************************************************/
+#include "sht21_adaptive.h"
+#include "sht21_sim.h"
+
+#include <stdio.h>
+
+#define BENCH_DURATION_MS   (12UL * 3600UL * 1000UL)
+
+/********************************************************************************************
+ *  A change of the room at time ms. A step jumps by the deltas, a ramp reaches them
+ *  linearly over duration ms.
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 ms;
+    UInt32 duration;
+    float temp;
+    float humidity;
+} Bench_Event_TypeDef;
+
+static const Bench_Event_TypeDef bench_events[] =
+{
+    { 2UL * 3600000UL, 0, 1.5f, 0.0f },                 // Sun on the window
+    { 4UL * 3600000UL, 0, 0.0f, 8.0f },                 // Shower next door
+    { 6UL * 3600000UL, 1800000UL, -3.0f, -5.0f },       // Evening, heating turned down
+    { 9UL * 3600000UL, 0, -0.5f, 3.0f },                // Window opened
+};
+
+#define BENCH_EVENTS        (sizeof(bench_events) / sizeof(bench_events[0]))
+
+typedef struct
+{
+    UInt32 measurements;
+    UInt32 conversion;
+    UInt32 user_reg_writes;
+    unsigned long long bus_busy_us;
+    unsigned long long reg_busy_us;
+    UInt32 missed_steps;
+} Bench_Result_TypeDef;
+
+// Room at time ms, with +-0.01 C and +-0.05 %RH of noise
+static void bench_room(SHT21_Sim_TypeDef* sim, UInt32 ms, UInt32* seed)
+{
+    float temp = 22.0f;
+    float humidity = 45.0f;
+
+    for (UInt32 i = 0; i < BENCH_EVENTS; i++)
+    {
+        const Bench_Event_TypeDef* event = &bench_events[i];
+        if (ms < event->ms)
+            break;
+        float part = 1.0f;
+        if (event->duration > 0 && ms - event->ms < event->duration)
+            part = (float)(ms - event->ms) / (float)event->duration;
+        temp += event->temp * part;
+        humidity += event->humidity * part;
+    }
+
+    *seed = *seed * 1103515245U + 12345U;
+    temp += (float)((Int32)((*seed >> 16) % 21U) - 10) * 0.001f;
+    *seed = *seed * 1103515245U + 12345U;
+    humidity += (float)((Int32)((*seed >> 16) % 21U) - 10) * 0.005f;
+
+    sim->temp = temp;
+    sim->humidity = humidity;
+}
+
+static SHT21_Error_TypeDef bench_measure(SHT21_Bus_TypeDef* bus, SHT21_Commands_TypeDef cmd,
+                                         SHT21_Resolution_TypeDef res, UInt16* reading)
+{
+    SHT21_Measurement_TypeDef meas;
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(&meas, bus, cmd);
+    if (status == SHT21_OK)
+        status = SHT21_Measure_Wait(&meas, SHT21_Conversion_Time(res, cmd));
+    if (status == SHT21_OK)
+        status = SHT21_Parse_Reading(meas.frame, reading);
+    return status;
+}
+
+// Read, modify and write the user register as the application has to, adding its bus time
+static SHT21_Error_TypeDef bench_write_res(SHT21_Sim_TypeDef* sim, SHT21_Resolution_TypeDef res,
+                                           Bench_Result_TypeDef* result)
+{
+    unsigned long long busy = sim->clock->bus_busy_us;
+    UInt8 buf[2] = { SHT21_READ_USER_REG, 0 };
+    SHT21_Error_TypeDef status = sim->bus.write(sim->bus.handle, SHT21_I2C_ADDRESS, buf, 1);
+    if (status == SHT21_OK)
+        status = sim->bus.read(sim->bus.handle, SHT21_I2C_ADDRESS, &buf[1], 1);
+    if (status == SHT21_OK)
+    {
+        SHT21_User_Reg_TypeDef reg = SHT21_Set_Resolution(SHT21_Parse_User_Reg(&buf[1]), res);
+        buf[0] = SHT21_WRITE_USER_REG;
+        buf[1] = reg.reg;
+        status = sim->bus.write(sim->bus.handle, SHT21_I2C_ADDRESS, buf, 2);
+    }
+    result->user_reg_writes++;
+    result->reg_busy_us += sim->clock->bus_busy_us - busy;
+    return status;
+}
+
+/********************************************************************************************
+ *  Samples the room until BENCH_DURATION_MS, with the controller when adaptive is set
+ *******************************************************************************************/
+static Bench_Result_TypeDef bench_run(int adaptive)
+{
+    Bench_Result_TypeDef result = {0};
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Adaptive_TypeDef ctrl;
+    UInt32 seed = 1U;
+    UInt32 next_event = 0;
+
+    SHT21_Sim_Init(&sim, &clock);
+    SHT21_Adaptive_Init(&ctrl, 0);
+
+    SHT21_Resolution_TypeDef res = ctrl.resolution;
+    bench_write_res(&sim, res, &result);
+
+    while (clock.now_us < BENCH_DURATION_MS * 1000ULL)
+    {
+        UInt32 start_ms = (UInt32)(clock.now_us / 1000ULL);
+        UInt16 temp, rh;
+
+        bench_room(&sim, start_ms, &seed);
+        if (bench_measure(&sim.bus, SHT21_TEMP_MEASURE, res, &temp) != SHT21_OK ||
+            bench_measure(&sim.bus, SHT21_RH_MEASURE, res, &rh) != SHT21_OK)
+        {
+            printf("measurement failed\n");
+            result.missed_steps++;
+            break;
+        }
+        result.measurements++;
+        result.conversion += SHT21_Conversion_Time(res, SHT21_TEMP_MEASURE) +
+                             SHT21_Conversion_Time(res, SHT21_RH_MEASURE);
+
+        UInt32 interval = 1000U;
+        if (adaptive)
+        {
+            UInt8 changed = SHT21_Adaptive_Update(&ctrl, temp, rh);
+            interval = ctrl.interval;
+
+            // The first sample after a step must be back at the fine setting
+            while (next_event < BENCH_EVENTS && bench_events[next_event].ms <= start_ms)
+            {
+                if (bench_events[next_event].duration == 0 &&
+                    (interval != ctrl.config.min_interval || ctrl.resolution != ctrl.config.fine))
+                    result.missed_steps++;
+                next_event++;
+            }
+
+            if (changed & SHT21_ADAPTIVE_RESOLUTION)
+            {
+                res = ctrl.resolution;
+                bench_write_res(&sim, res, &result);
+            }
+        }
+
+        UInt32 spent_ms = (UInt32)(clock.now_us / 1000ULL) - start_ms;
+        if (spent_ms < interval)
+            SHT21_Sim_Advance(&clock, (unsigned long long)(interval - spent_ms) * 1000ULL);
+    }
+
+    result.bus_busy_us = clock.bus_busy_us;
+    if (adaptive)
+        printf("adaptive: %u moves, %u ms conversion, %u ms at fixed rate by the controller\n",
+               ctrl.stats.moves, ctrl.stats.conversion_time, SHT21_Adaptive_Fixed_Conversion(&ctrl));
+    return result;
+}
+
+static void bench_print(const char* name, const Bench_Result_TypeDef* result)
+{
+    printf("%-10s %8u %12.1f %14.1f %10u %11.2f\n", name, result->measurements, (double)result->bus_busy_us / 1000.0,
+           (double)result->conversion / 1000.0, result->user_reg_writes, (double)result->reg_busy_us / 1000.0);
+}
+
+int main(void)
+{
+    Bench_Result_TypeDef fixed = bench_run(0);
+    Bench_Result_TypeDef adaptive = bench_run(1);
+
+    printf("\n           samples  bus time ms  conversion s  reg writes  reg bus ms\n");
+    bench_print("fixed 1 s", &fixed);
+    bench_print("adaptive", &adaptive);
+
+    // Bus time per sample shows what the resolution steps save apart from the interval
+    double fixed_per_sample = (double)fixed.bus_busy_us / fixed.measurements;
+    double adaptive_per_sample = (double)adaptive.bus_busy_us / adaptive.measurements;
+    printf("bus time saved %.1f %%, %.1f %% fewer samples, bus time per sample %.1f us against %.1f us\n",
+           100.0 * (1.0 - (double)adaptive.bus_busy_us / (double)fixed.bus_busy_us),
+           100.0 * (1.0 - (double)adaptive.measurements / (double)fixed.measurements),
+           adaptive_per_sample, fixed_per_sample);
+    printf("conversion time saved %.1f %%\n", 100.0 * (1.0 - (double)adaptive.conversion / (double)fixed.conversion));
+    printf("steps not caught at the first sample: %u\n", adaptive.missed_steps);
+
+    // RH8/T12 is off the ladder, it would convert no faster than RH11/T11
+    SHT21_Adaptive_TypeDef ctrl;
+    SHT21_Adaptive_Config_TypeDef config = SHT21_ADAPTIVE_CONFIG_DEFAULT;
+    config.coarse = SHT21_RES_RH8_T12;
+    int rejected = SHT21_Adaptive_Init(&ctrl, &config) == SHT21_UNIT_ERROR;
+    printf("RH8/T12 as coarse resolution: %s\n", rejected ? "rejected" : "ACCEPTED");
+
+    int ok = adaptive.missed_steps == 0 && fixed.missed_steps == 0 && adaptive.bus_busy_us < fixed.bus_busy_us &&
+             rejected;
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
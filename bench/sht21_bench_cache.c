@@ -0,0 +1,177 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_cache.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Three consumers of one simulated sensor, each reading at its own interval with its
+ *  own max age, for a minute of virtual time through SHT21_Cache_Read and
+ *  SHT21_Cache_Read_Both, and again with a max age of 0 as without the cache. Reports
+ *  the conversions, the bus time and the hit rate of each. Also runs the max age reads
+ *  of the STM32 example on the HAL stand-in. Exits with 1 if a read returns a value
+ *  older than its max age, a wrong value, or touches the bus on a hit.
+ *
+ *      make bench && build/sht21_bench_cache
+ *
+ *******************************************************************************************/
+#include "sht21.h"
+#include "sht21_cache.h"
+#include "sht21_sim.h"
+
+#include <stdio.h>
+
+#define BENCH_RUN_MS            (60000U)
+#define BENCH_CONSUMERS         (3U)
+
+typedef enum
+{
+    BENCH_TEMP                  = (0x00U),
+    BENCH_RH                    = (0x01U),
+    BENCH_BOTH                  = (0x02U)
+} Bench_Read_TypeDef;
+
+typedef struct
+{
+    const char* name;
+    Bench_Read_TypeDef read;
+    UInt32 interval;
+    UInt32 max_age;
+} Bench_Consumer_TypeDef;
+
+static const Bench_Consumer_TypeDef bench_consumers[BENCH_CONSUMERS] =
+{
+    { "control loop, T every 100 ms, max 500 ms",     BENCH_TEMP, 100U,  500U  },
+    { "display, RH every 250 ms, max 1000 ms",        BENCH_RH,   250U,  1000U },
+    { "logger, T and RH every 1 s, max 2000 ms",      BENCH_BOTH, 1000U, 2000U }
+};
+
+static int bench_close(float value, float expected, float tolerance)
+{
+    return value >= expected - tolerance && value <= expected + tolerance;
+}
+
+/********************************************************************************************
+ *  Runs the consumers, with their max ages or with 0. Returns 0 on a wrong or stale read.
+ *******************************************************************************************/
+static int bench_run(int cached)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Cache_TypeDef cache;
+    UInt32 next[BENCH_CONSUMERS] = {0};
+    UInt32 reads = 0;
+    UInt32 bad = 0;
+
+    SHT21_Sim_Init(&sim, &clock);
+    SHT21_Cache_Init(&cache, &sim.bus);
+
+    for (;;)
+    {
+        UInt32 c = 0;
+        for (UInt32 i = 1; i < BENCH_CONSUMERS; i++)
+            if (next[i] < next[c])
+                c = i;
+        if (next[c] >= BENCH_RUN_MS)
+            break;
+
+        UInt32 now = (UInt32)(clock.now_us / 1000ULL);
+        if (now < next[c])
+            SHT21_Sim_Advance(&clock, 1000ULL * (next[c] - now));
+        next[c] += bench_consumers[c].interval;
+
+        // The room drifts slowly, so a cached value stays close to the current one
+        now = (UInt32)(clock.now_us / 1000ULL);
+        sim.temp = 20.0f + (float)now / 60000.0f;
+        sim.humidity = 40.0f + (float)now / 30000.0f;
+
+        UInt32 max_age = cached ? bench_consumers[c].max_age : 0U;
+        UInt32 transactions = sim.transactions;
+        SHT21_Error_TypeDef status;
+        float temp = sim.temp;
+        float humidity = sim.humidity;
+        UInt32 hits = cache.hits;
+
+        if (bench_consumers[c].read == BENCH_BOTH)
+        {
+            SHT21_Sample_TypeDef sample = SHT21_Cache_Read_Both(&cache, SHT21_RES_RH12_T14, max_age);
+            status = sample.status;
+            temp = sample.temp;
+            humidity = sample.humidity;
+        }
+        else if (bench_consumers[c].read == BENCH_TEMP)
+            status = SHT21_Cache_Read(&cache, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, max_age, &temp);
+        else
+            status = SHT21_Cache_Read(&cache, SHT21_RH_MEASURE, SHT21_RES_RH12_T14, max_age, &humidity);
+
+        // A value at most max_age old is within 0.05 C and 0.1 %RH of the room at 2 s
+        reads++;
+        now = (UInt32)(clock.now_us / 1000ULL);
+        UInt32 temp_age = now - cache.temp_tick;
+        UInt32 humidity_age = now - cache.humidity_tick;
+        UInt32 limit = (max_age > 0U) ? max_age : 1000U;
+        if (status != SHT21_OK || !bench_close(temp, sim.temp, 0.05f) || !bench_close(humidity, sim.humidity, 0.1f) ||
+            (bench_consumers[c].read != BENCH_RH && temp_age >= limit) ||
+            (bench_consumers[c].read != BENCH_TEMP && humidity_age >= limit) ||
+            (cache.hits != hits && sim.transactions != transactions))
+            bad++;
+    }
+
+    printf("%-9s %6u %12u %10.2f %8u %7u %8.1f %%  %s\n", cached ? "max age" : "no cache", reads, sim.conversions,
+           (double)clock.bus_busy_us / 1000.0, cache.hits, cache.misses,
+           100.0 * cache.hits / (cache.hits + cache.misses), bad ? "STALE OR WRONG" : "");
+    return bad == 0 && cache.hits + cache.misses == reads && (cached || cache.hits == 0);
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    for (UInt32 i = 0; i < BENCH_CONSUMERS; i++)
+        printf("%s\n", bench_consumers[i].name);
+    printf("\nrun        reads  conversions  bus ms      hits  misses  hit rate\n");
+    ok = bench_run(0) && ok;
+    ok = bench_run(1) && ok;
+
+    // The STM32 example: a second read within the max age does not touch the bus
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Sim_Init(&sim, &clock);
+    Fake_HAL_Init(&sim);
+
+    float first = SHT21_read_temp(1000U);
+    UInt32 transactions = sim.transactions;
+    HAL_Delay(500);
+    float second = SHT21_read_temp(1000U);
+    int hit = sim.transactions == transactions && second == first && sht21_last_error == HAL_OK;
+    HAL_Delay(600);
+    SHT21_read_temp(1000U);
+    int refreshed = sim.transactions != transactions;
+
+    const SHT21_Cache_TypeDef* cache = SHT21_get_cache();
+    printf("STM32 SHT21_read_temp: %s within max age, %s after, %u hits %u misses\n", hit ? "cached" : "MEASURED",
+           refreshed ? "measured" : "NOT MEASURED", cache->hits, cache->misses);
+    ok = ok && hit && refreshed && cache->hits == 1U && cache->misses == 2U;
+
+    // A max age of 0 measures and counts a miss, in the core as in the wrappers
+    SHT21_read_temp(0U);
+    int wrapper_miss = cache->misses == 3U;
+    SHT21_Cache_TypeDef core_cache;
+    float value;
+    SHT21_Cache_Init(&core_cache, &sim.bus);
+    SHT21_Cache_Read(&core_cache, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, 0U, &value);
+    SHT21_Cache_Read(&core_cache, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, 0U, &value);
+    int core_miss = core_cache.misses == 2U && core_cache.hits == 0U;
+    printf("max age 0: %s\n", wrapper_miss && core_miss ? "a miss" : "COUNTED DIFFERENTLY");
+    ok = ok && wrapper_miss && core_miss;
+
+    // Both values are stamped when their frame was read, the temperature a conversion earlier
+    SHT21_Cache_Invalidate(&core_cache);
+    SHT21_Sample_TypeDef sample = SHT21_Cache_Read_Both(&core_cache, SHT21_RES_RH12_T14, 1000U);
+    UInt32 gap = core_cache.humidity_tick - core_cache.temp_tick;
+    UInt32 rh_conversion = SHT21_Conversion_Time(SHT21_RES_RH12_T14, SHT21_RH_MEASURE) * sim.conversion_percent / 100U;
+    printf("temperature stamped %u ms before humidity\n", gap);
+    ok = ok && sample.status == SHT21_OK && gap + 1U >= rh_conversion;
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_coro.cpp
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  How many sensors one thread drives with the coroutine API of sht21_coro.h. Runs
+ *  100 to 10000 simulated sensors, each sampling at 1 Hz on its own sim and bus, all on
+ *  one executor and one virtual clock, with a heater selftest on the first sensor in
+ *  between. Reports the host CPU time per sample and the sensors per core at 1 Hz,
+ *  against the sensors a thread blocking in SHT21_Measure_Both can serve. Also checks
+ *  that Sht21_Async::measure gives the same samples and bus time as SHT21_Measure_Both.
+ *  Exits with 1 on a failed sample, a late sample or a difference.
+ *
+ *      make bench && build/sht21_bench_coro
+ *
+ *******************************************************************************************/
+#include "sht21_coro.h"
+#include "sht21_sim.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_SECONDS           (30U)
+#define BENCH_PERIOD_MS         (1000U)
+
+static const UInt32 bench_counts[] = { 100U, 1000U, 10000U };
+
+static double bench_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+struct Bench_Sensor
+{
+    SHT21_Sim_TypeDef sim;
+    UInt32 samples;
+    UInt32 errors;
+    UInt32 max_late_ms;
+    UInt32 max_sample_ms;
+};
+
+/********************************************************************************************
+ *  Samples every BENCH_PERIOD_MS from offset on, checking each sample against the sim
+ *******************************************************************************************/
+static Sht21_Task<SHT21_Error_TypeDef> bench_sensor_loop(Sht21_Executor* executor, Bench_Sensor* sensor,
+                                                        UInt32 offset, bool selftest)
+{
+    Sht21_Async device(executor, &sensor->sim.bus);
+
+    SHT21_Error_TypeDef status = co_await device.wait_ready();
+    if (status == SHT21_OK && selftest)
+        status = co_await device.selftest();
+    if (status != SHT21_OK)
+    {
+        sensor->errors++;
+        co_return status;
+    }
+
+    UInt32 next = executor->now() + offset;
+    for (UInt32 i = 0; i < BENCH_SECONDS; i++, next += BENCH_PERIOD_MS)
+    {
+        co_await executor->sleep_until(next);
+        UInt32 start = executor->now();
+        if (start - next > sensor->max_late_ms)
+            sensor->max_late_ms = start - next;
+
+        SHT21_Sample_TypeDef sample = co_await device.measure();
+        if (executor->now() - start > sensor->max_sample_ms)
+            sensor->max_sample_ms = executor->now() - start;
+
+        // The selftest sensor cools down from the heater for a few seconds
+        float temp = sensor->sim.temp + sensor->sim.heater_rise;
+        float humidity = sensor->sim.humidity - SHT21_SIM_RH_PER_C * sensor->sim.heater_rise;
+        sensor->samples++;
+        if (sample.status != SHT21_OK || sample.temp < temp - 0.05f || sample.temp > temp + 0.05f ||
+            sample.humidity < humidity - 0.2f || sample.humidity > humidity + 0.2f)
+            sensor->errors++;
+    }
+    co_return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  count sensors for BENCH_SECONDS, returns false on a failed or late sample
+ *******************************************************************************************/
+static bool bench_sensors(UInt32 count)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    std::vector<Bench_Sensor> sensors(count);
+
+    for (UInt32 i = 0; i < count; i++)
+    {
+        SHT21_Sim_Init(&sensors[i].sim, &clock);
+        sensors[i].sim.bit_time_us = 0;     // Every sensor on its own bus, transfers do not delay the others
+        sensors[i].sim.temp = -10.0f + (float)(i % 500U) * 0.1f;
+        sensors[i].sim.humidity = 10.0f + (float)(i % 800U) * 0.1f;
+    }
+
+    Sht21_Executor executor(&sensors[0].sim.bus);
+    for (UInt32 i = 0; i < count; i++)
+        executor.spawn(bench_sensor_loop(&executor, &sensors[i], i * BENCH_PERIOD_MS / count, i == 0));
+
+    double start = bench_cpu_ns();
+    executor.run();
+    double cpu_ns = bench_cpu_ns() - start;
+
+    UInt32 samples = 0;
+    UInt32 errors = 0;
+    UInt32 max_late_ms = 0;
+    UInt32 max_sample_ms = 0;
+    for (UInt32 i = 0; i < count; i++)
+    {
+        samples += sensors[i].samples;
+        errors += sensors[i].errors;
+        if (sensors[i].max_late_ms > max_late_ms)
+            max_late_ms = sensors[i].max_late_ms;
+        if (sensors[i].max_sample_ms > max_sample_ms)
+            max_sample_ms = sensors[i].max_sample_ms;
+    }
+
+    double ns_per_sample = cpu_ns / samples;
+    printf("%7u %8u %6u %10.1f %8u %9u %10.2f %14.0f\n", count, samples, errors, (double)clock.now_us / 1e6,
+           max_late_ms, max_sample_ms, ns_per_sample / 1000.0, 1e9 / ns_per_sample);
+
+    return executor.pending() == 0 && errors == 0 && samples == count * BENCH_SECONDS && max_late_ms <= 1U;
+}
+
+/********************************************************************************************
+ *  Sht21_Async::measure on one sim against SHT21_Measure_Both on another
+ *******************************************************************************************/
+static Sht21_Task<SHT21_Error_TypeDef> bench_compare_loop(Sht21_Executor* executor, SHT21_Sim_TypeDef* sim,
+                                                         SHT21_Sim_TypeDef* ref, bool* same)
+{
+    Sht21_Async device(executor, &sim->bus);
+    for (UInt32 i = 0; i < 1000U; i++)
+    {
+        sim->temp = ref->temp = -20.0f + (float)i * 0.1f;
+        sim->humidity = ref->humidity = 5.0f + (float)(i % 900U) * 0.1f;
+
+        SHT21_Sample_TypeDef a = co_await device.measure();
+        SHT21_Sample_TypeDef b = SHT21_Measure_Both(&ref->bus, SHT21_RES_RH12_T14);
+        *same = *same && a.status == SHT21_OK && b.status == SHT21_OK && a.temp == b.temp && a.humidity == b.humidity;
+    }
+    co_return SHT21_OK;
+}
+
+static bool bench_compare(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_Clock_TypeDef ref_clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Sim_TypeDef ref;
+    SHT21_Sim_Init(&sim, &clock);
+    SHT21_Sim_Init(&ref, &ref_clock);
+
+    bool same = true;
+    Sht21_Executor executor(&sim.bus);
+    executor.spawn(bench_compare_loop(&executor, &sim, &ref, &same));
+    executor.run();
+
+    same = same && clock.now_us == ref_clock.now_us && clock.bus_busy_us == ref_clock.bus_busy_us &&
+           sim.transactions == ref.transactions;
+    printf("Sht21_Async::measure against SHT21_Measure_Both: %s\n", same ? "same samples and bus time" : "MISMATCH");
+    return same;
+}
+
+int main(void)
+{
+    bool ok = bench_compare();
+
+    // A thread blocking in SHT21_Measure_Both is held for the whole conversion
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Sim_Init(&sim, &clock);
+    ok = ok && SHT21_Measure_Both(&sim.bus, SHT21_RES_RH12_T14).status == SHT21_OK;
+    double blocking_ms = (double)clock.now_us / 1000.0;
+    printf("blocking: %.1f ms per sample, %u sensors per thread at 1 Hz\n\n", blocking_ms,
+           (UInt32)(BENCH_PERIOD_MS / blocking_ms));
+
+    printf("sensors  samples errors  virtual s  late ms sample ms  cpu us/sample  sensors/core 1 Hz\n");
+    for (UInt32 i = 0; i < sizeof(bench_counts) / sizeof(bench_counts[0]); i++)
+        ok = bench_sensors(bench_counts[i]) && ok;
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
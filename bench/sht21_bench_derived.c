@@ -0,0 +1,149 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_derived.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Accuracy and speed of the derived values against libm. The reference is the same
+ *  Magnus formulas in double precision with log and exp, the errors are the maximum
+ *  over -40 to 125 C and 1 to 100 %RH, for the enthalpy up to 80 C. Timing runs over a
+ *  day of samples. Exits with 1 if an error is above the bound given in sht21_derived.h.
+ *
+ *      make bench && build/sht21_bench_derived
+ *
+ *******************************************************************************************/
+#include "sht21_derived.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_SAMPLES               (86400U)
+#define BENCH_ROUNDS                (50U)
+#define BENCH_ENTHALPY_MAX_TEMP     (80.0f)
+
+static float bench_temp[BENCH_SAMPLES];
+static float bench_rh[BENCH_SAMPLES];
+static SHT21_Derived_TypeDef bench_out[BENCH_SAMPLES];
+static volatile float bench_sink;
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void bench_magnus(double temp, double* tn, double* m)
+{
+    *tn = (temp < 0.0) ? SHT21_MAGNUS_ICE_TN : SHT21_MAGNUS_WATER_TN;
+    *m = (temp < 0.0) ? SHT21_MAGNUS_ICE_M : SHT21_MAGNUS_WATER_M;
+}
+
+// The formulas of sht21_derived.c in double precision with libm
+static SHT21_Derived_TypeDef bench_reference(double temp, double rh)
+{
+    SHT21_Derived_TypeDef out;
+    double tn, m;
+    bench_magnus(temp, &tn, &m);
+
+    double gamma = m * temp / (tn + temp) + log(rh / 100.0);
+    out.dew_point = (float)(tn * gamma / (m - gamma));
+
+    double pw = rh / 100.0 * (double)SHT21_MAGNUS_A * exp(m * temp / (tn + temp));
+    out.abs_humidity = (float)(216.7 * pw / (273.15 + temp));
+    out.enthalpy = (float)(1.006 * temp + 0.622 * pw / ((double)SHT21_DERIVED_PRESSURE - pw) * (2501.0 + 1.86 * temp));
+    return out;
+}
+
+// The same in single precision with logf and expf, what the consumers do today
+static SHT21_Derived_TypeDef bench_libm(float temp, float rh)
+{
+    SHT21_Derived_TypeDef out;
+    float tn = (temp < 0.0f) ? SHT21_MAGNUS_ICE_TN : SHT21_MAGNUS_WATER_TN;
+    float m = (temp < 0.0f) ? SHT21_MAGNUS_ICE_M : SHT21_MAGNUS_WATER_M;
+    float magnus = m * temp / (tn + temp);
+
+    float gamma = magnus + logf(rh / 100.0f);
+    out.dew_point = tn * gamma / (m - gamma);
+
+    float pw = rh / 100.0f * SHT21_MAGNUS_A * expf(magnus);
+    out.abs_humidity = 216.7f * pw / (273.15f + temp);
+    out.enthalpy = 1.006f * temp + 0.622f * pw / (SHT21_DERIVED_PRESSURE - pw) * (2501.0f + 1.86f * temp);
+    return out;
+}
+
+static void bench_max(float* max, float error)
+{
+    if (error > *max)
+        *max = error;
+}
+
+// Absolute error of the dew point, relative error of the other two. The enthalpy is only
+// compared up to BENCH_ENTHALPY_MAX_TEMP, above it the vapor pressure nears the air pressure.
+static void bench_max_error(SHT21_Derived_TypeDef* max, float temp, SHT21_Derived_TypeDef value,
+                            SHT21_Derived_TypeDef ref)
+{
+    bench_max(&max->dew_point, fabsf(value.dew_point - ref.dew_point));
+    bench_max(&max->abs_humidity, fabsf(value.abs_humidity - ref.abs_humidity) / ref.abs_humidity);
+    if (temp <= BENCH_ENTHALPY_MAX_TEMP)
+        bench_max(&max->enthalpy, fabsf(value.enthalpy - ref.enthalpy) / fmaxf(fabsf(ref.enthalpy), 1.0f));
+}
+
+static double bench_time(int kind)
+{
+    double start = bench_now_ns();
+    for (UInt32 round = 0; round < BENCH_ROUNDS; round++)
+    {
+        if (kind == 0)
+        {
+            for (UInt32 i = 0; i < BENCH_SAMPLES; i++)
+                bench_out[i] = bench_libm(bench_temp[i], bench_rh[i]);
+        }
+        else if (kind == 1)
+        {
+            for (UInt32 i = 0; i < BENCH_SAMPLES; i++)
+                bench_out[i] = SHT21_Derived(bench_temp[i], bench_rh[i]);
+        }
+        else
+            SHT21_Derived_Batch(bench_temp, bench_rh, BENCH_SAMPLES, bench_out);
+        bench_sink = bench_out[round].dew_point;
+    }
+    return (bench_now_ns() - start) / ((double)BENCH_ROUNDS * BENCH_SAMPLES);
+}
+
+int main(void)
+{
+    SHT21_Derived_TypeDef fast_error = {0};
+    SHT21_Derived_TypeDef libm_error = {0};
+
+    for (float temp = -40.0f; temp <= 125.0f; temp += 0.05f)
+    {
+        for (float rh = 1.0f; rh <= 100.0f; rh += 0.25f)
+        {
+            SHT21_Derived_TypeDef ref = bench_reference(temp, rh);
+            bench_max_error(&fast_error, temp, SHT21_Derived(temp, rh), ref);
+            bench_max_error(&libm_error, temp, bench_libm(temp, rh), ref);
+        }
+    }
+
+    printf("max error            dew point C   abs humidity rel   enthalpy rel\n");
+    printf("libm, float          %11.6f   %16.2e   %12.2e\n", libm_error.dew_point, libm_error.abs_humidity,
+           libm_error.enthalpy);
+    printf("SHT21_Derived        %11.6f   %16.2e   %12.2e\n", fast_error.dew_point, fast_error.abs_humidity,
+           fast_error.enthalpy);
+
+    for (UInt32 i = 0; i < BENCH_SAMPLES; i++)
+    {
+        bench_temp[i] = 22.0f + 3.0f * sinf(2.0f * 3.14159265f * (float)i / BENCH_SAMPLES);
+        bench_rh[i] = 45.0f - 10.0f * sinf(2.0f * 3.14159265f * (float)i / BENCH_SAMPLES);
+    }
+
+    printf("\nlibm, float          %6.2f ns/sample\n", bench_time(0));
+    printf("SHT21_Derived        %6.2f ns/sample\n", bench_time(1));
+    printf("SHT21_Derived_Batch  %6.2f ns/sample\n", bench_time(2));
+
+    int ok = fast_error.dew_point < 1e-4f && fast_error.abs_humidity < 5e-6f && fast_error.enthalpy < 5e-6f;
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_filter.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Median 5, EMA 1/8 and decimate by 16 on noisy temperature frames with spikes, once
+ *  on the raw readings with sht21_filter.c and once the way application code does it,
+ *  converting every frame to float first. Reports ns per input frame, the difference
+ *  between the two and how far the spikes got through. Exits with 1 if the filters
+ *  disagree by more than BENCH_MAX_DIFF or a spike is not rejected.
+ *
+ *      make bench && build/sht21_bench_filter
+ *
+ *******************************************************************************************/
+#include "sht21_filter.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_FRAMES        (86400U)
+#define BENCH_ROUNDS        (20U)
+#define BENCH_MEDIAN        (5U)
+#define BENCH_EMA_SHIFT     (3U)
+#define BENCH_DECIMATE      (16U)
+#define BENCH_SPIKE_EVERY   (97U)
+#define BENCH_MAX_DIFF      (0.01f)     // C between the integer and the float filters
+#define BENCH_MAX_SPIKE     (0.05f)     // C from the output without spikes
+
+static UInt8 bench_frames[BENCH_FRAMES * 3U];
+static UInt8 bench_clean[BENCH_FRAMES * 3U];
+static float bench_out_ticks[BENCH_FRAMES / BENCH_DECIMATE];
+static float bench_out_float[BENCH_FRAMES / BENCH_DECIMATE];
+static float bench_out_clean[BENCH_FRAMES / BENCH_DECIMATE];
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void bench_frame(UInt8* frame, UInt16 reading)
+{
+    frame[0] = (UInt8)(reading >> 8);
+    frame[1] = (UInt8)reading & 0xFCU;
+    for (frame[2] = 0; SHT21_Check_Crc(frame, 2, frame[2]) != 0; frame[2]++)
+        ;
+}
+
+// A day at 1 Hz, 22 +- 3 C with +-4 ticks of noise, every 97th frame a spike of 10 C
+static void bench_fill(void)
+{
+    UInt32 seed = 1U;
+    for (UInt32 i = 0; i < BENCH_FRAMES; i++)
+    {
+        float temp = 22.0f + 3.0f * sinf(2.0f * 3.14159265f * (float)i / BENCH_FRAMES);
+        Int32 reading = (Int32)((temp + 46.85f) / 175.72f * 65536.0f) & ~3;
+        seed = seed * 1103515245U + 12345U;
+        reading += (Int32)((seed >> 16) % 9U) * 4 - 16;
+        bench_frame(&bench_clean[i * 3U], (UInt16)reading);
+        if ((i % BENCH_SPIKE_EVERY) == BENCH_SPIKE_EVERY - 1U)
+            reading += 3728;
+        bench_frame(&bench_frames[i * 3U], (UInt16)reading);
+    }
+}
+
+static UInt32 bench_ticks(const UInt8* frames, float* out)
+{
+    SHT21_Filter_TypeDef filter;
+    UInt32 outputs = 0;
+
+    SHT21_Filter_Init(&filter);
+    SHT21_Filter_Add_Median(&filter, BENCH_MEDIAN);
+    SHT21_Filter_Add_Ema(&filter, BENCH_EMA_SHIFT);
+    SHT21_Filter_Add_Decimator(&filter, BENCH_DECIMATE);
+
+    for (UInt32 i = 0; i < BENCH_FRAMES; i++)
+    {
+        UInt16 reading;
+        if (SHT21_Parse_Reading((UInt8*)&frames[i * 3U], &reading) != SHT21_OK)
+            continue;
+        if (SHT21_Filter_Update(&filter, reading, &reading))
+            out[outputs++] = SHT21_Convert_Temp(reading);
+    }
+    return outputs;
+}
+
+static int bench_compare(const void* a, const void* b)
+{
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+// The same chain in float, converting every frame and sorting a copy of the window
+static UInt32 bench_float(const UInt8* frames, float* out)
+{
+    float window[BENCH_MEDIAN];
+    float sorted[BENCH_MEDIAN];
+    UInt32 count = 0;
+    UInt32 outputs = 0;
+    float ema = 0.0f;
+    float sum = 0.0f;
+
+    for (UInt32 i = 0; i < BENCH_FRAMES; i++)
+    {
+        float temp;
+        if (SHT21_Parse_Temp_Checked((UInt8*)&frames[i * 3U], &temp) != SHT21_OK)
+            continue;
+
+        window[count % BENCH_MEDIAN] = temp;
+        count++;
+        UInt32 fill = count < BENCH_MEDIAN ? count : BENCH_MEDIAN;
+        memcpy(sorted, window, fill * sizeof(float));
+        qsort(sorted, fill, sizeof(float), bench_compare);
+        float median = sorted[(fill - 1U) / 2U];
+
+        ema = (count == 1U) ? median : ema + (median - ema) / (float)(1U << BENCH_EMA_SHIFT);
+        sum += ema;
+        if ((count % BENCH_DECIMATE) == 0)
+        {
+            out[outputs++] = sum / BENCH_DECIMATE;
+            sum = 0.0f;
+        }
+    }
+    return outputs;
+}
+
+static double bench_time(UInt32 (*fn)(const UInt8*, float*), float* out)
+{
+    fn(bench_frames, out);
+    double start = bench_now_ns();
+    for (UInt32 round = 0; round < BENCH_ROUNDS; round++)
+        fn(bench_frames, out);
+    return (bench_now_ns() - start) / ((double)BENCH_ROUNDS * BENCH_FRAMES);
+}
+
+int main(void)
+{
+    bench_fill();
+
+    double ns_ticks = bench_time(bench_ticks, bench_out_ticks);
+    double ns_float = bench_time(bench_float, bench_out_float);
+    UInt32 outputs = bench_ticks(bench_frames, bench_out_ticks);
+    bench_float(bench_frames, bench_out_float);
+    bench_ticks(bench_clean, bench_out_clean);
+
+    float diff = 0.0f;
+    float spike = 0.0f;
+    for (UInt32 i = 0; i < outputs; i++)
+    {
+        diff = fmaxf(diff, fabsf(bench_out_ticks[i] - bench_out_float[i]));
+        spike = fmaxf(spike, fabsf(bench_out_ticks[i] - bench_out_clean[i]));
+    }
+
+    printf("%u frames, %u outputs\n", BENCH_FRAMES, outputs);
+    printf("raw readings         %6.2f ns/frame\n", ns_ticks);
+    printf("float per frame      %6.2f ns/frame\n", ns_float);
+    printf("max difference       %8.4f C\n", diff);
+    printf("max spike residue    %8.4f C\n", spike);
+
+    int ok = diff <= BENCH_MAX_DIFF && spike <= BENCH_MAX_SPIKE;
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_fixed.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Compares the integer conversions in sht21_fixed.c against the float parsers. Checks
+ *  the documented error bounds over every possible reading and reports the cost of
+ *  each conversion.
+ *
+ *  On a host with an FPU the float conversion is a few instructions, so the difference
+ *  is small. On a Cortex-M0 every float operation is a call into the soft-float
+ *  library. To show that cost on the host the float conversion is also run through an
+ *  integer only IEEE single implementation below, the same work the library does for
+ *  __aeabi_ui2f, __aeabi_fmul and __aeabi_fadd. It is checked to give the same bits as
+ *  the FPU for every reading.
+ *
+ *      make bench && build/sht21_bench_fixed
+ *
+ *******************************************************************************************/
+#include "sht21_fixed.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES() __rdtsc()
+#else
+#define BENCH_CYCLES() 0ULL
+#endif
+
+#define BENCH_ROUNDS    (200U)
+
+typedef enum
+{
+    BENCH_FLOAT                 = (0x00U),
+    BENCH_SOFT_FLOAT            = (0x01U),
+    BENCH_FIXED                 = (0x02U)
+} Bench_Path_TypeDef;
+
+static volatile float bench_sink_f;
+static volatile UInt32 bench_sink_u;
+static volatile Int16 bench_sink_i;
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static UInt32 bench_bits(float f)
+{
+    UInt32 bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+/*
+ *  IEEE single precision on integers, round to nearest even. Only normal numbers and
+ *  zero, which is all the conversions produce.
+ */
+static UInt32 bench_sf_round(UInt32 sign, Int32 exp, unsigned long long mant, Int32 top)
+{
+    // mant has its leading one at bit top, the result keeps 24 bits
+    Int32 shift = top - 23;
+    UInt32 m;
+    if (shift > 0)
+    {
+        unsigned long long rem = mant & ((1ULL << shift) - 1ULL);
+        unsigned long long half = 1ULL << (shift - 1);
+        m = (UInt32)(mant >> shift);
+        if (rem > half || (rem == half && (m & 1U)))
+            m++;
+        if (m == 0x1000000U)
+        {
+            m >>= 1;
+            exp++;
+        }
+    }
+    else
+        m = (UInt32)(mant << -shift);
+    return sign | ((UInt32)exp << 23) | (m & 0x7FFFFFU);
+}
+
+static Int32 bench_sf_top(unsigned long long x)
+{
+    return 63 - __builtin_clzll(x);
+}
+
+static UInt32 bench_sf_from_u16(UInt16 v)
+{
+    if (v == 0)
+        return 0;
+    Int32 top = bench_sf_top(v);
+    return bench_sf_round(0, 127 + top, v, top);
+}
+
+static UInt32 bench_sf_mul(UInt32 a, UInt32 b)
+{
+    UInt32 sign = (a ^ b) & 0x80000000U;
+    if ((a & 0x7FFFFFFFU) == 0 || (b & 0x7FFFFFFFU) == 0)
+        return sign;
+
+    Int32 exp = (Int32)((a >> 23) & 0xFFU) + (Int32)((b >> 23) & 0xFFU) - 127;
+    unsigned long long mant = (unsigned long long)((a & 0x7FFFFFU) | 0x800000U) * ((b & 0x7FFFFFU) | 0x800000U);
+    Int32 top = bench_sf_top(mant);
+    return bench_sf_round(sign, exp + top - 46, mant, top);
+}
+
+static UInt32 bench_sf_add(UInt32 a, UInt32 b)
+{
+    if ((a & 0x7FFFFFFFU) < (b & 0x7FFFFFFFU))
+    {
+        UInt32 t = a;
+        a = b;
+        b = t;
+    }
+    if ((b & 0x7FFFFFFFU) == 0)
+        return a;
+
+    Int32 exp_a = (Int32)((a >> 23) & 0xFFU);
+    Int32 diff = exp_a - (Int32)((b >> 23) & 0xFFU);
+    unsigned long long x = (unsigned long long)((a & 0x7FFFFFU) | 0x800000U) << 32;
+    unsigned long long y = (unsigned long long)((b & 0x7FFFFFU) | 0x800000U) << 32;
+
+    // Bits shifted out of the smaller one are kept as a sticky bit
+    if (diff > 60)
+        y = 1;
+    else if (diff > 0)
+        y = (y >> diff) | ((y & ((1ULL << diff) - 1ULL)) != 0);
+
+    x = ((a ^ b) & 0x80000000U) ? x - y : x + y;
+    if (x == 0)
+        return 0;
+    Int32 top = bench_sf_top(x);
+    return bench_sf_round(a & 0x80000000U, exp_a + top - 55, x, top);
+}
+
+// SHT21_Convert_Temp and SHT21_Convert_RH, operation by operation
+static UInt32 bench_sf_convert(UInt16 reading, UInt32 offset, UInt32 scale)
+{
+    static const UInt32 inv_65536 = 0x37800000U;  // 1 / 65536
+    return bench_sf_add(offset, bench_sf_mul(scale, bench_sf_mul(bench_sf_from_u16(reading), inv_65536)));
+}
+
+/********************************************************************************************
+ *  Returns the largest difference between the integer and float conversion over every
+ *  masked reading.
+ *******************************************************************************************/
+static float bench_max_error(int humidity)
+{
+    float max_error = 0.0f;
+    for (UInt32 r = 0; r < 65536U; r += 4U)
+    {
+        float ref = humidity ? SHT21_Convert_RH((UInt16)r) : SHT21_Convert_Temp((UInt16)r);
+        Int16 centi = humidity ? SHT21_Convert_RH_Centi((UInt16)r) : SHT21_Convert_Temp_Centi((UInt16)r);
+        float error = (float)centi / 100.0f - ref;
+        if (error < 0.0f)
+            error = -error;
+        if (error > max_error)
+            max_error = error;
+    }
+    return max_error;
+}
+
+// Returns the number of readings the soft-float path gives other bits than the FPU for
+static UInt32 bench_soft_float_mismatches(void)
+{
+    UInt32 mismatches = 0;
+    for (UInt32 r = 0; r < 65536U; r += 4U)
+    {
+        mismatches += bench_sf_convert((UInt16)r, bench_bits(-46.85f), bench_bits(175.72f)) !=
+                      bench_bits(SHT21_Convert_Temp((UInt16)r));
+        mismatches += bench_sf_convert((UInt16)r, bench_bits(-6.0f), bench_bits(125.0f)) !=
+                      bench_bits(SHT21_Convert_RH((UInt16)r));
+    }
+    return mismatches;
+}
+
+// Returns the ns per conversion
+static double bench_run(const char* name, Bench_Path_TypeDef path)
+{
+    const UInt32 temp_offset = bench_bits(-46.85f);
+    const UInt32 temp_scale = bench_bits(175.72f);
+    const UInt32 rh_offset = bench_bits(-6.0f);
+    const UInt32 rh_scale = bench_bits(125.0f);
+
+    unsigned long long cycles = BENCH_CYCLES();
+    double start = bench_now_ns();
+    for (UInt32 round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for (UInt32 r = 0; r < 65536U; r += 4U)
+        {
+            if (path == BENCH_FIXED)
+            {
+                bench_sink_i = SHT21_Convert_Temp_Centi((UInt16)r);
+                bench_sink_i = SHT21_Convert_RH_Centi((UInt16)r);
+            }
+            else if (path == BENCH_SOFT_FLOAT)
+            {
+                bench_sink_u = bench_sf_convert((UInt16)r, temp_offset, temp_scale);
+                bench_sink_u = bench_sf_convert((UInt16)r, rh_offset, rh_scale);
+            }
+            else
+            {
+                bench_sink_f = SHT21_Convert_Temp((UInt16)r);
+                bench_sink_f = SHT21_Convert_RH((UInt16)r);
+            }
+        }
+    }
+    double ops = (double)BENCH_ROUNDS * 16384.0 * 2.0;
+    double ns = (bench_now_ns() - start) / ops;
+    cycles = BENCH_CYCLES() - cycles;
+    printf("%-11s %8.3f ns/op %8.2f cycles/op\n", name, ns, (double)cycles / ops);
+    return ns;
+}
+
+int main(void)
+{
+    float temp_error = bench_max_error(0);
+    float rh_error = bench_max_error(1);
+    UInt32 mismatches = bench_soft_float_mismatches();
+
+    printf("max error temp: %.5f C\n", temp_error);
+    printf("max error rh:   %.5f %%RH\n", rh_error);
+    printf("soft-float bits differing from the FPU: %u\n", mismatches);
+
+    bench_run("float", BENCH_FLOAT);
+    double soft = bench_run("soft-float", BENCH_SOFT_FLOAT);
+    double fixed = bench_run("fixed", BENCH_FIXED);
+    printf("fixed is %.1f x faster than soft-float\n", soft / fixed);
+
+    // Same bounds as documented in sht21_fixed.h and checked by make test
+    int ok = temp_error <= 0.0051f && rh_error <= 0.0051f && mismatches == 0;
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_log.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Writes 30 days of 1 Hz samples to a log, reopening it halfway, and reads them back.
+ *  Reports the file size against printf text and a raw struct per sample, the write
+ *  and full decode rates, and the time and blocks touched by range queries. Exits with
+ *  1 if any sample does not read back exactly, if a corrupt frame is appended or if a
+ *  failed open leaves the file open.
+ *
+ *      make bench && build/sht21_bench_log
+ *
+ *******************************************************************************************/
+#define _GNU_SOURCE
+#include "sht21_logfile.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_SAMPLES       (30U * 24U * 3600U)
+#define BENCH_QUERIES       (1000U)
+#define BENCH_QUERY_MS      (3600000ULL)    // 1 hour
+#define BENCH_START_MS      (1790000000000ULL)
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Sample i of an indoor day cycle with sensor noise and a few ms of timer jitter
+static void bench_sample(UInt32 i, SHT21_Log_Record_TypeDef* record)
+{
+    static UInt32 seed;
+    if (i == 0)
+        seed = 1U;
+    seed = seed * 1103515245U + 12345U;
+
+    double day = 2.0 * 3.14159265358979 * (double)i / 86400.0;
+    double temp = 22.0 + 2.5 * sin(day) + 0.01 * (double)((seed >> 16) % 5U);
+    double rh = 45.0 - 8.0 * sin(day) + 0.04 * (double)((seed >> 20) % 3U);
+
+    record->time_ms = BENCH_START_MS + 1000ULL * i + (seed >> 24) % 4U;
+    record->temp_ticks = (UInt16)((temp + 46.85) / 175.72 * 65536.0) >> 2;
+    record->rh_ticks = (UInt16)((rh + 6.0) / 125.0 * 65536.0) >> 4;
+}
+
+// A 3 byte frame of reading with its CRC
+static void bench_frame(UInt16 reading, UInt8* frame)
+{
+    frame[0] = (UInt8)(reading >> 8);
+    frame[1] = (UInt8)reading;
+    frame[2] = 0;
+    while (SHT21_Check_Crc(frame, 2, frame[2]) != 0)
+        frame[2]++;
+}
+
+/********************************************************************************************
+ *  A corrupt frame is not appended, and a file that is not a log is closed again.
+ *  Returns the number of errors.
+ *******************************************************************************************/
+static UInt32 bench_failures(const char* path)
+{
+    SHT21_Logfile_TypeDef log;
+    UInt8 temp_frame[3], rh_frame[3];
+    UInt32 errors = 0;
+
+    bench_frame(0x6640U, temp_frame);
+    bench_frame(0x7B12U, rh_frame);
+    if (SHT21_Logfile_Open(&log, path) != SHT21_OK)
+        return 1;
+    UInt16 count = log.writer.header.count;
+    rh_frame[1] ^= 0x10U;
+    errors += SHT21_Logfile_Append(&log, BENCH_START_MS + 1000ULL * BENCH_SAMPLES, temp_frame, rh_frame) !=
+              SHT21_CHECKSUM_ERROR;
+    rh_frame[1] ^= 0x10U;
+    temp_frame[2] ^= 0x01U;
+    errors += SHT21_Logfile_Append(&log, BENCH_START_MS + 1000ULL * BENCH_SAMPLES, temp_frame, rh_frame) !=
+              SHT21_CHECKSUM_ERROR;
+    errors += log.writer.header.count != count;
+    SHT21_Logfile_Close(&log);
+
+    // open() returns the lowest free fd, a leaked one would move the next
+    char bad[] = "/tmp/sht21_bench_bad_XXXXXX";
+    int fd = mkstemp(bad);
+    if (fd < 0)
+        return errors + 1U;
+    errors += write(fd, "not a log file, not a log file, not a log file", 46) != 46;
+    close(fd);
+    int before = open("/dev/null", O_RDONLY);
+    close(before);
+    errors += SHT21_Logfile_Open(&log, bad) != SHT21_UNIT_ERROR || log.fd != -1;
+    int after = open("/dev/null", O_RDONLY);
+    close(after);
+    errors += before != after;
+    unlink(bad);
+
+    printf("corrupt frames and bad file: %s\n", errors ? "FAILED" : "rejected");
+    return errors;
+}
+
+int main(void)
+{
+    char path[] = "/tmp/sht21_bench_log_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return 1;
+    close(fd);
+
+    SHT21_Logfile_TypeDef log;
+    SHT21_Log_Record_TypeDef record, expected;
+    UInt32 errors = 0;
+    size_t text_bytes = 0;
+    char line[64];
+
+    // Write, closing and reopening halfway to continue the last block
+    double start = bench_now_ns();
+    if (SHT21_Logfile_Open(&log, path) != SHT21_OK)
+        return 1;
+    for (UInt32 i = 0; i < BENCH_SAMPLES; i++)
+    {
+        bench_sample(i, &record);
+        if (SHT21_Logfile_Append_Record(&log, &record) != SHT21_OK)
+            errors++;
+        if (i == BENCH_SAMPLES / 2U)
+        {
+            if (SHT21_Logfile_Close(&log) != SHT21_OK || SHT21_Logfile_Open(&log, path) != SHT21_OK)
+                return 1;
+        }
+    }
+    SHT21_Logfile_Close(&log);
+    double write_ns = bench_now_ns() - start;
+
+    for (UInt32 i = 0; i < BENCH_SAMPLES; i++)
+    {
+        bench_sample(i, &record);
+        text_bytes += (size_t)snprintf(line, sizeof(line), "%llu Humidity: %.2f, Temp: %.02f\n", record.time_ms,
+                                       SHT21_Log_RH(&record), SHT21_Log_Temp(&record));
+    }
+
+    SHT21_Logfile_Reader_TypeDef reader;
+    SHT21_Logfile_Cursor_TypeDef cursor;
+    if (SHT21_Logfile_Map(&reader, path) != SHT21_OK)
+        return 1;
+
+    // Full decode, checked against the samples written
+    UInt32 count = 0;
+    float sum = 0.0f;
+    start = bench_now_ns();
+    SHT21_Logfile_Range(&reader, &cursor, 0, ~0ULL);
+    while (SHT21_Logfile_Next(&cursor, &record))
+    {
+        sum += SHT21_Log_Temp(&record);
+        bench_sample(count++, &expected);
+        if (record.time_ms != expected.time_ms || record.temp_ticks != expected.temp_ticks ||
+            record.rh_ticks != expected.rh_ticks)
+            errors++;
+    }
+    double read_ns = bench_now_ns() - start;
+    if (count != BENCH_SAMPLES)
+        errors++;
+
+    // Random one hour windows
+    UInt32 blocks = 0;
+    UInt32 found = 0;
+    srand(1);
+    start = bench_now_ns();
+    for (UInt32 q = 0; q < BENCH_QUERIES; q++)
+    {
+        unsigned long long from = BENCH_START_MS + 1000ULL * (UInt32)(rand() % (BENCH_SAMPLES - 3600U));
+        SHT21_Logfile_Range(&reader, &cursor, from, from + BENCH_QUERY_MS - 1ULL);
+        while (SHT21_Logfile_Next(&cursor, &record))
+            found++;
+        blocks += cursor.blocks_decoded;
+    }
+    double query_ns = bench_now_ns() - start;
+    if (found < BENCH_QUERIES * 3590U)
+        errors++;
+
+    size_t file_bytes = reader.size;
+    printf("%u samples, %u blocks of %u bytes\n", BENCH_SAMPLES, reader.blocks, SHT21_LOG_BLOCK_SIZE);
+    printf("log       %10zu bytes  %6.2f bytes/sample\n", file_bytes, (double)file_bytes / BENCH_SAMPLES);
+    printf("text      %10zu bytes  %6.2f bytes/sample  %5.1fx larger\n", text_bytes,
+           (double)text_bytes / BENCH_SAMPLES, (double)text_bytes / file_bytes);
+    printf("struct    %10zu bytes  %6.2f bytes/sample  %5.1fx larger\n", (size_t)BENCH_SAMPLES * 12U, 12.0,
+           12.0 * BENCH_SAMPLES / file_bytes);
+    printf("write     %8.1f Msamples/s\n", BENCH_SAMPLES / write_ns * 1e3);
+    printf("decode    %8.1f Msamples/s  (mean %.2f C)\n", BENCH_SAMPLES / read_ns * 1e3, sum / count);
+    printf("1 h range %8.1f us/query  %5.1f blocks/query  of %u\n", query_ns / BENCH_QUERIES / 1e3,
+           (double)blocks / BENCH_QUERIES, reader.blocks);
+
+    SHT21_Logfile_Unmap(&reader);
+    errors += bench_failures(path);
+    printf("%s\n", errors ? "FAILED" : "OK");
+    unlink(path);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_mux.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Throughput of the multiplexer scheduler against simulated TCA9548A muxes and SHT21
+ *  sensors on a 100 kHz bus. Time is virtual, every transfer advances the clock by the
+ *  time it occupies the bus, so the figures are deterministic.
+ *
+ *      gcc -O2 -I.. -I../sim sht21_bench_mux.c ../sht21_core.c ../sht21_mux.c ../sim/sht21_sim.c -lm
+ *
+ *******************************************************************************************/
+#include "sht21_mux.h"
+#include "sht21_sim.h"
+
+#include <stdio.h>
+
+#define BENCH_MAX_SENSORS   (SHT21_SIM_MUX_COUNT * SHT21_SIM_MUX_CHANNELS)
+#define BENCH_RUN_US        (10000000U)     // 10 s
+
+static void bench_run(UInt8 count, SHT21_Resolution_TypeDef resolution)
+{
+    static SHT21_Sim_TypeDef sims[BENCH_MAX_SENSORS];
+    static SHT21_Mux_Sensor_TypeDef sensors[BENCH_MAX_SENSORS];
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_Mux_TypeDef mux;
+    SHT21_Mux_Scheduler_TypeDef sched;
+
+    SHT21_Sim_Mux_Init(&mux, &clock);
+    for (UInt8 i = 0; i < count; i++)
+    {
+        SHT21_User_Reg_TypeDef reg = {0};
+        SHT21_Sim_Init(&sims[i], &clock);
+        sims[i].user_reg = SHT21_Set_Resolution(reg, resolution).reg | SHT21_DISABLE_OTP_RELOAD;
+        mux.sensors[i] = &sims[i];
+
+        sensors[i].mux_address = (UInt8)(SHT21_MUX_BASE_ADDRESS + i / SHT21_MUX_CHANNELS);
+        sensors[i].channel = (UInt8)(i % SHT21_MUX_CHANNELS);
+        sensors[i].resolution = resolution;
+    }
+    SHT21_Mux_Init(&sched, &mux.bus, sensors, count);
+
+    while (clock.now_us < BENCH_RUN_US)
+    {
+        UInt32 wait = SHT21_Mux_Step(&sched);
+        if (wait > 0)
+            mux.bus.delay(&mux, wait);
+    }
+
+    UInt32 samples = 0;
+    UInt32 transfers = mux.transactions;
+    for (UInt8 i = 0; i < count; i++)
+    {
+        samples += sensors[i].samples;
+        transfers += sims[i].transactions;
+    }
+
+    double seconds = (double)clock.now_us / 1e6;
+    printf("%3u sensors  %8.1f samples/s  %7.2f per sensor  bus %5.1f %%  %9.1f transfers/s\n",
+           count, samples / seconds, samples / seconds / count,
+           100.0 * (double)clock.bus_busy_us / (double)clock.now_us, transfers / seconds);
+}
+
+int main(void)
+{
+    static const UInt8 counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+    printf("Blocking reference: one T+RH pair takes 130 ms, 7.7 samples/s on the bus\n");
+    printf("\nRH:12 T:14\n");
+    for (UInt8 i = 0; i < sizeof(counts); i++)
+        bench_run(counts[i], SHT21_RES_RH12_T14);
+
+    printf("\nRH:8 T:12\n");
+    for (UInt8 i = 0; i < sizeof(counts); i++)
+        bench_run(counts[i], SHT21_RES_RH8_T12);
+    return 0;
+}
@@ -0,0 +1,181 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_read_mode.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Bus time of the short read modes against the full 3 byte read, on a simulated SHT21
+ *  at 100 kHz. Measures temperature and humidity with SHT21_Measure_Both_Mode at every
+ *  resolution and read mode, then runs 16 sensors behind muxes with the modes mixed
+ *  per sensor. Exits with 1 if a short read is off by more than the resolution, or if
+ *  a 2 byte frame of the wrong measurement is not rejected with SHT21_UNIT_ERROR.
+ *
+ *      make bench && build/sht21_bench_read_mode
+ *
+ *******************************************************************************************/
+#include "sht21_mux.h"
+#include "sht21_sim.h"
+
+#include <stdio.h>
+
+#define BENCH_SAMPLES           (100U)
+#define BENCH_MUX_SENSORS       (16U)
+#define BENCH_MUX_RUN_US        (10000000U)     // 10 s
+
+typedef struct
+{
+    const char* name;
+    SHT21_Resolution_TypeDef resolution;
+    float temp_step;
+    float rh_step;
+} Bench_Resolution_TypeDef;
+
+// One LSB of each resolution, the most a shorter read may truncate
+static const Bench_Resolution_TypeDef bench_resolutions[] =
+{
+    { "RH:12 T:14", SHT21_RES_RH12_T14, 175.72f / 16384.0f, 125.0f / 4096.0f },
+    { "RH:8 T:12",  SHT21_RES_RH8_T12,  175.72f / 4096.0f,  125.0f / 256.0f  },
+    { "RH:10 T:13", SHT21_RES_RH10_T13, 175.72f / 8192.0f,  125.0f / 1024.0f },
+    { "RH:11 T:11", SHT21_RES_RH11_T11, 175.72f / 2048.0f,  125.0f / 2048.0f }
+};
+
+static const char* const bench_modes[] = { "full", "no crc", "msb" };
+
+static void bench_sim_init(SHT21_Sim_TypeDef* sim, SHT21_Sim_Clock_TypeDef* clock, SHT21_Resolution_TypeDef res)
+{
+    SHT21_User_Reg_TypeDef reg = {0};
+    SHT21_Sim_Init(sim, clock);
+    sim->user_reg = SHT21_Set_Resolution(reg, res).reg | SHT21_DISABLE_OTP_RELOAD;
+}
+
+static int bench_close(float value, float expected, float tolerance)
+{
+    return value >= expected - tolerance && value <= expected + tolerance;
+}
+
+/********************************************************************************************
+ *  BENCH_SAMPLES pairs with one read mode for both measurements. Returns the bus time
+ *  of a pair in us, or 0 if a value is off by more than one LSB of the resolution.
+ *******************************************************************************************/
+static double bench_pairs(const Bench_Resolution_TypeDef* res, SHT21_Read_Mode_TypeDef mode)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    UInt32 bad = 0;
+
+    bench_sim_init(&sim, &clock, res->resolution);
+    for (UInt32 i = 0; i < BENCH_SAMPLES; i++)
+    {
+        sim.temp = -10.0f + 0.37f * (float)i;
+        sim.humidity = 5.0f + 0.83f * (float)i;
+
+        SHT21_Sample_TypeDef sample = SHT21_Measure_Both_Mode(&sim.bus, res->resolution, mode, mode);
+        if (sample.status != SHT21_OK || !bench_close(sample.temp, sim.temp, res->temp_step + 0.01f) ||
+            !bench_close(sample.humidity, sim.humidity, res->rh_step + 0.01f))
+            bad++;
+    }
+
+    double per_pair = (double)clock.bus_busy_us / BENCH_SAMPLES;
+    printf("%-10s  %-6s  %2u+%u bytes  %8.1f us  %s\n", res->name, bench_modes[mode],
+           SHT21_Read_Length(mode, res->resolution, SHT21_TEMP_MEASURE),
+           SHT21_Read_Length(mode, res->resolution, SHT21_RH_MEASURE), per_pair, bad ? "OFF BY MORE THAN 1 LSB" : "");
+    return bad ? 0.0 : per_pair;
+}
+
+/********************************************************************************************
+ *  A 2 byte humidity frame must not pass as a temperature, the status bits are all that
+ *  is left to tell them apart.
+ *******************************************************************************************/
+static int bench_wrong_kind(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Measurement_TypeDef meas;
+    float value = 0.0f;
+
+    bench_sim_init(&sim, &clock, SHT21_RES_RH12_T14);
+    SHT21_Error_TypeDef status = SHT21_Measure_Start_Mode(&meas, &sim.bus, SHT21_RH_MEASURE, SHT21_RES_RH12_T14,
+                                                          SHT21_READ_NO_CRC);
+    if (status == SHT21_OK)
+        status = SHT21_Measure_Wait(&meas, SHT21_Conversion_Time(SHT21_RES_RH12_T14, SHT21_RH_MEASURE));
+
+    int rejected = SHT21_Parse_Frame(meas.frame, meas.length, SHT21_TEMP_MEASURE, &value) == SHT21_UNIT_ERROR;
+    int accepted = SHT21_Parse_Frame(meas.frame, meas.length, SHT21_RH_MEASURE, &value) == SHT21_OK;
+    printf("2 byte humidity frame parsed as temperature: %s\n", rejected ? "rejected" : "ACCEPTED");
+    return status == SHT21_OK && meas.length == 2U && rejected && accepted;
+}
+
+/********************************************************************************************
+ *  16 sensors at RH:8 T:12 behind two muxes, every other one on short reads or all on
+ *  full reads. Prints the bus load, returns the bus time per sample in us.
+ *******************************************************************************************/
+static double bench_mux(int short_reads)
+{
+    static SHT21_Sim_TypeDef sims[BENCH_MUX_SENSORS];
+    static SHT21_Mux_Sensor_TypeDef sensors[BENCH_MUX_SENSORS];
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_Mux_TypeDef mux;
+    SHT21_Mux_Scheduler_TypeDef sched;
+
+    SHT21_Sim_Mux_Init(&mux, &clock);
+    for (UInt8 i = 0; i < BENCH_MUX_SENSORS; i++)
+    {
+        bench_sim_init(&sims[i], &clock, SHT21_RES_RH8_T12);
+        mux.sensors[i] = &sims[i];
+
+        sensors[i] = (SHT21_Mux_Sensor_TypeDef){0};
+        sensors[i].mux_address = (UInt8)(SHT21_MUX_BASE_ADDRESS + i / SHT21_MUX_CHANNELS);
+        sensors[i].channel = (UInt8)(i % SHT21_MUX_CHANNELS);
+        sensors[i].resolution = SHT21_RES_RH8_T12;
+        if (short_reads && (i & 1U))
+        {
+            sensors[i].temp_mode = SHT21_READ_NO_CRC;
+            sensors[i].rh_mode = SHT21_READ_MSB;
+        }
+    }
+    SHT21_Mux_Init(&sched, &mux.bus, sensors, BENCH_MUX_SENSORS);
+
+    while (clock.now_us < BENCH_MUX_RUN_US)
+    {
+        UInt32 wait = SHT21_Mux_Step(&sched);
+        if (wait > 0)
+            mux.bus.delay(&mux, wait);
+    }
+
+    UInt32 samples = 0;
+    for (UInt8 i = 0; i < BENCH_MUX_SENSORS; i++)
+        samples += sensors[i].samples;
+
+    double per_sample = (double)clock.bus_busy_us / samples;
+    printf("%-22s  %8.1f samples/s  bus %5.1f %%  %7.1f us per sample\n",
+           short_reads ? "half T no crc, RH msb" : "all full",
+           samples / ((double)clock.now_us / 1e6), 100.0 * (double)clock.bus_busy_us / (double)clock.now_us, per_sample);
+    return per_sample;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    printf("resolution  mode    read bytes  bus per T+RH pair\n");
+    for (UInt32 r = 0; r < sizeof(bench_resolutions) / sizeof(bench_resolutions[0]); r++)
+    {
+        double full = bench_pairs(&bench_resolutions[r], SHT21_READ_FULL);
+        double no_crc = bench_pairs(&bench_resolutions[r], SHT21_READ_NO_CRC);
+        double msb = bench_pairs(&bench_resolutions[r], SHT21_READ_MSB);
+        ok = ok && full > 0.0 && no_crc > 0.0 && msb > 0.0 && no_crc < full && msb <= no_crc;
+        if (bench_resolutions[r].resolution == SHT21_RES_RH8_T12)
+            ok = ok && msb < no_crc;
+    }
+
+    printf("\n");
+    ok = bench_wrong_kind() && ok;
+
+    printf("\n16 sensors behind muxes, RH:8 T:12\n");
+    double full = bench_mux(0);
+    double mixed = bench_mux(1);
+    ok = ok && mixed < full;
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_ready.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Time from power up and soft reset to the first measurement against the simulator,
+ *  probing for readiness instead of the fixed 1 s delays the examples had. Runs
+ *  sensors that start after 2, 8 and 15 ms, a sensor that never answers, and the boot
+ *  sequence of the STM32 example on the HAL stand-in. Exits with 1 if readiness is
+ *  reported before the sensor answers, more than 1 ms after, or not at all.
+ *
+ *      make bench && build/sht21_bench_ready
+ *
+ *******************************************************************************************/
+#include "sht21.h"
+#include "sht21_sim.h"
+
+#include <stdio.h>
+
+#define BENCH_OLD_BOOT_MS       (2000U)     // 1 s before and after the reset
+
+static const UInt32 bench_start_us[] = { 2000U, 8000U, 15000U };
+
+#define BENCH_STARTS            (sizeof(bench_start_us) / sizeof(bench_start_us[0]))
+
+// Checks ready_ms against the time the sim started answering, with 1 ms of probing slack
+static int bench_check(const SHT21_Ready_TypeDef* ready, UInt32 start_us)
+{
+    return ready->ready && ready->ready_ms * 1000U >= start_us && ready->ready_ms * 1000U <= start_us + 1000U;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    printf("sensor starts after   power up ms  probes   soft reset ms  probes\n");
+    for (UInt32 i = 0; i < BENCH_STARTS; i++)
+    {
+        SHT21_Sim_Clock_TypeDef clock = {0};
+        SHT21_Sim_TypeDef sim;
+        SHT21_Ready_TypeDef power_up;
+        SHT21_Ready_TypeDef reset;
+
+        SHT21_Sim_Init(&sim, &clock);
+        sim.reset_time_us = bench_start_us[i];
+
+        SHT21_Sim_Power_Up(&sim);
+        SHT21_Ready_Start(&power_up, &sim.bus, SHT21_POWER_UP_TIME);
+        SHT21_Error_TypeDef status = SHT21_Ready_Wait(&power_up);
+        ok = ok && status == SHT21_OK && bench_check(&power_up, bench_start_us[i]);
+
+        status = SHT21_Soft_Reset(&reset, &sim.bus);
+        if (status == SHT21_OK)
+            status = SHT21_Ready_Wait(&reset);
+        ok = ok && status == SHT21_OK && bench_check(&reset, bench_start_us[i]);
+
+        printf("%14.1f ms %14u %7u %15u %7u\n", bench_start_us[i] / 1000.0, power_up.ready_ms, power_up.probes,
+               reset.ready_ms, reset.probes);
+    }
+
+    // A sensor that never answers is given up at twice the datasheet time
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Ready_TypeDef ready;
+    SHT21_Sim_Init(&sim, &clock);
+    sim.inject_nacks = 0xFFFFFFFFU;
+    SHT21_Ready_Start(&ready, &sim.bus, SHT21_POWER_UP_TIME);
+    SHT21_Error_TypeDef status = SHT21_Ready_Wait(&ready);
+    UInt32 given_up = (UInt32)(clock.now_us / 1000ULL);
+    printf("missing sensor: status %u after %u ms and %u probes\n", status, given_up, ready.probes);
+    ok = ok && status == SHT21_TIME_OUT_ERROR && given_up <= 2U * SHT21_POWER_UP_TIME + 1U;
+
+    // Boot of the STM32 example: wait for power up, reset, wait again, first measurement
+    clock = (SHT21_Sim_Clock_TypeDef){0};
+    SHT21_Sim_Init(&sim, &clock);
+    sim.reset_time_us = 8000U;
+    SHT21_Sim_Power_Up(&sim);
+    Fake_HAL_Init(&sim);
+
+    status = SHT21_wait_ready();
+    HAL_StatusTypeDef reset_status = SHT21_reset();
+    SHT21_Error_TypeDef reset_ready = SHT21_wait_ready();
+    SHT21_Sample_TypeDef sample = SHT21_measure_both();
+    UInt32 boot_ms = (UInt32)(clock.now_us / 1000ULL);
+    printf("STM32 example: first sample after %u ms, was at least %u ms\n", boot_ms, BENCH_OLD_BOOT_MS);
+    ok = ok && status == SHT21_OK && reset_status == HAL_OK && reset_ready == SHT21_OK && sample.status == SHT21_OK;
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_ring.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Stress test of the sample ring with the producer and consumer on separate threads.
+ *  The producer pushes frames numbered in tick, the consumer drains them in batches and
+ *  checks that every entry arrives once, in order and intact, that the numbers missing
+ *  are exactly the overflows, and that received plus overflows is what was pushed.
+ *  Exits with 1 on any mismatch.
+ *
+ *  Runs once with the producer flat out, where overflows are expected, once with the
+ *  producer backing off while the ring is full, where none are, and once paced, with
+ *  the producer pushing at a rate the consumer keeps up with and the consumer spinning
+ *  on the ring, so both are busy at the same time. The paced run allows at most
+ *  BENCH_PACED_OVERFLOW_PPM overflows, and is skipped on a single CPU, where the
+ *  spinning threads only take turns.
+ *
+ *      make bench && build/sht21_bench_ring
+ *
+ *******************************************************************************************/
+#define _GNU_SOURCE
+#include "sht21_ring.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_ENTRIES       (5000000U)
+#define BENCH_BATCH         (16U)
+#define BENCH_PACE_NS       (250.0)         // One push per 250 ns in the paced run
+#define BENCH_PACED_OVERFLOW_PPM    (1000U) // Overflows allowed per million paced pushes
+
+typedef enum
+{
+    BENCH_FLAT_OUT              = (0x00U),
+    BENCH_LOSSLESS              = (0x01U),  // Producer yields while the ring is full
+    BENCH_PACED                 = (0x02U)   // Producer at a bounded rate, consumer spins
+} Bench_Mode_TypeDef;
+
+typedef struct
+{
+    SHT21_Ring_TypeDef ring;
+    Bench_Mode_TypeDef mode;
+    UInt32 attempts;
+    UInt32 pushed;
+    UInt32 received;
+    UInt32 missing;
+    UInt32 batches;
+    UInt32 busy_batches;        // Batches popped while the producer was still pushing
+    UInt32 errors;
+    UInt8 producer_done;
+} Bench_State;
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void bench_frame(UInt32 n, UInt8* frame)
+{
+    frame[0] = (UInt8)(n >> 8);
+    frame[1] = (UInt8)n;
+    frame[2] = (UInt8)(frame[0] ^ frame[1] ^ 0x5AU);
+}
+
+static void* bench_producer(void* arg)
+{
+    Bench_State* state = (Bench_State*)arg;
+    UInt8 frame[3];
+    double start = bench_now_ns();
+
+    for (UInt32 n = 0; n < BENCH_ENTRIES; n++)
+    {
+        bench_frame(n, frame);
+        if (state->mode == BENCH_LOSSLESS)
+        {
+            while (SHT21_Ring_Count(&state->ring) >= SHT21_RING_CAPACITY)
+                sched_yield();
+        }
+        else if (state->mode == BENCH_PACED)
+        {
+            while (bench_now_ns() - start < n * BENCH_PACE_NS)
+                ;
+        }
+        state->attempts++;
+        state->pushed += SHT21_Ring_Push_Frame(&state->ring, n, SHT21_TEMP_MEASURE, frame);
+    }
+    __atomic_store_n(&state->producer_done, 1U, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void* bench_consumer(void* arg)
+{
+    Bench_State* state = (Bench_State*)arg;
+    SHT21_Ring_Entry_TypeDef batch[BENCH_BATCH];
+    UInt32 expected = 0;
+    UInt8 frame[3];
+
+    while (expected < BENCH_ENTRIES)
+    {
+        UInt8 producer_done = __atomic_load_n(&state->producer_done, __ATOMIC_ACQUIRE);
+        UInt32 count = SHT21_Ring_Pop_Batch(&state->ring, batch, BENCH_BATCH);
+        if (count == 0)
+        {
+            // Done once the producer has finished and the ring is drained
+            if (producer_done && SHT21_Ring_Count(&state->ring) == 0)
+                break;
+            if (state->mode != BENCH_PACED)
+                sched_yield();
+            continue;
+        }
+        state->batches++;
+        state->busy_batches += !producer_done;
+
+        // Entries come in order, a number is only skipped when its push overflowed
+        for (UInt32 i = 0; i < count; i++)
+        {
+            bench_frame(batch[i].tick, frame);
+            if (batch[i].tick < expected || batch[i].kind != SHT21_RING_FRAME || batch[i].cmd != SHT21_TEMP_MEASURE ||
+                batch[i].data.frame[0] != frame[0] || batch[i].data.frame[1] != frame[1] ||
+                batch[i].data.frame[2] != frame[2])
+                state->errors++;
+            else
+                state->missing += batch[i].tick - expected;
+            expected = batch[i].tick + 1U;
+        }
+        state->received += count;
+    }
+    state->missing += BENCH_ENTRIES - expected;
+    return 0;
+}
+
+static int bench_run(Bench_Mode_TypeDef mode)
+{
+    static const char* const names[] = { "flat out", "lossless", "paced" };
+    static Bench_State state;
+    pthread_t producer, consumer;
+
+    state = (Bench_State){0};
+    state.mode = mode;
+    SHT21_Ring_Init(&state.ring);
+
+    double start = bench_now_ns();
+    pthread_create(&consumer, 0, bench_consumer, &state);
+    pthread_create(&producer, 0, bench_producer, &state);
+    pthread_join(producer, 0);
+    pthread_join(consumer, 0);
+    double ns = bench_now_ns() - start;
+
+    UInt32 overflows = SHT21_Ring_Overflows(&state.ring);
+    int ok = state.errors == 0 && state.attempts == BENCH_ENTRIES && state.received == state.pushed &&
+             state.received + overflows == state.attempts && state.missing == overflows &&
+             (mode != BENCH_LOSSLESS || overflows == 0) &&
+             (mode != BENCH_PACED || (state.busy_batches > 0 &&
+                                      (double)overflows * 1e6 <= (double)state.attempts * BENCH_PACED_OVERFLOW_PPM));
+
+    printf("%-9s %7.1f Mpushes/s  received %9u  overflows %9u  missing %9u  %5.1f entries/batch  "
+           "%5.1f %% popped while pushing  %s\n",
+           names[mode], BENCH_ENTRIES / ns * 1e3, state.received, overflows, state.missing,
+           (double)state.received / (state.batches ? state.batches : 1U),
+           100.0 * state.busy_batches / (state.batches ? state.batches : 1U), ok ? "OK" : "FAILED");
+    return ok;
+}
+
+int main(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    printf("capacity %u, batch %u, %u entries, %ld CPUs\n", SHT21_RING_CAPACITY, BENCH_BATCH, BENCH_ENTRIES, cpus);
+    int ok = bench_run(BENCH_FLAT_OUT);
+    ok &= bench_run(BENCH_LOSSLESS);
+    if (cpus >= 2)
+        ok &= bench_run(BENCH_PACED);
+    else
+        printf("paced     skipped, needs 2 CPUs for the producer and consumer to run at once\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_selftest.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Runs the step driven selftest against the simulator: a healthy sensor, a broken
+ *  heater, NACKs while heating and an abort. Reports the time to a result against the
+ *  fixed 10 s of the blocking test and the longest a single step holds the caller.
+ *  Also runs SHT21_selftest of the STM32 example on the HAL stand-in. Exits with 1
+ *  if a result is wrong or the heater is left on.
+ *
+ *      make bench && build/sht21_bench_selftest
+ *
+ *******************************************************************************************/
+#include "sht21.h"
+#include "sht21_sim.h"
+
+#include <stdio.h>
+
+#define BENCH_OLD_SELFTEST_MS   (10000U + 4U * 114U)   // Fixed wait and 4 readings at RH12/T14
+
+typedef enum
+{
+    BENCH_HEALTHY               = (0x00U),
+    BENCH_BROKEN_HEATER         = (0x01U),
+    BENCH_NACKS                 = (0x02U),
+    BENCH_ABORT                 = (0x03U)
+} Bench_Case_TypeDef;
+
+static const char* bench_case_names[] = { "healthy", "broken heater", "nacks while heating", "abort" };
+
+typedef struct
+{
+    SHT21_Error_TypeDef result;
+    UInt32 ms;
+    UInt32 steps;
+    UInt32 readings;
+    unsigned long long max_step_us;
+    UInt8 heater_left_on;
+} Bench_Result_TypeDef;
+
+static Bench_Result_TypeDef bench_run(Bench_Case_TypeDef bench_case)
+{
+    Bench_Result_TypeDef result = {0};
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Selftest_TypeDef test;
+    UInt8 injected = 0;
+
+    SHT21_Sim_Init(&sim, &clock);
+    if (bench_case == BENCH_BROKEN_HEATER)
+        sim.heater_max = 0.0f;
+
+    SHT21_Selftest_Start(&test, &sim.bus, 0);
+    SHT21_Error_TypeDef status = SHT21_BUSY;
+    while (status == SHT21_BUSY)
+    {
+        if (test.state == SHT21_SELFTEST_HEATING && test.readings == 1 && !injected)
+        {
+            injected = 1;
+            if (bench_case == BENCH_NACKS)
+                sim.inject_nacks = 2;   // The next reading and the first heater restore
+            if (bench_case == BENCH_ABORT)
+                SHT21_Selftest_Abort(&test);
+        }
+
+        unsigned long long before = clock.now_us;
+        status = SHT21_Selftest_Step(&test);
+        if (clock.now_us - before > result.max_step_us)
+            result.max_step_us = clock.now_us - before;
+        result.steps++;
+
+        if (status == SHT21_BUSY)
+            SHT21_Sim_Advance(&clock, 1000ULL * test.wait);
+    }
+
+    result.result = status;
+    result.ms = (UInt32)(clock.now_us / 1000ULL);
+    result.readings = test.readings;
+    result.heater_left_on = (sim.user_reg & SHT21_ENABLE_CHIP_HEATER) != 0;
+    return result;
+}
+
+int main(void)
+{
+    static const SHT21_Error_TypeDef expected[] = { SHT21_OK, SHT21_SELFTEST_FAILED, SHT21_ACK_ERROR,
+                                                    SHT21_SELFTEST_FAILED };
+    int ok = 1;
+
+    printf("case                  result    ms  steps  readings  longest step us  heater\n");
+    for (UInt8 i = 0; i < 4; i++)
+    {
+        Bench_Result_TypeDef result = bench_run((Bench_Case_TypeDef)i);
+        printf("%-20s %7u %5u %6u %9u %16llu  %s\n", bench_case_names[i], result.result, result.ms, result.steps,
+               result.readings, result.max_step_us, result.heater_left_on ? "LEFT ON" : "off");
+        ok = ok && result.result == expected[i] && !result.heater_left_on;
+        if (i == BENCH_HEALTHY)
+            printf("  %.1f x faster than the fixed wait of %u ms\n", (double)BENCH_OLD_SELFTEST_MS / result.ms,
+                   BENCH_OLD_SELFTEST_MS);
+        if (i == BENCH_BROKEN_HEATER)
+            ok = ok && result.ms >= SHT21_SELFTEST_DEADLINE && result.ms < SHT21_SELFTEST_DEADLINE + 500U;
+    }
+
+    // The blocking wrapper of the STM32 example
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Sim_Init(&sim, &clock);
+    Fake_HAL_Init(&sim);
+    SHT21_Error_TypeDef status = SHT21_selftest();
+    printf("STM32 SHT21_selftest: %u after %llu ms, heater %s\n", status, clock.now_us / 1000ULL,
+           (sim.user_reg & SHT21_ENABLE_CHIP_HEATER) ? "LEFT ON" : "off");
+    ok = ok && status == SHT21_OK && (sim.user_reg & SHT21_ENABLE_CHIP_HEATER) == 0;
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_server.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  1 to 64 client threads reading one simulated SHT21, through the bus owner service of
+ *  sht21_server.h and, for comparison, each running its own transactions on the bus
+ *  under a mutex. The sim waits in real time scaled down by BENCH_SCALE, latencies are
+ *  reported in sensor ms. Reports conversions per request, the share of the time the
+ *  sensor converts and the latency percentiles. Exits with 1 on a failed request or
+ *  if the tail latency through the server grows with the number of clients.
+ *
+ *      make bench && build/sht21_bench_server
+ *
+ *******************************************************************************************/
+#define _GNU_SOURCE
+#include "sht21_server.h"
+#include "sht21_sim.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_SCALE             (4U)        // Sensor ms per real ms
+#define BENCH_REQUESTS          (4U)        // Per client
+#define BENCH_THINK_MS          (50U)       // Most a client waits between requests
+#define BENCH_MAX_CLIENTS       (64U)
+#define BENCH_TAIL_LIMIT_MS     (300.0)     // Two full conversions and scheduling slack
+
+static const UInt32 bench_clients[] = { 1U, 4U, 16U, 64U };
+
+typedef enum
+{
+    BENCH_SERVER                = (0x00U),
+    BENCH_MUTEX                 = (0x01U)
+} Bench_Mode_TypeDef;
+
+typedef struct
+{
+    SHT21_Sim_Clock_TypeDef clock;
+    SHT21_Sim_TypeDef sim;
+    SHT21_Bus_TypeDef bus;
+    SHT21_Server_TypeDef server;
+    pthread_mutex_t mutex;
+    pthread_barrier_t barrier;
+    Bench_Mode_TypeDef mode;
+    double latency_ms[BENCH_MAX_CLIENTS * BENCH_REQUESTS];
+    UInt32 errors;
+} Bench_TypeDef;
+
+typedef struct
+{
+    Bench_TypeDef* bench;
+    UInt32 index;
+} Bench_Client_TypeDef;
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void bench_sleep_sensor_ms(UInt32 ms)
+{
+    struct timespec ts = { 0, (long)(1000000UL * ms / BENCH_SCALE) };
+    while (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    nanosleep(&ts, NULL);
+}
+
+// The sim bus, waiting in scaled real time as well as on the virtual clock
+static void bench_delay(void* handle, UInt32 ms)
+{
+    SHT21_Sim_Advance(((SHT21_Sim_TypeDef*)handle)->clock, 1000ULL * ms);
+    bench_sleep_sensor_ms(ms);
+}
+
+static SHT21_Error_TypeDef bench_mutex_read(Bench_TypeDef* bench, SHT21_Commands_TypeDef cmd, float* value)
+{
+    SHT21_Measurement_TypeDef meas;
+
+    pthread_mutex_lock(&bench->mutex);
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(&meas, &bench->bus, cmd);
+    if (status == SHT21_OK)
+        status = SHT21_Measure_Wait(&meas, SHT21_Conversion_Time(SHT21_RES_RH12_T14, cmd));
+    if (status == SHT21_OK)
+        status = SHT21_Measure_Complete(&meas, value);
+    pthread_mutex_unlock(&bench->mutex);
+    return status;
+}
+
+static void* bench_client(void* arg)
+{
+    Bench_Client_TypeDef* client = (Bench_Client_TypeDef*)arg;
+    Bench_TypeDef* bench = client->bench;
+    unsigned int seed = client->index + 1U;
+    UInt32 errors = 0;
+
+    pthread_barrier_wait(&bench->barrier);
+    for (UInt32 i = 0; i < BENCH_REQUESTS; i++)
+    {
+        bench_sleep_sensor_ms((UInt32)rand_r(&seed) % BENCH_THINK_MS);
+
+        SHT21_Commands_TypeDef cmd = ((client->index + i) & 1U) ? SHT21_RH_MEASURE : SHT21_TEMP_MEASURE;
+        float value = 0.0f;
+        double start = bench_now_ns();
+        SHT21_Error_TypeDef status = (bench->mode == BENCH_SERVER) ?
+            SHT21_Server_Read(&bench->server, cmd, &value) : bench_mutex_read(bench, cmd, &value);
+        bench->latency_ms[client->index * BENCH_REQUESTS + i] = (bench_now_ns() - start) * BENCH_SCALE / 1e6;
+
+        float expected = (cmd == SHT21_TEMP_MEASURE) ? bench->sim.temp : bench->sim.humidity;
+        if (status != SHT21_OK || value < expected - 0.2f || value > expected + 0.2f)
+            errors++;
+    }
+    __atomic_add_fetch(&bench->errors, errors, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static int bench_compare_ms(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/********************************************************************************************
+ *  One run, returns the 99th percentile latency in sensor ms or a negative value on errors
+ *******************************************************************************************/
+static double bench_run(Bench_TypeDef* bench, Bench_Mode_TypeDef mode, UInt32 clients)
+{
+    static Bench_Client_TypeDef args[BENCH_MAX_CLIENTS];
+    pthread_t threads[BENCH_MAX_CLIENTS];
+
+    bench->clock = (SHT21_Sim_Clock_TypeDef){0, 0};
+    SHT21_Sim_Init(&bench->sim, &bench->clock);
+    bench->bus = bench->sim.bus;
+    bench->bus.delay = bench_delay;
+    bench->mode = mode;
+    bench->errors = 0;
+    pthread_barrier_init(&bench->barrier, NULL, clients + 1U);
+
+    if (mode == BENCH_SERVER && SHT21_Server_Start(&bench->server, &bench->bus, SHT21_RES_RH12_T14) != SHT21_OK)
+        return -1.0;
+
+    for (UInt32 i = 0; i < clients; i++)
+    {
+        args[i].bench = bench;
+        args[i].index = i;
+        pthread_create(&threads[i], NULL, bench_client, &args[i]);
+    }
+
+    pthread_barrier_wait(&bench->barrier);
+    double start = bench_now_ns();
+    for (UInt32 i = 0; i < clients; i++)
+        pthread_join(threads[i], NULL);
+    double elapsed_ms = (bench_now_ns() - start) * BENCH_SCALE / 1e6;
+
+    UInt32 requests = clients * BENCH_REQUESTS;
+    UInt32 conversions = bench->sim.conversions;
+    if (mode == BENCH_SERVER)
+        SHT21_Server_Stop(&bench->server);
+    pthread_barrier_destroy(&bench->barrier);
+
+    qsort(bench->latency_ms, requests, sizeof(double), bench_compare_ms);
+    double p50 = bench->latency_ms[requests / 2U];
+    double p99 = bench->latency_ms[(requests * 99U) / 100U];
+    double busy = 100.0 * (double)bench->clock.now_us / 1000.0 / elapsed_ms;
+
+    printf("%-7s %7u %8u %11u %9.2f %6.0f %% %8.1f %8.1f %8.1f\n", mode == BENCH_SERVER ? "server" : "mutex",
+           clients, requests, conversions, (double)conversions / requests, busy, p50, p99,
+           bench->latency_ms[requests - 1U]);
+
+    return bench->errors == 0 ? p99 : -1.0;
+}
+
+int main(void)
+{
+    static Bench_TypeDef bench;
+    int ok = 1;
+
+    pthread_mutex_init(&bench.mutex, NULL);
+
+    printf("mode    clients requests conversions conv/req   busy   p50 ms   p99 ms   max ms\n");
+    for (UInt32 mode = BENCH_SERVER; mode <= BENCH_MUTEX; mode++)
+    {
+        for (UInt32 i = 0; i < sizeof(bench_clients) / sizeof(bench_clients[0]); i++)
+        {
+            double p99 = bench_run(&bench, (Bench_Mode_TypeDef)mode, bench_clients[i]);
+            ok = ok && p99 >= 0.0;
+            if (mode == BENCH_SERVER)
+                ok = ok && p99 <= BENCH_TAIL_LIMIT_MS;
+        }
+    }
+
+    pthread_mutex_destroy(&bench.mutex);
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_sim.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Runs every transaction path of the driver against the SHT21 model and reports the
+ *  virtual time, bus time and number of transfers of each, next to the host time it
+ *  took to simulate. The virtual figures are deterministic.
+ *
+ *      gcc -O2 -I.. -I../sim sht21_bench_sim.c ../sht21_core.c ../sim/sht21_sim.c -lm
+ *
+ *******************************************************************************************/
+#include "sht21_sim.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_OPS       (1000U)
+
+typedef SHT21_Error_TypeDef (*Bench_Op)(SHT21_Sim_TypeDef* sim);
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Hold master: command and a read the sensor stretches until the conversion is done
+static SHT21_Error_TypeDef bench_hold(SHT21_Sim_TypeDef* sim)
+{
+    UInt8 cmd = SHT21_TEMP_MEASURE_HOLD;
+    UInt8 frame[3];
+    SHT21_Error_TypeDef status = sim->bus.write(sim, SHT21_I2C_ADDRESS, &cmd, 1);
+    if (status != SHT21_OK)
+        return status;
+    return sim->bus.read(sim, SHT21_I2C_ADDRESS, frame, 3);
+}
+
+// No hold master, sleeping the conversion time before polling
+static SHT21_Error_TypeDef bench_no_hold(SHT21_Sim_TypeDef* sim)
+{
+    SHT21_Measurement_TypeDef meas;
+    float value;
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(&meas, &sim->bus, SHT21_TEMP_MEASURE);
+    if (status != SHT21_OK)
+        return status;
+    status = SHT21_Measure_Wait(&meas, SHT21_Conversion_Time(SHT21_RES_RH12_T14, SHT21_TEMP_MEASURE));
+    if (status != SHT21_OK)
+        return status;
+    return SHT21_Measure_Complete(&meas, &value);
+}
+
+// No hold master, polling back to back from the start
+static SHT21_Error_TypeDef bench_no_hold_poll(SHT21_Sim_TypeDef* sim)
+{
+    SHT21_Measurement_TypeDef meas;
+    float value;
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(&meas, &sim->bus, SHT21_TEMP_MEASURE);
+    if (status != SHT21_OK)
+        return status;
+
+    do
+        status = SHT21_Measure_Poll(&meas);
+    while (status == SHT21_BUSY);
+
+    if (status != SHT21_OK)
+        return status;
+    return SHT21_Measure_Complete(&meas, &value);
+}
+
+static SHT21_Error_TypeDef bench_both(SHT21_Sim_TypeDef* sim)
+{
+    return SHT21_Measure_Both(&sim->bus, SHT21_RES_RH12_T14).status;
+}
+
+static SHT21_Error_TypeDef bench_read_user_reg(SHT21_Sim_TypeDef* sim)
+{
+    UInt8 cmd = SHT21_READ_USER_REG;
+    UInt8 reg;
+    SHT21_Error_TypeDef status = sim->bus.write(sim, SHT21_I2C_ADDRESS, &cmd, 1);
+    if (status != SHT21_OK)
+        return status;
+    return sim->bus.read(sim, SHT21_I2C_ADDRESS, &reg, 1);
+}
+
+static SHT21_Error_TypeDef bench_write_user_reg(SHT21_Sim_TypeDef* sim)
+{
+    UInt8 buf[2] = { SHT21_WRITE_USER_REG, SHT21_DISABLE_OTP_RELOAD };
+    return sim->bus.write(sim, SHT21_I2C_ADDRESS, buf, 2);
+}
+
+// Soft reset, then probing the user register until the sensor answers
+static SHT21_Error_TypeDef bench_reset(SHT21_Sim_TypeDef* sim)
+{
+    UInt8 cmd = SHT21_SOFT_RESET;
+    SHT21_Error_TypeDef status = sim->bus.write(sim, SHT21_I2C_ADDRESS, &cmd, 1);
+    if (status != SHT21_OK)
+        return status;
+
+    while ((status = bench_read_user_reg(sim)) == SHT21_ACK_ERROR)
+        sim->bus.delay(sim, 1);
+    return status;
+}
+
+static void bench_run(const char* name, Bench_Op op)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Sim_Init(&sim, &clock);
+    UInt32 errors = 0;
+
+    double start = bench_now_ns();
+    for (UInt32 i = 0; i < BENCH_OPS; i++)
+        errors += (op(&sim) != SHT21_OK);
+    double host_ns = bench_now_ns() - start;
+
+    printf("%-16s %9.3f ms/op  bus %8.1f us/op  %6.1f transfers/op  host %7.0f ns/op  %8.0fx real time%s\n",
+           name, (double)clock.now_us / 1000.0 / BENCH_OPS, (double)clock.bus_busy_us / BENCH_OPS,
+           (double)sim.transactions / BENCH_OPS, host_ns / BENCH_OPS,
+           (double)clock.now_us * 1000.0 / host_ns, errors ? "  ERRORS" : "");
+}
+
+int main(void)
+{
+    bench_run("hold", bench_hold);
+    bench_run("no hold", bench_no_hold);
+    bench_run("no hold poll", bench_no_hold_poll);
+    bench_run("measure both", bench_both);
+    bench_run("read user reg", bench_read_user_reg);
+    bench_run("write user reg", bench_write_user_reg);
+    bench_run("soft reset", bench_reset);
+    return 0;
+}
@@ -0,0 +1,175 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_stats.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Transaction stats against the simulator with bit errors and NACKs injected. Checks
+ *  the counters against what the simulator saw, prints the latency percentiles and
+ *  times the host cost of the instrumentation and of a snapshot. Also runs sensors
+ *  behind a simulated mux with stats per sensor. Built against a copy of the library
+ *  compiled with SHT21_STATS, exits with 1 if a counter is off.
+ *
+ *      make bench && build/sht21_bench_stats
+ *
+ *******************************************************************************************/
+#include "sht21_mux.h"
+#include "sht21_retry.h"
+#include "sht21_sim.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_MEASUREMENTS  (20000U)
+#define BENCH_SNAPSHOTS     (1000000U)
+#define BENCH_MUX_SENSORS   (4U)
+#define BENCH_MUX_RUN_US    (10000000U)
+
+static const char* bench_latency_names[SHT21_STATS_LATENCIES] = { "command write", "conversion", "readback" };
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static UInt32 bench_get_us(void* handle)
+{
+    return (UInt32)((SHT21_Sim_Clock_TypeDef*)handle)->now_us;
+}
+
+// Runs the measurements and returns the host time per measurement in ns
+static double bench_measure(SHT21_Sim_TypeDef* sim, SHT21_Retry_TypeDef* retry)
+{
+    double start = bench_now_ns();
+    for (UInt32 i = 0; i < BENCH_MEASUREMENTS; i++)
+    {
+        if ((i % 97U) == 0)
+            sim->inject_nacks = 1;
+        SHT21_Retry_Measure_Both(retry, SHT21_RES_RH12_T14);
+    }
+    return (bench_now_ns() - start) / BENCH_MEASUREMENTS;
+}
+
+static void bench_print(const SHT21_Stats_Snapshot_TypeDef* snapshot)
+{
+    printf("transactions %u, crc errors %u, nacks %u, busy polls %u, timeouts %u, bus errors %u\n",
+           snapshot->counters[SHT21_STATS_TRANSACTIONS], snapshot->counters[SHT21_STATS_CRC_ERRORS],
+           snapshot->counters[SHT21_STATS_NACKS], snapshot->counters[SHT21_STATS_BUSY_POLLS],
+           snapshot->counters[SHT21_STATS_TIMEOUTS], snapshot->counters[SHT21_STATS_BUS_ERRORS]);
+    for (UInt8 i = 0; i < SHT21_STATS_LATENCIES; i++)
+    {
+        SHT21_Stats_Latency_TypeDef latency = (SHT21_Stats_Latency_TypeDef)i;
+        printf("  %-14s p50 <= %6u us  p99 <= %6u us\n", bench_latency_names[i],
+               SHT21_Stats_Percentile(snapshot, latency, 50), SHT21_Stats_Percentile(snapshot, latency, 99));
+    }
+}
+
+static int bench_single(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Stats_TypeDef stats;
+    SHT21_Retry_TypeDef retry;
+    SHT21_Stats_Snapshot_TypeDef snapshot;
+
+    SHT21_Sim_Init(&sim, &clock);
+    sim.bit_error_rate = 1024U;     // 1.6 % of the frames
+    sim.latch_result = 1;
+    SHT21_Stats_Init(&stats, bench_get_us, &clock);
+    SHT21_Retry_Init(&retry, &sim.bus, 0);
+
+    sim.bus.stats = 0;
+    double ns_off = bench_measure(&sim, &retry);
+
+    sim.transactions = 0;
+    sim.bit_errors = 0;
+    sim.bus.stats = &stats;
+    double ns_on = bench_measure(&sim, &retry);
+
+    double start = bench_now_ns();
+    for (UInt32 i = 0; i < BENCH_SNAPSHOTS; i++)
+        SHT21_Stats_Snapshot(&stats, &snapshot);
+    double ns_snapshot = (bench_now_ns() - start) / BENCH_SNAPSHOTS;
+
+    printf("%u measurements of temperature and humidity\n", BENCH_MEASUREMENTS);
+    bench_print(&snapshot);
+    printf("simulator: transactions %u, bit errors %u\n", sim.transactions, sim.bit_errors);
+    printf("host time per measurement: %.0f ns without stats, %.0f ns with, snapshot %.0f ns\n",
+           ns_off, ns_on, ns_snapshot);
+
+    int ok = snapshot.counters[SHT21_STATS_TRANSACTIONS] == sim.transactions &&
+             snapshot.counters[SHT21_STATS_CRC_ERRORS] == sim.bit_errors &&
+             snapshot.counters[SHT21_STATS_NACKS] > 0;
+
+    SHT21_Stats_Reset(&stats);
+    SHT21_Stats_Snapshot(&stats, &snapshot);
+    ok = ok && snapshot.counters[SHT21_STATS_TRANSACTIONS] == 0;
+    return ok;
+}
+
+// Sensors behind a mux, each with its own stats
+static int bench_mux(void)
+{
+    static SHT21_Sim_TypeDef sims[BENCH_MUX_SENSORS];
+    static SHT21_Mux_Sensor_TypeDef sensors[BENCH_MUX_SENSORS];
+    static SHT21_Stats_TypeDef stats[BENCH_MUX_SENSORS];
+    static SHT21_Stats_TypeDef bus_stats;
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_Mux_TypeDef mux;
+    SHT21_Mux_Scheduler_TypeDef sched;
+    int ok = 1;
+
+    SHT21_Sim_Mux_Init(&mux, &clock);
+    for (UInt8 i = 0; i < BENCH_MUX_SENSORS; i++)
+    {
+        SHT21_Sim_Init(&sims[i], &clock);
+        sims[i].bit_error_rate = 256U * i;
+        mux.sensors[i] = &sims[i];
+        SHT21_Stats_Init(&stats[i], bench_get_us, &clock);
+        sensors[i].mux_address = SHT21_MUX_BASE_ADDRESS;
+        sensors[i].channel = i;
+        sensors[i].resolution = SHT21_RES_RH12_T14;
+    }
+    SHT21_Mux_Init(&sched, &mux.bus, sensors, BENCH_MUX_SENSORS);
+    for (UInt8 i = 0; i < BENCH_MUX_SENSORS; i++)
+        sensors[i].stats = &stats[i];
+
+    // The stats of the bus itself are put back after each sensor and see none of them
+    SHT21_Stats_Init(&bus_stats, bench_get_us, &clock);
+    mux.bus.stats = &bus_stats;
+
+    while (clock.now_us < BENCH_MUX_RUN_US)
+    {
+        UInt32 wait = SHT21_Mux_Step(&sched);
+        if (wait > 0)
+            mux.bus.delay(&mux, wait);
+    }
+
+    printf("\n%u sensors behind a mux\n", BENCH_MUX_SENSORS);
+    for (UInt8 i = 0; i < BENCH_MUX_SENSORS; i++)
+    {
+        SHT21_Stats_Snapshot_TypeDef snapshot;
+        SHT21_Stats_Snapshot(&stats[i], &snapshot);
+        printf("sensor %u: %u samples, ", i, sensors[i].samples);
+        bench_print(&snapshot);
+        ok = ok && snapshot.counters[SHT21_STATS_TRANSACTIONS] == sims[i].transactions &&
+             snapshot.counters[SHT21_STATS_CRC_ERRORS] == sims[i].bit_errors;
+    }
+
+    SHT21_Stats_Snapshot_TypeDef snapshot;
+    SHT21_Stats_Snapshot(&bus_stats, &snapshot);
+    printf("bus stats %s, %u transactions\n", mux.bus.stats == &bus_stats ? "restored" : "NOT RESTORED",
+           snapshot.counters[SHT21_STATS_TRANSACTIONS]);
+    ok = ok && mux.bus.stats == &bus_stats && snapshot.counters[SHT21_STATS_TRANSACTIONS] == 0;
+    return ok;
+}
+
+int main(void)
+{
+    int ok = bench_single();
+    ok = bench_mux() && ok;
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
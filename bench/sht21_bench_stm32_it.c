@@ -0,0 +1,283 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_stm32_it.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Runs the STM32 example on the host HAL stand-in against the simulated SHT21 and
+ *  compares the blocking driver with the interrupt driven one. Checks the order of the
+ *  callbacks of every measurement and the result, and reports the virtual latency, the
+ *  time the CPU is blocked, the host time spent in the driver and interrupts per
+ *  measurement. Exits with 1 if a sequence or result is wrong.
+ *
+ *  Callback log: T transmit done, R receive done, E transfer error, C measurement done
+ *
+ *      make bench && build/sht21_bench_stm32_it
+ *
+ *******************************************************************************************/
+#include "sht21_it.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_OPS       (200U)
+#define BENCH_LOG_SIZE  (64U)
+
+static char bench_log[BENCH_LOG_SIZE];
+static UInt32 bench_log_len;
+static double bench_driver_ns;
+static UInt32 bench_done;
+static SHT21_Error_TypeDef bench_status;
+static UInt8 bench_frame[3];
+static SHT21_Error_TypeDef bench_statuses[4];
+static SHT21_Commands_TypeDef bench_cmds[4];
+static SHT21_Ring_TypeDef bench_ring;
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void bench_log_event(char event)
+{
+    if (bench_log_len < BENCH_LOG_SIZE - 1U)
+        bench_log[bench_log_len++] = event;
+}
+
+// The HAL callbacks forward to the driver, timed and logged
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    bench_log_event('T');
+    double start = bench_now_ns();
+    SHT21_it_tx_cplt(hi2c);
+    bench_driver_ns += bench_now_ns() - start;
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    bench_log_event('R');
+    double start = bench_now_ns();
+    SHT21_it_rx_cplt(hi2c);
+    bench_driver_ns += bench_now_ns() - start;
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c)
+{
+    bench_log_event('E');
+    double start = bench_now_ns();
+    SHT21_it_error(hi2c);
+    bench_driver_ns += bench_now_ns() - start;
+}
+
+void HAL_SYSTICK_Callback(void)
+{
+    double start = bench_now_ns();
+    SHT21_it_tick();
+    bench_driver_ns += bench_now_ns() - start;
+}
+
+void SHT21_it_measurement_cplt_callback(SHT21_Error_TypeDef status, SHT21_Commands_TypeDef cmd, UInt8* frame)
+{
+    bench_log_event('C');
+    bench_status = status;
+    memcpy(bench_frame, frame, 3);
+    if (bench_done < 4U)
+    {
+        bench_statuses[bench_done] = status;
+        bench_cmds[bench_done] = cmd;
+    }
+    bench_done++;
+}
+
+// Expected log of one measurement: T, any number of E while converting, R and C
+static int bench_check_log(const char* log, UInt32 len)
+{
+    if (len < 3 || log[0] != 'T' || log[len - 2] != 'R' || log[len - 1] != 'C')
+        return 0;
+    for (UInt32 i = 1; i < len - 2; i++)
+        if (log[i] != 'E')
+            return 0;
+    return 1;
+}
+
+static int bench_check_value(SHT21_Sim_TypeDef* sim, SHT21_Commands_TypeDef cmd, UInt8* frame)
+{
+    float value;
+    if (cmd == SHT21_TEMP_MEASURE || cmd == SHT21_TEMP_MEASURE_HOLD)
+        return SHT21_Parse_Temp_Checked(frame, &value) == SHT21_OK && value > sim->temp - 0.1f && value < sim->temp + 0.1f;
+    return SHT21_Parse_RH_Checked(frame, &value) == SHT21_OK && value > sim->humidity - 0.2f && value < sim->humidity + 0.2f;
+}
+
+static void bench_report(const char* name, SHT21_Sim_Clock_TypeDef* clock, unsigned long long start_us,
+                         double blocked_us, UInt32 ops, UInt32 errors)
+{
+    printf("%-22s %7.2f ms/op  blocked %9.1f us/op  driver %6.0f ns/op  %5.1f interrupts/op  %s\n",
+           name, (double)(clock->now_us - start_us) / 1000.0 / ops, blocked_us / ops,
+           bench_driver_ns / ops, (double)hi2c1.interrupts / ops, errors ? "FAILED" : "OK");
+}
+
+static UInt32 bench_blocking(SHT21_Sim_TypeDef* sim)
+{
+    UInt32 errors = 0;
+    unsigned long long start_us = sim->clock->now_us;
+
+    bench_driver_ns = 0;
+    hi2c1.interrupts = 0;
+    for (UInt32 i = 0; i < BENCH_OPS; i++)
+    {
+        double start = bench_now_ns();
+        float temp = SHT21_get_temp();
+        bench_driver_ns += bench_now_ns() - start;
+        if (sht21_last_error != HAL_OK || temp < sim->temp - 0.1f || temp > sim->temp + 0.1f)
+            errors++;
+    }
+
+    // The CPU is blocked for the whole measurement
+    bench_report("blocking hold", sim->clock, start_us, (double)(sim->clock->now_us - start_us), BENCH_OPS, errors);
+    return errors;
+}
+
+static UInt32 bench_it(SHT21_Sim_TypeDef* sim, const char* name, SHT21_Commands_TypeDef cmd)
+{
+    UInt32 errors = 0;
+    unsigned long long start_us = sim->clock->now_us;
+
+    bench_driver_ns = 0;
+    hi2c1.interrupts = 0;
+    for (UInt32 i = 0; i < BENCH_OPS; i++)
+    {
+        bench_log_len = 0;
+        bench_done = 0;
+
+        double start = bench_now_ns();
+        SHT21_Error_TypeDef status = SHT21_it_start(cmd);
+        bench_driver_ns += bench_now_ns() - start;
+
+        while (status == SHT21_OK && SHT21_it_busy())
+            Fake_HAL_Advance(100);
+
+        if (status != SHT21_OK || bench_done != 1 || bench_status != SHT21_OK ||
+            !bench_check_log(bench_log, bench_log_len) || !bench_check_value(sim, cmd, bench_frame))
+            errors++;
+    }
+
+    bench_report(name, sim->clock, start_us, 0.0, BENCH_OPS, errors);
+    return errors;
+}
+
+static UInt32 bench_it_both(SHT21_Sim_TypeDef* sim)
+{
+    UInt32 errors = 0;
+    unsigned long long start_us = sim->clock->now_us;
+    SHT21_Ring_Entry_TypeDef entries[4];
+
+    // Drop the frames of the single measurements
+    SHT21_Ring_Init(&bench_ring);
+    bench_driver_ns = 0;
+    hi2c1.interrupts = 0;
+    for (UInt32 i = 0; i < BENCH_OPS; i++)
+    {
+        bench_log_len = 0;
+        bench_done = 0;
+
+        double start = bench_now_ns();
+        SHT21_Error_TypeDef status = SHT21_it_start_both();
+        bench_driver_ns += bench_now_ns() - start;
+
+        while (status == SHT21_OK && SHT21_it_busy())
+            Fake_HAL_Advance(100);
+
+        // Both frames arrive through the ring, temperature first
+        UInt32 count = SHT21_Ring_Pop_Batch(&bench_ring, entries, 4);
+        if (status != SHT21_OK || bench_done != 2 || count != 2 ||
+            entries[0].cmd != SHT21_TEMP_MEASURE || entries[1].cmd != SHT21_RH_MEASURE ||
+            !bench_check_value(sim, SHT21_TEMP_MEASURE, entries[0].data.frame) ||
+            !bench_check_value(sim, SHT21_RH_MEASURE, entries[1].data.frame))
+            errors++;
+    }
+
+    bench_report("IT pair, ring", sim->clock, start_us, 0.0, BENCH_OPS, errors);
+    return errors;
+}
+
+// Runs one measurement or pair to the end, at most 200 ms of virtual time
+static SHT21_Error_TypeDef bench_it_run(SHT21_Commands_TypeDef cmd)
+{
+    bench_log_len = 0;
+    bench_done = 0;
+
+    SHT21_Error_TypeDef status = (cmd == SHT21_RH_MEASURE) ? SHT21_it_start_both() : SHT21_it_start(cmd);
+    for (UInt32 i = 0; status == SHT21_OK && SHT21_it_busy() && i < 2000U; i++)
+        Fake_HAL_Advance(100);
+    return status;
+}
+
+// A failed pair still reports both halves, a receive the HAL never starts times out
+static UInt32 bench_it_faults(SHT21_Sim_TypeDef* sim)
+{
+    UInt32 errors = 0;
+    unsigned long long start_us = sim->clock->now_us;
+    SHT21_Ring_Entry_TypeDef entries[4];
+
+    SHT21_Ring_Init(&bench_ring);
+    bench_driver_ns = 0;
+    hi2c1.interrupts = 0;
+
+    // Temperature frame fails its CRC
+    sim->inject_bit_errors = 1;
+    if (bench_it_run(SHT21_RH_MEASURE) != SHT21_OK || SHT21_it_busy() || bench_done != 2 ||
+        bench_statuses[0] != SHT21_CHECKSUM_ERROR || bench_cmds[1] != SHT21_RH_MEASURE ||
+        bench_statuses[1] != SHT21_CHECKSUM_ERROR)
+        errors++;
+
+    // Temperature command NACKed
+    sim->inject_nacks = 1;
+    if (bench_it_run(SHT21_RH_MEASURE) != SHT21_OK || SHT21_it_busy() || bench_done != 2 ||
+        bench_statuses[0] != SHT21_ACK_ERROR || bench_cmds[1] != SHT21_RH_MEASURE ||
+        bench_statuses[1] != SHT21_ACK_ERROR)
+        errors++;
+
+    // Receive never starts, hold master skips the conversion wait
+    hi2c1.refuse_receives = 0xFFFFFFFFU;
+    if (bench_it_run(SHT21_TEMP_MEASURE_HOLD) != SHT21_OK || SHT21_it_busy() || bench_done != 1 ||
+        bench_status != SHT21_TIME_OUT_ERROR)
+        errors++;
+    hi2c1.refuse_receives = 0;
+
+    // Nothing failed reaches the ring, and the driver works again
+    if (SHT21_Ring_Pop_Batch(&bench_ring, entries, 4) != 0)
+        errors++;
+    if (bench_it_run(SHT21_RH_MEASURE) != SHT21_OK || bench_done != 2 ||
+        bench_statuses[0] != SHT21_OK || bench_statuses[1] != SHT21_OK)
+        errors++;
+    SHT21_Ring_Init(&bench_ring);
+
+    bench_report("IT faults", sim->clock, start_us, 0.0, 4U, errors);
+    return errors;
+}
+
+int main(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0};
+    SHT21_Sim_TypeDef sim;
+    UInt32 errors = 0;
+
+    SHT21_Sim_Init(&sim, &clock);
+    Fake_HAL_Init(&sim);
+    SHT21_Ring_Init(&bench_ring);
+    SHT21_it_init(&bench_ring);
+
+    errors += bench_blocking(&sim);
+    errors += bench_it(&sim, "IT hold", SHT21_TEMP_MEASURE_HOLD);
+    errors += bench_it(&sim, "IT no hold", SHT21_TEMP_MEASURE);
+    errors += bench_it_both(&sim);
+    errors += bench_it_faults(&sim);
+
+    // A sensor slower than the datasheet, the driver keeps polling on the tick
+    sim.conversion_percent = 110U;
+    errors += bench_it(&sim, "IT no hold, slow", SHT21_TEMP_MEASURE);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/********************************************************************************************
+ *  Filename: sht21_bench_template.cpp
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Compares Sht21<Bus, Res> with SHT21_Measure_Both of the C core for every resolution
+ *  on the simulator. Both run against their own sim with the same environment, the
+ *  samples and the bus time must be identical. Reports the host time per sample of
+ *  each. Also runs the template on the bus policies of the C bus, the STM32 HAL
+ *  stand-in and the Linux backend on a simulated fd. Exits with 1 on any difference.
+ *
+ *      make bench && build/sht21_bench_template
+ *
+ *******************************************************************************************/
+#include "sht21_template.h"
+#include "sht21_sim_bus.h"
+#include "sht21_hal_bus.h"
+#include "sht21_linux_bus.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#define BENCH_CHECK_SAMPLES     (2000U)
+#define BENCH_TIMED_SAMPLES     (50000U)
+
+static const char* bench_res_names[4] = { "RH12/T14", "RH8/T12", "RH10/T13", "RH11/T11" };
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Room slowly moving through the range of the sensor
+static void bench_room(SHT21_Sim_TypeDef* sim, UInt32 i)
+{
+    sim->temp = -20.0f + (float)(i % 1000U) * 0.1f;
+    sim->humidity = 5.0f + (float)(i % 900U) * 0.1f;
+}
+
+static void bench_set_resolution(SHT21_Sim_TypeDef* sim, SHT21_Resolution_TypeDef res)
+{
+    SHT21_User_Reg_TypeDef reg;
+    reg.reg = sim->user_reg;
+    sim->user_reg = SHT21_Set_Resolution(reg, res).reg;
+}
+
+static bool bench_same(const SHT21_Sample_TypeDef& a, const SHT21_Sample_TypeDef& b)
+{
+    return a.status == SHT21_OK && b.status == SHT21_OK && a.temp == b.temp && a.humidity == b.humidity;
+}
+
+/********************************************************************************************
+ *  Checks and times one resolution, returns false if the template differs from the core
+ *******************************************************************************************/
+template <SHT21_Resolution_TypeDef Res>
+static bool bench_resolution(void)
+{
+    SHT21_Sim_Clock_TypeDef c_clock = {0, 0};
+    SHT21_Sim_Clock_TypeDef t_clock = {0, 0};
+    SHT21_Sim_TypeDef c_sim;
+    SHT21_Sim_TypeDef t_sim;
+
+    SHT21_Sim_Init(&c_sim, &c_clock);
+    SHT21_Sim_Init(&t_sim, &t_clock);
+    bench_set_resolution(&c_sim, Res);
+
+    Sht21<Sht21_Sim_Bus, Res> sensor((Sht21_Sim_Bus(&t_sim)));
+    bool ok = sensor.configure() == SHT21_OK && t_sim.user_reg == c_sim.user_reg;
+    c_clock = t_clock;
+    c_sim.transactions = t_sim.transactions;
+
+    for (UInt32 i = 0; ok && i < BENCH_CHECK_SAMPLES; i++)
+    {
+        bench_room(&c_sim, i);
+        bench_room(&t_sim, i);
+        ok = bench_same(SHT21_Measure_Both(&c_sim.bus, Res), sensor.measure_both());
+    }
+    ok = ok && c_clock.now_us == t_clock.now_us && c_clock.bus_busy_us == t_clock.bus_busy_us &&
+         c_sim.transactions == t_sim.transactions;
+
+    float sink = 0.0f;
+    double start = bench_now_ns();
+    for (UInt32 i = 0; i < BENCH_TIMED_SAMPLES; i++)
+        sink += SHT21_Measure_Both(&c_sim.bus, Res).temp;
+    double ns_c = (bench_now_ns() - start) / BENCH_TIMED_SAMPLES;
+
+    start = bench_now_ns();
+    for (UInt32 i = 0; i < BENCH_TIMED_SAMPLES; i++)
+        sink += sensor.measure_both().temp;
+    double ns_t = (bench_now_ns() - start) / BENCH_TIMED_SAMPLES;
+
+    printf("%-9s %10.0f %10.0f %12s %s\n", bench_res_names[Res], ns_c, ns_t,
+           (c_clock.bus_busy_us == t_clock.bus_busy_us) ? "same" : "differs", ok ? "" : "MISMATCH");
+    return ok && sink != 0.0f;
+}
+
+/********************************************************************************************
+ *  ioctl of the Linux backend on bench_linux_sim, a NACK fails with EREMOTEIO. The
+ *  policy takes its time from the virtual clock of the sim.
+ *******************************************************************************************/
+static SHT21_Sim_TypeDef* bench_linux_sim;
+
+class Bench_Linux_Bus : public Sht21_Linux_Bus
+{
+public:
+  explicit Bench_Linux_Bus(SHT21_Linux_TypeDef* dev) : Sht21_Linux_Bus(dev) {}
+
+  UInt32 get_tick() { return (UInt32)(bench_linux_sim->clock->now_us / 1000U); }
+  void delay(UInt32 ms) { SHT21_Sim_Advance(bench_linux_sim->clock, 1000ULL * ms); }
+};
+
+static int bench_linux_ioctl(int fd, unsigned long request, void* arg)
+{
+    (void)fd;
+    if (request != I2C_RDWR)
+        return -1;
+
+    struct i2c_rdwr_ioctl_data* data = (struct i2c_rdwr_ioctl_data*)arg;
+    for (UInt32 i = 0; i < data->nmsgs; i++)
+    {
+        struct i2c_msg* msg = &data->msgs[i];
+        SHT21_Error_TypeDef status = (msg->flags & I2C_M_RD) ?
+            SHT21_Sim_Read(bench_linux_sim, (UInt8)msg->addr, msg->buf, (UInt8)msg->len) :
+            SHT21_Sim_Write(bench_linux_sim, (UInt8)msg->addr, msg->buf, (UInt8)msg->len);
+        if (status != SHT21_OK)
+        {
+            errno = EREMOTEIO;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/********************************************************************************************
+ *  A few samples through a policy on its own sim, checked against the core on another
+ *******************************************************************************************/
+template <class Bus>
+static bool bench_policy(const char* name, Sht21<Bus, SHT21_RES_RH11_T11>& sensor, SHT21_Sim_TypeDef* sim)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef ref;
+    SHT21_Sim_Init(&ref, &clock);
+    bench_set_resolution(&ref, SHT21_RES_RH11_T11);
+
+    bool ok = sensor.configure() == SHT21_OK && sim->user_reg == ref.user_reg;
+    for (UInt32 i = 0; ok && i < 100U; i++)
+    {
+        bench_room(&ref, i * 7U);
+        bench_room(sim, i * 7U);
+        ok = bench_same(SHT21_Measure_Both(&ref.bus, SHT21_RES_RH11_T11), sensor.measure_both());
+    }
+
+    printf("%-12s %s\n", name, ok ? "same samples as the core" : "MISMATCH");
+    return ok;
+}
+
+int main(void)
+{
+    printf("host ns per sample, C core and template on the sim\n");
+    printf("resolution      core   template     bus time\n");
+    bool ok = bench_resolution<SHT21_RES_RH12_T14>();
+    ok = bench_resolution<SHT21_RES_RH8_T12>() && ok;
+    ok = bench_resolution<SHT21_RES_RH10_T13>() && ok;
+    ok = bench_resolution<SHT21_RES_RH11_T11>() && ok;
+
+    printf("\nbus policies at RH11/T11\n");
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+
+    SHT21_Sim_Init(&sim, &clock);
+    Sht21<Sht21_Bus_Policy, SHT21_RES_RH11_T11> c_bus_sensor((Sht21_Bus_Policy(&sim.bus)));
+    ok = bench_policy("C bus", c_bus_sensor, &sim) && ok;
+
+    SHT21_Sim_Init(&sim, &clock);
+    Fake_HAL_Init(&sim);
+    Sht21<Sht21_Hal_Bus, SHT21_RES_RH11_T11> hal_sensor((Sht21_Hal_Bus(&hi2c1)));
+    ok = bench_policy("STM32 HAL", hal_sensor, &sim) && ok;
+
+    SHT21_Sim_Init(&sim, &clock);
+    bench_linux_sim = &sim;
+    SHT21_Linux_TypeDef dev;
+    SHT21_Linux_Attach(&dev, 0, bench_linux_ioctl);
+    Sht21<Bench_Linux_Bus, SHT21_RES_RH11_T11> linux_sensor((Bench_Linux_Bus(&dev)));
+    ok = bench_policy("Linux", linux_sensor, &sim) && ok;
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
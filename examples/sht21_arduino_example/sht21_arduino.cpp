@@ -11,6 +11,99 @@
 #include <Wire.h>
 #include <Arduino.h>
 
+/********************************************************************************************
+ *  Writes len bytes to the device, used as the core bus write function
+ *******************************************************************************************/
+static SHT21_Error_TypeDef wireWrite(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+  TwoWire* wire = (TwoWire*)handle;
+  wire->beginTransmission(address);
+  wire->write(buf, len);
+
+  // 2 and 3 are NACK on address and data
+  switch (wire->endTransmission())
+  {
+    case 0:
+    return SHT21_OK;
+    case 2:
+    case 3:
+    return SHT21_ACK_ERROR;
+    default:
+    return SHT21_TIME_OUT_ERROR;
+  }
+}
+
+/********************************************************************************************
+ *  Reads len bytes from the device, used as the core bus read function. A NACK on the
+ *  address gives no bytes.
+ *******************************************************************************************/
+static SHT21_Error_TypeDef wireRead(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+  TwoWire* wire = (TwoWire*)handle;
+  if (wire->requestFrom((int)address, (int)len) != len)
+    return SHT21_ACK_ERROR;
+
+  for (UInt8 i = 0; i < len; i++)
+    buf[i] = wire->read();
+
+  return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Returns the millisecond tick, used as the core bus tick function
+ *******************************************************************************************/
+static UInt32 wireGetTick(void* handle)
+{
+  (void)handle;
+  return millis();
+}
+
+/********************************************************************************************
+ *  Waits the given number of ms, used as the core bus delay function
+ *******************************************************************************************/
+static void wireDelay(void* handle, UInt32 ms)
+{
+  (void)handle;
+  delay(ms);
+}
+
+#ifdef SHT21_STATS
+/********************************************************************************************
+ *  Microsecond counter of the latency histograms
+ *******************************************************************************************/
+static UInt32 wireGetUs(void* handle)
+{
+  (void)handle;
+  return micros();
+}
+#endif
+
+/********************************************************************************************
+ *  Sets up the core bus on the Arduino Wire instance. The power up time of the SHT21 is
+ *  counted from here, see waitReady().
+ *******************************************************************************************/
+SHT21::SHT21()
+{
+  bus.write = wireWrite;
+  bus.read = wireRead;
+  bus.get_tick = wireGetTick;
+  bus.delay = wireDelay;
+  bus.handle = &Wire;
+#ifdef SHT21_STATS
+  SHT21_Stats_Init(&stats, wireGetUs, nullptr);
+  bus.stats = &stats;
+#endif
+  measurement.state = SHT21_MEASURE_IDLE;
+  selftestState.state = SHT21_SELFTEST_IDLE;
+  resolution = SHT21_RES_RH12_T14;
+  tempReadMode = SHT21_READ_FULL;
+  rhReadMode = SHT21_READ_FULL;
+  userReg.reg = 0;
+  userRegValid = false;
+  SHT21_Ready_Start(&readiness, &bus, SHT21_POWER_UP_TIME);
+  SHT21_Cache_Init(&cache, &bus);
+}
+
 /********************************************************************************************
  *  Initliazes the Arduino I2C, to be called in setup()
  *******************************************************************************************/
@@ -20,152 +113,322 @@ void SHT21::init()
 }
 
 /********************************************************************************************
- *  Returns the humidity reading of the SHT21
+ *  Returns the humidity reading of the SHT21. With maxAge, the last reading is returned
+ *  without a new measurement if it is younger than maxAge ms.
  *******************************************************************************************/
-float SHT21::getHumidity(SHT21_Error_TypeDef* error)
+float SHT21::getHumidity(SHT21_Error_TypeDef* error, UInt32 maxAge)
 {
-  UInt8 rxBuf[3] = {0};
+  return measureCached(SHT21_RH_MEASURE_HOLD, maxAge, error);
+}
 
-  if (error == nullptr) // No error checking enabled
-  {
-    if (transmitReceiveSht21(rxBuf, 3, SHT21_RH_MEASURE_HOLD) == SHT21_OK)
-      return SHT21_Parse_RH(rxBuf);
-  }
-  else
-  {
-    *error = transmitReceiveSht21(rxBuf, 3, SHT21_RH_MEASURE_HOLD);
-    if (*error == SHT21_OK)
-      return SHT21_Parse_RH(rxBuf);
-  }
-  return 0.0f;
+/********************************************************************************************
+ *  Returns the temperature reading of the SHT21. With maxAge, the last reading is
+ *  returned without a new measurement if it is younger than maxAge ms.
+ *******************************************************************************************/
+float SHT21::getTemp(SHT21_Error_TypeDef* error, UInt32 maxAge)
+{
+  return measureCached(SHT21_TEMP_MEASURE_HOLD, maxAge, error);
 }
 
 /********************************************************************************************
- *  Returns the temperature reading of the SHT21
+ *  Returns the user register of the SHT21. The register is kept in a shadow copy, so it
+ *  is only read from the SHT21 the first time and after a reset. Use refreshUserReg()
+ *  to get the current end of battery status.
  *******************************************************************************************/
-float SHT21::getTemp(SHT21_Error_TypeDef* error)
+SHT21_User_Reg_TypeDef SHT21::getUserReg(SHT21_Error_TypeDef* error)
 {
-  UInt8 rxBuf[3] = {0};
-  if (error == nullptr) // No error checking enabled
+  if (userRegValid)
   {
-    if (transmitReceiveSht21(rxBuf, 3, SHT21_TEMP_MEASURE_HOLD) == SHT21_OK)
-      return SHT21_Parse_Temp(rxBuf);
+    if (error != nullptr) // Error checking enabled
+      *error = SHT21_OK;
+    return userReg;
   }
-  else
-  {
-    *error = transmitReceiveSht21(rxBuf, 3, SHT21_TEMP_MEASURE_HOLD);
-      if (*error == SHT21_OK)
-        return SHT21_Parse_Temp(rxBuf);
-  }
-  return 0.0f;
+  return refreshUserReg(error);
 }
 
 /********************************************************************************************
- *  Returns the user register of the SHT21
+ *  Reads the user register from the SHT21 and updates the shadow copy
  *******************************************************************************************/
-SHT21_User_Reg_TypeDef SHT21::getUserReg(SHT21_Error_TypeDef* error)
+SHT21_User_Reg_TypeDef SHT21::refreshUserReg(SHT21_Error_TypeDef* error)
 {
   UInt8 rxBuf[1] = {0};
-  if (error == nullptr) // No error checking enabled
-  {
-    if (transmitReceiveSht21(rxBuf, 1, SHT21_READ_USER_REG) == SHT21_OK)
-      return SHT21_Parse_User_Reg(rxBuf);
-  }
-  else
-  {
-    *error = transmitReceiveSht21(rxBuf, 1, SHT21_READ_USER_REG);
-    if (*error == SHT21_OK)
-      return SHT21_Parse_User_Reg(rxBuf);
-  }
-  return SHT21_User_Reg_TypeDef{0};
+  SHT21_Error_TypeDef status = transmitReceiveSht21(rxBuf, 1, SHT21_READ_USER_REG);
+  if (error != nullptr) // Error checking enabled
+    *error = status;
+
+  if (status != SHT21_OK)
+    return SHT21_User_Reg_TypeDef{0};
+
+  userReg = SHT21_Parse_User_Reg(rxBuf);
+  userRegValid = true;
+  resolution = SHT21_Get_Resolution(userReg); // Keep track of the active resolution
+  return userReg;
 }
 
 /********************************************************************************************
  *  Updates the user register on the SHT21
  *******************************************************************************************/
 void SHT21::updateUserReg(SHT21_User_Reg_TypeDef new_reg)
+{
+  writeUserReg(new_reg);
+}
+
+/********************************************************************************************
+ *  Updates the bits in mask to the bits of value with a single write, using the shadow
+ *  copy of the user register instead of reading it back first.
+ *  Example: updateUserRegFields(SHT21_ENABLE_CHIP_HEATER, SHT21_ENABLE_CHIP_HEATER)
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::updateUserRegFields(UInt8 mask, UInt8 value)
+{
+  SHT21_Error_TypeDef error = SHT21_OK;
+  SHT21_User_Reg_TypeDef reg = getUserReg(&error);
+  if (error != SHT21_OK)
+    return error;
+
+  return writeUserReg(SHT21_Update_User_Reg_Fields(reg, mask, value));
+}
+
+/********************************************************************************************
+ *  Sets the measurement resolution
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::setResolution(SHT21_Resolution_TypeDef res)
+{
+  SHT21_User_Reg_TypeDef reg = SHT21_Set_Resolution(SHT21_User_Reg_TypeDef{0}, res);
+  return updateUserRegFields(SHT21_MEAS_RESOLUTION_BIT1 | SHT21_MEAS_RESOLUTION_BIT2, reg.reg);
+}
+
+/********************************************************************************************
+ *  Turns the on-chip heater on or off
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::setHeater(bool enable)
+{
+  return updateUserRegFields(SHT21_ENABLE_CHIP_HEATER, enable ? SHT21_ENABLE_CHIP_HEATER : 0U);
+}
+
+/********************************************************************************************
+ *  Writes the user register to the SHT21 and updates the shadow copy
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::writeUserReg(SHT21_User_Reg_TypeDef new_reg)
 {
   SHT21_Request_TypeDef sht21_request = SHT21_Request_Buf(SHT21_WRITE_USER_REG);
-  Wire.beginTransmission(sht21_request.data.address);
-  Wire.write(sht21_request.data.command);
-  Wire.write(new_reg.reg);
-  Wire.endTransmission();
+  UInt8 txBuf[2] = { sht21_request.data.command, new_reg.reg };
+
+  SHT21_Error_TypeDef error = bus.write(bus.handle, sht21_request.data.address, txBuf, 2);
+  if (error != SHT21_OK)
+  {
+    userRegValid = false; // Unknown what the SHT21 has now
+    return error;
+  }
+
+  // Cached readings are not what the sensor reads after the heater is switched
+  if ((userReg.reg ^ new_reg.reg) & SHT21_ENABLE_CHIP_HEATER)
+    SHT21_Cache_Invalidate(&cache);
+
+  // The end of battery bit is read only, keep the last value read
+  userReg = SHT21_Update_User_Reg_Fields(userReg, SHT21_USER_REG_WRITABLE, new_reg.reg);
+  resolution = SHT21_Get_Resolution(userReg);
+  return SHT21_OK;
 }
 
 /********************************************************************************************
  *  Send a reset command to the SHT21 for a soft reset. This will reset the SHT21 to
- *  default settings, except the heat enabled bit.
+ *  default settings, except the heat enabled bit. Use waitReady() or pollReady() before
+ *  the next command.
  *******************************************************************************************/
 void SHT21::reset()
 {
-  SHT21_Request_TypeDef sht21_request = SHT21_Request_Buf(SHT21_SOFT_RESET);
-  Wire.beginTransmission(sht21_request.data.address);
-  Wire.write(sht21_request.data.command);
-  Wire.endTransmission();
+  SHT21_Soft_Reset(&readiness, &bus);
+  resolution = SHT21_RES_RH12_T14; // Reset restores the default resolution
+  userRegValid = false;            // Validate the shadow copy on next access
+}
+
+/********************************************************************************************
+ *  Checks if the SHT21 answers after power up or reset(), by reading the user register.
+ *  Returns SHT21_BUSY while it is still starting, SHT21_OK once it answered and
+ *  SHT21_TIME_OUT_ERROR if it did not answer in twice the datasheet time. Only touches
+ *  the bus until it answered, the register read fills the shadow copy.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::pollReady()
+{
+  if (readiness.ready)
+    return SHT21_OK;
+
+  SHT21_Error_TypeDef error = SHT21_Ready_Poll(&readiness);
+  if (error == SHT21_OK)
+  {
+    userReg = readiness.user_reg;
+    userRegValid = true;
+    resolution = SHT21_Get_Resolution(userReg);
+  }
+  return error;
 }
 
 /********************************************************************************************
- *  Runs a function test on the SHT21. Before starting it will store the current temperature
- *  and humidity values. It then turns on the heating element. Wait some time and then check
- *  if the temperature has risen and humidity has decreased to certain threshold.
+ *  Waits until the SHT21 answers after power up or reset(), usually a few ms. Call it
+ *  after init() instead of a fixed delay.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::waitReady()
+{
+  SHT21_Error_TypeDef error = pollReady();
+  while (error == SHT21_BUSY)
+  {
+    delay(1);
+    error = pollReady();
+  }
+  return error;
+}
+
+/********************************************************************************************
+ *  Runs a function test on the SHT21. It stores the current temperature and humidity,
+ *  turns on the heater and keeps reading until the temperature has risen and the
+ *  humidity has fallen by the thresholds. Passes as soon as they have, and fails if
+ *  they have not after deadline ms. The heater is turned off again in any case.
  *
- *  If any problems on the communication if SHT21 it will also return error. 
+ *  If any problems on the communication if SHT21 it will also return error.
  *
  *  It is important the chip is at a stable temperature before starting this test.
+ *  Blocks until done, use selftestStart() and selftestStep() to run it from loop().
  *******************************************************************************************/
-SHT21_Error_TypeDef SHT21::selftest()
+SHT21_Error_TypeDef SHT21::selftest(UInt32 deadline)
 {
-  // Variable to store status
-  SHT21_Error_TypeDef error = SHT21_OK;
+  SHT21_Error_TypeDef error = SHT21_Selftest_Run(&selftestState, &bus, deadline);
+  userRegValid = false; // Validate the shadow copy on next access
+  return error;
+}
 
-  // Store the current temp and hum values
-  float tempAtStart = getTemp(&error);
-  if (error != SHT21_OK)
-    return error;
+/********************************************************************************************
+ *  Starts the selftest without blocking. No other measurements can be made until
+ *  selftestStep() stops returning SHT21_BUSY.
+ *******************************************************************************************/
+void SHT21::selftestStart(UInt32 deadline)
+{
+  SHT21_Selftest_Start(&selftestState, &bus, deadline);
+}
 
-  float humAtStart = getHumidity(&error);
-  if (error != SHT21_OK)
-    return error;
+/********************************************************************************************
+ *  Runs the next part of the selftest, returns SHT21_BUSY while it runs and the result
+ *  of selftest() when done. wait is set to the ms until the next call has work to do.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::selftestStep(UInt32* wait)
+{
+  SHT21_Error_TypeDef error = SHT21_Selftest_Step(&selftestState);
+  if (wait != nullptr)
+    *wait = selftestState.wait;
+  if (error != SHT21_BUSY)
+    userRegValid = false;
+  return error;
+}
 
-  // Enable the heater
-  SHT21_User_Reg_TypeDef sht21User = getUserReg(&error); // Read the current user register
-  if (error != SHT21_OK)
-    return error;
+/********************************************************************************************
+ *  Stops the selftest, keep calling selftestStep() until it stops returning SHT21_BUSY
+ *  so the heater is turned off
+ *******************************************************************************************/
+void SHT21::selftestAbort()
+{
+  SHT21_Selftest_Abort(&selftestState);
+}
 
-  sht21User.data.chip_heater = 1U;                 // Set the chip heater enabled
-  updateUserReg(sht21User);                        // Update SHT21 with the modified register
+/********************************************************************************************
+ *  Reads only part of the temperature or humidity results to save bus time, see
+ *  SHT21_Read_Mode_TypeDef. SHT21_READ_NO_CRC and SHT21_READ_MSB give up the checksum.
+ *  cmd is any temperature or humidity command.
+ *******************************************************************************************/
+void SHT21::setReadMode(SHT21_Commands_TypeDef cmd, SHT21_Read_Mode_TypeDef mode)
+{
+  if (cmd == SHT21_TEMP_MEASURE || cmd == SHT21_TEMP_MEASURE_HOLD)
+    tempReadMode = mode;
+  else
+    rhReadMode = mode;
+}
 
-  // Wait for temp to rise and humidity to fall
-  delay(10000);
+SHT21_Read_Mode_TypeDef SHT21::readMode(SHT21_Commands_TypeDef cmd)
+{
+  return (cmd == SHT21_TEMP_MEASURE || cmd == SHT21_TEMP_MEASURE_HOLD) ? tempReadMode : rhReadMode;
+}
 
-  // Get the current readings
-  float tempAfterTest = getTemp(&error);
-  if (error != SHT21_OK)
-    return error;
+/********************************************************************************************
+ *  Starts a no hold master measurement, SHT21_TEMP_MEASURE or SHT21_RH_MEASURE.
+ *  Returns without waiting for the conversion, use pollMeasurement() to get the result.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::startMeasurement(SHT21_Commands_TypeDef cmd)
+{
+  return SHT21_Measure_Start_Mode(&measurement, &bus, cmd, resolution, readMode(cmd));
+}
 
-  float  humAfterTest = getHumidity(&error);
-  if (error != SHT21_OK)
-    return error;
+/********************************************************************************************
+ *  Polls the measurement started with startMeasurement(). Returns SHT21_BUSY while the
+ *  sensor is converting, and SHT21_OK with the result stored in value when done.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21::pollMeasurement(float* value)
+{
+  SHT21_Error_TypeDef status = SHT21_Measure_Poll(&measurement);
+  if (status != SHT21_OK)
+    return status;
 
-  // Check if the changes after heater has been on had its initial values
-  // change above thresholds
-  if (tempAfterTest - tempAtStart > SHT21_SELFTEST_TEMP_THRESHOLD &&
-      humAtStart - humAfterTest > SHT21_SELFTEST_HUM_THRESHOLD)
-  {
-    error = SHT21_OK;
-  }
-  else 
-    error = SHT21_SELFTEST_FAILED;
+  status = SHT21_Measure_Complete(&measurement, value);
+  if (status == SHT21_OK)
+    SHT21_Cache_Put(&cache, measurement.cmd, bus.get_tick(bus.handle), *value);
+  return status;
+}
 
-  // Disable the heater
-  sht21User = getUserReg(&error);
-  if (error != SHT21_OK)
-    return error;
+/********************************************************************************************
+ *  Measures temperature and humidity in one call. The humidity conversion runs while
+ *  the temperature frame is checked and converted. Each value is cached with the tick
+ *  it was read.
+ *******************************************************************************************/
+SHT21_Sample_TypeDef SHT21::measureBoth()
+{
+  return SHT21_Cache_Measure_Both(&cache, resolution, tempReadMode, rhReadMode);
+}
 
-  sht21User.data.chip_heater = 0U;
-  updateUserReg(sht21User);
+/********************************************************************************************
+ *  Returns the maximum conversion time in ms of the measurement command at the active
+ *  resolution. Can be used to schedule polls of startMeasurement().
+ *******************************************************************************************/
+UInt8 SHT21::getConversionTime(SHT21_Commands_TypeDef cmd)
+{
+  return SHT21_Conversion_Time(resolution, cmd);
+}
 
-  return error;
+/********************************************************************************************
+ *  Returns the cache of the last readings with its hit and miss counts, for tuning the
+ *  maxAge of getTemp() and getHumidity()
+ *******************************************************************************************/
+const SHT21_Cache_TypeDef& SHT21::getCache() const
+{
+  return cache;
+}
+
+/********************************************************************************************
+ *  Hold master measurement through the cache, reading as much of the result as the read
+ *  mode says. Only readings that parse are cached, a full frame with a bad checksum
+ *  still returns the SHT21_Parse_Temp/SHT21_Parse_RH value.
+ *******************************************************************************************/
+float SHT21::measureCached(SHT21_Commands_TypeDef cmd, UInt32 maxAge, SHT21_Error_TypeDef* error)
+{
+  UInt8 rxBuf[SHT21_FRAME_LENGTH] = {0};
+  float value = 0.0f;
+  SHT21_Error_TypeDef status = SHT21_OK;
+
+  if (!SHT21_Cache_Get(&cache, cmd, bus.get_tick(bus.handle), maxAge, &value))
+  {
+    UInt8 len = SHT21_Read_Length(readMode(cmd), resolution, cmd);
+    status = transmitReceiveSht21(rxBuf, len, cmd);
+    if (status == SHT21_OK)
+    {
+      SHT21_Error_TypeDef parsed = SHT21_Parse_Frame(rxBuf, len, cmd, &value);
+      if (parsed == SHT21_OK)
+        SHT21_Cache_Put(&cache, cmd, bus.get_tick(bus.handle), value);
+      else if (len == SHT21_FRAME_LENGTH)
+        value = (cmd == SHT21_TEMP_MEASURE_HOLD) ? SHT21_Parse_Temp(rxBuf) : SHT21_Parse_RH(rxBuf);
+      else
+        status = parsed;
+    }
+  }
+
+  if (error != nullptr)
+    *error = status;
+  return value;
 }
 
 /********************************************************************************************
@@ -176,25 +439,25 @@ SHT21_Error_TypeDef SHT21::transmitReceiveSht21(UInt8* rxBuf, UInt8 len, SHT21_C
 {
   SHT21_Error_TypeDef status = SHT21_OK;
   SHT21_Request_TypeDef sht21_request = SHT21_Request_Buf(cmd);
+  UInt32 writeStart = SHT21_STATS_NOW(&bus);
   Wire.beginTransmission(sht21_request.data.address);
   Wire.write(sht21_request.data.command);
-  Wire.endTransmission();
+  UInt8 writeResult = Wire.endTransmission();
+  SHT21_STATS_TRANSFER(&bus, SHT21_STATS_COMMAND_WRITE, writeResult == 0 ? SHT21_OK : SHT21_ACK_ERROR, writeStart);
+  (void)writeResult;
 
-  // Wait for given time if performing temp or humidity readings
-  switch (cmd)
-  {
-    case SHT21_TEMP_MEASURE_HOLD:
-    delay(90);
-    break;
-    case SHT21_RH_MEASURE_HOLD:
-    delay(40);
-    break;
-    default:
-    break;
-  }
+  // Wait for the conversion time of the active resolution if performing temp or humidity readings
+  UInt32 conversionStart = SHT21_STATS_NOW(&bus);
+  UInt8 conversionTime = SHT21_Conversion_Time(resolution, cmd);
+  if (conversionTime != 0)
+    delay(conversionTime);
 
+  UInt32 readStart = SHT21_STATS_NOW(&bus);
+  if (conversionTime != 0)
+    SHT21_STATS_LATENCY(&bus, SHT21_STATS_CONVERSION, readStart - conversionStart);
   Wire.requestFrom((int)sht21_request.data.address, (int)len);
   status = readSht21(rxBuf, len);
+  SHT21_STATS_TRANSFER(&bus, SHT21_STATS_READBACK, status, readStart);
   return status;
 }
 
@@ -221,4 +484,22 @@ SHT21_Error_TypeDef SHT21::readSht21(UInt8* rxBuf, UInt8 len)
     return SHT21_TIME_OUT_ERROR;
 
   return SHT21_OK;
-}
\ No newline at end of file
+}
+
+#ifdef SHT21_STATS
+/********************************************************************************************
+ *  Copies the transaction counters and latency histograms, see sht21_stats.h
+ *******************************************************************************************/
+void SHT21::getStats(SHT21_Stats_Snapshot_TypeDef* snapshot)
+{
+  SHT21_Stats_Snapshot(&stats, snapshot);
+}
+
+/********************************************************************************************
+ *  Clears the transaction counters and latency histograms
+ *******************************************************************************************/
+void SHT21::resetStats()
+{
+  SHT21_Stats_Reset(&stats);
+}
+#endif
@@ -10,24 +10,59 @@
 #pragma once
 
 #include "sht21_core.h"
+#include "sht21_cache.h"
 
 #define SHT21_READ_TIMEOUT 1000
-#define SHT21_SELFTEST_TEMP_THRESHOLD 0.3f
-#define SHT21_SELFTEST_HUM_THRESHOLD 0.5f
 
 class SHT21
 {
 public:
-  SHT21(){};
+  SHT21();
   void init();
-  float getHumidity(SHT21_Error_TypeDef* error = nullptr);
-  float getTemp(SHT21_Error_TypeDef* error = nullptr);
+  float getHumidity(SHT21_Error_TypeDef* error = nullptr, UInt32 maxAge = 0);
+  float getTemp(SHT21_Error_TypeDef* error = nullptr, UInt32 maxAge = 0);
   SHT21_User_Reg_TypeDef getUserReg(SHT21_Error_TypeDef* error = nullptr);
+  SHT21_User_Reg_TypeDef refreshUserReg(SHT21_Error_TypeDef* error = nullptr);
   void updateUserReg(SHT21_User_Reg_TypeDef new_reg);
+  SHT21_Error_TypeDef updateUserRegFields(UInt8 mask, UInt8 value);
+  SHT21_Error_TypeDef setResolution(SHT21_Resolution_TypeDef res);
+  SHT21_Error_TypeDef setHeater(bool enable);
   void reset();
-  SHT21_Error_TypeDef selftest();
+  SHT21_Error_TypeDef pollReady();
+  SHT21_Error_TypeDef waitReady();
+  SHT21_Error_TypeDef selftest(UInt32 deadline = SHT21_SELFTEST_DEADLINE);
+  void selftestStart(UInt32 deadline = SHT21_SELFTEST_DEADLINE);
+  SHT21_Error_TypeDef selftestStep(UInt32* wait = nullptr);
+  void selftestAbort();
+  void setReadMode(SHT21_Commands_TypeDef cmd, SHT21_Read_Mode_TypeDef mode);
+  SHT21_Error_TypeDef startMeasurement(SHT21_Commands_TypeDef cmd);
+  SHT21_Error_TypeDef pollMeasurement(float* value);
+  SHT21_Sample_TypeDef measureBoth();
+  UInt8 getConversionTime(SHT21_Commands_TypeDef cmd);
+  const SHT21_Cache_TypeDef& getCache() const;
+#ifdef SHT21_STATS
+  void getStats(SHT21_Stats_Snapshot_TypeDef* snapshot);
+  void resetStats();
+#endif
 
 private:
+  SHT21_Bus_TypeDef bus;
+#ifdef SHT21_STATS
+  SHT21_Stats_TypeDef stats;
+#endif
+  SHT21_Measurement_TypeDef measurement;
+  SHT21_Selftest_TypeDef selftestState;
+  SHT21_Ready_TypeDef readiness;
+  SHT21_Cache_TypeDef cache;
+  SHT21_Resolution_TypeDef resolution;
+  SHT21_Read_Mode_TypeDef tempReadMode;
+  SHT21_Read_Mode_TypeDef rhReadMode;
+  SHT21_User_Reg_TypeDef userReg;
+  bool userRegValid;
+
   SHT21_Error_TypeDef transmitReceiveSht21(UInt8* rxBuf, UInt8 len, SHT21_Commands_TypeDef cmd);
   SHT21_Error_TypeDef readSht21(UInt8* rxBuf, UInt8 len);
+  SHT21_Error_TypeDef writeUserReg(SHT21_User_Reg_TypeDef new_reg);
+  float measureCached(SHT21_Commands_TypeDef cmd, UInt32 maxAge, SHT21_Error_TypeDef* error);
+  SHT21_Read_Mode_TypeDef readMode(SHT21_Commands_TypeDef cmd);
 };
\ No newline at end of file
@@ -1,34 +1,47 @@
 #include "sht21_arduino.h"
 
 SHT21 sht21;
+bool selftestRunning = true;
 
 void setup() 
 {
   sht21.init(); // Start the I2C for SHT21
   Serial.begin(9600);
-  delay(100);
 
-  // Perform a selftest to see if sensor is working (Takes 10seconds)
-  if (sht21.selftest() == SHT21_OK)
-    Serial.println("Selftest OK!\n");
-  else
-    Serial.println("Selftest failed!\n");
+  // Wait until the SHT21 answers after power up, within 15 ms
+  if (sht21.waitReady() != SHT21_OK)
+    Serial.println("SHT21 not found!\n");
+
+  // Start a selftest to see if sensor is working, it is run from loop() without blocking
+  sht21.selftestStart();
 }
 
 void loop() 
 {
-  // Get the temperature reading
-  float temp = sht21.getTemp();
-  // Get the humidity reading
-  float hum = sht21.getHumidity();
-  // Get the user register
+  // Step the selftest until it is done, usually within a second or two
+  if (selftestRunning)
+  {
+    SHT21_Error_TypeDef result = sht21.selftestStep();
+    if (result == SHT21_BUSY)
+      return; // Other work can be done here
+
+    selftestRunning = false;
+    if (result == SHT21_OK)
+      Serial.println("Selftest OK!\n");
+    else
+      Serial.println("Selftest failed!\n");
+  }
+
+  // Get the temperature and humidity readings in one call
+  SHT21_Sample_TypeDef sample = sht21.measureBoth();
+  // Get the user register, served from the shadow copy without an I2C transfer
   SHT21_User_Reg_TypeDef sht21User = sht21.getUserReg();
 
   // Print the temperature and humidity readings
   Serial.print("### Temp: ");
-  Serial.print(temp);
+  Serial.print(sample.temp);
   Serial.print(" | Humidity: ");
-  Serial.print(hum);
+  Serial.print(sample.humidity);
   Serial.println(" ###");
 
   // Print the user register
@@ -0,0 +1,49 @@
+/********************************************************************************************
+ *  Filename: sht21_wire_bus.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Bus policy of Sht21<Bus, Res> on an Arduino TwoWire instance
+ *
+ *      Sht21<Sht21_Wire_Bus, SHT21_RES_RH12_T14> sensor(Sht21_Wire_Bus(Wire));
+ *
+ *******************************************************************************************/
+#pragma once
+
+#include "sht21_template.h"
+#include <Wire.h>
+#include <Arduino.h>
+
+class Sht21_Wire_Bus
+{
+public:
+  explicit Sht21_Wire_Bus(TwoWire& wire) : wire(&wire) {}
+
+  // 2 and 3 are NACK on address and data
+  SHT21_Error_TypeDef write(UInt8 address, UInt8* buf, UInt8 len)
+  {
+    wire->beginTransmission(address);
+    wire->write(buf, len);
+    UInt8 result = wire->endTransmission();
+    if (result == 0)
+      return SHT21_OK;
+    return (result == 2 || result == 3) ? SHT21_ACK_ERROR : SHT21_TIME_OUT_ERROR;
+  }
+
+  // A NACK on the address gives no bytes
+  SHT21_Error_TypeDef read(UInt8 address, UInt8* buf, UInt8 len)
+  {
+    if (wire->requestFrom((int)address, (int)len) != len)
+      return SHT21_ACK_ERROR;
+    for (UInt8 i = 0; i < len; i++)
+      buf[i] = wire->read();
+    return SHT21_OK;
+  }
+
+  UInt32 get_tick() { return millis(); }
+  void delay(UInt32 ms) { ::delay(ms); }
+
+private:
+  TwoWire* wire;
+};
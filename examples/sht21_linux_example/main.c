@@ -0,0 +1,60 @@
+/********************************************************************************************
+ *  Filename: main.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Example reading a SHT21 on a Linux I2C adapter. Build with:
+ *      gcc -I../.. main.c sht21_linux.c ../../sht21_core.c -o sht21_linux_example
+ *
+ *  Run with the adapter as argument, default is /dev/i2c-1.
+ *
+ *******************************************************************************************/
+#include "sht21_linux.h"
+
+#include <stdio.h>
+
+int main(int argc, char** argv)
+{
+    const char* path = (argc > 1) ? argv[1] : "/dev/i2c-1";
+    SHT21_Linux_TypeDef sht21;
+
+    if (SHT21_Linux_Open(&sht21, path) != SHT21_OK)
+    {
+        perror(path);
+        return 1;
+    }
+
+    // Read the user register with a single combined transaction
+    UInt8 rx_buf[3] = {0};
+    SHT21_Error_TypeDef error = SHT21_Linux_Transfer(&sht21, SHT21_READ_USER_REG, rx_buf, 1);
+    if (error != SHT21_OK)
+    {
+        printf("Error reading user register: %d\n", error);
+        SHT21_Linux_Close(&sht21);
+        return 1;
+    }
+    SHT21_Resolution_TypeDef resolution = SHT21_Get_Resolution(SHT21_Parse_User_Reg(rx_buf));
+
+    // Hold master measurement, the command and the clock stretched read in one syscall
+    error = SHT21_Linux_Transfer(&sht21, SHT21_TEMP_MEASURE_HOLD, rx_buf, 3);
+    if (error == SHT21_OK)
+        printf("Hold master temp: %.2f (%u syscall)\n", SHT21_Parse_Temp(rx_buf), sht21.last_syscalls);
+
+    // No hold master measurements of both values, polled until the SHT21 answers
+    for (int i = 0; i < 10; i++)
+    {
+        UInt32 syscalls = sht21.syscalls;
+        SHT21_Sample_TypeDef sample = SHT21_Measure_Both(&sht21.bus, resolution);
+
+        if (sample.status == SHT21_OK)
+            printf("Humidity: %.2f, Temp: %.02f (%u syscalls)\n", sample.humidity, sample.temp,
+                   sht21.syscalls - syscalls);
+        else
+            printf("Error during measurement: %d\n", sample.status);
+    }
+
+    printf("%u transactions, %u syscalls\n", sht21.transactions, sht21.syscalls);
+    SHT21_Linux_Close(&sht21);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/********************************************************************************************
+ *  Filename: sht21_linux.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 Linux backend
+ *
+ *******************************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "sht21_linux.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+/********************************************************************************************
+ *  Default ioctl function
+ *******************************************************************************************/
+static int SHT21_Linux_Ioctl(int fd, unsigned long request, void* arg)
+{
+    return ioctl(fd, request, arg);
+}
+
+/********************************************************************************************
+ *  Runs the messages as one I2C_RDWR transaction. The adapter reports a NACK as
+ *  EREMOTEIO or ENXIO depending on the driver.
+ *******************************************************************************************/
+static SHT21_Error_TypeDef SHT21_Linux_Rdwr(SHT21_Linux_TypeDef* dev, struct i2c_msg* msgs, UInt32 count)
+{
+    struct i2c_rdwr_ioctl_data data;
+    data.msgs = msgs;
+    data.nmsgs = count;
+
+    dev->transactions++;
+    dev->syscalls++;
+    dev->last_syscalls = 1;
+
+    if (dev->ioctl_fn(dev->fd, I2C_RDWR, &data) >= 0)
+        return SHT21_OK;
+
+    switch (errno)
+    {
+        case EREMOTEIO:
+        case ENXIO:
+        return SHT21_ACK_ERROR;
+        default:
+        return SHT21_TIME_OUT_ERROR;
+    }
+}
+
+/********************************************************************************************
+ *  Writes len bytes to the device in one transaction
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Linux_Write(SHT21_Linux_TypeDef* dev, UInt8 address, UInt8* buf, UInt8 len)
+{
+    struct i2c_msg msg = { address, 0, len, buf };
+    return SHT21_Linux_Rdwr(dev, &msg, 1);
+}
+
+/********************************************************************************************
+ *  Reads len bytes from the device in one transaction
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Linux_Read(SHT21_Linux_TypeDef* dev, UInt8 address, UInt8* buf, UInt8 len)
+{
+    struct i2c_msg msg = { address, I2C_M_RD, len, buf };
+    return SHT21_Linux_Rdwr(dev, &msg, 1);
+}
+
+/********************************************************************************************
+ *  Writes tx_buf and reads rx_buf with a repeated start, in a single syscall
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Linux_Write_Read(SHT21_Linux_TypeDef* dev, UInt8 address, UInt8* tx_buf, UInt8 tx_len,
+                                           UInt8* rx_buf, UInt8 rx_len)
+{
+    struct i2c_msg msgs[2] =
+    {
+        { address, 0, tx_len, tx_buf },
+        { address, I2C_M_RD, rx_len, rx_buf }
+    };
+    return SHT21_Linux_Rdwr(dev, msgs, 2);
+}
+
+/********************************************************************************************
+ *  Sends the command and reads the response in one combined transaction. Meant for
+ *  SHT21_READ_USER_REG and the hold master measurements, where the SHT21 stretches the
+ *  clock until the conversion is done.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Linux_Transfer(SHT21_Linux_TypeDef* dev, SHT21_Commands_TypeDef cmd, UInt8* rx_buf, UInt8 len)
+{
+    SHT21_Request_TypeDef sht21_request = SHT21_Request_Buf(cmd);
+    UInt8 tx_buf = sht21_request.data.command;
+    return SHT21_Linux_Write_Read(dev, sht21_request.data.address, &tx_buf, 1, rx_buf, len);
+}
+
+static SHT21_Error_TypeDef SHT21_Linux_Bus_Write(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+    return SHT21_Linux_Write((SHT21_Linux_TypeDef*)handle, address, buf, len);
+}
+
+static SHT21_Error_TypeDef SHT21_Linux_Bus_Read(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+    return SHT21_Linux_Read((SHT21_Linux_TypeDef*)handle, address, buf, len);
+}
+
+static UInt32 SHT21_Linux_Bus_Get_Tick(void* handle)
+{
+    (void)handle;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UInt32)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
+}
+
+static void SHT21_Linux_Bus_Delay(void* handle, UInt32 ms)
+{
+    (void)handle;
+    struct timespec ts;
+    ts.tv_sec = ms / 1000U;
+    ts.tv_nsec = (long)(ms % 1000U) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
+
+/********************************************************************************************
+ *  Uses an already open fd, with ioctl_fn in place of ioctl. Pass 0 as ioctl_fn to
+ *  use the real ioctl.
+ *******************************************************************************************/
+void SHT21_Linux_Attach(SHT21_Linux_TypeDef* dev, int fd, SHT21_Linux_Ioctl_Fn ioctl_fn)
+{
+    dev->fd = fd;
+    dev->ioctl_fn = (ioctl_fn != 0) ? ioctl_fn : SHT21_Linux_Ioctl;
+    dev->transactions = 0;
+    dev->syscalls = 0;
+    dev->last_syscalls = 0;
+
+    dev->bus.write = SHT21_Linux_Bus_Write;
+    dev->bus.read = SHT21_Linux_Bus_Read;
+    dev->bus.get_tick = SHT21_Linux_Bus_Get_Tick;
+    dev->bus.delay = SHT21_Linux_Bus_Delay;
+    dev->bus.handle = dev;
+    SHT21_STATS_ATTACH(&dev->bus, 0);
+}
+
+/********************************************************************************************
+ *  Opens the I2C adapter, for example "/dev/i2c-1"
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Linux_Open(SHT21_Linux_TypeDef* dev, const char* path)
+{
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        return SHT21_UNIT_ERROR;
+
+    SHT21_Linux_Attach(dev, fd, 0);
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Closes the I2C adapter
+ *******************************************************************************************/
+void SHT21_Linux_Close(SHT21_Linux_TypeDef* dev)
+{
+    if (dev->fd >= 0)
+        close(dev->fd);
+    dev->fd = -1;
+}
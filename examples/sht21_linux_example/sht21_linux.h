@@ -0,0 +1,57 @@
+/********************************************************************************************
+ *  Filename: sht21_linux.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Linux userspace backend for the SHT21 core, talking to /dev/i2c-N. Every transfer is
+ *  a single I2C_RDWR ioctl, a command followed by its read is sent as one combined
+ *  transaction with a repeated start.
+ *
+ *  The ioctl function can be replaced with SHT21_Linux_Attach, so the backend can run
+ *  against a simulated fd without real hardware.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_LINUX__H
+#define __SHT21_LINUX__H
+
+#include "sht21_core.h"
+
+typedef int (*SHT21_Linux_Ioctl_Fn)(int fd, unsigned long request, void* arg);
+
+/********************************************************************************************
+ *  A SHT21 on a Linux I2C adapter. The counters can be read and cleared at any time.
+ *
+ *  transactions    : Number of bus transactions run
+ *  syscalls        : Number of syscalls made for those transactions
+ *  last_syscalls   : Syscalls made by the last transaction
+ *  bus             : Core bus running on this adapter
+ *******************************************************************************************/
+typedef struct
+{
+    int fd;
+    SHT21_Linux_Ioctl_Fn ioctl_fn;
+    UInt32 transactions;
+    UInt32 syscalls;
+    UInt32 last_syscalls;
+    SHT21_Bus_TypeDef bus;
+} SHT21_Linux_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SHT21_Error_TypeDef SHT21_Linux_Open(SHT21_Linux_TypeDef* dev, const char* path);
+void SHT21_Linux_Attach(SHT21_Linux_TypeDef* dev, int fd, SHT21_Linux_Ioctl_Fn ioctl_fn);
+void SHT21_Linux_Close(SHT21_Linux_TypeDef* dev);
+SHT21_Error_TypeDef SHT21_Linux_Write(SHT21_Linux_TypeDef* dev, UInt8 address, UInt8* buf, UInt8 len);
+SHT21_Error_TypeDef SHT21_Linux_Read(SHT21_Linux_TypeDef* dev, UInt8 address, UInt8* buf, UInt8 len);
+SHT21_Error_TypeDef SHT21_Linux_Write_Read(SHT21_Linux_TypeDef* dev, UInt8 address, UInt8* tx_buf, UInt8 tx_len,
+                                           UInt8* rx_buf, UInt8 rx_len);
+SHT21_Error_TypeDef SHT21_Linux_Transfer(SHT21_Linux_TypeDef* dev, SHT21_Commands_TypeDef cmd, UInt8* rx_buf, UInt8 len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_LINUX__H
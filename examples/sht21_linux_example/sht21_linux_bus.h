@@ -0,0 +1,51 @@
+/********************************************************************************************
+ *  Filename: sht21_linux_bus.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Bus policy of Sht21<Bus, Res> on the Linux backend, one I2C_RDWR ioctl per transfer
+ *
+ *      SHT21_Linux_TypeDef dev;
+ *      SHT21_Linux_Open(&dev, "/dev/i2c-1");
+ *      Sht21<Sht21_Linux_Bus, SHT21_RES_RH12_T14> sensor(Sht21_Linux_Bus(&dev));
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_LINUX_BUS__H
+#define __SHT21_LINUX_BUS__H
+
+#include "sht21_template.h"
+#include "sht21_linux.h"
+
+#include <errno.h>
+#include <time.h>
+
+class Sht21_Linux_Bus
+{
+public:
+  explicit Sht21_Linux_Bus(SHT21_Linux_TypeDef* dev) : dev(dev) {}
+
+  SHT21_Error_TypeDef write(UInt8 address, UInt8* buf, UInt8 len) { return SHT21_Linux_Write(dev, address, buf, len); }
+  SHT21_Error_TypeDef read(UInt8 address, UInt8* buf, UInt8 len) { return SHT21_Linux_Read(dev, address, buf, len); }
+
+  UInt32 get_tick()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UInt32)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
+  }
+
+  void delay(UInt32 ms)
+  {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000U;
+    ts.tv_nsec = (long)(ms % 1000U) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+      ;
+  }
+
+private:
+  SHT21_Linux_TypeDef* dev;
+};
+
+#endif // __SHT21_LINUX_BUS__H
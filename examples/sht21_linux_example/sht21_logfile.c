@@ -0,0 +1,255 @@
+/********************************************************************************************
+ *  Filename: sht21_logfile.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 log files
+ *
+ *******************************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include "sht21_logfile.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static off_t SHT21_Logfile_Block_Offset(UInt32 index)
+{
+    return (off_t)SHT21_LOG_HEADER_SIZE + (off_t)index * SHT21_LOG_BLOCK_SIZE;
+}
+
+static SHT21_Error_TypeDef SHT21_Logfile_Write_Block(SHT21_Logfile_TypeDef* log)
+{
+    ssize_t written = pwrite(log->fd, log->writer.data, SHT21_LOG_BLOCK_SIZE,
+                             SHT21_Logfile_Block_Offset(log->block_index));
+    return (written == (ssize_t)SHT21_LOG_BLOCK_SIZE) ? SHT21_OK : SHT21_UNIT_ERROR;
+}
+
+// Closes a log that could not be opened, so log->fd is never left open after an error
+static SHT21_Error_TypeDef SHT21_Logfile_Open_Failed(SHT21_Logfile_TypeDef* log)
+{
+    close(log->fd);
+    log->fd = -1;
+    return SHT21_UNIT_ERROR;
+}
+
+/********************************************************************************************
+ *  Opens or creates a log. An existing log is appended to, continuing its last block.
+ *  Returns SHT21_UNIT_ERROR if the file can not be used, log->fd is then -1.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Logfile_Open(SHT21_Logfile_TypeDef* log, const char* path)
+{
+    UInt8 header[SHT21_LOG_HEADER_SIZE];
+    struct stat st;
+
+    log->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (log->fd < 0)
+        return SHT21_UNIT_ERROR;
+    if (fstat(log->fd, &st) != 0)
+        return SHT21_Logfile_Open_Failed(log);
+
+    log->block_index = 0;
+    SHT21_Log_Writer_Begin(&log->writer);
+
+    if (st.st_size == 0)
+    {
+        SHT21_Log_Write_Header(header);
+        if (pwrite(log->fd, header, sizeof(header), 0) != (ssize_t)sizeof(header))
+            return SHT21_Logfile_Open_Failed(log);
+        return SHT21_OK;
+    }
+
+    if (pread(log->fd, header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        SHT21_Log_Check_Header(header) != SHT21_OK)
+        return SHT21_Logfile_Open_Failed(log);
+
+    UInt32 blocks = (UInt32)((st.st_size - SHT21_LOG_HEADER_SIZE) / SHT21_LOG_BLOCK_SIZE);
+    if (blocks == 0)
+        return SHT21_OK;
+
+    // Continue the last block, it is rewritten on the next flush
+    UInt8 block[SHT21_LOG_BLOCK_SIZE];
+    log->block_index = blocks - 1U;
+    if (pread(log->fd, block, sizeof(block), SHT21_Logfile_Block_Offset(log->block_index)) != (ssize_t)sizeof(block) ||
+        SHT21_Log_Writer_Resume(&log->writer, block) != SHT21_OK)
+        return SHT21_Logfile_Open_Failed(log);
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Appends a sample. Timestamps must not go backwards.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Logfile_Append_Record(SHT21_Logfile_TypeDef* log, const SHT21_Log_Record_TypeDef* record)
+{
+    if (SHT21_Log_Writer_Append(&log->writer, record))
+        return SHT21_OK;
+
+    // Block full, store it and start the next one
+    SHT21_Error_TypeDef status = SHT21_Logfile_Write_Block(log);
+    if (status != SHT21_OK)
+        return status;
+
+    log->block_index++;
+    SHT21_Log_Writer_Begin(&log->writer);
+    SHT21_Log_Writer_Append(&log->writer, record);
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Appends a sample from the 3 byte temperature and humidity frames as received.
+ *  Returns SHT21_CHECKSUM_ERROR without appending if either frame is corrupt.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Logfile_Append(SHT21_Logfile_TypeDef* log, unsigned long long time_ms,
+                                         UInt8* temp_frame, UInt8* rh_frame)
+{
+    SHT21_Log_Record_TypeDef record;
+    UInt16 temp_reading;
+    UInt16 rh_reading;
+
+    SHT21_Error_TypeDef status = SHT21_Parse_Reading(temp_frame, &temp_reading);
+    if (status == SHT21_OK)
+        status = SHT21_Parse_Reading(rh_frame, &rh_reading);
+    if (status != SHT21_OK)
+        return status;
+
+    record.time_ms = time_ms;
+    record.temp_ticks = (UInt16)(temp_reading >> 2);
+    record.rh_ticks = (UInt16)(rh_reading >> 4);
+    return SHT21_Logfile_Append_Record(log, &record);
+}
+
+/********************************************************************************************
+ *  Writes the block being filled, so readers see every sample appended so far
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Logfile_Flush(SHT21_Logfile_TypeDef* log)
+{
+    if (log->writer.header.count == 0)
+        return SHT21_OK;
+    return SHT21_Logfile_Write_Block(log);
+}
+
+/********************************************************************************************
+ *  Flushes and closes the log
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Logfile_Close(SHT21_Logfile_TypeDef* log)
+{
+    SHT21_Error_TypeDef status = SHT21_Logfile_Flush(log);
+    if (close(log->fd) != 0 && status == SHT21_OK)
+        status = SHT21_UNIT_ERROR;
+    log->fd = -1;
+    return status;
+}
+
+/********************************************************************************************
+ *  Maps a log for reading. Nothing is decoded until a range is read.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Logfile_Map(SHT21_Logfile_Reader_TypeDef* reader, const char* path)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    reader->map = 0;
+    reader->blocks = 0;
+    if (fd < 0)
+        return SHT21_UNIT_ERROR;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)SHT21_LOG_HEADER_SIZE)
+    {
+        close(fd);
+        return SHT21_UNIT_ERROR;
+    }
+
+    void* map = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return SHT21_UNIT_ERROR;
+
+    reader->map = (const UInt8*)map;
+    reader->size = (size_t)st.st_size;
+    if (SHT21_Log_Check_Header(reader->map) != SHT21_OK)
+    {
+        SHT21_Logfile_Unmap(reader);
+        return SHT21_UNIT_ERROR;
+    }
+    reader->blocks = (UInt32)((reader->size - SHT21_LOG_HEADER_SIZE) / SHT21_LOG_BLOCK_SIZE);
+    return SHT21_OK;
+}
+
+void SHT21_Logfile_Unmap(SHT21_Logfile_Reader_TypeDef* reader)
+{
+    if (reader->map != 0)
+        munmap((void*)reader->map, reader->size);
+    reader->map = 0;
+    reader->blocks = 0;
+}
+
+static const UInt8* SHT21_Logfile_Block(const SHT21_Logfile_Reader_TypeDef* reader, UInt32 index)
+{
+    return reader->map + SHT21_Logfile_Block_Offset(index);
+}
+
+/********************************************************************************************
+ *  Sets up cursor to read the samples from from_ms to to_ms, both included. Finds the
+ *  first block by binary search, blocks before it are never touched.
+ *******************************************************************************************/
+void SHT21_Logfile_Range(const SHT21_Logfile_Reader_TypeDef* reader, SHT21_Logfile_Cursor_TypeDef* cursor,
+                         unsigned long long from_ms, unsigned long long to_ms)
+{
+    UInt32 low = 0;
+    UInt32 high = reader->blocks;
+
+    // First block that ends at or after from_ms
+    while (low < high)
+    {
+        UInt32 mid = low + (high - low) / 2U;
+        SHT21_Log_Block_Header_TypeDef header;
+        SHT21_Log_Read_Block_Header(SHT21_Logfile_Block(reader, mid), &header);
+        if (header.last_ms < from_ms)
+            low = mid + 1U;
+        else
+            high = mid;
+    }
+
+    cursor->reader = reader;
+    cursor->block = low;
+    cursor->from_ms = from_ms;
+    cursor->to_ms = to_ms;
+    cursor->blocks_decoded = 0;
+    cursor->decoder.header.count = 0;
+    cursor->decoder.index = 0;
+}
+
+/********************************************************************************************
+ *  Decodes the next sample of the range into record. Returns 0 at the end of the range.
+ *******************************************************************************************/
+UInt8 SHT21_Logfile_Next(SHT21_Logfile_Cursor_TypeDef* cursor, SHT21_Log_Record_TypeDef* record)
+{
+    for (;;)
+    {
+        if (!SHT21_Log_Decoder_Next(&cursor->decoder, record))
+        {
+            if (cursor->block >= cursor->reader->blocks)
+                return 0;
+
+            SHT21_Log_Decoder_Init(&cursor->decoder, SHT21_Logfile_Block(cursor->reader, cursor->block));
+            cursor->block++;
+            cursor->blocks_decoded++;
+            if (cursor->decoder.header.count > 0 && cursor->decoder.header.first_ms > cursor->to_ms)
+            {
+                cursor->block = cursor->reader->blocks;
+                return 0;
+            }
+            continue;
+        }
+
+        if (record->time_ms > cursor->to_ms)
+        {
+            cursor->block = cursor->reader->blocks;
+            cursor->decoder.index = cursor->decoder.header.count;
+            return 0;
+        }
+        if (record->time_ms >= cursor->from_ms)
+            return 1;
+    }
+}
@@ -0,0 +1,68 @@
+/********************************************************************************************
+ *  Filename: sht21_logfile.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Files in the sht21_log.h format. The writer appends samples and writes a block when
+ *  it is full, the last block is rewritten in place by SHT21_Logfile_Flush. The reader
+ *  maps the file and decodes only the blocks a time range touches, found by binary
+ *  search over the block headers.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_LOGFILE__H
+#define __SHT21_LOGFILE__H
+
+#include "sht21_log.h"
+
+#include <stddef.h>
+
+typedef struct
+{
+    int fd;
+    UInt32 block_index;
+    SHT21_Log_Writer_TypeDef writer;
+} SHT21_Logfile_TypeDef;
+
+typedef struct
+{
+    const UInt8* map;
+    size_t size;
+    UInt32 blocks;
+} SHT21_Logfile_Reader_TypeDef;
+
+/********************************************************************************************
+ *  Position of a range read. blocks_decoded counts the blocks touched.
+ *******************************************************************************************/
+typedef struct
+{
+    const SHT21_Logfile_Reader_TypeDef* reader;
+    UInt32 block;
+    unsigned long long from_ms;
+    unsigned long long to_ms;
+    SHT21_Log_Decoder_TypeDef decoder;
+    UInt32 blocks_decoded;
+} SHT21_Logfile_Cursor_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SHT21_Error_TypeDef SHT21_Logfile_Open(SHT21_Logfile_TypeDef* log, const char* path);
+SHT21_Error_TypeDef SHT21_Logfile_Append(SHT21_Logfile_TypeDef* log, unsigned long long time_ms,
+                                         UInt8* temp_frame, UInt8* rh_frame);
+SHT21_Error_TypeDef SHT21_Logfile_Append_Record(SHT21_Logfile_TypeDef* log, const SHT21_Log_Record_TypeDef* record);
+SHT21_Error_TypeDef SHT21_Logfile_Flush(SHT21_Logfile_TypeDef* log);
+SHT21_Error_TypeDef SHT21_Logfile_Close(SHT21_Logfile_TypeDef* log);
+
+SHT21_Error_TypeDef SHT21_Logfile_Map(SHT21_Logfile_Reader_TypeDef* reader, const char* path);
+void SHT21_Logfile_Unmap(SHT21_Logfile_Reader_TypeDef* reader);
+void SHT21_Logfile_Range(const SHT21_Logfile_Reader_TypeDef* reader, SHT21_Logfile_Cursor_TypeDef* cursor,
+                         unsigned long long from_ms, unsigned long long to_ms);
+UInt8 SHT21_Logfile_Next(SHT21_Logfile_Cursor_TypeDef* cursor, SHT21_Log_Record_TypeDef* record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_LOGFILE__H
@@ -0,0 +1,247 @@
+/********************************************************************************************
+ *  Filename: sht21_server.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 bus owner service
+ *
+ *******************************************************************************************/
+#define _GNU_SOURCE
+#include "sht21_server.h"
+
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Index of the pending list of a measurement
+#define SHT21_SERVER_TEMP           (0U)
+#define SHT21_SERVER_RH             (1U)
+
+/********************************************************************************************
+ *  Requests of one measurement waiting for the dispatcher, in arrival order. order is
+ *  when the first of them arrived.
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Server_Request_TypeDef* head;
+    SHT21_Server_Request_TypeDef* tail;
+    UInt32 count;
+    UInt32 order;
+} SHT21_Server_List_TypeDef;
+
+static void SHT21_Server_Futex_Wait(int* addr, int value)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static void SHT21_Server_Futex_Wake(int* addr, int count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/********************************************************************************************
+ *  Hands a result to the client. The client may reuse the request as soon as done is
+ *  set, so next is read before.
+ *******************************************************************************************/
+static SHT21_Server_Request_TypeDef* SHT21_Server_Finish(SHT21_Server_Request_TypeDef* request,
+                                                         SHT21_Error_TypeDef status, float value)
+{
+    SHT21_Server_Request_TypeDef* next = request->next;
+    request->status = status;
+    request->value = value;
+    __atomic_store_n(&request->done, 1, __ATOMIC_RELEASE);
+    SHT21_Server_Futex_Wake(&request->done, INT_MAX);
+    return next;
+}
+
+/********************************************************************************************
+ *  Takes everything submitted so far and appends it to the pending lists. The
+ *  submissions are a stack, so they are reversed first to keep the arrival order.
+ *******************************************************************************************/
+static void SHT21_Server_Drain(SHT21_Server_TypeDef* server, SHT21_Server_List_TypeDef* lists, UInt32* order)
+{
+    SHT21_Server_Request_TypeDef* taken = __atomic_exchange_n(&server->submitted, NULL, __ATOMIC_ACQUIRE);
+    SHT21_Server_Request_TypeDef* reversed = NULL;
+
+    while (taken != NULL)
+    {
+        SHT21_Server_Request_TypeDef* next = taken->next;
+        taken->next = reversed;
+        reversed = taken;
+        taken = next;
+    }
+
+    while (reversed != NULL)
+    {
+        SHT21_Server_Request_TypeDef* request = reversed;
+        reversed = request->next;
+        request->next = NULL;
+
+        SHT21_Server_List_TypeDef* list;
+        if (request->cmd == SHT21_TEMP_MEASURE)
+            list = &lists[SHT21_SERVER_TEMP];
+        else if (request->cmd == SHT21_RH_MEASURE)
+            list = &lists[SHT21_SERVER_RH];
+        else
+        {
+            SHT21_Server_Finish(request, SHT21_UNIT_ERROR, 0.0f);
+            continue;
+        }
+
+        if (list->head == NULL)
+        {
+            list->head = request;
+            list->order = (*order)++;
+        }
+        else
+            list->tail->next = request;
+        list->tail = request;
+        list->count++;
+    }
+}
+
+/********************************************************************************************
+ *  Runs one conversion for every request in the list. Requests for the same measurement
+ *  that arrive while it converts join the list before the result is handed out.
+ *******************************************************************************************/
+static void SHT21_Server_Convert(SHT21_Server_TypeDef* server, SHT21_Server_List_TypeDef* lists, UInt32 index,
+                                 UInt32* order)
+{
+    SHT21_Server_List_TypeDef* list = &lists[index];
+    SHT21_Measurement_TypeDef meas;
+    float value = 0.0f;
+
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(&meas, server->bus, list->head->cmd);
+    if (status == SHT21_OK)
+        status = SHT21_Measure_Wait(&meas, SHT21_Conversion_Time(server->resolution, meas.cmd));
+
+    SHT21_Server_Drain(server, lists, order);
+    if (status == SHT21_OK)
+        status = SHT21_Measure_Complete(&meas, &value);
+
+    server->requests += list->count;
+    server->conversions++;
+    server->coalesced += list->count - 1U;
+
+    SHT21_Server_Request_TypeDef* request = list->head;
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    while (request != NULL)
+        request = SHT21_Server_Finish(request, status, value);
+}
+
+/********************************************************************************************
+ *  Dispatcher thread. Sleeps on wake while nothing is pending, serves the measurement
+ *  whose oldest request came first, and returns when stopped with nothing pending.
+ *******************************************************************************************/
+static void* SHT21_Server_Dispatch(void* arg)
+{
+    SHT21_Server_TypeDef* server = (SHT21_Server_TypeDef*)arg;
+    SHT21_Server_List_TypeDef lists[2] = {{0}};
+    UInt32 order = 0;
+
+    for (;;)
+    {
+        int wake = __atomic_load_n(&server->wake, __ATOMIC_SEQ_CST);
+        SHT21_Server_Drain(server, lists, &order);
+
+        UInt8 temp = lists[SHT21_SERVER_TEMP].head != NULL;
+        UInt8 rh = lists[SHT21_SERVER_RH].head != NULL;
+        if (temp && rh)
+            SHT21_Server_Convert(server, lists, (Int32)(lists[SHT21_SERVER_TEMP].order - lists[SHT21_SERVER_RH].order) < 0 ?
+                                 SHT21_SERVER_TEMP : SHT21_SERVER_RH, &order);
+        else if (temp || rh)
+            SHT21_Server_Convert(server, lists, temp ? SHT21_SERVER_TEMP : SHT21_SERVER_RH, &order);
+        else if (__atomic_load_n(&server->stop, __ATOMIC_ACQUIRE))
+            return NULL;
+        else
+        {
+            __atomic_store_n(&server->sleeping, 1, __ATOMIC_SEQ_CST);
+            SHT21_Server_Futex_Wait(&server->wake, wake);
+            __atomic_store_n(&server->sleeping, 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/********************************************************************************************
+ *  Wakes the dispatcher if it sleeps. The increment of wake makes a dispatcher that is
+ *  about to sleep return from the futex at once.
+ *******************************************************************************************/
+static void SHT21_Server_Wake(SHT21_Server_TypeDef* server)
+{
+    __atomic_add_fetch(&server->wake, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&server->sleeping, __ATOMIC_SEQ_CST))
+        SHT21_Server_Futex_Wake(&server->wake, 1);
+}
+
+/********************************************************************************************
+ *  Starts the dispatcher of a bus. resolution must be the one set in the sensor.
+ *  Returns SHT21_UNIT_ERROR if the thread can not be created.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Server_Start(SHT21_Server_TypeDef* server, SHT21_Bus_TypeDef* bus,
+                                       SHT21_Resolution_TypeDef resolution)
+{
+    *server = (SHT21_Server_TypeDef){0};
+    server->bus = bus;
+    server->resolution = resolution;
+
+    if (pthread_create(&server->thread, NULL, SHT21_Server_Dispatch, server) != 0)
+        return SHT21_UNIT_ERROR;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Serves what is pending and stops the dispatcher. No requests may be submitted after.
+ *******************************************************************************************/
+void SHT21_Server_Stop(SHT21_Server_TypeDef* server)
+{
+    __atomic_store_n(&server->stop, 1, __ATOMIC_RELEASE);
+    SHT21_Server_Wake(server);
+    pthread_join(server->thread, NULL);
+}
+
+/********************************************************************************************
+ *  Queues a measurement, cmd is SHT21_TEMP_MEASURE or SHT21_RH_MEASURE. Lock-free, safe
+ *  from any number of threads. The request must stay valid until SHT21_Server_Wait.
+ *******************************************************************************************/
+void SHT21_Server_Submit(SHT21_Server_TypeDef* server, SHT21_Server_Request_TypeDef* request,
+                         SHT21_Commands_TypeDef cmd)
+{
+    request->cmd = cmd;
+    request->status = SHT21_BUSY;
+    request->done = 0;
+
+    SHT21_Server_Request_TypeDef* head = __atomic_load_n(&server->submitted, __ATOMIC_RELAXED);
+    do
+        request->next = head;
+    while (!__atomic_compare_exchange_n(&server->submitted, &head, request, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    SHT21_Server_Wake(server);
+}
+
+/********************************************************************************************
+ *  Sleeps until a submitted request is served, returns its status
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Server_Wait(SHT21_Server_Request_TypeDef* request)
+{
+    while (__atomic_load_n(&request->done, __ATOMIC_ACQUIRE) == 0)
+        SHT21_Server_Futex_Wait(&request->done, 0);
+    return request->status;
+}
+
+/********************************************************************************************
+ *  Submits a measurement and waits for it
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Server_Read(SHT21_Server_TypeDef* server, SHT21_Commands_TypeDef cmd, float* value)
+{
+    SHT21_Server_Request_TypeDef request;
+    SHT21_Server_Submit(server, &request, cmd);
+
+    SHT21_Error_TypeDef status = SHT21_Server_Wait(&request);
+    if (status == SHT21_OK)
+        *value = request.value;
+    return status;
+}
@@ -0,0 +1,78 @@
+/********************************************************************************************
+ *  Filename: sht21_server.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Bus owner service for sharing a SHT21 between threads. One dispatcher thread per bus
+ *  runs every transaction, clients submit requests to it through a lock-free multiple
+ *  producer queue and sleep on a futex until the result is in.
+ *
+ *  Requests for the same measurement that arrive while its conversion runs are
+ *  coalesced onto that conversion and get the same result, so the bus is used once per
+ *  conversion however many clients ask. Requests are served in the order they arrive,
+ *  a temperature and a humidity conversion can not run at the same time.
+ *
+ *  The dispatcher only touches the bus of the server, which must not be used by
+ *  anything else while the server runs. Needs pthreads and Linux futexes.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_SERVER__H
+#define __SHT21_SERVER__H
+
+#include "sht21_core.h"
+
+#include <pthread.h>
+
+/********************************************************************************************
+ *  A request, owned by the client until it is done. cmd is SHT21_TEMP_MEASURE or
+ *  SHT21_RH_MEASURE, status and value are valid after SHT21_Server_Wait.
+ *******************************************************************************************/
+typedef struct SHT21_Server_Request
+{
+    struct SHT21_Server_Request* next;
+    SHT21_Commands_TypeDef cmd;
+    SHT21_Error_TypeDef status;
+    float value;
+    int done;
+} SHT21_Server_Request_TypeDef;
+
+/********************************************************************************************
+ *  A dispatcher and its bus. The counters are written by the dispatcher only.
+ *
+ *  requests        : Requests served
+ *  conversions     : Conversions run for them
+ *  coalesced       : Requests served by a conversion another request started
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Bus_TypeDef* bus;
+    SHT21_Resolution_TypeDef resolution;
+    SHT21_Server_Request_TypeDef* submitted;
+    int wake;
+    int sleeping;
+    int stop;
+    pthread_t thread;
+
+    UInt32 requests;
+    UInt32 conversions;
+    UInt32 coalesced;
+} SHT21_Server_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SHT21_Error_TypeDef SHT21_Server_Start(SHT21_Server_TypeDef* server, SHT21_Bus_TypeDef* bus,
+                                       SHT21_Resolution_TypeDef resolution);
+void SHT21_Server_Stop(SHT21_Server_TypeDef* server);
+void SHT21_Server_Submit(SHT21_Server_TypeDef* server, SHT21_Server_Request_TypeDef* request,
+                         SHT21_Commands_TypeDef cmd);
+SHT21_Error_TypeDef SHT21_Server_Wait(SHT21_Server_Request_TypeDef* request);
+SHT21_Error_TypeDef SHT21_Server_Read(SHT21_Server_TypeDef* server, SHT21_Commands_TypeDef cmd, float* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_SERVER__H
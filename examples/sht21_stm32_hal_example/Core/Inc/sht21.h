@@ -2,11 +2,10 @@
 #define __SHT21_H
 
 #include "sht21_core.h"
+#include "sht21_cache.h"
 #include "i2c.h"
 
 #define SHT21_READ_TIMEOUT 1000
-#define SHT21_SELFTEST_TEMP_THRESHOLD 0.3f
-#define SHT21_SELFTEST_HUM_THRESHOLD 0.5f
 
 // Note: Change this to your HAL I2C handler you are going to be using!
 #define SHT21_I2C_HANDLE &hi2c1
@@ -15,9 +14,29 @@ extern HAL_StatusTypeDef sht21_last_error;
 
 float SHT21_get_humidity(void);
 float SHT21_get_temp(void);
+float SHT21_read_humidity(UInt32 max_age);
+float SHT21_read_temp(UInt32 max_age);
+const SHT21_Cache_TypeDef* SHT21_get_cache(void);
 SHT21_User_Reg_TypeDef SHT21_get_user_reg(void);
+SHT21_User_Reg_TypeDef SHT21_refresh_user_reg(void);
 HAL_StatusTypeDef SHT21_update_user_reg(SHT21_User_Reg_TypeDef new_reg);
+HAL_StatusTypeDef SHT21_update_user_reg_fields(UInt8 mask, UInt8 value);
+HAL_StatusTypeDef SHT21_set_resolution(SHT21_Resolution_TypeDef res);
 HAL_StatusTypeDef SHT21_reset(void);
+SHT21_Error_TypeDef SHT21_poll_ready(void);
+SHT21_Error_TypeDef SHT21_wait_ready(void);
 SHT21_Error_TypeDef SHT21_selftest(void);
+void SHT21_selftest_start(UInt32 deadline);
+SHT21_Error_TypeDef SHT21_selftest_step(UInt32* wait);
+void SHT21_selftest_abort(void);
+void SHT21_set_read_mode(SHT21_Commands_TypeDef cmd, SHT21_Read_Mode_TypeDef mode);
+SHT21_Error_TypeDef SHT21_start_measurement(SHT21_Commands_TypeDef cmd);
+SHT21_Error_TypeDef SHT21_poll_measurement(float* value);
+SHT21_Sample_TypeDef SHT21_measure_both(void);
+UInt8 SHT21_get_conversion_time(SHT21_Commands_TypeDef cmd);
+#ifdef SHT21_STATS
+void SHT21_get_stats(SHT21_Stats_Snapshot_TypeDef* snapshot);
+void SHT21_reset_stats(void);
+#endif
 
 #endif // SHT21
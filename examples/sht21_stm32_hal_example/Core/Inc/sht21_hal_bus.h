@@ -0,0 +1,51 @@
+/********************************************************************************************
+ *  Filename: sht21_hal_bus.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Bus policy of Sht21<Bus, Res> on a STM32 HAL I2C handle, for C++ projects
+ *
+ *      Sht21<Sht21_Hal_Bus, SHT21_RES_RH12_T14> sensor(Sht21_Hal_Bus(&hi2c1));
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_HAL_BUS__H
+#define __SHT21_HAL_BUS__H
+
+#include "sht21_template.h"
+#include "i2c.h"
+
+class Sht21_Hal_Bus
+{
+public:
+  explicit Sht21_Hal_Bus(I2C_HandleTypeDef* hi2c, UInt32 timeout = SHT21_MEASURE_TIMEOUT) : hi2c(hi2c), timeout(timeout) {}
+
+  SHT21_Error_TypeDef write(UInt8 address, UInt8* buf, UInt8 len)
+  {
+    return to_error(HAL_I2C_Master_Transmit(hi2c, (UInt16)(address << 1U), buf, len, timeout));
+  }
+
+  SHT21_Error_TypeDef read(UInt8 address, UInt8* buf, UInt8 len)
+  {
+    return to_error(HAL_I2C_Master_Receive(hi2c, (UInt16)((address << 1U) | 1U), buf, len, timeout));
+  }
+
+  UInt32 get_tick() { return HAL_GetTick(); }
+  void delay(UInt32 ms) { HAL_Delay(ms); }
+
+private:
+  I2C_HandleTypeDef* hi2c;
+  UInt32 timeout;
+
+  // A NACK shows up as HAL_ERROR with the acknowledge failure bit set
+  SHT21_Error_TypeDef to_error(HAL_StatusTypeDef status)
+  {
+    if (status == HAL_OK)
+      return SHT21_OK;
+    if (status != HAL_TIMEOUT && (HAL_I2C_GetError(hi2c) & HAL_I2C_ERROR_AF))
+      return SHT21_ACK_ERROR;
+    return SHT21_TIME_OUT_ERROR;
+  }
+};
+
+#endif // __SHT21_HAL_BUS__H
@@ -0,0 +1,37 @@
+#ifndef __SHT21_IT_H
+#define __SHT21_IT_H
+
+#include "sht21.h"
+#include "sht21_ring.h"
+
+// Define to move the command and frame with DMA instead of an interrupt per byte
+// #define SHT21_IT_USE_DMA
+
+// Define if the application has its own HAL_I2C_xxxCallback functions, and call
+// SHT21_it_tx_cplt, SHT21_it_rx_cplt and SHT21_it_error from them
+// #define SHT21_IT_NO_HAL_CALLBACKS
+
+/********************************************************************************************
+ *  State of the interrupt driven measurement
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_IT_IDLE               = (0x00U),
+    SHT21_IT_SEND_CMD           = (0x01U),  // Command transmit running
+    SHT21_IT_CONVERTING         = (0x02U),  // No hold master, waiting for the conversion
+    SHT21_IT_RECEIVE            = (0x03U)   // Frame receive running
+} SHT21_It_State_TypeDef;
+
+extern volatile SHT21_It_State_TypeDef sht21_it_state;
+
+void SHT21_it_init(SHT21_Ring_TypeDef* ring);
+SHT21_Error_TypeDef SHT21_it_start(SHT21_Commands_TypeDef cmd);
+SHT21_Error_TypeDef SHT21_it_start_both(void);
+UInt8 SHT21_it_busy(void);
+void SHT21_it_tick(void);
+void SHT21_it_tx_cplt(I2C_HandleTypeDef* hi2c);
+void SHT21_it_rx_cplt(I2C_HandleTypeDef* hi2c);
+void SHT21_it_error(I2C_HandleTypeDef* hi2c);
+void SHT21_it_measurement_cplt_callback(SHT21_Error_TypeDef status, SHT21_Commands_TypeDef cmd, UInt8* frame);
+
+#endif // __SHT21_IT_H
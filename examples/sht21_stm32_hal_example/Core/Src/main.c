@@ -102,20 +102,25 @@ int main(void)
   MX_USART2_UART_Init();
   /* USER CODE BEGIN 2 */
 
-  HAL_Delay(1000);
+  // Wait until the SHT21 answers after power up, within 15 ms of boot
+  if (SHT21_wait_ready() != SHT21_OK)
+    printf("SHT21 not found\n\r");
 
   // Example for resetting the SHT21
   SHT21_reset();
 
-  HAL_Delay(1000);
-
   // Check if there was errors during transmissions
   if (sht21_last_error != HAL_OK)
     printf("Error during SHT21 transmit: %d\n\r", sht21_last_error);
 
+  // The SHT21 answers again within 15 ms of the reset
+  SHT21_wait_ready();
+
   /* Run a selftest
    * Turns on the heater element and verifies that the temperature rises and the
-   * humidity decreases to verify SHT21 operations.
+   * humidity decreases to verify SHT21 operations. Returns as soon as they have, at
+   * most after SHT21_SELFTEST_DEADLINE ms. SHT21_selftest_start and
+   * SHT21_selftest_step run it from the main loop instead.
    */
   if (SHT21_selftest() == SHT21_OK)
     printf("Selftest Successful!\n\r");
@@ -130,13 +135,11 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-    // Get the Humidity value
-    float hum = SHT21_get_humidity();
-    // Get the temperature value
-    float temp = SHT21_get_temp();
+    // Get the temperature and humidity values in one call
+    SHT21_Sample_TypeDef sample = SHT21_measure_both();
 
     // Print the values
-    printf("Humidity: %.2f, Temp: %.02f\n\r", hum, temp);
+    printf("Humidity: %.2f, Temp: %.02f\n\r", sample.humidity, sample.temp);
 
     // Get the SHT21 User Register
     SHT21_User_Reg_TypeDef sht21 = SHT21_get_user_reg();
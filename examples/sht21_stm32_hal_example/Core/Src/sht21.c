@@ -2,6 +2,119 @@
 
 HAL_StatusTypeDef sht21_last_error = HAL_OK;
 
+/********************************************************************************************
+ *  Converts the HAL status of the last transfer to the core error type. A NACK shows
+ *  up as HAL_ERROR with the acknowledge failure bit set.
+ *******************************************************************************************/
+static SHT21_Error_TypeDef SHT21_hal_to_error(I2C_HandleTypeDef* hi2c, HAL_StatusTypeDef status)
+{
+    switch (status)
+    {
+        case HAL_OK:
+        return SHT21_OK;
+        case HAL_TIMEOUT:
+        return SHT21_TIME_OUT_ERROR;
+        default:
+        break;
+    }
+
+    if (HAL_I2C_GetError(hi2c) & HAL_I2C_ERROR_AF)
+        return SHT21_ACK_ERROR;
+
+    return SHT21_TIME_OUT_ERROR;
+}
+
+/********************************************************************************************
+ *  Writes len bytes to the device, used as the core bus write function
+ *******************************************************************************************/
+static SHT21_Error_TypeDef SHT21_bus_write(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+    I2C_HandleTypeDef* hi2c = (I2C_HandleTypeDef*)handle;
+
+    sht21_last_error = HAL_I2C_Master_Transmit(hi2c, (address << 1U), buf, len, SHT21_READ_TIMEOUT);
+    return SHT21_hal_to_error(hi2c, sht21_last_error);
+}
+
+/********************************************************************************************
+ *  Reads len bytes from the device, used as the core bus read function
+ *******************************************************************************************/
+static SHT21_Error_TypeDef SHT21_bus_read(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+    I2C_HandleTypeDef* hi2c = (I2C_HandleTypeDef*)handle;
+
+    sht21_last_error = HAL_I2C_Master_Receive(hi2c, (address << 1U) | 1U, buf, len, SHT21_READ_TIMEOUT);
+    return SHT21_hal_to_error(hi2c, sht21_last_error);
+}
+
+/********************************************************************************************
+ *  Returns the millisecond tick, used as the core bus tick function
+ *******************************************************************************************/
+static UInt32 SHT21_bus_get_tick(void* handle)
+{
+    (void)handle;
+    return HAL_GetTick();
+}
+
+/********************************************************************************************
+ *  Waits the given number of ms, used as the core bus delay function
+ *******************************************************************************************/
+static void SHT21_bus_delay(void* handle, UInt32 ms)
+{
+    (void)handle;
+    HAL_Delay(ms);
+}
+
+#ifdef SHT21_STATS
+/********************************************************************************************
+ *  Microsecond counter for the latency histograms. Has the resolution of HAL_GetTick,
+ *  override it with a timer or the DWT cycle counter for finer buckets.
+ *******************************************************************************************/
+__weak UInt32 SHT21_get_us(void)
+{
+    return HAL_GetTick() * 1000U;
+}
+
+static UInt32 SHT21_stats_get_us(void* handle)
+{
+    (void)handle;
+    return SHT21_get_us();
+}
+
+static SHT21_Stats_TypeDef sht21_stats = { .get_us = SHT21_stats_get_us };
+#endif
+
+static SHT21_Bus_TypeDef sht21_bus =
+{
+    .write = SHT21_bus_write,
+    .read = SHT21_bus_read,
+    .get_tick = SHT21_bus_get_tick,
+    .delay = SHT21_bus_delay,
+    .handle = SHT21_I2C_HANDLE,
+#ifdef SHT21_STATS
+    .stats = &sht21_stats
+#endif
+};
+
+static SHT21_Measurement_TypeDef sht21_measurement = {0};
+static SHT21_Selftest_TypeDef sht21_selftest_state = {0};
+
+// Power up is counted from tick 0, the boot of the MCU
+static SHT21_Ready_TypeDef sht21_ready = { .bus = &sht21_bus, .window = SHT21_POWER_UP_TIME };
+
+// Last readings, for SHT21_read_temp and SHT21_read_humidity
+static SHT21_Cache_TypeDef sht21_cache = { .bus = &sht21_bus };
+
+// Active measurement resolution, used for the conversion wait times
+static SHT21_Resolution_TypeDef sht21_resolution = SHT21_RES_RH12_T14;
+
+// How much of the temperature and humidity results is read, see SHT21_set_read_mode
+static SHT21_Read_Mode_TypeDef sht21_temp_read_mode = SHT21_READ_FULL;
+static SHT21_Read_Mode_TypeDef sht21_rh_read_mode = SHT21_READ_FULL;
+
+// Shadow copy of the user register, read from the SHT21 on first use and after reset
+static SHT21_User_Reg_TypeDef sht21_user_reg = {0};
+static UInt8 sht21_user_reg_valid = 0U;
+
 /********************************************************************************************
  *  Transmit the passed command to the SHT21 and reads the response. Response data is
  *  parsed in the get functions.
@@ -20,20 +133,15 @@ static HAL_StatusTypeDef SHT21_transmit_receive(UInt8* rx_buf, UInt8 len, SHT21_
 
     UInt8 tx_buf = sht21_request.data.command;
     // Transmit the command
+    UInt32 write_start = SHT21_STATS_NOW(&sht21_bus);
     HAL_StatusTypeDef status = HAL_I2C_Master_Transmit(SHT21_I2C_HANDLE, address, &tx_buf, 1, SHT21_READ_TIMEOUT);
+    SHT21_STATS_TRANSFER(&sht21_bus, SHT21_STATS_COMMAND_WRITE, SHT21_hal_to_error(SHT21_I2C_HANDLE, status), write_start);
 
-    // Wait for given time if performing temp or humidity readings
-    switch (cmd)
-    {
-        case SHT21_TEMP_MEASURE_HOLD:
-        HAL_Delay(90);
-        break;
-        case SHT21_RH_MEASURE_HOLD:
-        HAL_Delay(40);
-        break;
-        default:
-        break;
-    }
+    // Wait for the conversion time of the active resolution if performing temp or humidity readings
+    UInt32 conversion_start = SHT21_STATS_NOW(&sht21_bus);
+    UInt8 conversion_time = SHT21_Conversion_Time(sht21_resolution, cmd);
+    if (conversion_time != 0)
+        HAL_Delay(conversion_time);
 
     // Check if transmit was successful
     if (status != HAL_OK)
@@ -42,23 +150,53 @@ static HAL_StatusTypeDef SHT21_transmit_receive(UInt8* rx_buf, UInt8 len, SHT21_
     // Setting the read bit, Address will be 0b10000001 after.
     address |= (1U << 0U);
 
+    UInt32 read_start = SHT21_STATS_NOW(&sht21_bus);
+    if (conversion_time != 0)
+        SHT21_STATS_LATENCY(&sht21_bus, SHT21_STATS_CONVERSION, read_start - conversion_start);
     status =  HAL_I2C_Master_Receive(SHT21_I2C_HANDLE, address, rx_buf, len, SHT21_READ_TIMEOUT);
+    SHT21_STATS_TRANSFER(&sht21_bus, SHT21_STATS_READBACK, SHT21_hal_to_error(SHT21_I2C_HANDLE, status), read_start);
 
     return status;
 }
 
+static SHT21_Read_Mode_TypeDef SHT21_read_mode(SHT21_Commands_TypeDef cmd)
+{
+    return (cmd == SHT21_TEMP_MEASURE || cmd == SHT21_TEMP_MEASURE_HOLD) ? sht21_temp_read_mode : sht21_rh_read_mode;
+}
+
 /********************************************************************************************
- *  Returns the humidity reading of the SHT21
+ *  Hold master measurement that also fills the cache. Only readings that parse are
+ *  cached, a full frame with a bad checksum still returns the SHT21_Parse_Temp/
+ *  SHT21_Parse_RH value. A short frame of the wrong kind sets HAL_ERROR.
  *******************************************************************************************/
-float SHT21_get_humidity(void)
+static float SHT21_measure_cached(SHT21_Commands_TypeDef cmd)
 {
-    UInt8 rx_buf[3] = {0};
+    UInt8 rx_buf[SHT21_FRAME_LENGTH] = {0};
+    float value = 0.0f;
+    UInt8 len = SHT21_Read_Length(SHT21_read_mode(cmd), sht21_resolution, cmd);
 
-    sht21_last_error = SHT21_transmit_receive(rx_buf, 3, SHT21_RH_MEASURE_HOLD);
-    if (sht21_last_error == HAL_OK)
-        return SHT21_Parse_RH(rx_buf);
-    else
+    sht21_last_error = SHT21_transmit_receive(rx_buf, len, cmd);
+    if (sht21_last_error != HAL_OK)
         return 0.0f;
+
+    if (SHT21_Parse_Frame(rx_buf, len, cmd, &value) == SHT21_OK)
+        SHT21_Cache_Put(&sht21_cache, cmd, HAL_GetTick(), value);
+    else if (len == SHT21_FRAME_LENGTH)
+        value = (cmd == SHT21_TEMP_MEASURE_HOLD) ? SHT21_Parse_Temp(rx_buf) : SHT21_Parse_RH(rx_buf);
+    else
+    {
+        sht21_last_error = HAL_ERROR;
+        value = 0.0f;
+    }
+    return value;
+}
+
+/********************************************************************************************
+ *  Returns the humidity reading of the SHT21
+ *******************************************************************************************/
+float SHT21_get_humidity(void)
+{
+    return SHT21_measure_cached(SHT21_RH_MEASURE_HOLD);
 }
 
 /********************************************************************************************
@@ -66,30 +204,83 @@ float SHT21_get_humidity(void)
  *******************************************************************************************/
 float SHT21_get_temp(void)
 {
-    UInt8 rx_buf[3] = {0};
+    return SHT21_measure_cached(SHT21_TEMP_MEASURE_HOLD);
+}
 
-    sht21_last_error = SHT21_transmit_receive(rx_buf, 3, SHT21_TEMP_MEASURE_HOLD);
-    if (sht21_last_error == HAL_OK)
-        return SHT21_Parse_Temp(rx_buf);
-    else
-        return 0.0f;
+/********************************************************************************************
+ *  Returns the last humidity reading if it is younger than max_age ms, without touching
+ *  the bus, and measures otherwise
+ *******************************************************************************************/
+float SHT21_read_humidity(UInt32 max_age)
+{
+    float humidity;
+    if (SHT21_Cache_Get(&sht21_cache, SHT21_RH_MEASURE, HAL_GetTick(), max_age, &humidity))
+    {
+        sht21_last_error = HAL_OK;
+        return humidity;
+    }
+    return SHT21_get_humidity();
 }
 
 /********************************************************************************************
- *  Returns the user register of the SHT21
+ *  Returns the last temperature reading if it is younger than max_age ms, without
+ *  touching the bus, and measures otherwise
  *******************************************************************************************/
-SHT21_User_Reg_TypeDef SHT21_get_user_reg(void)
+float SHT21_read_temp(UInt32 max_age)
+{
+    float temp;
+    if (SHT21_Cache_Get(&sht21_cache, SHT21_TEMP_MEASURE, HAL_GetTick(), max_age, &temp))
+    {
+        sht21_last_error = HAL_OK;
+        return temp;
+    }
+    return SHT21_get_temp();
+}
+
+/********************************************************************************************
+ *  Returns the cache of the last readings with its hit and miss counts, for tuning the
+ *  max_age of SHT21_read_temp and SHT21_read_humidity
+ *******************************************************************************************/
+const SHT21_Cache_TypeDef* SHT21_get_cache(void)
+{
+    return &sht21_cache;
+}
+
+/********************************************************************************************
+ *  Reads the user register from the SHT21 and updates the shadow copy
+ *******************************************************************************************/
+SHT21_User_Reg_TypeDef SHT21_refresh_user_reg(void)
 {
     UInt8 rx_buf[1] = {0};
     SHT21_User_Reg_TypeDef reg = {0};
 
     sht21_last_error = SHT21_transmit_receive(rx_buf, 1, SHT21_READ_USER_REG);
     if (sht21_last_error == HAL_OK)
+    {
         reg = SHT21_Parse_User_Reg(rx_buf);
+        sht21_user_reg = reg;
+        sht21_user_reg_valid = 1U;
+        sht21_resolution = SHT21_Get_Resolution(reg); // Keep track of the active resolution
+    }
 
     return reg;
 }
 
+/********************************************************************************************
+ *  Returns the user register of the SHT21. The register is kept in a shadow copy, so it
+ *  is only read from the SHT21 the first time and after a reset. Use
+ *  SHT21_refresh_user_reg to get the current end of battery status.
+ *******************************************************************************************/
+SHT21_User_Reg_TypeDef SHT21_get_user_reg(void)
+{
+    if (sht21_user_reg_valid)
+    {
+        sht21_last_error = HAL_OK;
+        return sht21_user_reg;
+    }
+    return SHT21_refresh_user_reg();
+}
+
 /********************************************************************************************
  *  Updates the user register on the SHT21
  *******************************************************************************************/
@@ -108,12 +299,50 @@ HAL_StatusTypeDef SHT21_update_user_reg(SHT21_User_Reg_TypeDef new_reg)
     tx_buf[0] = sht21_request.data.command;
     tx_buf[1] = new_reg.reg;
     sht21_last_error = HAL_I2C_Master_Transmit(SHT21_I2C_HANDLE, address, tx_buf, 2, SHT21_READ_TIMEOUT);
+    if (sht21_last_error != HAL_OK)
+    {
+        sht21_user_reg_valid = 0U; // Unknown what the SHT21 has now
+        return sht21_last_error;
+    }
+
+    // Cached readings are not what the sensor reads after the heater is switched
+    if ((sht21_user_reg.reg ^ new_reg.reg) & SHT21_ENABLE_CHIP_HEATER)
+        SHT21_Cache_Invalidate(&sht21_cache);
+
+    // The end of battery bit is read only, keep the last value read
+    sht21_user_reg = SHT21_Update_User_Reg_Fields(sht21_user_reg, SHT21_USER_REG_WRITABLE, new_reg.reg);
+    sht21_resolution = SHT21_Get_Resolution(sht21_user_reg);
+
     return sht21_last_error;
 }
 
+/********************************************************************************************
+ *  Updates the bits in mask to the bits of value with a single write, using the shadow
+ *  copy of the user register instead of reading it back first.
+ *  Example: SHT21_update_user_reg_fields(SHT21_ENABLE_CHIP_HEATER, SHT21_ENABLE_CHIP_HEATER)
+ *******************************************************************************************/
+HAL_StatusTypeDef SHT21_update_user_reg_fields(UInt8 mask, UInt8 value)
+{
+    SHT21_User_Reg_TypeDef reg = SHT21_get_user_reg();
+    if (sht21_last_error != HAL_OK)
+        return sht21_last_error;
+
+    return SHT21_update_user_reg(SHT21_Update_User_Reg_Fields(reg, mask, value));
+}
+
+/********************************************************************************************
+ *  Sets the measurement resolution
+ *******************************************************************************************/
+HAL_StatusTypeDef SHT21_set_resolution(SHT21_Resolution_TypeDef res)
+{
+    SHT21_User_Reg_TypeDef reg = SHT21_Set_Resolution((SHT21_User_Reg_TypeDef){0}, res);
+    return SHT21_update_user_reg_fields(SHT21_MEAS_RESOLUTION_BIT1 | SHT21_MEAS_RESOLUTION_BIT2, reg.reg);
+}
+
 /********************************************************************************************
  *  Send a reset command to the SHT21 for a soft reset. This will reset the SHT21 to
- *  default settings, except the heat enabled bit.
+ *  default settings, except the heat enabled bit. Use SHT21_wait_ready or
+ *  SHT21_poll_ready before the next command.
  *******************************************************************************************/
 HAL_StatusTypeDef SHT21_reset(void)
 {
@@ -129,70 +358,176 @@ HAL_StatusTypeDef SHT21_reset(void)
     address &= ~(0x2U);
 
     sht21_last_error = HAL_I2C_Master_Transmit(SHT21_I2C_HANDLE, address, &tx_buf, 1, SHT21_READ_TIMEOUT);
+    if (sht21_last_error == HAL_OK)
+    {
+        sht21_resolution = SHT21_RES_RH12_T14; // Reset restores the default resolution
+        sht21_user_reg_valid = 0U;             // Validate the shadow copy on next access
+        SHT21_Ready_Start(&sht21_ready, &sht21_bus, SHT21_SOFT_RESET_TIME);
+    }
+
     return sht21_last_error;
 }
 
 /********************************************************************************************
- *  Runs a function test on the SHT21. Before starting it will store the current temperature
- *  and humidity values. It then turns on the heating element. Wait some time and then check
- *  if the temperature has risen and humidity has decreased to certain threshold.
+ *  Checks if the SHT21 answers after power up or SHT21_reset, by reading the user
+ *  register. Returns SHT21_BUSY while it is still starting, SHT21_OK once it answered
+ *  and SHT21_TIME_OUT_ERROR if it did not answer in twice the datasheet time. Only
+ *  touches the bus until it answered, the register read fills the shadow copy.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_poll_ready(void)
+{
+    if (sht21_ready.ready)
+        return SHT21_OK;
+
+    SHT21_Error_TypeDef status = SHT21_Ready_Poll(&sht21_ready);
+    if (status == SHT21_OK)
+    {
+        sht21_user_reg = sht21_ready.user_reg;
+        sht21_user_reg_valid = 1U;
+        sht21_resolution = SHT21_Get_Resolution(sht21_user_reg);
+    }
+    return status;
+}
+
+/********************************************************************************************
+ *  Waits until the SHT21 answers after power up or SHT21_reset, usually a few ms
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_wait_ready(void)
+{
+    SHT21_Error_TypeDef status = SHT21_poll_ready();
+    while (status == SHT21_BUSY)
+    {
+        HAL_Delay(1);
+        status = SHT21_poll_ready();
+    }
+    return status;
+}
+
+/********************************************************************************************
+ *  Runs a function test on the SHT21. It stores the current temperature and humidity,
+ *  turns on the heater and keeps reading until the temperature has risen and the
+ *  humidity has fallen by the thresholds. Passes as soon as they have, and fails if
+ *  they have not after SHT21_SELFTEST_DEADLINE ms. The heater is turned off again in
+ *  any case.
  *
- *  If any problems on the communication if SHT21 it will also return error. 
+ *  If any problems on the communication if SHT21 it will also return error.
  *
  *  It is important the chip is at a stable temperature before starting this test.
+ *  Blocks until done, use SHT21_selftest_start and SHT21_selftest_step to run it from
+ *  the main loop.
  *******************************************************************************************/
 SHT21_Error_TypeDef SHT21_selftest(void)
 {
-    // Store the current temp and hum values
-    float tempAtStart = SHT21_get_temp();
-    if (sht21_last_error != HAL_OK)
-        return sht21_last_error;
+    SHT21_Error_TypeDef status = SHT21_Selftest_Run(&sht21_selftest_state, &sht21_bus, SHT21_SELFTEST_DEADLINE);
+    sht21_user_reg_valid = 0U; // Validate the shadow copy on next access
+    return status;
+}
 
-    float humAtStart = SHT21_get_humidity();
-    if (sht21_last_error != HAL_OK)
-        return sht21_last_error;
+/********************************************************************************************
+ *  Starts the selftest without blocking, 0 as deadline uses SHT21_SELFTEST_DEADLINE.
+ *  No other measurements can be made until SHT21_selftest_step stops returning
+ *  SHT21_BUSY.
+ *******************************************************************************************/
+void SHT21_selftest_start(UInt32 deadline)
+{
+    SHT21_Selftest_Start(&sht21_selftest_state, &sht21_bus, deadline);
+}
 
-    // Enable the heater
-    SHT21_User_Reg_TypeDef sht21User = SHT21_get_user_reg(); // Read the current user register
-    if (sht21_last_error != HAL_OK)
-        return sht21_last_error;
+/********************************************************************************************
+ *  Runs the next part of the selftest, returns SHT21_BUSY while it runs and the result
+ *  of SHT21_selftest when done. wait, if not 0, is set to the ms until the next call
+ *  has work to do.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_selftest_step(UInt32* wait)
+{
+    SHT21_Error_TypeDef status = SHT21_Selftest_Step(&sht21_selftest_state);
+    if (wait != 0)
+        *wait = sht21_selftest_state.wait;
+    if (status != SHT21_BUSY)
+        sht21_user_reg_valid = 0U;
+    return status;
+}
 
-    sht21User.data.chip_heater = 1U;    // Set the chip heater enabled
-    SHT21_update_user_reg(sht21User);   // Update SHT21 with the modified register
-    if (sht21_last_error != HAL_OK)
-        return sht21_last_error;
+/********************************************************************************************
+ *  Stops the selftest, keep calling SHT21_selftest_step until it stops returning
+ *  SHT21_BUSY so the heater is turned off
+ *******************************************************************************************/
+void SHT21_selftest_abort(void)
+{
+    SHT21_Selftest_Abort(&sht21_selftest_state);
+}
 
-    // Wait for temp to rise and humidity to fall
-    HAL_Delay(10000);
+/********************************************************************************************
+ *  Reads only part of the temperature or humidity results to save bus time, see
+ *  SHT21_Read_Mode_TypeDef. SHT21_READ_NO_CRC and SHT21_READ_MSB give up the checksum.
+ *  cmd is any temperature or humidity command.
+ *******************************************************************************************/
+void SHT21_set_read_mode(SHT21_Commands_TypeDef cmd, SHT21_Read_Mode_TypeDef mode)
+{
+    if (cmd == SHT21_TEMP_MEASURE || cmd == SHT21_TEMP_MEASURE_HOLD)
+        sht21_temp_read_mode = mode;
+    else
+        sht21_rh_read_mode = mode;
+}
 
-    // Get the current readings
-    float tempAfterTest = SHT21_get_temp();
-    if (sht21_last_error != HAL_OK)
-        return sht21_last_error;
+/********************************************************************************************
+ *  Starts a no hold master measurement, SHT21_TEMP_MEASURE or SHT21_RH_MEASURE.
+ *  Returns without waiting for the conversion, use SHT21_poll_measurement to get the
+ *  result.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_start_measurement(SHT21_Commands_TypeDef cmd)
+{
+    return SHT21_Measure_Start_Mode(&sht21_measurement, &sht21_bus, cmd, sht21_resolution, SHT21_read_mode(cmd));
+}
 
-    float  humAfterTest = SHT21_get_humidity();
-    if (sht21_last_error != HAL_OK)
-        return sht21_last_error;
+/********************************************************************************************
+ *  Polls the measurement started with SHT21_start_measurement. Returns SHT21_BUSY while
+ *  the sensor is converting, and SHT21_OK with the result stored in value when done.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_poll_measurement(float* value)
+{
+    SHT21_Error_TypeDef status = SHT21_Measure_Poll(&sht21_measurement);
+    if (status != SHT21_OK)
+        return status;
 
-    // Check if the changes after heater has been on had its initial values
-    // change above thresholds
-    // Variable to store status
-    HAL_StatusTypeDef status = SHT21_OK;
-    if (tempAfterTest - tempAtStart > SHT21_SELFTEST_TEMP_THRESHOLD &&
-        humAtStart - humAfterTest > SHT21_SELFTEST_HUM_THRESHOLD)
-    {
-        status = SHT21_OK;
-    }
-    else 
-        status = SHT21_SELFTEST_FAILED;
+    status = SHT21_Measure_Complete(&sht21_measurement, value);
+    if (status == SHT21_OK)
+        SHT21_Cache_Put(&sht21_cache, sht21_measurement.cmd, HAL_GetTick(), *value);
+    return status;
+}
 
-    // Disable the heater
-    sht21User = SHT21_get_user_reg();
-    if (sht21_last_error != HAL_OK)
-        return sht21_last_error;
+/********************************************************************************************
+ *  Measures temperature and humidity in one call. The humidity conversion runs while
+ *  the temperature frame is checked and converted.
+ *******************************************************************************************/
+SHT21_Sample_TypeDef SHT21_measure_both(void)
+{
+    return SHT21_Cache_Measure_Both(&sht21_cache, sht21_resolution, sht21_temp_read_mode, sht21_rh_read_mode);
+}
 
-    sht21User.data.chip_heater = 0U;
-    SHT21_update_user_reg(sht21User);
+/********************************************************************************************
+ *  Returns the maximum conversion time in ms of the measurement command at the active
+ *  resolution. Can be used to schedule polls of SHT21_start_measurement.
+ *******************************************************************************************/
+UInt8 SHT21_get_conversion_time(SHT21_Commands_TypeDef cmd)
+{
+    return SHT21_Conversion_Time(sht21_resolution, cmd);
+}
 
-    return status;
+#ifdef SHT21_STATS
+/********************************************************************************************
+ *  Copies the transaction counters and latency histograms, see sht21_stats.h
+ *******************************************************************************************/
+void SHT21_get_stats(SHT21_Stats_Snapshot_TypeDef* snapshot)
+{
+    SHT21_Stats_Snapshot(&sht21_stats, snapshot);
+}
+
+/********************************************************************************************
+ *  Clears the transaction counters and latency histograms
+ *******************************************************************************************/
+void SHT21_reset_stats(void)
+{
+    SHT21_Stats_Reset(&sht21_stats);
 }
+#endif
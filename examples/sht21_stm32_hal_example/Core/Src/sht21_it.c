@@ -0,0 +1,244 @@
+#include "sht21_it.h"
+
+/*
+ *  Interrupt driven measurements. The CPU only starts the transfers, everything else
+ *  runs from the HAL I2C completion callbacks and a 1 ms tick:
+ *
+ *  Hold master     : Command transmit, frame receive started from TxCplt. The SHT21
+ *                    stretches the clock until the conversion is done, RxCplt ends it.
+ *  No hold master  : Command transmit, then SHT21_it_tick starts the receive when the
+ *                    conversion time has passed. A NACK in the error callback means it
+ *                    is still converting, the receive is tried again on the next tick.
+ *
+ *  Call SHT21_it_tick every ms, for example from HAL_SYSTICK_Callback or a timer. The
+ *  result is pushed into the ring given to SHT21_it_init and passed to
+ *  SHT21_it_measurement_cplt_callback, both from interrupt context.
+ */
+
+#ifdef SHT21_IT_USE_DMA
+#define SHT21_IT_HAL_TRANSMIT   HAL_I2C_Master_Transmit_DMA
+#define SHT21_IT_HAL_RECEIVE    HAL_I2C_Master_Receive_DMA
+#else
+#define SHT21_IT_HAL_TRANSMIT   HAL_I2C_Master_Transmit_IT
+#define SHT21_IT_HAL_RECEIVE    HAL_I2C_Master_Receive_IT
+#endif
+
+#define SHT21_IT_ADDRESS    (SHT21_I2C_ADDRESS << 1U)
+
+volatile SHT21_It_State_TypeDef sht21_it_state = SHT21_IT_IDLE;
+
+static SHT21_Ring_TypeDef* sht21_it_ring = 0;
+static SHT21_Commands_TypeDef sht21_it_cmd;
+static SHT21_Commands_TypeDef sht21_it_next_cmd = (SHT21_Commands_TypeDef)0;
+static UInt8 sht21_it_tx_buf;
+static UInt8 sht21_it_frame[3];
+static UInt32 sht21_it_start_tick;
+static UInt32 sht21_it_conversion_time;
+
+/********************************************************************************************
+ *  Sets up the interrupt driven measurements. Finished frames are pushed into ring, it
+ *  can be 0 if only the callback is used.
+ *******************************************************************************************/
+void SHT21_it_init(SHT21_Ring_TypeDef* ring)
+{
+    sht21_it_ring = ring;
+    sht21_it_state = SHT21_IT_IDLE;
+    sht21_it_next_cmd = (SHT21_Commands_TypeDef)0;
+}
+
+/********************************************************************************************
+ *  Called with every finished measurement from interrupt context. frame holds the 3
+ *  bytes read, status is SHT21_OK, SHT21_CHECKSUM_ERROR or the transfer error. If the
+ *  temperature of SHT21_it_start_both fails, or the humidity command can not be sent,
+ *  it is called once more with that error, cmd SHT21_RH_MEASURE and a zeroed frame.
+ *  Override it in the application.
+ *******************************************************************************************/
+__weak void SHT21_it_measurement_cplt_callback(SHT21_Error_TypeDef status, SHT21_Commands_TypeDef cmd, UInt8* frame)
+{
+    (void)status;
+    (void)cmd;
+    (void)frame;
+}
+
+static SHT21_Error_TypeDef SHT21_it_send(SHT21_Commands_TypeDef cmd)
+{
+    sht21_it_cmd = cmd;
+    sht21_it_tx_buf = SHT21_Request_Buf(cmd).data.command;
+    sht21_it_conversion_time = SHT21_get_conversion_time(cmd);
+    sht21_it_start_tick = HAL_GetTick();
+    sht21_it_state = SHT21_IT_SEND_CMD;
+
+    sht21_last_error = SHT21_IT_HAL_TRANSMIT(SHT21_I2C_HANDLE, SHT21_IT_ADDRESS, &sht21_it_tx_buf, 1);
+    if (sht21_last_error != HAL_OK)
+    {
+        sht21_it_state = SHT21_IT_IDLE;
+        return (sht21_last_error == HAL_BUSY) ? SHT21_BUSY : SHT21_ACK_ERROR;
+    }
+    return SHT21_OK;
+}
+
+static void SHT21_it_receive(void)
+{
+    sht21_it_state = SHT21_IT_RECEIVE;
+    sht21_last_error = SHT21_IT_HAL_RECEIVE(SHT21_I2C_HANDLE, SHT21_IT_ADDRESS | 1U, sht21_it_frame, 3);
+    if (sht21_last_error != HAL_OK)
+        sht21_it_state = SHT21_IT_CONVERTING; // Try again on the next tick
+}
+
+// Ends the measurement, starts the humidity of a pair and reports the result
+static void SHT21_it_finish(SHT21_Error_TypeDef status)
+{
+    SHT21_Commands_TypeDef cmd = sht21_it_cmd;
+    UInt8 frame[3] = { sht21_it_frame[0], sht21_it_frame[1], sht21_it_frame[2] };
+    SHT21_Commands_TypeDef next = sht21_it_next_cmd;
+    SHT21_Error_TypeDef next_status = SHT21_OK;
+
+    sht21_it_state = SHT21_IT_IDLE;
+    sht21_it_next_cmd = (SHT21_Commands_TypeDef)0;
+    if (next != 0)
+        next_status = (status == SHT21_OK) ? SHT21_it_send(next) : status;
+
+    if (status == SHT21_OK && sht21_it_ring != 0)
+        SHT21_Ring_Push_Frame(sht21_it_ring, HAL_GetTick(), cmd, frame);
+    SHT21_it_measurement_cplt_callback(status, cmd, frame);
+
+    // The second half of a pair that was aborted or could not be started ends here too
+    if (next_status != SHT21_OK)
+    {
+        UInt8 empty[3] = { 0, 0, 0 };
+        SHT21_it_measurement_cplt_callback(next_status, next, empty);
+    }
+}
+
+/********************************************************************************************
+ *  Starts an interrupt driven measurement, hold or no hold master. Returns SHT21_BUSY
+ *  if a measurement is already running.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_it_start(SHT21_Commands_TypeDef cmd)
+{
+    if (sht21_it_state != SHT21_IT_IDLE)
+        return SHT21_BUSY;
+    return SHT21_it_send(cmd);
+}
+
+/********************************************************************************************
+ *  Starts a no hold temperature measurement followed by humidity, the humidity command
+ *  is sent from the interrupt as soon as the temperature is read.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_it_start_both(void)
+{
+    if (sht21_it_state != SHT21_IT_IDLE)
+        return SHT21_BUSY;
+
+    sht21_it_next_cmd = SHT21_RH_MEASURE;
+    SHT21_Error_TypeDef status = SHT21_it_send(SHT21_TEMP_MEASURE);
+    if (status != SHT21_OK)
+        sht21_it_next_cmd = (SHT21_Commands_TypeDef)0;
+    return status;
+}
+
+/********************************************************************************************
+ *  Returns 1 while a measurement or pair is running
+ *******************************************************************************************/
+UInt8 SHT21_it_busy(void)
+{
+    return sht21_it_state != SHT21_IT_IDLE;
+}
+
+/********************************************************************************************
+ *  Starts the receive of a no hold measurement once the conversion time has passed, and
+ *  retries a receive the HAL refused to start. Ends it with SHT21_TIME_OUT_ERROR after
+ *  SHT21_MEASURE_TIMEOUT. Call every ms.
+ *******************************************************************************************/
+void SHT21_it_tick(void)
+{
+    if (sht21_it_state != SHT21_IT_CONVERTING)
+        return;
+
+    UInt32 elapsed = HAL_GetTick() - sht21_it_start_tick;
+    if (elapsed > SHT21_MEASURE_TIMEOUT)
+        SHT21_it_finish(SHT21_TIME_OUT_ERROR);
+    else if (elapsed >= sht21_it_conversion_time)
+        SHT21_it_receive();
+}
+
+/********************************************************************************************
+ *  Command transmitted. Hold master reads right away, no hold waits for the tick.
+ *******************************************************************************************/
+void SHT21_it_tx_cplt(I2C_HandleTypeDef* hi2c)
+{
+    if (hi2c != SHT21_I2C_HANDLE || sht21_it_state != SHT21_IT_SEND_CMD)
+        return;
+
+    switch (sht21_it_cmd)
+    {
+        case SHT21_TEMP_MEASURE_HOLD:
+        case SHT21_RH_MEASURE_HOLD:
+        SHT21_it_receive();
+        break;
+        case SHT21_TEMP_MEASURE:
+        case SHT21_RH_MEASURE:
+        sht21_it_state = SHT21_IT_CONVERTING;
+        break;
+        default:
+        SHT21_it_finish(SHT21_OK);
+        break;
+    }
+}
+
+/********************************************************************************************
+ *  Frame received, checks the CRC and reports it
+ *******************************************************************************************/
+void SHT21_it_rx_cplt(I2C_HandleTypeDef* hi2c)
+{
+    if (hi2c != SHT21_I2C_HANDLE || sht21_it_state != SHT21_IT_RECEIVE)
+        return;
+
+    if (SHT21_Check_Crc(sht21_it_frame, 2, sht21_it_frame[2]) != 0)
+        SHT21_it_finish(SHT21_CHECKSUM_ERROR);
+    else
+        SHT21_it_finish(SHT21_OK);
+}
+
+/********************************************************************************************
+ *  Transfer failed. A NACKed no hold receive within the time out is the sensor still
+ *  converting, anything else ends the measurement.
+ *******************************************************************************************/
+void SHT21_it_error(I2C_HandleTypeDef* hi2c)
+{
+    if (hi2c != SHT21_I2C_HANDLE || sht21_it_state == SHT21_IT_IDLE)
+        return;
+
+    UInt8 nack = (HAL_I2C_GetError(hi2c) & HAL_I2C_ERROR_AF) != 0;
+    UInt8 no_hold = (sht21_it_cmd == SHT21_TEMP_MEASURE || sht21_it_cmd == SHT21_RH_MEASURE);
+
+    if (nack && no_hold && sht21_it_state == SHT21_IT_RECEIVE)
+    {
+        if ((UInt32)(HAL_GetTick() - sht21_it_start_tick) <= SHT21_MEASURE_TIMEOUT)
+        {
+            sht21_it_state = SHT21_IT_CONVERTING;
+            return;
+        }
+        SHT21_it_finish(SHT21_TIME_OUT_ERROR);
+        return;
+    }
+
+    SHT21_it_finish(nack ? SHT21_ACK_ERROR : SHT21_TIME_OUT_ERROR);
+}
+
+#ifndef SHT21_IT_NO_HAL_CALLBACKS
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    SHT21_it_tx_cplt(hi2c);
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    SHT21_it_rx_cplt(hi2c);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c)
+{
+    SHT21_it_error(hi2c);
+}
+#endif
@@ -0,0 +1,86 @@
+/********************************************************************************************
+ *  Filename: i2c.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Stand-in for the STM32 HAL on a Linux host, just what sht21.c and sht21_it.c use.
+ *  hi2c1 talks to a simulated SHT21 (sim/sht21_sim.h), and time is the virtual clock of
+ *  the sim.
+ *
+ *  Blocking transfers run at once. _IT and _DMA transfers run on the sim when started,
+ *  but their completion callback is only delivered by Fake_HAL_Advance once the virtual
+ *  clock reaches the end of the transfer, the same order a real interrupt would come
+ *  in. Fake_HAL_Advance also calls HAL_SYSTICK_Callback every ms.
+ *
+ *******************************************************************************************/
+#ifndef __FAKE_HAL_I2C_H
+#define __FAKE_HAL_I2C_H
+
+#include "sht21_sim.h"
+
+#define __weak                  __attribute__((weak))
+#define HAL_MAX_DELAY           (0xFFFFFFFFU)
+#define HAL_I2C_ERROR_NONE      (0x00U)
+#define HAL_I2C_ERROR_AF        (0x04U)
+
+typedef enum
+{
+    HAL_OK                      = (0x00U),
+    HAL_ERROR                   = (0x01U),
+    HAL_BUSY                    = (0x02U),
+    HAL_TIMEOUT                 = (0x03U)
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+    FAKE_HAL_NONE               = (0x00U),
+    FAKE_HAL_TX_CPLT            = (0x01U),
+    FAKE_HAL_RX_CPLT            = (0x02U),
+    FAKE_HAL_ERROR              = (0x03U)
+} Fake_HAL_Event_TypeDef;
+
+/********************************************************************************************
+ *  I2C handle. interrupts counts the interrupts a real peripheral would raise, one per
+ *  byte for _IT and one per transfer for _DMA. The next refuse_receives _IT and _DMA
+ *  receives return HAL_ERROR without starting, like a peripheral stuck busy.
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Sim_TypeDef* sim;
+    UInt32 ErrorCode;
+    Fake_HAL_Event_TypeDef event;
+    unsigned long long event_us;
+    UInt32 transfers;
+    UInt32 interrupts;
+    UInt32 refuse_receives;
+} I2C_HandleTypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern I2C_HandleTypeDef hi2c1;
+
+void Fake_HAL_Init(SHT21_Sim_TypeDef* sim);
+void Fake_HAL_Advance(unsigned long long us);
+
+UInt32 HAL_GetTick(void);
+void HAL_Delay(UInt32 ms);
+void HAL_SYSTICK_Callback(void);
+UInt32 HAL_I2C_GetError(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len, UInt32 timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len, UInt32 timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FAKE_HAL_I2C_H
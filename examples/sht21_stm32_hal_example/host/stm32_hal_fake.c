@@ -0,0 +1,197 @@
+/********************************************************************************************
+ *  Filename: stm32_hal_fake.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the host stand-in for the STM32 HAL
+ *
+ *******************************************************************************************/
+#include "i2c.h"
+
+I2C_HandleTypeDef hi2c1;
+
+// Time of the next SysTick
+static unsigned long long fake_hal_tick_us;
+
+static SHT21_Sim_Clock_TypeDef* fake_hal_clock(I2C_HandleTypeDef* hi2c)
+{
+    return hi2c->sim->clock;
+}
+
+/********************************************************************************************
+ *  Connects hi2c1 to sim, all time is taken from the clock of sim
+ *******************************************************************************************/
+void Fake_HAL_Init(SHT21_Sim_TypeDef* sim)
+{
+    hi2c1 = (I2C_HandleTypeDef){0};
+    hi2c1.sim = sim;
+    fake_hal_tick_us = (sim->clock->now_us / 1000ULL + 1ULL) * 1000ULL;
+}
+
+__weak void HAL_SYSTICK_Callback(void)
+{
+}
+
+__weak void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c)
+{
+    (void)hi2c;
+}
+
+// Delivers the pending completion of hi2c, the callback may start the next transfer
+static void fake_hal_deliver(I2C_HandleTypeDef* hi2c)
+{
+    Fake_HAL_Event_TypeDef event = hi2c->event;
+    hi2c->event = FAKE_HAL_NONE;
+
+    switch (event)
+    {
+        case FAKE_HAL_TX_CPLT:
+        HAL_I2C_MasterTxCpltCallback(hi2c);
+        break;
+        case FAKE_HAL_RX_CPLT:
+        HAL_I2C_MasterRxCpltCallback(hi2c);
+        break;
+        case FAKE_HAL_ERROR:
+        HAL_I2C_ErrorCallback(hi2c);
+        break;
+        default:
+        break;
+    }
+}
+
+/********************************************************************************************
+ *  Moves the virtual clock us forward, delivering completions and SysTick callbacks in
+ *  time order as they fall due.
+ *******************************************************************************************/
+void Fake_HAL_Advance(unsigned long long us)
+{
+    SHT21_Sim_Clock_TypeDef* clock = fake_hal_clock(&hi2c1);
+    unsigned long long end = clock->now_us + us;
+
+    // Ticks missed while a blocking call moved the clock are delivered once, like a
+    // pending SysTick interrupt
+    if (fake_hal_tick_us + 1000ULL <= clock->now_us)
+        fake_hal_tick_us = clock->now_us - clock->now_us % 1000ULL;
+
+    for (;;)
+    {
+        UInt8 event_due = hi2c1.event != FAKE_HAL_NONE && hi2c1.event_us <= fake_hal_tick_us;
+        unsigned long long next = event_due ? hi2c1.event_us : fake_hal_tick_us;
+
+        if (next > end)
+            break;
+        if (next > clock->now_us)
+            SHT21_Sim_Advance(clock, next - clock->now_us);
+
+        if (event_due)
+            fake_hal_deliver(&hi2c1);
+        else
+        {
+            fake_hal_tick_us += 1000ULL;
+            HAL_SYSTICK_Callback();
+        }
+    }
+
+    if (end > clock->now_us)
+        SHT21_Sim_Advance(clock, end - clock->now_us);
+}
+
+UInt32 HAL_GetTick(void)
+{
+    return (UInt32)(fake_hal_clock(&hi2c1)->now_us / 1000ULL);
+}
+
+void HAL_Delay(UInt32 ms)
+{
+    Fake_HAL_Advance(1000ULL * ms);
+}
+
+UInt32 HAL_I2C_GetError(I2C_HandleTypeDef* hi2c)
+{
+    return hi2c->ErrorCode;
+}
+
+// Runs the transfer on the sim now, the clock moves to the end of it
+static HAL_StatusTypeDef fake_hal_transfer(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len)
+{
+    SHT21_Error_TypeDef status;
+
+    hi2c->transfers++;
+    if (address & 1U)
+        status = SHT21_Sim_Read(hi2c->sim, (UInt8)(address >> 1U), buf, (UInt8)len);
+    else
+        status = SHT21_Sim_Write(hi2c->sim, (UInt8)(address >> 1U), buf, (UInt8)len);
+
+    hi2c->ErrorCode = (status == SHT21_OK) ? HAL_I2C_ERROR_NONE : HAL_I2C_ERROR_AF;
+    return (status == SHT21_OK) ? HAL_OK : HAL_ERROR;
+}
+
+// Runs the transfer on the sim and schedules its completion for when it would end
+static HAL_StatusTypeDef fake_hal_transfer_async(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len,
+                                                 UInt32 interrupts)
+{
+    SHT21_Sim_Clock_TypeDef* clock = fake_hal_clock(hi2c);
+
+    if (hi2c->event != FAKE_HAL_NONE)
+        return HAL_BUSY;
+    if ((address & 1U) && hi2c->refuse_receives > 0)
+    {
+        hi2c->refuse_receives--;
+        return HAL_ERROR;
+    }
+
+    unsigned long long start = clock->now_us;
+    HAL_StatusTypeDef status = fake_hal_transfer(hi2c, address, buf, len);
+    hi2c->event_us = clock->now_us;
+    clock->now_us = start;
+
+    hi2c->interrupts += interrupts;
+    if (status != HAL_OK)
+        hi2c->event = FAKE_HAL_ERROR;
+    else
+        hi2c->event = (address & 1U) ? FAKE_HAL_RX_CPLT : FAKE_HAL_TX_CPLT;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len, UInt32 timeout)
+{
+    (void)timeout;
+    return fake_hal_transfer(hi2c, address & ~1U, buf, len);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len, UInt32 timeout)
+{
+    (void)timeout;
+    return fake_hal_transfer(hi2c, address | 1U, buf, len);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len)
+{
+    return fake_hal_transfer_async(hi2c, address & ~1U, buf, len, len + 1U);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len)
+{
+    return fake_hal_transfer_async(hi2c, address | 1U, buf, len, len + 1U);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len)
+{
+    return fake_hal_transfer_async(hi2c, address & ~1U, buf, len, 1U);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef* hi2c, UInt16 address, UInt8* buf, UInt16 len)
+{
+    return fake_hal_transfer_async(hi2c, address | 1U, buf, len, 1U);
+}
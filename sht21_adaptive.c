@@ -0,0 +1,165 @@
+/********************************************************************************************
+ *  Filename: sht21_adaptive.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 adaptive interval and resolution controller
+ *
+ *******************************************************************************************/
+#include "sht21_adaptive.h"
+
+#define SHT21_ADAPTIVE_LEVELS       (3U)
+#define SHT21_ADAPTIVE_NOISE_SHIFT  (3U)    // Noise floor averages over about 8 samples
+
+// Resolutions from the longest to the shortest conversion time, RH8/T12 saves nothing over RH11/T11
+static const SHT21_Resolution_TypeDef sht21_adaptive_levels[SHT21_ADAPTIVE_LEVELS] =
+{
+    SHT21_RES_RH12_T14, SHT21_RES_RH10_T13, SHT21_RES_RH11_T11
+};
+
+// Returns SHT21_ADAPTIVE_LEVELS for a resolution not on the ladder
+static UInt8 SHT21_Adaptive_Level(SHT21_Resolution_TypeDef res)
+{
+    UInt8 level = 0;
+    while (level < SHT21_ADAPTIVE_LEVELS && sht21_adaptive_levels[level] != res)
+        level++;
+    return level;
+}
+
+static UInt32 SHT21_Adaptive_Conversion_Time(SHT21_Resolution_TypeDef res)
+{
+    return SHT21_Conversion_Time(res, SHT21_TEMP_MEASURE) + SHT21_Conversion_Time(res, SHT21_RH_MEASURE);
+}
+
+/********************************************************************************************
+ *  Starts at min_interval and the fine resolution. Uses SHT21_ADAPTIVE_CONFIG_DEFAULT
+ *  when config is 0. Returns SHT21_UNIT_ERROR if the bounds are the wrong way round or
+ *  a resolution is not one the controller steps through.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Adaptive_Init(SHT21_Adaptive_TypeDef* ctrl, const SHT21_Adaptive_Config_TypeDef* config)
+{
+    static const SHT21_Adaptive_Config_TypeDef default_config = SHT21_ADAPTIVE_CONFIG_DEFAULT;
+
+    if (config == 0)
+        config = &default_config;
+    if (config->min_interval == 0 || config->min_interval > config->max_interval ||
+        SHT21_Adaptive_Level(config->coarse) == SHT21_ADAPTIVE_LEVELS ||
+        SHT21_Adaptive_Level(config->fine) > SHT21_Adaptive_Level(config->coarse) ||
+        config->temp_stable > config->temp_move || config->rh_stable > config->rh_move)
+        return SHT21_UNIT_ERROR;
+
+    ctrl->config = *config;
+    ctrl->stats = (SHT21_Adaptive_Stats_TypeDef){0};
+    ctrl->temp_noise = 0;
+    ctrl->rh_noise = 0;
+    SHT21_Adaptive_Wake(ctrl);
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Goes back to min_interval and the fine resolution, for example when the application
+ *  knows a change is coming. The next sample starts a new comparison.
+ *******************************************************************************************/
+void SHT21_Adaptive_Wake(SHT21_Adaptive_TypeDef* ctrl)
+{
+    ctrl->interval = ctrl->config.min_interval;
+    ctrl->resolution = ctrl->config.fine;
+    ctrl->level = SHT21_Adaptive_Level(ctrl->config.fine);
+    ctrl->stable_run = 0;
+    ctrl->primed = 0;
+}
+
+static UInt32 SHT21_Adaptive_Diff(UInt16 a, UInt16 b)
+{
+    return (a > b) ? (UInt32)(a - b) : (UInt32)(b - a);
+}
+
+/********************************************************************************************
+ *  Passes the masked readings of a sample, see SHT21_Parse_Reading. Returns
+ *  SHT21_ADAPTIVE_INTERVAL and/or SHT21_ADAPTIVE_RESOLUTION when the setting for the
+ *  next sample changed, 0 otherwise. Wait ctrl->interval ms before the next sample and
+ *  write the user register from SHT21_Adaptive_User_Reg when the resolution changed.
+ *******************************************************************************************/
+UInt8 SHT21_Adaptive_Update(SHT21_Adaptive_TypeDef* ctrl, UInt16 temp_reading, UInt16 rh_reading)
+{
+    SHT21_Adaptive_Config_TypeDef* config = &ctrl->config;
+    UInt32 interval = ctrl->interval;
+    UInt8 level = ctrl->level;
+
+    ctrl->stats.measurements++;
+    ctrl->stats.conversion_time += SHT21_Adaptive_Conversion_Time(ctrl->resolution);
+
+    if (ctrl->primed)
+    {
+        UInt32 temp_diff = SHT21_Adaptive_Diff(temp_reading, ctrl->last_temp);
+        UInt32 rh_diff = SHT21_Adaptive_Diff(rh_reading, ctrl->last_rh);
+        UInt32 temp_noise = ctrl->temp_noise >> SHT21_ADAPTIVE_NOISE_SHIFT;
+        UInt32 rh_noise = ctrl->rh_noise >> SHT21_ADAPTIVE_NOISE_SHIFT;
+
+        if (temp_diff > temp_noise + config->temp_move || rh_diff > rh_noise + config->rh_move)
+        {
+            if (interval != config->min_interval || level != SHT21_Adaptive_Level(config->fine))
+                ctrl->stats.moves++;
+            interval = config->min_interval;
+            level = SHT21_Adaptive_Level(config->fine);
+            ctrl->stable_run = 0;
+        }
+        else
+        {
+            ctrl->temp_noise += temp_diff - temp_noise;
+            ctrl->rh_noise += rh_diff - rh_noise;
+
+            if (temp_diff <= temp_noise + config->temp_stable && rh_diff <= rh_noise + config->rh_stable)
+                ctrl->stable_run++;
+            else
+                ctrl->stable_run = 0;
+
+            if (ctrl->stable_run >= config->stable_samples)
+            {
+                ctrl->stable_run = 0;
+                interval = (interval > config->max_interval / 2U) ? config->max_interval : interval * 2U;
+                if (level < SHT21_Adaptive_Level(config->coarse))
+                    level++;
+            }
+        }
+    }
+
+    ctrl->primed = 1;
+    ctrl->last_temp = temp_reading;
+    ctrl->last_rh = rh_reading;
+    ctrl->stats.elapsed += interval;
+
+    UInt8 changed = 0;
+    if (interval != ctrl->interval)
+        changed |= SHT21_ADAPTIVE_INTERVAL;
+    if (level != ctrl->level)
+    {
+        changed |= SHT21_ADAPTIVE_RESOLUTION;
+        ctrl->stats.res_changes++;
+    }
+
+    ctrl->interval = interval;
+    ctrl->level = level;
+    ctrl->resolution = sht21_adaptive_levels[level];
+    return changed;
+}
+
+/********************************************************************************************
+ *  The user register with the resolution bits set to the current resolution
+ *******************************************************************************************/
+SHT21_User_Reg_TypeDef SHT21_Adaptive_User_Reg(const SHT21_Adaptive_TypeDef* ctrl, SHT21_User_Reg_TypeDef reg)
+{
+    return SHT21_Set_Resolution(reg, ctrl->resolution);
+}
+
+/********************************************************************************************
+ *  Conversion time in ms that sampling at min_interval with the fine resolution would
+ *  have taken over the same time, compare with stats.conversion_time. The bus time
+ *  saved is less, see bench/sht21_bench_adaptive.c.
+ *******************************************************************************************/
+UInt32 SHT21_Adaptive_Fixed_Conversion(const SHT21_Adaptive_TypeDef* ctrl)
+{
+    UInt32 samples = ctrl->stats.elapsed / ctrl->config.min_interval;
+    return samples * SHT21_Adaptive_Conversion_Time(ctrl->config.fine);
+}
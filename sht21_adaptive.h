@@ -0,0 +1,113 @@
+/********************************************************************************************
+ *  Filename: sht21_adaptive.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Adapts the sampling interval and resolution to how much the readings move. While
+ *  the readings are stable the interval is doubled and the resolution stepped down
+ *  one level every stable_samples samples, up to max_interval and the coarse
+ *  resolution. The first sample that moves puts it back to min_interval and the fine
+ *  resolution, so a change is picked up within one interval.
+ *
+ *  A sample is compared to the previous one on the raw readings. A noise floor, the
+ *  average difference of the samples that did not move, is added to both thresholds:
+ *      Moving  : difference > noise floor + move threshold
+ *      Stable  : difference <= noise floor + stable threshold
+ *  Samples between the two hold the current setting, and the stable threshold being
+ *  below the move threshold is the hysteresis.
+ *
+ *  Resolutions step through RH12/T14, RH10/T13 and RH11/T11, in the order of their
+ *  conversion time. RH8/T12 is left out, it takes as long as RH11/T11. The move
+ *  threshold should be above the step of the readings at the coarse resolution, see
+ *  SHT21_Adaptive_Config_TypeDef.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_ADAPTIVE__H
+#define __SHT21_ADAPTIVE__H
+
+#include "sht21_core.h"
+
+// Returned by SHT21_Adaptive_Update
+#define SHT21_ADAPTIVE_INTERVAL     (1U << 0U)  // interval changed
+#define SHT21_ADAPTIVE_RESOLUTION   (1U << 1U)  // resolution changed, write the user register
+
+/********************************************************************************************
+ *  Bounds and thresholds. Thresholds are in ticks of the masked 16 bit readings,
+ *  1 C = 373 ticks and 1 %RH = 524 ticks. A reading at T:11 moves in steps of 32 ticks,
+ *  at RH:11 in steps of 32.
+ *
+ *  min_interval    : Interval in ms while moving
+ *  max_interval    : Longest interval in ms while stable
+ *  fine            : Resolution while moving
+ *  coarse          : Lowest resolution while stable, not below RH11/T11
+ *  temp_move       : Temperature difference above the noise floor that counts as moving
+ *  rh_move         : Same for humidity
+ *  temp_stable     : Temperature difference above the noise floor still counted as stable
+ *  rh_stable       : Same for humidity
+ *  stable_samples  : Stable samples in a row before stepping down once
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 min_interval;
+    UInt32 max_interval;
+    SHT21_Resolution_TypeDef fine;
+    SHT21_Resolution_TypeDef coarse;
+    UInt16 temp_move;
+    UInt16 rh_move;
+    UInt16 temp_stable;
+    UInt16 rh_stable;
+    UInt8 stable_samples;
+} SHT21_Adaptive_Config_TypeDef;
+
+// 1 s to 1 min, RH12/T14 to RH10/T13, moving at 0.1 C or 1 %RH, stable below 0.05 C and 0.5 %RH
+#define SHT21_ADAPTIVE_CONFIG_DEFAULT { 1000U, 60000U, SHT21_RES_RH12_T14, SHT21_RES_RH10_T13, \
+                                        37U, 524U, 19U, 262U, 4U }
+
+/********************************************************************************************
+ *  measurements    : Samples passed to SHT21_Adaptive_Update
+ *  elapsed         : ms covered by the samples, the sum of their intervals
+ *  conversion_time : ms of temperature and humidity conversion time at the resolutions
+ *                    used. Not bus time, the transfers and register writes come on top.
+ *  moves           : Times a moving sample put it back to the fine setting
+ *  res_changes     : Resolution changes, each a user register read and write
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 measurements;
+    UInt32 elapsed;
+    UInt32 conversion_time;
+    UInt32 moves;
+    UInt32 res_changes;
+} SHT21_Adaptive_Stats_TypeDef;
+
+typedef struct
+{
+    SHT21_Adaptive_Config_TypeDef config;
+    SHT21_Adaptive_Stats_TypeDef stats;
+    UInt32 interval;
+    SHT21_Resolution_TypeDef resolution;
+    UInt8 level;
+    UInt8 stable_run;
+    UInt8 primed;
+    UInt16 last_temp;
+    UInt16 last_rh;
+    UInt32 temp_noise;      // Noise floor in ticks * 8
+    UInt32 rh_noise;
+} SHT21_Adaptive_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SHT21_Error_TypeDef SHT21_Adaptive_Init(SHT21_Adaptive_TypeDef* ctrl, const SHT21_Adaptive_Config_TypeDef* config);
+UInt8 SHT21_Adaptive_Update(SHT21_Adaptive_TypeDef* ctrl, UInt16 temp_reading, UInt16 rh_reading);
+void SHT21_Adaptive_Wake(SHT21_Adaptive_TypeDef* ctrl);
+SHT21_User_Reg_TypeDef SHT21_Adaptive_User_Reg(const SHT21_Adaptive_TypeDef* ctrl, SHT21_User_Reg_TypeDef reg);
+UInt32 SHT21_Adaptive_Fixed_Conversion(const SHT21_Adaptive_TypeDef* ctrl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_ADAPTIVE__H
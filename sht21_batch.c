@@ -0,0 +1,264 @@
+/********************************************************************************************
+ *  Filename: sht21_batch.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 batch decoder
+ *
+ *******************************************************************************************/
+#include "sht21_batch.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(SHT21_BATCH_NO_SIMD)
+#define SHT21_BATCH_X86
+#include <immintrin.h>
+#endif
+
+// Number of frames deinterleaved and decoded in one go
+#define SHT21_BATCH_BLOCK           (16U)
+
+/*
+ *  The CRC is computed on the 16 bit reading as one register. Shifting the reading out
+ *  through the top bit and xor'ing the polynomial into the upper byte leaves the CRC of
+ *  both bytes in the upper byte after 16 rounds.
+ */
+#define SHT21_BATCH_CRC_POLY        (0x3100U)
+
+typedef void (*SHT21_Batch_Kernel_Fn)(const UInt16* reading, const UInt16* checksum, UInt32 count,
+                                      float offset, float scale, float* out, UInt8* status);
+
+/********************************************************************************************
+ *  Scalar kernel. Uses the same CRC and conversion as the single frame parsers.
+ *******************************************************************************************/
+static void SHT21_Batch_Kernel_Scalar(const UInt16* reading, const UInt16* checksum, UInt32 count,
+                                      float offset, float scale, float* out, UInt8* status)
+{
+    for (UInt32 i = 0; i < count; i++)
+    {
+        UInt8 buf[2];
+        buf[0] = (UInt8)(reading[i] >> 8);
+        buf[1] = (UInt8)(reading[i] & 0xFFU);
+
+        if (SHT21_Check_Crc(buf, 2, (UInt8)checksum[i]) != 0)
+        {
+            out[i] = SHT21_CHECKSUM_ERROR;
+            status[i] = SHT21_CHECKSUM_ERROR;
+            continue;
+        }
+
+        UInt16 masked = reading[i] & ~(0x3U); // Mask out the status bits
+        out[i] = offset + scale * ((float)masked / (float)65536);
+        status[i] = SHT21_OK;
+    }
+}
+
+#ifdef SHT21_BATCH_X86
+/********************************************************************************************
+ *  SSE2 kernel, 8 frames per iteration
+ *******************************************************************************************/
+__attribute__((target("sse2")))
+static void SHT21_Batch_Kernel_Sse2(const UInt16* reading, const UInt16* checksum, UInt32 count,
+                                    float offset, float scale, float* out, UInt8* status)
+{
+    const __m128i poly = _mm_set1_epi16((short)SHT21_BATCH_CRC_POLY);
+    const __m128i status_mask = _mm_set1_epi16((short)0xFFFCU);
+    const __m128i crc_error = _mm_set1_epi8(SHT21_CHECKSUM_ERROR);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 v_offset = _mm_set1_ps(offset);
+    const __m128 v_scale = _mm_set1_ps(scale);
+    const __m128 v_div = _mm_set1_ps(1.0f / 65536.0f);
+    const __m128 v_error = _mm_set1_ps((float)SHT21_CHECKSUM_ERROR);
+    UInt32 i = 0;
+
+    for (; i + 8U <= count; i += 8U)
+    {
+        __m128i raw = _mm_loadu_si128((const __m128i*)&reading[i]);
+        __m128i chk = _mm_loadu_si128((const __m128i*)&checksum[i]);
+
+        // Calculate the checksum of all 8 readings
+        __m128i crc = raw;
+        for (UInt8 bit = 16; bit > 0; --bit)
+        {
+            __m128i top = _mm_and_si128(_mm_srai_epi16(crc, 15), poly);
+            crc = _mm_xor_si128(_mm_slli_epi16(crc, 1), top);
+        }
+        __m128i ok = _mm_cmpeq_epi16(_mm_srli_epi16(crc, 8), chk);
+
+        // Calculate the ADC values to engineering units
+        __m128i masked = _mm_and_si128(raw, status_mask);
+        __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(masked, zero));
+        __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(masked, zero));
+        lo = _mm_add_ps(v_offset, _mm_mul_ps(v_scale, _mm_mul_ps(lo, v_div)));
+        hi = _mm_add_ps(v_offset, _mm_mul_ps(v_scale, _mm_mul_ps(hi, v_div)));
+
+        // Replace failed frames with the error value, same as the single frame parsers
+        __m128 ok_lo = _mm_castsi128_ps(_mm_unpacklo_epi16(ok, ok));
+        __m128 ok_hi = _mm_castsi128_ps(_mm_unpackhi_epi16(ok, ok));
+        lo = _mm_or_ps(_mm_and_ps(ok_lo, lo), _mm_andnot_ps(ok_lo, v_error));
+        hi = _mm_or_ps(_mm_and_ps(ok_hi, hi), _mm_andnot_ps(ok_hi, v_error));
+        _mm_storeu_ps(&out[i], lo);
+        _mm_storeu_ps(&out[i + 4U], hi);
+
+        __m128i st = _mm_andnot_si128(_mm_packs_epi16(ok, zero), crc_error);
+        _mm_storel_epi64((__m128i*)&status[i], st);
+    }
+
+    SHT21_Batch_Kernel_Scalar(&reading[i], &checksum[i], count - i, offset, scale, &out[i], &status[i]);
+}
+
+/********************************************************************************************
+ *  AVX2 kernel, 16 frames per iteration
+ *******************************************************************************************/
+__attribute__((target("avx2")))
+static void SHT21_Batch_Kernel_Avx2(const UInt16* reading, const UInt16* checksum, UInt32 count,
+                                    float offset, float scale, float* out, UInt8* status)
+{
+    const __m256i poly = _mm256_set1_epi16((short)SHT21_BATCH_CRC_POLY);
+    const __m256i status_mask = _mm256_set1_epi16((short)0xFFFCU);
+    const __m128i crc_error = _mm_set1_epi8(SHT21_CHECKSUM_ERROR);
+    const __m256 v_offset = _mm256_set1_ps(offset);
+    const __m256 v_scale = _mm256_set1_ps(scale);
+    const __m256 v_div = _mm256_set1_ps(1.0f / 65536.0f);
+    const __m256 v_error = _mm256_set1_ps((float)SHT21_CHECKSUM_ERROR);
+    UInt32 i = 0;
+
+    for (; i + 16U <= count; i += 16U)
+    {
+        __m256i raw = _mm256_loadu_si256((const __m256i*)&reading[i]);
+        __m256i chk = _mm256_loadu_si256((const __m256i*)&checksum[i]);
+
+        // Calculate the checksum of all 16 readings
+        __m256i crc = raw;
+        for (UInt8 bit = 16; bit > 0; --bit)
+        {
+            __m256i top = _mm256_and_si256(_mm256_srai_epi16(crc, 15), poly);
+            crc = _mm256_xor_si256(_mm256_slli_epi16(crc, 1), top);
+        }
+        __m256i ok = _mm256_cmpeq_epi16(_mm256_srli_epi16(crc, 8), chk);
+
+        // Calculate the ADC values to engineering units
+        __m256i masked = _mm256_and_si256(raw, status_mask);
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(masked)));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(masked, 1)));
+        lo = _mm256_add_ps(v_offset, _mm256_mul_ps(v_scale, _mm256_mul_ps(lo, v_div)));
+        hi = _mm256_add_ps(v_offset, _mm256_mul_ps(v_scale, _mm256_mul_ps(hi, v_div)));
+
+        // Replace failed frames with the error value, same as the single frame parsers
+        __m128i ok_lo16 = _mm256_castsi256_si128(ok);
+        __m128i ok_hi16 = _mm256_extracti128_si256(ok, 1);
+        __m256 ok_lo = _mm256_castsi256_ps(_mm256_cvtepi16_epi32(ok_lo16));
+        __m256 ok_hi = _mm256_castsi256_ps(_mm256_cvtepi16_epi32(ok_hi16));
+        lo = _mm256_blendv_ps(v_error, lo, ok_lo);
+        hi = _mm256_blendv_ps(v_error, hi, ok_hi);
+        _mm256_storeu_ps(&out[i], lo);
+        _mm256_storeu_ps(&out[i + 8U], hi);
+
+        __m128i st = _mm_andnot_si128(_mm_packs_epi16(ok_lo16, ok_hi16), crc_error);
+        _mm_storeu_si128((__m128i*)&status[i], st);
+    }
+
+    SHT21_Batch_Kernel_Scalar(&reading[i], &checksum[i], count - i, offset, scale, &out[i], &status[i]);
+}
+#endif // SHT21_BATCH_X86
+
+/*
+ *  The kernel is picked on the first call if SHT21_Batch_Select_Kernel was not called,
+ *  possibly from several threads at once. They all pick the same kernel, the pointer
+ *  only has to be read and written whole.
+ */
+#ifdef __GNUC__
+#define SHT21_BATCH_KERNEL_LOAD()       __atomic_load_n(&sht21_batch_kernel, __ATOMIC_ACQUIRE)
+#define SHT21_BATCH_KERNEL_STORE(fn)    __atomic_store_n(&sht21_batch_kernel, (fn), __ATOMIC_RELEASE)
+#else
+#define SHT21_BATCH_KERNEL_LOAD()       (sht21_batch_kernel)
+#define SHT21_BATCH_KERNEL_STORE(fn)    (sht21_batch_kernel = (fn))
+#endif
+
+static SHT21_Batch_Kernel_Fn sht21_batch_kernel = 0;
+
+/********************************************************************************************
+ *  Selects the kernel used by the batch parsers. Passing SHT21_BATCH_KERNEL_AUTO picks the
+ *  widest kernel supported by the CPU. Kernels not supported by the CPU or target falls
+ *  back to the scalar kernel. Returns the kernel that was selected.
+ *******************************************************************************************/
+SHT21_Batch_Kernel_TypeDef SHT21_Batch_Select_Kernel(SHT21_Batch_Kernel_TypeDef kernel)
+{
+#ifdef SHT21_BATCH_X86
+    __builtin_cpu_init();
+    int has_avx2 = __builtin_cpu_supports("avx2");
+    int has_sse2 = __builtin_cpu_supports("sse2");
+
+    if (kernel == SHT21_BATCH_KERNEL_AUTO)
+        kernel = has_avx2 ? SHT21_BATCH_KERNEL_AVX2 : SHT21_BATCH_KERNEL_SSE2;
+
+    if (kernel == SHT21_BATCH_KERNEL_AVX2 && has_avx2)
+    {
+        SHT21_BATCH_KERNEL_STORE(SHT21_Batch_Kernel_Avx2);
+        return SHT21_BATCH_KERNEL_AVX2;
+    }
+    if (kernel == SHT21_BATCH_KERNEL_SSE2 && has_sse2)
+    {
+        SHT21_BATCH_KERNEL_STORE(SHT21_Batch_Kernel_Sse2);
+        return SHT21_BATCH_KERNEL_SSE2;
+    }
+#else
+    (void)kernel;
+#endif
+    SHT21_BATCH_KERNEL_STORE(SHT21_Batch_Kernel_Scalar);
+    return SHT21_BATCH_KERNEL_SCALAR;
+}
+
+/********************************************************************************************
+ *  Splits the frames into readings and checksums block by block and runs the selected
+ *  kernel on them. Returns the number of frames that failed the checksum.
+ *******************************************************************************************/
+static UInt32 SHT21_Batch_Parse(UInt8* frames, UInt32 count, float offset, float scale,
+                                float* out, UInt8* status)
+{
+    UInt16 reading[SHT21_BATCH_BLOCK];
+    UInt16 checksum[SHT21_BATCH_BLOCK];
+    UInt32 errors = 0;
+
+    SHT21_Batch_Kernel_Fn kernel = SHT21_BATCH_KERNEL_LOAD();
+    if (kernel == 0)
+    {
+        SHT21_Batch_Select_Kernel(SHT21_BATCH_KERNEL_AUTO);
+        kernel = SHT21_BATCH_KERNEL_LOAD();
+    }
+
+    for (UInt32 i = 0; i < count; i += SHT21_BATCH_BLOCK)
+    {
+        UInt32 n = (count - i < SHT21_BATCH_BLOCK) ? (count - i) : SHT21_BATCH_BLOCK;
+        UInt8* frame = &frames[i * SHT21_FRAME_SIZE];
+
+        for (UInt32 j = 0; j < n; j++, frame += SHT21_FRAME_SIZE)
+        {
+            reading[j] = (UInt16)((frame[0] << 8) | frame[1]);
+            checksum[j] = frame[2];
+        }
+
+        kernel(reading, checksum, n, offset, scale, &out[i], &status[i]);
+
+        for (UInt32 j = 0; j < n; j++)
+            errors += (status[i + j] != SHT21_OK);
+    }
+    return errors;
+}
+
+/********************************************************************************************
+ *  Parses count temperature frames into temp. The status of each frame is written to
+ *  status, SHT21_OK or SHT21_CHECKSUM_ERROR. Returns the number of failed frames.
+ *******************************************************************************************/
+UInt32 SHT21_Parse_Temp_Batch(UInt8* frames, UInt32 count, float* temp, UInt8* status)
+{
+    return SHT21_Batch_Parse(frames, count, -46.85f, 175.72f, temp, status);
+}
+
+/********************************************************************************************
+ *  Parses count humidity frames into humidity. The status of each frame is written to
+ *  status, SHT21_OK or SHT21_CHECKSUM_ERROR. Returns the number of failed frames.
+ *******************************************************************************************/
+UInt32 SHT21_Parse_RH_Batch(UInt8* frames, UInt32 count, float* humidity, UInt8* status)
+{
+    return SHT21_Batch_Parse(frames, count, -6.0f, 125.0f, humidity, status);
+}
@@ -0,0 +1,46 @@
+/********************************************************************************************
+ *  Filename: sht21_batch.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Batch decoder for arrays of raw SHT21 frames. Frames are stored back to back as
+ *  received from the sensor (MSB, LSB, CRC), 3 bytes per frame.
+ *
+ *  On x86 the SSE2 or AVX2 kernel is picked at runtime, every other target uses the
+ *  scalar kernel. All kernels give bit-identical results to SHT21_Parse_Temp and
+ *  SHT21_Parse_RH, as long as the compiler is not allowed to contract the conversion
+ *  into a fused multiply-add (-ffp-contract=off).
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_BATCH__H
+#define __SHT21_BATCH__H
+
+#include "sht21_core.h"
+
+#define SHT21_FRAME_SIZE            (3U)
+
+/********************************************************************************************
+ *  Kernels available for the batch decoder
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_BATCH_KERNEL_AUTO     = (0x00U),
+    SHT21_BATCH_KERNEL_SCALAR   = (0x01U),
+    SHT21_BATCH_KERNEL_SSE2     = (0x02U),
+    SHT21_BATCH_KERNEL_AVX2     = (0x03U)
+} SHT21_Batch_Kernel_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SHT21_Batch_Kernel_TypeDef SHT21_Batch_Select_Kernel(SHT21_Batch_Kernel_TypeDef kernel);
+UInt32 SHT21_Parse_Temp_Batch(UInt8* frames, UInt32 count, float* temp, UInt8* status);
+UInt32 SHT21_Parse_RH_Batch(UInt8* frames, UInt32 count, float* humidity, UInt8* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_BATCH__H
@@ -0,0 +1,151 @@
+/********************************************************************************************
+ *  Filename: sht21_cache.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 max age cache
+ *
+ *******************************************************************************************/
+#include "sht21_cache.h"
+
+static UInt8 SHT21_Cache_Is_Temp(SHT21_Commands_TypeDef cmd)
+{
+    return cmd == SHT21_TEMP_MEASURE || cmd == SHT21_TEMP_MEASURE_HOLD;
+}
+
+// A value is fresh if it was read less than max_age ms ago, so 0 always measures
+static UInt8 SHT21_Cache_Fresh(UInt8 valid, UInt32 tick, UInt32 now, UInt32 max_age)
+{
+    return valid && (UInt32)(now - tick) < max_age;
+}
+
+/********************************************************************************************
+ *  Sets up an empty cache. bus is only used by SHT21_Cache_Read and
+ *  SHT21_Cache_Read_Both and may be 0 otherwise.
+ *******************************************************************************************/
+void SHT21_Cache_Init(SHT21_Cache_TypeDef* cache, SHT21_Bus_TypeDef* bus)
+{
+    *cache = (SHT21_Cache_TypeDef){0};
+    cache->bus = bus;
+}
+
+/********************************************************************************************
+ *  Drops the cached values, the next reads measure. Keeps the counters.
+ *******************************************************************************************/
+void SHT21_Cache_Invalidate(SHT21_Cache_TypeDef* cache)
+{
+    cache->temp_valid = 0U;
+    cache->humidity_valid = 0U;
+}
+
+/********************************************************************************************
+ *  Looks up the value of a measurement command at tick now. Returns 1 and writes value
+ *  on a hit, 0 on a miss, and counts either.
+ *******************************************************************************************/
+UInt8 SHT21_Cache_Get(SHT21_Cache_TypeDef* cache, SHT21_Commands_TypeDef cmd, UInt32 now, UInt32 max_age, float* value)
+{
+    UInt8 hit;
+    if (SHT21_Cache_Is_Temp(cmd))
+    {
+        hit = SHT21_Cache_Fresh(cache->temp_valid, cache->temp_tick, now, max_age);
+        if (hit)
+            *value = cache->temp;
+    }
+    else
+    {
+        hit = SHT21_Cache_Fresh(cache->humidity_valid, cache->humidity_tick, now, max_age);
+        if (hit)
+            *value = cache->humidity;
+    }
+
+    if (hit)
+        cache->hits++;
+    else
+        cache->misses++;
+    return hit;
+}
+
+/********************************************************************************************
+ *  Stores a value measured with cmd, tick is when it was read
+ *******************************************************************************************/
+void SHT21_Cache_Put(SHT21_Cache_TypeDef* cache, SHT21_Commands_TypeDef cmd, UInt32 tick, float value)
+{
+    if (SHT21_Cache_Is_Temp(cmd))
+    {
+        cache->temp = value;
+        cache->temp_tick = tick;
+        cache->temp_valid = 1U;
+    }
+    else
+    {
+        cache->humidity = value;
+        cache->humidity_tick = tick;
+        cache->humidity_valid = 1U;
+    }
+}
+
+/********************************************************************************************
+ *  Returns a value younger than max_age ms, measuring with a no hold command if the
+ *  cached one is older. A failed measurement leaves the cache as it was.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Cache_Read(SHT21_Cache_TypeDef* cache, SHT21_Commands_TypeDef cmd,
+                                     SHT21_Resolution_TypeDef res, UInt32 max_age, float* value)
+{
+    SHT21_Bus_TypeDef* bus = cache->bus;
+    if (SHT21_Cache_Get(cache, cmd, bus->get_tick(bus->handle), max_age, value))
+        return SHT21_OK;
+
+    cmd = SHT21_Cache_Is_Temp(cmd) ? SHT21_TEMP_MEASURE : SHT21_RH_MEASURE;
+
+    SHT21_Measurement_TypeDef meas;
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(&meas, bus, cmd);
+    if (status == SHT21_OK)
+        status = SHT21_Measure_Wait(&meas, SHT21_Conversion_Time(res, cmd));
+    if (status == SHT21_OK)
+        status = SHT21_Measure_Complete(&meas, value);
+    if (status == SHT21_OK)
+        SHT21_Cache_Put(cache, cmd, bus->get_tick(bus->handle), *value);
+    return status;
+}
+
+/********************************************************************************************
+ *  Measures temperature and humidity as SHT21_Measure_Both_Mode and caches each value
+ *  that parses, stamped with the tick its frame was read.
+ *******************************************************************************************/
+SHT21_Sample_TypeDef SHT21_Cache_Measure_Both(SHT21_Cache_TypeDef* cache, SHT21_Resolution_TypeDef res,
+                                              SHT21_Read_Mode_TypeDef temp_mode, SHT21_Read_Mode_TypeDef rh_mode)
+{
+    SHT21_Sample_Ticks_TypeDef ticks;
+    SHT21_Sample_TypeDef sample = SHT21_Measure_Both_Ticks(cache->bus, res, temp_mode, rh_mode, &ticks);
+
+    if (ticks.temp_valid)
+        SHT21_Cache_Put(cache, SHT21_TEMP_MEASURE, ticks.temp_tick, sample.temp);
+    if (ticks.humidity_valid)
+        SHT21_Cache_Put(cache, SHT21_RH_MEASURE, ticks.humidity_tick, sample.humidity);
+    return sample;
+}
+
+/********************************************************************************************
+ *  Returns temperature and humidity both younger than max_age ms, measuring both with
+ *  SHT21_Cache_Measure_Both if either is older. Counts one hit or miss.
+ *******************************************************************************************/
+SHT21_Sample_TypeDef SHT21_Cache_Read_Both(SHT21_Cache_TypeDef* cache, SHT21_Resolution_TypeDef res, UInt32 max_age)
+{
+    SHT21_Bus_TypeDef* bus = cache->bus;
+    SHT21_Sample_TypeDef sample = {0};
+    UInt32 now = bus->get_tick(bus->handle);
+
+    if (SHT21_Cache_Fresh(cache->temp_valid, cache->temp_tick, now, max_age) &&
+        SHT21_Cache_Fresh(cache->humidity_valid, cache->humidity_tick, now, max_age))
+    {
+        cache->hits++;
+        sample.temp = cache->temp;
+        sample.humidity = cache->humidity;
+        sample.status = SHT21_OK;
+        return sample;
+    }
+
+    cache->misses++;
+    return SHT21_Cache_Measure_Both(cache, res, SHT21_READ_FULL, SHT21_READ_FULL);
+}
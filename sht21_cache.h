@@ -0,0 +1,56 @@
+/********************************************************************************************
+ *  Filename: sht21_cache.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Last temperature and humidity of a sensor with the tick they were read, for callers
+ *  that only need a reading younger than some max age. A read with a max age returns
+ *  the cached value without touching the bus if it is fresh enough, and measures
+ *  otherwise. Hits and misses are counted to tune the max ages, a max age of 0 always
+ *  measures and counts a miss.
+ *
+ *  SHT21_Cache_Read and SHT21_Cache_Read_Both measure with the no hold functions of
+ *  the core. Drivers with their own transactions use SHT21_Cache_Get and
+ *  SHT21_Cache_Put around them, and SHT21_Cache_Invalidate when the heater or a reset
+ *  changes what the sensor reads.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_CACHE__H
+#define __SHT21_CACHE__H
+
+#include "sht21_core.h"
+
+typedef struct
+{
+    SHT21_Bus_TypeDef* bus;
+    float temp;
+    float humidity;
+    UInt32 temp_tick;
+    UInt32 humidity_tick;
+    UInt8 temp_valid;
+    UInt8 humidity_valid;
+
+    UInt32 hits;
+    UInt32 misses;
+} SHT21_Cache_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void SHT21_Cache_Init(SHT21_Cache_TypeDef* cache, SHT21_Bus_TypeDef* bus);
+void SHT21_Cache_Invalidate(SHT21_Cache_TypeDef* cache);
+UInt8 SHT21_Cache_Get(SHT21_Cache_TypeDef* cache, SHT21_Commands_TypeDef cmd, UInt32 now, UInt32 max_age, float* value);
+void SHT21_Cache_Put(SHT21_Cache_TypeDef* cache, SHT21_Commands_TypeDef cmd, UInt32 tick, float value);
+SHT21_Error_TypeDef SHT21_Cache_Read(SHT21_Cache_TypeDef* cache, SHT21_Commands_TypeDef cmd,
+                                     SHT21_Resolution_TypeDef res, UInt32 max_age, float* value);
+SHT21_Sample_TypeDef SHT21_Cache_Read_Both(SHT21_Cache_TypeDef* cache, SHT21_Resolution_TypeDef res, UInt32 max_age);
+SHT21_Sample_TypeDef SHT21_Cache_Measure_Both(SHT21_Cache_TypeDef* cache, SHT21_Resolution_TypeDef res,
+                                              SHT21_Read_Mode_TypeDef temp_mode, SHT21_Read_Mode_TypeDef rh_mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_CACHE__H
@@ -14,7 +14,7 @@
  *  It will compare the calculated checksum with the passed one and return error if
  *  mismatch. 
  *******************************************************************************************/
-static UInt16 SHT21_Check_Crc(UInt8* buf, UInt8 length, UInt8 checksum)
+UInt16 SHT21_Check_Crc(UInt8* buf, UInt8 length, UInt8 checksum)
 {
     UInt8 crc = 0;	
 
@@ -48,6 +48,28 @@ SHT21_Request_TypeDef SHT21_Request_Buf(SHT21_Commands_TypeDef cmd)
     return buf;
 }
 
+/********************************************************************************************
+ *  Converts a masked 16 bit temperature reading to degrees Celsius
+ *******************************************************************************************/
+float SHT21_Convert_Temp(UInt16 reading)
+{
+    // Calculate the ADC value to temperature
+    float temp = -46.85f + 175.72f * ((float)reading / (float)65536);
+
+    return temp;
+}
+
+/********************************************************************************************
+ *  Converts a masked 16 bit humidity reading to %RH
+ *******************************************************************************************/
+float SHT21_Convert_RH(UInt16 reading)
+{
+    // Calculate the ADC value to humidity
+    float humidity = -6.0f + 125.0f * ((float)reading / (float)65536);
+
+    return humidity;
+}
+
 /********************************************************************************************
  *  Parses the 2 byte temp value received from SHT21
  *******************************************************************************************/
@@ -60,10 +82,7 @@ float SHT21_Parse_Temp(UInt8* buf)
     if (SHT21_Check_Crc(buf, 2, buf[2]) != 0)
         return SHT21_CHECKSUM_ERROR;
 
-    // Calculate the ADC value to temperature
-    float temp = -46.85f + 175.72f * ((float)reading / (float)65536);
-
-    return temp;
+    return SHT21_Convert_Temp(reading);
 }
 
 /********************************************************************************************
@@ -78,10 +97,90 @@ float SHT21_Parse_RH(UInt8* buf)
     if (SHT21_Check_Crc(buf, 2, buf[2]) != 0)
         return SHT21_CHECKSUM_ERROR;
 
-    // Calculate the ADC value to humidity
-    float humidity = -6.0f + 125.0f * ((float)reading / (float)65536);
+    return SHT21_Convert_RH(reading);
+}
 
-    return humidity;
+/********************************************************************************************
+ *  Extracts the masked 16 bit reading of a temp or RH frame, for filtering on the raw
+ *  readings before converting. reading is only written with SHT21_OK.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Parse_Reading(UInt8* buf, UInt16* reading)
+{
+    if (SHT21_Check_Crc(buf, 2, buf[2]) != 0)
+        return SHT21_CHECKSUM_ERROR;
+
+    *reading = ((buf[0] << 8) | buf[1]) & ~(0x3U);
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Parses the 2 byte temp value received from SHT21 into temp. Unlike SHT21_Parse_Temp
+ *  a corrupt frame can not be mistaken for a reading, temp is only written with SHT21_OK.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Parse_Temp_Checked(UInt8* buf, float* temp)
+{
+    UInt16 reading;
+    SHT21_Error_TypeDef status = SHT21_Parse_Reading(buf, &reading);
+    if (status == SHT21_OK)
+        *temp = SHT21_Convert_Temp(reading);
+    return status;
+}
+
+/********************************************************************************************
+ *  Parses the 2 byte RH value received from SHT21 into humidity, only written with
+ *  SHT21_OK.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Parse_RH_Checked(UInt8* buf, float* humidity)
+{
+    UInt16 reading;
+    SHT21_Error_TypeDef status = SHT21_Parse_Reading(buf, &reading);
+    if (status == SHT21_OK)
+        *humidity = SHT21_Convert_RH(reading);
+    return status;
+}
+
+/********************************************************************************************
+ *  Parses a measurement result of length bytes, as read with SHT21_Read_Length. A full
+ *  frame is checked as SHT21_Parse_Reading, 2 bytes have no CRC. Either returns
+ *  SHT21_UNIT_ERROR if the status bit says it is the other measurement. 1 byte is the
+ *  MSB of a RH8 humidity, 0 bytes return SHT21_UNIT_ERROR.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Parse_Frame(UInt8* buf, UInt8 length, SHT21_Commands_TypeDef cmd, float* value)
+{
+    UInt8 humidity = (cmd == SHT21_RH_MEASURE || cmd == SHT21_RH_MEASURE_HOLD);
+    UInt16 reading;
+
+    if (length == 0U)
+        return SHT21_UNIT_ERROR;
+
+    if (length >= SHT21_FRAME_LENGTH)
+    {
+        SHT21_Error_TypeDef status = SHT21_Parse_Reading(buf, &reading);
+        if (status != SHT21_OK)
+            return status;
+    }
+    else if (length == 2U)
+        reading = ((buf[0] << 8) | buf[1]) & ~(0x3U);
+    else
+        reading = (UInt16)(buf[0] << 8);
+
+    if (length >= 2U && ((buf[1] & SHT21_STATUS_RH) != 0U) != humidity)
+        return SHT21_UNIT_ERROR;
+
+    *value = humidity ? SHT21_Convert_RH(reading) : SHT21_Convert_Temp(reading);
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Bytes to read of a measurement result in mode at resolution res
+ *******************************************************************************************/
+UInt8 SHT21_Read_Length(SHT21_Read_Mode_TypeDef mode, SHT21_Resolution_TypeDef res, SHT21_Commands_TypeDef cmd)
+{
+    if (mode == SHT21_READ_FULL)
+        return SHT21_FRAME_LENGTH;
+    if (mode == SHT21_READ_MSB && res == SHT21_RES_RH8_T12 && (cmd == SHT21_RH_MEASURE || cmd == SHT21_RH_MEASURE_HOLD))
+        return 1U;
+    return 2U;
 }
 
 /********************************************************************************************
@@ -97,3 +196,587 @@ SHT21_User_Reg_TypeDef SHT21_Parse_User_Reg(UInt8* buf)
     sht21.reg  |= ((UInt8)buf[0] & SHT21_STATUS);
     return sht21;
 }
+
+/********************************************************************************************
+ *  Returns the user register with the bits in mask replaced by the bits of value. Only
+ *  the writable bits are changed, the end of battery status bit is read only.
+ *  Example: SHT21_Update_User_Reg_Fields(reg, SHT21_ENABLE_CHIP_HEATER, 0) turns the
+ *  heater off and leaves the rest of the register as is.
+ *******************************************************************************************/
+SHT21_User_Reg_TypeDef SHT21_Update_User_Reg_Fields(SHT21_User_Reg_TypeDef reg, UInt8 mask, UInt8 value)
+{
+    mask &= SHT21_USER_REG_WRITABLE;
+    reg.reg = (reg.reg & ~mask) | (value & mask);
+    return reg;
+}
+
+/********************************************************************************************
+ *  Returns the measurement resolution set in the user register
+ *******************************************************************************************/
+SHT21_Resolution_TypeDef SHT21_Get_Resolution(SHT21_User_Reg_TypeDef reg)
+{
+    UInt8 res = 0;
+    if (reg.reg & SHT21_MEAS_RESOLUTION_BIT1)
+        res |= 0x2U;
+    if (reg.reg & SHT21_MEAS_RESOLUTION_BIT2)
+        res |= 0x1U;
+    return (SHT21_Resolution_TypeDef)res;
+}
+
+/********************************************************************************************
+ *  Returns the user register with the resolution bits set to res
+ *******************************************************************************************/
+SHT21_User_Reg_TypeDef SHT21_Set_Resolution(SHT21_User_Reg_TypeDef reg, SHT21_Resolution_TypeDef res)
+{
+    reg.reg &= ~(SHT21_MEAS_RESOLUTION_BIT1 | SHT21_MEAS_RESOLUTION_BIT2);
+    if (res & 0x2U)
+        reg.reg |= SHT21_MEAS_RESOLUTION_BIT1;
+    if (res & 0x1U)
+        reg.reg |= SHT21_MEAS_RESOLUTION_BIT2;
+    return reg;
+}
+
+/********************************************************************************************
+ *  Returns the maximum conversion time in ms from the datasheet for the measurement
+ *  command at the given resolution. Returns 0 for commands that are not measurements.
+ *
+ *  Resolution      Temp    RH
+ *  RH:12 T:14      85      29
+ *  RH:8  T:12      22      4
+ *  RH:10 T:13      43      9
+ *  RH:11 T:11      11      15
+ *******************************************************************************************/
+UInt8 SHT21_Conversion_Time(SHT21_Resolution_TypeDef res, SHT21_Commands_TypeDef cmd)
+{
+    static const UInt8 temp_time[4] = { 85U, 22U, 43U, 11U };
+    static const UInt8 rh_time[4]   = { 29U, 4U, 9U, 15U };
+
+    switch (cmd)
+    {
+        case SHT21_TEMP_MEASURE_HOLD:
+        case SHT21_TEMP_MEASURE:
+        return temp_time[res & 0x3U];
+        case SHT21_RH_MEASURE_HOLD:
+        case SHT21_RH_MEASURE:
+        return rh_time[res & 0x3U];
+        default:
+        return 0;
+    }
+}
+
+/********************************************************************************************
+ *  Starts a no hold master measurement. cmd is SHT21_TEMP_MEASURE or SHT21_RH_MEASURE.
+ *  Returns as soon as the command is written, the result is collected with
+ *  SHT21_Measure_Poll and SHT21_Measure_Complete.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Measure_Start(SHT21_Measurement_TypeDef* meas, SHT21_Bus_TypeDef* bus, SHT21_Commands_TypeDef cmd)
+{
+    SHT21_Request_TypeDef sht21_request = SHT21_Request_Buf(cmd);
+    UInt8 tx_buf = sht21_request.data.command;
+
+    meas->bus = bus;
+    meas->cmd = cmd;
+    meas->state = SHT21_MEASURE_IDLE;
+    meas->timeout = SHT21_MEASURE_TIMEOUT;
+    meas->length = SHT21_FRAME_LENGTH;
+
+    UInt32 write_start = SHT21_STATS_NOW(bus);
+    SHT21_Error_TypeDef status = bus->write(bus->handle, sht21_request.data.address, &tx_buf, 1);
+    SHT21_STATS_TRANSFER(bus, SHT21_STATS_COMMAND_WRITE, status, write_start);
+    if (status != SHT21_OK)
+        return status;
+
+    meas->start_tick = bus->get_tick(bus->handle);
+#ifdef SHT21_STATS
+    meas->start_us = SHT21_STATS_NOW(bus);
+#endif
+    meas->state = SHT21_MEASURE_CONVERTING;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Starts a measurement that reads only as much of the result as mode says, see
+ *  SHT21_Read_Mode_TypeDef. res is the active resolution.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Measure_Start_Mode(SHT21_Measurement_TypeDef* meas, SHT21_Bus_TypeDef* bus,
+                                             SHT21_Commands_TypeDef cmd, SHT21_Resolution_TypeDef res,
+                                             SHT21_Read_Mode_TypeDef mode)
+{
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(meas, bus, cmd);
+    meas->length = SHT21_Read_Length(mode, res, cmd);
+    return status;
+}
+
+/********************************************************************************************
+ *  Polls a started measurement. Tries to read the result, which the SHT21 NACKs until
+ *  the conversion is done. Returns SHT21_BUSY while converting, SHT21_OK when the result
+ *  is read and SHT21_TIME_OUT_ERROR if the sensor did not answer in time.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Measure_Poll(SHT21_Measurement_TypeDef* meas)
+{
+    if (meas->state == SHT21_MEASURE_READY)
+        return SHT21_OK;
+    if (meas->state != SHT21_MEASURE_CONVERTING) // No measurement started
+        return SHT21_ACK_ERROR;
+
+    SHT21_Bus_TypeDef* bus = meas->bus;
+    UInt32 read_start = SHT21_STATS_NOW(bus);
+    SHT21_Error_TypeDef status = bus->read(bus->handle, SHT21_I2C_ADDRESS, meas->frame, meas->length);
+
+    if (status == SHT21_OK)
+    {
+#ifdef SHT21_STATS
+        SHT21_STATS_LATENCY(bus, SHT21_STATS_CONVERSION, read_start - meas->start_us);
+#endif
+        SHT21_STATS_TRANSFER(bus, SHT21_STATS_READBACK, status, read_start);
+        meas->state = SHT21_MEASURE_READY;
+        return SHT21_OK;
+    }
+
+    // A NACK means the conversion is still running, anything else is a bus error
+    if (status == SHT21_ACK_ERROR &&
+        (UInt32)(bus->get_tick(bus->handle) - meas->start_tick) <= meas->timeout)
+    {
+        SHT21_STATS_COUNT(bus, SHT21_STATS_TRANSACTIONS);
+        SHT21_STATS_COUNT(bus, SHT21_STATS_BUSY_POLLS);
+        return SHT21_BUSY;
+    }
+
+    meas->state = SHT21_MEASURE_IDLE;
+    if (status == SHT21_ACK_ERROR)
+        status = SHT21_TIME_OUT_ERROR;
+    SHT21_STATS_TRANSFER(bus, SHT21_STATS_READBACK, status, read_start);
+    return status;
+}
+
+/********************************************************************************************
+ *  Parses the result of a finished measurement into value. Returns SHT21_BUSY if the
+ *  measurement is not finished, SHT21_CHECKSUM_ERROR if the frame is corrupt and
+ *  SHT21_UNIT_ERROR if the frame holds the other measurement.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Measure_Complete(SHT21_Measurement_TypeDef* meas, float* value)
+{
+    if (meas->state != SHT21_MEASURE_READY)
+        return SHT21_BUSY;
+
+    meas->state = SHT21_MEASURE_IDLE;
+    return SHT21_STATS_PARSED(meas->bus, SHT21_Parse_Frame(meas->frame, meas->length, meas->cmd, value));
+}
+
+/********************************************************************************************
+ *  Blocks until a started measurement is read. Sleeps for what is left of the
+ *  conversion time before polling, then polls once per ms until the SHT21 answers.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Measure_Wait(SHT21_Measurement_TypeDef* meas, UInt32 conversion_time)
+{
+    SHT21_Bus_TypeDef* bus = meas->bus;
+    UInt32 elapsed = bus->get_tick(bus->handle) - meas->start_tick;
+
+    if (elapsed < conversion_time)
+        bus->delay(bus->handle, conversion_time - elapsed);
+
+    SHT21_Error_TypeDef status = SHT21_Measure_Poll(meas);
+    while (status == SHT21_BUSY)
+    {
+        bus->delay(bus->handle, 1);
+        status = SHT21_Measure_Poll(meas);
+    }
+    return status;
+}
+
+/********************************************************************************************
+ *  Measures temperature and humidity in one go. The humidity conversion is started as
+ *  soon as the temperature is read, and the temperature frame is checked and converted
+ *  while the humidity conversion runs.
+ *******************************************************************************************/
+SHT21_Sample_TypeDef SHT21_Measure_Both(SHT21_Bus_TypeDef* bus, SHT21_Resolution_TypeDef res)
+{
+    return SHT21_Measure_Both_Mode(bus, res, SHT21_READ_FULL, SHT21_READ_FULL);
+}
+
+/********************************************************************************************
+ *  SHT21_Measure_Both reading only as much of each result as its mode says
+ *******************************************************************************************/
+SHT21_Sample_TypeDef SHT21_Measure_Both_Mode(SHT21_Bus_TypeDef* bus, SHT21_Resolution_TypeDef res,
+                                             SHT21_Read_Mode_TypeDef temp_mode, SHT21_Read_Mode_TypeDef rh_mode)
+{
+    SHT21_Sample_Ticks_TypeDef ticks;
+    return SHT21_Measure_Both_Ticks(bus, res, temp_mode, rh_mode, &ticks);
+}
+
+/********************************************************************************************
+ *  SHT21_Measure_Both_Mode that also returns the tick each frame was read at, the
+ *  temperature is read a humidity conversion before the humidity.
+ *******************************************************************************************/
+SHT21_Sample_TypeDef SHT21_Measure_Both_Ticks(SHT21_Bus_TypeDef* bus, SHT21_Resolution_TypeDef res,
+                                              SHT21_Read_Mode_TypeDef temp_mode, SHT21_Read_Mode_TypeDef rh_mode,
+                                              SHT21_Sample_Ticks_TypeDef* ticks)
+{
+    SHT21_Sample_TypeDef sample = {0};
+    SHT21_Measurement_TypeDef temp_meas;
+    SHT21_Measurement_TypeDef rh_meas;
+
+    *ticks = (SHT21_Sample_Ticks_TypeDef){0};
+    sample.status = SHT21_Measure_Start_Mode(&temp_meas, bus, SHT21_TEMP_MEASURE, res, temp_mode);
+    if (sample.status != SHT21_OK)
+        return sample;
+
+    sample.status = SHT21_Measure_Wait(&temp_meas, SHT21_Conversion_Time(res, SHT21_TEMP_MEASURE));
+    if (sample.status != SHT21_OK)
+        return sample;
+    ticks->temp_tick = bus->get_tick(bus->handle);
+
+    // Start the humidity conversion before handling the temperature frame
+    sample.status = SHT21_Measure_Start_Mode(&rh_meas, bus, SHT21_RH_MEASURE, res, rh_mode);
+    if (sample.status != SHT21_OK)
+        return sample;
+
+    SHT21_Error_TypeDef temp_status = SHT21_Measure_Complete(&temp_meas, &sample.temp);
+    ticks->temp_valid = (temp_status == SHT21_OK);
+
+    sample.status = SHT21_Measure_Wait(&rh_meas, SHT21_Conversion_Time(res, SHT21_RH_MEASURE));
+    if (sample.status != SHT21_OK)
+        return sample;
+    ticks->humidity_tick = bus->get_tick(bus->handle);
+
+    sample.status = SHT21_Measure_Complete(&rh_meas, &sample.humidity);
+    ticks->humidity_valid = (sample.status == SHT21_OK);
+    if (temp_status != SHT21_OK)
+        sample.status = temp_status;
+
+    return sample;
+}
+
+
+/********************************************************************************************
+ *  Starts waiting for the sensor to answer, window is SHT21_POWER_UP_TIME right after
+ *  power up or SHT21_SOFT_RESET_TIME after a soft reset. Start it when the sensor gets
+ *  power, or as early as possible in the boot.
+ *******************************************************************************************/
+void SHT21_Ready_Start(SHT21_Ready_TypeDef* ready, SHT21_Bus_TypeDef* bus, UInt32 window)
+{
+    ready->bus = bus;
+    ready->start_tick = bus->get_tick(bus->handle);
+    ready->window = window;
+    ready->ready_ms = 0;
+    ready->probes = 0;
+    ready->ready = 0;
+    ready->user_reg.reg = 0;
+}
+
+/********************************************************************************************
+ *  Probes the sensor by reading the user register. Returns SHT21_OK once it answered,
+ *  SHT21_BUSY while it still NACKs within the window and SHT21_TIME_OUT_ERROR if it has
+ *  not answered at twice the datasheet maximum. Does not touch the bus once ready.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Ready_Poll(SHT21_Ready_TypeDef* ready)
+{
+    if (ready->ready)
+        return SHT21_OK;
+
+    SHT21_Bus_TypeDef* bus = ready->bus;
+    UInt8 buf = SHT21_READ_USER_REG;
+
+    ready->probes++;
+    SHT21_Error_TypeDef status = bus->write(bus->handle, SHT21_I2C_ADDRESS, &buf, 1);
+    if (status == SHT21_OK)
+        status = bus->read(bus->handle, SHT21_I2C_ADDRESS, &buf, 1);
+
+    UInt32 elapsed = bus->get_tick(bus->handle) - ready->start_tick;
+    if (status == SHT21_OK)
+    {
+        ready->ready = 1;
+        ready->ready_ms = elapsed;
+        ready->user_reg = SHT21_Parse_User_Reg(&buf);
+        return SHT21_OK;
+    }
+
+    if (status == SHT21_ACK_ERROR && elapsed <= 2U * ready->window)
+        return SHT21_BUSY;
+    return (status == SHT21_ACK_ERROR) ? SHT21_TIME_OUT_ERROR : status;
+}
+
+/********************************************************************************************
+ *  Blocks until the sensor answers, probing once per ms
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Ready_Wait(SHT21_Ready_TypeDef* ready)
+{
+    SHT21_Error_TypeDef status = SHT21_Ready_Poll(ready);
+    while (status == SHT21_BUSY)
+    {
+        ready->bus->delay(ready->bus->handle, 1);
+        status = SHT21_Ready_Poll(ready);
+    }
+    return status;
+}
+
+/********************************************************************************************
+ *  Sends a soft reset and starts waiting for the sensor to answer again. The user
+ *  register goes back to default, except the heater bit.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Soft_Reset(SHT21_Ready_TypeDef* ready, SHT21_Bus_TypeDef* bus)
+{
+    UInt8 buf = SHT21_SOFT_RESET;
+    SHT21_Error_TypeDef status = bus->write(bus->handle, SHT21_I2C_ADDRESS, &buf, 1);
+    if (status != SHT21_OK)
+        return status;
+
+    SHT21_Ready_Start(ready, bus, SHT21_SOFT_RESET_TIME);
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Runs the temperature and then the humidity half of a selftest reading, one bus
+ *  transfer per call. Returns SHT21_BUSY until both are in test->temp and
+ *  test->humidity.
+ *******************************************************************************************/
+static SHT21_Error_TypeDef SHT21_Selftest_Measure(SHT21_Selftest_TypeDef* test)
+{
+    SHT21_Commands_TypeDef cmd = test->humidity_half ? SHT21_RH_MEASURE : SHT21_TEMP_MEASURE;
+    SHT21_Error_TypeDef status;
+
+    if (test->meas.state == SHT21_MEASURE_IDLE)
+    {
+        status = SHT21_Measure_Start(&test->meas, test->bus, cmd);
+        test->wait = SHT21_Conversion_Time(test->resolution, cmd);
+        return (status == SHT21_OK) ? SHT21_BUSY : status;
+    }
+
+    status = SHT21_Measure_Poll(&test->meas);
+    if (status == SHT21_BUSY)
+        test->wait = 1;
+    if (status != SHT21_OK)
+        return status;
+
+    status = SHT21_Measure_Complete(&test->meas, test->humidity_half ? &test->humidity : &test->temp);
+    if (status != SHT21_OK)
+        return status;
+
+    // Start the humidity conversion at once
+    if (!test->humidity_half)
+    {
+        test->humidity_half = 1;
+        return SHT21_Selftest_Measure(test);
+    }
+    test->humidity_half = 0;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Ends the test with result, writing back the user register if the heater may be on.
+ *  A sensor may not take the write while converting, so with a conversion running the
+ *  restore starts once it is done.
+ *******************************************************************************************/
+static void SHT21_Selftest_Finish(SHT21_Selftest_TypeDef* test, SHT21_Error_TypeDef result, UInt8 restore)
+{
+    test->result = result;
+    test->state = restore ? SHT21_SELFTEST_RESTORE : SHT21_SELFTEST_DONE;
+    test->wait = 0;
+    if (!restore)
+        return;
+
+    SHT21_Bus_TypeDef* bus = test->bus;
+    test->restore_tick = bus->get_tick(bus->handle);
+    if (test->meas.state == SHT21_MEASURE_CONVERTING)
+    {
+        UInt32 elapsed = test->restore_tick - test->meas.start_tick;
+        UInt32 conversion = SHT21_Conversion_Time(test->resolution, test->meas.cmd);
+        if (elapsed < conversion)
+        {
+            test->wait = conversion - elapsed;
+            test->restore_tick += test->wait;
+        }
+    }
+}
+
+/********************************************************************************************
+ *  Starts a selftest, run it with SHT21_Selftest_Step. The test fails if the heater
+ *  has not shown its effect deadline ms after it was turned on, 0 uses
+ *  SHT21_SELFTEST_DEADLINE. No other transfers may be made to the sensor until the
+ *  test is done.
+ *
+ *  It is important the chip is at a stable temperature before starting this test.
+ *******************************************************************************************/
+void SHT21_Selftest_Start(SHT21_Selftest_TypeDef* test, SHT21_Bus_TypeDef* bus, UInt32 deadline)
+{
+    test->bus = bus;
+    test->state = SHT21_SELFTEST_READ_REG;
+    test->meas.state = SHT21_MEASURE_IDLE;
+    test->deadline = (deadline != 0) ? deadline : SHT21_SELFTEST_DEADLINE;
+    test->wait = 0;
+    test->readings = 0;
+    test->humidity_half = 0;
+    test->restore_attempts = 0;
+    test->result = SHT21_BUSY;
+}
+
+/********************************************************************************************
+ *  Does the next part of a selftest, at most a few short transfers, and returns
+ *  SHT21_BUSY while the test runs. Call it again after test->wait ms, calling it
+ *  earlier is harmless. Returns SHT21_OK as soon as the heater has raised the
+ *  temperature and lowered the humidity by the thresholds, SHT21_SELFTEST_FAILED at
+ *  the deadline, or the bus error that stopped the test. A finished test keeps
+ *  returning its result. A test that was never started returns SHT21_UNIT_ERROR, the
+ *  same code a reading of the wrong kind stops a test with, test->state tells them
+ *  apart: SHT21_SELFTEST_IDLE for never started, SHT21_SELFTEST_DONE for finished.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Selftest_Step(SHT21_Selftest_TypeDef* test)
+{
+    SHT21_Bus_TypeDef* bus = test->bus;
+    SHT21_Error_TypeDef status;
+    UInt8 buf[2];
+    UInt32 now;
+
+    switch (test->state)
+    {
+        case SHT21_SELFTEST_READ_REG:
+        buf[0] = SHT21_READ_USER_REG;
+        status = bus->write(bus->handle, SHT21_I2C_ADDRESS, buf, 1);
+        if (status == SHT21_OK)
+            status = bus->read(bus->handle, SHT21_I2C_ADDRESS, buf, 1);
+        if (status != SHT21_OK)
+        {
+            SHT21_Selftest_Finish(test, status, 0);
+            break;
+        }
+        test->user_reg = SHT21_Parse_User_Reg(buf);
+        test->resolution = SHT21_Get_Resolution(test->user_reg);
+        test->state = SHT21_SELFTEST_BASELINE;
+        return SHT21_Selftest_Step(test);
+
+        case SHT21_SELFTEST_BASELINE:
+        status = SHT21_Selftest_Measure(test);
+        if (status == SHT21_BUSY)
+            return SHT21_BUSY;
+        if (status != SHT21_OK)
+        {
+            SHT21_Selftest_Finish(test, status, 0);
+            break;
+        }
+        test->temp_start = test->temp;
+        test->humidity_start = test->humidity;
+        test->state = SHT21_SELFTEST_HEATER_ON;
+        return SHT21_Selftest_Step(test);
+
+        case SHT21_SELFTEST_HEATER_ON:
+        buf[0] = SHT21_WRITE_USER_REG;
+        buf[1] = SHT21_Update_User_Reg_Fields(test->user_reg, SHT21_ENABLE_CHIP_HEATER, SHT21_ENABLE_CHIP_HEATER).reg;
+        status = bus->write(bus->handle, SHT21_I2C_ADDRESS, buf, 2);
+        if (status != SHT21_OK)
+        {
+            SHT21_Selftest_Finish(test, status, 1); // The write may still have reached the sensor
+            break;
+        }
+        test->heater_tick = bus->get_tick(bus->handle);
+        test->next_tick = test->heater_tick;
+        test->state = SHT21_SELFTEST_HEATING;
+        return SHT21_Selftest_Step(test);
+
+        case SHT21_SELFTEST_HEATING:
+        now = bus->get_tick(bus->handle);
+        if (test->meas.state == SHT21_MEASURE_IDLE && !test->humidity_half)
+        {
+            if ((UInt32)(now - test->heater_tick) >= test->deadline)
+            {
+                SHT21_Selftest_Finish(test, SHT21_SELFTEST_FAILED, 1);
+                break;
+            }
+            if ((Int32)(test->next_tick - now) > 0)
+            {
+                test->wait = test->next_tick - now;
+                return SHT21_BUSY;
+            }
+            test->next_tick += SHT21_SELFTEST_INTERVAL;
+        }
+
+        status = SHT21_Selftest_Measure(test);
+        if (status == SHT21_BUSY)
+            return SHT21_BUSY;
+        if (status != SHT21_OK)
+        {
+            SHT21_Selftest_Finish(test, status, 1);
+            break;
+        }
+        test->readings++;
+        if (test->temp - test->temp_start > SHT21_SELFTEST_TEMP_THRESHOLD &&
+            test->humidity_start - test->humidity > SHT21_SELFTEST_HUM_THRESHOLD)
+        {
+            SHT21_Selftest_Finish(test, SHT21_OK, 1);
+            break;
+        }
+        return SHT21_Selftest_Step(test);
+
+        default:
+        break;
+    }
+
+    if (test->state == SHT21_SELFTEST_RESTORE)
+    {
+        now = bus->get_tick(bus->handle);
+        if ((Int32)(test->restore_tick - now) > 0)
+        {
+            test->wait = test->restore_tick - now;
+            return SHT21_BUSY;
+        }
+
+        // Retried for as long as a measurement may keep the sensor from answering
+        buf[0] = SHT21_WRITE_USER_REG;
+        buf[1] = test->user_reg.reg;
+        status = bus->write(bus->handle, SHT21_I2C_ADDRESS, buf, 2);
+        if (status != SHT21_OK && test->restore_attempts < SHT21_SELFTEST_RESTORE_ATTEMPTS)
+            test->restore_attempts++;
+        if (status != SHT21_OK && (test->restore_attempts < SHT21_SELFTEST_RESTORE_ATTEMPTS ||
+                                   (UInt32)(now - test->restore_tick) < SHT21_MEASURE_TIMEOUT))
+        {
+            test->wait = 1;
+            return SHT21_BUSY;
+        }
+        if (status != SHT21_OK)
+            test->result = status;
+        test->state = SHT21_SELFTEST_DONE;
+    }
+
+    if (test->state != SHT21_SELFTEST_DONE)
+        return SHT21_UNIT_ERROR; // Not started
+    return test->result;
+}
+
+/********************************************************************************************
+ *  Stops a running selftest with SHT21_SELFTEST_FAILED. If the heater was turned on
+ *  the steps still write back the user register, after a conversion that is running
+ *  has finished. Step after test->wait until it stops returning SHT21_BUSY.
+ *******************************************************************************************/
+void SHT21_Selftest_Abort(SHT21_Selftest_TypeDef* test)
+{
+    switch (test->state)
+    {
+        case SHT21_SELFTEST_READ_REG:
+        case SHT21_SELFTEST_BASELINE:
+        case SHT21_SELFTEST_HEATER_ON:
+        SHT21_Selftest_Finish(test, SHT21_SELFTEST_FAILED, 0);
+        break;
+        case SHT21_SELFTEST_HEATING:
+        SHT21_Selftest_Finish(test, SHT21_SELFTEST_FAILED, 1);
+        break;
+        default:
+        break;
+    }
+    test->meas.state = SHT21_MEASURE_IDLE;
+}
+
+/********************************************************************************************
+ *  Runs a whole selftest, sleeping with the bus delay between the steps
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Selftest_Run(SHT21_Selftest_TypeDef* test, SHT21_Bus_TypeDef* bus, UInt32 deadline)
+{
+    SHT21_Selftest_Start(test, bus, deadline);
+
+    SHT21_Error_TypeDef status = SHT21_Selftest_Step(test);
+    while (status == SHT21_BUSY)
+    {
+        if (test->wait > 0)
+            bus->delay(bus->handle, test->wait);
+        status = SHT21_Selftest_Step(test);
+    }
+    return status;
+}
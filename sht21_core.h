@@ -13,6 +13,8 @@
 #define UInt32 		unsigned int
 #define UInt16 		unsigned short
 #define UInt8 		unsigned char
+#define Int32 		signed int
+#define Int16 		signed short
 
 #define SHT21_I2C_ADDRESS           (0x40U)
 #define SHT21_I2C_READ_BIT          (1U)
@@ -24,9 +26,38 @@
 #define SHT21_STATUS                (1U << 6U)
 #define SHT21_ENABLE_CHIP_HEATER    (1U << 2U)
 #define SHT21_DISABLE_OTP_RELOAD    (1U << 1U)
+#define SHT21_USER_REG_WRITABLE     (SHT21_MEAS_RESOLUTION_BIT1 | SHT21_MEAS_RESOLUTION_BIT2 | \
+                                     SHT21_ENABLE_CHIP_HEATER | SHT21_DISABLE_OTP_RELOAD)
 
 #define SHT21_CRC_POLYNOMIAL        (0x131)  //P(x)=x^8+x^5+x^4+1 = 100110001
 
+// Measurement result: MSB, LSB with the status bits, CRC. Bit 1 of the LSB is set for RH.
+#define SHT21_FRAME_LENGTH          (3U)
+#define SHT21_STATUS_RH             (1U << 1U)
+
+// Time in ms before a no hold master measurement that is still NACKed is given up
+#define SHT21_MEASURE_TIMEOUT       (100U)
+
+// Datasheet maximum in ms from power up or a soft reset until the sensor answers
+#define SHT21_POWER_UP_TIME         (15U)
+#define SHT21_SOFT_RESET_TIME       (15U)
+
+// Selftest: minimum temperature rise in C and humidity drop in %RH with the heater on
+#ifndef SHT21_SELFTEST_TEMP_THRESHOLD
+#define SHT21_SELFTEST_TEMP_THRESHOLD   (0.3f)
+#endif
+#ifndef SHT21_SELFTEST_HUM_THRESHOLD
+#define SHT21_SELFTEST_HUM_THRESHOLD    (0.5f)
+#endif
+// Selftest: time in ms with the heater on before the test fails, and between readings
+#ifndef SHT21_SELFTEST_DEADLINE
+#define SHT21_SELFTEST_DEADLINE         (10000U)
+#endif
+#ifndef SHT21_SELFTEST_INTERVAL
+#define SHT21_SELFTEST_INTERVAL         (200U)
+#endif
+#define SHT21_SELFTEST_RESTORE_ATTEMPTS (3U)
+
 /********************************************************************************************
  *  User Register of the SHT21 module. Unioned for direct register access.
  * 
@@ -60,6 +91,17 @@ typedef union
     UInt8 reg;
 } SHT21_User_Reg_TypeDef;
 
+/********************************************************************************************
+ *  Measurement resolutions, the value of the resolution bits 7,0 of the user register
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_RES_RH12_T14          = (0x00U),
+    SHT21_RES_RH8_T12           = (0x01U),
+    SHT21_RES_RH10_T13          = (0x02U),
+    SHT21_RES_RH11_T11          = (0x03U)
+} SHT21_Resolution_TypeDef;
+
 typedef union
 {
     struct
@@ -95,17 +137,229 @@ typedef enum
     SHT21_TIME_OUT_ERROR        = (0x02U),
     SHT21_CHECKSUM_ERROR        = (0x04U),
     SHT21_UNIT_ERROR            = (0x08U),
-    SHT21_SELFTEST_FAILED       = (0x09U)
+    SHT21_SELFTEST_FAILED       = (0x09U),
+    SHT21_BUSY                  = (0x10U)
 } SHT21_Error_TypeDef;
 
+/********************************************************************************************
+ *  I2C bus used by the transaction functions of the core. Implemented by the platform
+ *  glue, see the examples. Addresses are passed as 7 bit addresses.
+ *
+ *  write       : Writes len bytes to the device
+ *  read        : Reads len bytes from the device, returns SHT21_ACK_ERROR if the device
+ *                NACKs its address
+ *  get_tick    : Returns a free running millisecond tick
+ *  delay       : Waits the given number of ms, used by the blocking functions
+ *  handle      : Passed to the functions above, typically the I2C handler
+ *  stats       : Only with SHT21_STATS, counters of the transactions or 0, see sht21_stats.h
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Error_TypeDef (*write)(void* handle, UInt8 address, UInt8* buf, UInt8 len);
+    SHT21_Error_TypeDef (*read)(void* handle, UInt8 address, UInt8* buf, UInt8 len);
+    UInt32 (*get_tick)(void* handle);
+    void (*delay)(void* handle, UInt32 ms);
+    void* handle;
+#ifdef SHT21_STATS
+    struct SHT21_Stats* stats;
+#endif
+} SHT21_Bus_TypeDef;
+
+/********************************************************************************************
+ *  States of a no hold master measurement
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_MEASURE_IDLE          = (0x00U),
+    SHT21_MEASURE_CONVERTING    = (0x01U),
+    SHT21_MEASURE_READY         = (0x02U)
+} SHT21_Measure_State_TypeDef;
+
+/********************************************************************************************
+ *  How much of a measurement result is read, the master may NACK after any byte.
+ *  Without the CRC a corrupt frame is not detected, only a reading of the wrong kind,
+ *  which is reported as SHT21_UNIT_ERROR. At RH8 all bits of the humidity are in the
+ *  MSB.
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_READ_FULL             = (0x00U),  // MSB, LSB and CRC
+    SHT21_READ_NO_CRC           = (0x01U),  // MSB and LSB
+    SHT21_READ_MSB              = (0x02U)   // MSB of a RH8 humidity, else as SHT21_READ_NO_CRC
+} SHT21_Read_Mode_TypeDef;
+
+/********************************************************************************************
+ *  A no hold master measurement in progress. The sensor NACKs reads until the
+ *  conversion is finished, so the bus is free for other work in the meantime.
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Bus_TypeDef* bus;
+    SHT21_Commands_TypeDef cmd;
+    SHT21_Measure_State_TypeDef state;
+    UInt32 start_tick;
+    UInt32 timeout;
+    UInt8 frame[SHT21_FRAME_LENGTH];
+    UInt8 length;
+#ifdef SHT21_STATS
+    UInt32 start_us;
+#endif
+} SHT21_Measurement_TypeDef;
+
+/********************************************************************************************
+ *  Waiting for the sensor to answer after power up or a soft reset. The user register
+ *  is probed until the sensor ACKs, so the first measurement can go out as soon as it
+ *  is ready instead of after a fixed delay.
+ *
+ *  window      : Datasheet maximum in ms, the sensor is given up at twice this
+ *  ready       : 1 once the sensor answered, user_reg holds the register it returned
+ *  ready_ms    : ms from the start until the sensor answered
+ *  probes      : Probes made, including the one that got an answer
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Bus_TypeDef* bus;
+    UInt32 start_tick;
+    UInt32 window;
+    UInt32 ready_ms;
+    UInt32 probes;
+    UInt8 ready;
+    SHT21_User_Reg_TypeDef user_reg;
+} SHT21_Ready_TypeDef;
+
+/********************************************************************************************
+ *  States of a selftest
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_SELFTEST_IDLE         = (0x00U),
+    SHT21_SELFTEST_READ_REG     = (0x01U),
+    SHT21_SELFTEST_BASELINE     = (0x02U),
+    SHT21_SELFTEST_HEATER_ON    = (0x03U),
+    SHT21_SELFTEST_HEATING      = (0x04U),
+    SHT21_SELFTEST_RESTORE      = (0x05U),
+    SHT21_SELFTEST_DONE         = (0x06U)
+} SHT21_Selftest_State_TypeDef;
+
+/********************************************************************************************
+ *  A selftest in progress, driven by SHT21_Selftest_Step. Takes a baseline reading,
+ *  turns the heater on and keeps reading every SHT21_SELFTEST_INTERVAL ms until the
+ *  temperature has risen and the humidity has dropped by the thresholds, or the
+ *  deadline has passed. The user register read at the start is written back at the
+ *  end, whatever the outcome. A failed write back is retried for at least
+ *  SHT21_SELFTEST_RESTORE_ATTEMPTS tries and SHT21_MEASURE_TIMEOUT ms.
+ *
+ *  wait        : ms until the next step has work to do
+ *  readings    : Readings taken with the heater on
+ *  temp_start  : Baseline, temp and humidity hold the last reading
+ *  restore_tick: Tick of the first write back
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Bus_TypeDef* bus;
+    SHT21_Selftest_State_TypeDef state;
+    SHT21_Measurement_TypeDef meas;
+    SHT21_User_Reg_TypeDef user_reg;
+    SHT21_Resolution_TypeDef resolution;
+    UInt32 deadline;
+    UInt32 heater_tick;
+    UInt32 next_tick;
+    UInt32 wait;
+    UInt32 readings;
+    UInt32 restore_tick;
+    UInt8 humidity_half;
+    UInt8 restore_attempts;
+    float temp_start;
+    float humidity_start;
+    float temp;
+    float humidity;
+    SHT21_Error_TypeDef result;
+} SHT21_Selftest_TypeDef;
+
+/********************************************************************************************
+ *  A temperature and humidity sample. status is SHT21_OK or the first error that
+ *  occured, the values are only valid with SHT21_OK.
+ *******************************************************************************************/
+typedef struct
+{
+    float temp;
+    float humidity;
+    SHT21_Error_TypeDef status;
+} SHT21_Sample_TypeDef;
+
+/********************************************************************************************
+ *  When the frames of a sample were read. A value is only marked valid if its frame
+ *  parsed, even if the sample as a whole failed.
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 temp_tick;
+    UInt32 humidity_tick;
+    UInt8 temp_valid;
+    UInt8 humidity_valid;
+} SHT21_Sample_Ticks_TypeDef;
+
+/*
+ *  Instrumentation of the bus transactions, empty unless SHT21_STATS is defined
+ */
+#ifdef SHT21_STATS
+#include "sht21_stats.h"
+#define SHT21_STATS_NOW(bus)                        SHT21_Stats_Now((bus)->stats)
+#define SHT21_STATS_COUNT(bus, counter)             SHT21_Stats_Count((bus)->stats, counter)
+#define SHT21_STATS_LATENCY(bus, latency, us)       SHT21_Stats_Latency((bus)->stats, latency, us)
+#define SHT21_STATS_TRANSFER(bus, latency, status, start) SHT21_Stats_Transfer((bus)->stats, latency, status, start)
+#define SHT21_STATS_PARSED(bus, status)             SHT21_Stats_Parsed((bus)->stats, status)
+#define SHT21_STATS_ATTACH(bus, sensor_stats)       ((bus)->stats = (sensor_stats))
+#else
+#define SHT21_STATS_NOW(bus)                        (0U)
+#define SHT21_STATS_COUNT(bus, counter)             ((void)0)
+#define SHT21_STATS_LATENCY(bus, latency, us)       ((void)(us))
+#define SHT21_STATS_TRANSFER(bus, latency, status, start) ((void)(start))
+#define SHT21_STATS_PARSED(bus, status)             (status)
+#define SHT21_STATS_ATTACH(bus, sensor_stats)       ((void)0)
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+UInt16 SHT21_Check_Crc(UInt8* buf, UInt8 length, UInt8 checksum);
 SHT21_Request_TypeDef SHT21_Request_Buf(SHT21_Commands_TypeDef cmd);
+float SHT21_Convert_Temp(UInt16 reading);
+float SHT21_Convert_RH(UInt16 reading);
 float SHT21_Parse_Temp(UInt8* buf);
 float SHT21_Parse_RH(UInt8* buf);
+SHT21_Error_TypeDef SHT21_Parse_Reading(UInt8* buf, UInt16* reading);
+SHT21_Error_TypeDef SHT21_Parse_Temp_Checked(UInt8* buf, float* temp);
+SHT21_Error_TypeDef SHT21_Parse_RH_Checked(UInt8* buf, float* humidity);
+SHT21_Error_TypeDef SHT21_Parse_Frame(UInt8* buf, UInt8 length, SHT21_Commands_TypeDef cmd, float* value);
+UInt8 SHT21_Read_Length(SHT21_Read_Mode_TypeDef mode, SHT21_Resolution_TypeDef res, SHT21_Commands_TypeDef cmd);
 SHT21_User_Reg_TypeDef SHT21_Parse_User_Reg(UInt8* buf);
+SHT21_User_Reg_TypeDef SHT21_Update_User_Reg_Fields(SHT21_User_Reg_TypeDef reg, UInt8 mask, UInt8 value);
+SHT21_Resolution_TypeDef SHT21_Get_Resolution(SHT21_User_Reg_TypeDef reg);
+SHT21_User_Reg_TypeDef SHT21_Set_Resolution(SHT21_User_Reg_TypeDef reg, SHT21_Resolution_TypeDef res);
+UInt8 SHT21_Conversion_Time(SHT21_Resolution_TypeDef res, SHT21_Commands_TypeDef cmd);
+SHT21_Error_TypeDef SHT21_Measure_Start(SHT21_Measurement_TypeDef* meas, SHT21_Bus_TypeDef* bus, SHT21_Commands_TypeDef cmd);
+SHT21_Error_TypeDef SHT21_Measure_Start_Mode(SHT21_Measurement_TypeDef* meas, SHT21_Bus_TypeDef* bus,
+                                             SHT21_Commands_TypeDef cmd, SHT21_Resolution_TypeDef res,
+                                             SHT21_Read_Mode_TypeDef mode);
+SHT21_Error_TypeDef SHT21_Measure_Poll(SHT21_Measurement_TypeDef* meas);
+SHT21_Error_TypeDef SHT21_Measure_Complete(SHT21_Measurement_TypeDef* meas, float* value);
+SHT21_Error_TypeDef SHT21_Measure_Wait(SHT21_Measurement_TypeDef* meas, UInt32 conversion_time);
+SHT21_Sample_TypeDef SHT21_Measure_Both(SHT21_Bus_TypeDef* bus, SHT21_Resolution_TypeDef res);
+SHT21_Sample_TypeDef SHT21_Measure_Both_Mode(SHT21_Bus_TypeDef* bus, SHT21_Resolution_TypeDef res,
+                                             SHT21_Read_Mode_TypeDef temp_mode, SHT21_Read_Mode_TypeDef rh_mode);
+SHT21_Sample_TypeDef SHT21_Measure_Both_Ticks(SHT21_Bus_TypeDef* bus, SHT21_Resolution_TypeDef res,
+                                              SHT21_Read_Mode_TypeDef temp_mode, SHT21_Read_Mode_TypeDef rh_mode,
+                                              SHT21_Sample_Ticks_TypeDef* ticks);
+void SHT21_Ready_Start(SHT21_Ready_TypeDef* ready, SHT21_Bus_TypeDef* bus, UInt32 window);
+SHT21_Error_TypeDef SHT21_Ready_Poll(SHT21_Ready_TypeDef* ready);
+SHT21_Error_TypeDef SHT21_Ready_Wait(SHT21_Ready_TypeDef* ready);
+SHT21_Error_TypeDef SHT21_Soft_Reset(SHT21_Ready_TypeDef* ready, SHT21_Bus_TypeDef* bus);
+void SHT21_Selftest_Start(SHT21_Selftest_TypeDef* test, SHT21_Bus_TypeDef* bus, UInt32 deadline);
+SHT21_Error_TypeDef SHT21_Selftest_Step(SHT21_Selftest_TypeDef* test);
+void SHT21_Selftest_Abort(SHT21_Selftest_TypeDef* test);
+SHT21_Error_TypeDef SHT21_Selftest_Run(SHT21_Selftest_TypeDef* test, SHT21_Bus_TypeDef* bus, UInt32 deadline);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,404 @@
+/********************************************************************************************
+ *  Filename: sht21_coro.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Header only C++20 coroutine API for driving many sensors from one thread.
+ *  Sht21_Async runs the no hold measurement, the selftest and the readiness probe of
+ *  the C core as coroutines that suspend while the sensor converts, heats or starts
+ *  up, instead of blocking in bus->delay:
+ *
+ *      Sht21_Task<SHT21_Error_TypeDef> sensor_loop(Sht21_Executor& executor, Sht21_Async& sensor)
+ *      {
+ *          UInt32 next = executor.now();
+ *          for (;;)
+ *          {
+ *              co_await executor.sleep_until(next += 1000U);
+ *              SHT21_Sample_TypeDef sample = co_await sensor.measure();
+ *              ...
+ *          }
+ *      }
+ *
+ *      executor.spawn(sensor_loop(executor, sensor));
+ *      executor.run();
+ *
+ *  Sht21_Executor is single threaded. Suspended coroutines wait on a timer wheel with
+ *  1 ms slots and are resumed by run() in the order they became due. It takes its time
+ *  from the get_tick and delay of a SHT21_Bus_TypeDef, which must count the same ms as
+ *  the buses of the sensors, and sleeps in delay when nothing is due.
+ *
+ *  The bus transfers themselves are synchronous, as in SHT21_Bus_TypeDef, so a coroutine
+ *  only suspends between them. Every call allocates a coroutine frame.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_CORO__H
+#define __SHT21_CORO__H
+
+#include "sht21_core.h"
+
+#include <coroutine>
+#include <exception>
+
+#ifndef SHT21_CORO_WHEEL_SLOTS
+#define SHT21_CORO_WHEEL_SLOTS      (256U)      // Power of 2, 1 ms each
+#endif
+
+template <class T> class Sht21_Task;
+
+/********************************************************************************************
+ *  A suspended coroutine, on the ready queue or in a slot of the timer wheel
+ *******************************************************************************************/
+struct Sht21_Coro_Node
+{
+  std::coroutine_handle<> handle;
+  UInt32 due;
+  Sht21_Coro_Node* next;
+};
+
+/********************************************************************************************
+ *  Single threaded executor with a timer wheel
+ *******************************************************************************************/
+class Sht21_Executor
+{
+public:
+  explicit Sht21_Executor(SHT21_Bus_TypeDef* clock) : clock(clock), tick(clock->get_tick(clock->handle)) {}
+
+  Sht21_Executor(const Sht21_Executor&) = delete;
+  Sht21_Executor& operator=(const Sht21_Executor&) = delete;
+
+  UInt32 now() { return clock->get_tick(clock->handle); }
+
+  // Tasks spawned and not finished
+  UInt32 pending() const { return tasks; }
+
+  /********************************************************************************************
+   *  Awaitable that resumes the coroutine when the tick reaches due
+   *******************************************************************************************/
+  class Sleep
+  {
+  public:
+    Sleep(Sht21_Executor* executor, UInt32 due) : executor(executor) { node.due = due; }
+
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      node.handle = handle;
+      executor->add_timer(&node);
+    }
+    void await_resume() {}
+
+  private:
+    Sht21_Executor* executor;
+    Sht21_Coro_Node node;
+  };
+
+  Sleep sleep(UInt32 ms) { return Sleep(this, now() + ms); }
+  Sleep sleep_until(UInt32 due) { return Sleep(this, due); }
+
+  /********************************************************************************************
+   *  Takes over a task and queues it to start in run(). The frame is freed when the
+   *  task returns, its result is dropped.
+   *******************************************************************************************/
+  template <class T>
+  void spawn(Sht21_Task<T> task)
+  {
+    auto handle = task.release();
+    handle.promise().executor = this;
+    handle.promise().node.handle = handle;
+    tasks++;
+    post(&handle.promise().node);
+  }
+
+  /********************************************************************************************
+   *  Resumes coroutines as they become due until every spawned task has returned, or
+   *  until the remaining ones wait on nothing the executor can resume
+   *******************************************************************************************/
+  void run()
+  {
+    while (tasks != 0)
+    {
+      while (ready_head != nullptr)
+      {
+        Sht21_Coro_Node* node = ready_head;
+        ready_head = node->next;
+        if (ready_head == nullptr)
+          ready_tail = nullptr;
+        node->handle.resume();
+      }
+
+      advance();
+      if (ready_head != nullptr)
+        continue;
+      if (timers == 0)
+        return;
+      idle();
+    }
+  }
+
+  // Called by a spawned task when it returns
+  void finished() { tasks--; }
+
+private:
+  static constexpr UInt32 wheel_mask = SHT21_CORO_WHEEL_SLOTS - 1U;
+  static_assert((SHT21_CORO_WHEEL_SLOTS & wheel_mask) == 0, "SHT21_CORO_WHEEL_SLOTS must be a power of 2");
+
+  SHT21_Bus_TypeDef* clock;
+  UInt32 tick;                  // Every slot up to tick has been fired
+  UInt32 tasks = 0;
+  UInt32 timers = 0;
+  Sht21_Coro_Node* ready_head = nullptr;
+  Sht21_Coro_Node* ready_tail = nullptr;
+  Sht21_Coro_Node* wheel[SHT21_CORO_WHEEL_SLOTS] = {};
+
+  void post(Sht21_Coro_Node* node)
+  {
+    node->next = nullptr;
+    if (ready_tail != nullptr)
+      ready_tail->next = node;
+    else
+      ready_head = node;
+    ready_tail = node;
+  }
+
+  // A timer due at a fired slot goes straight to the ready queue
+  void add_timer(Sht21_Coro_Node* node)
+  {
+    if ((Int32)(node->due - tick) <= 0)
+    {
+      post(node);
+      return;
+    }
+    Sht21_Coro_Node** slot = &wheel[node->due & wheel_mask];
+    node->next = *slot;
+    *slot = node;
+    timers++;
+  }
+
+  // Fires the slots from the last tick up to now, each at most once
+  void advance()
+  {
+    UInt32 to = now();
+    UInt32 steps = to - tick;
+    if (steps > SHT21_CORO_WHEEL_SLOTS)
+      steps = SHT21_CORO_WHEEL_SLOTS;
+
+    for (UInt32 i = 1; i <= steps; i++)
+    {
+      Sht21_Coro_Node** link = &wheel[(tick + i) & wheel_mask];
+      while (*link != nullptr)
+      {
+        Sht21_Coro_Node* node = *link;
+        if ((Int32)(to - node->due) >= 0)
+        {
+          *link = node->next;
+          timers--;
+          post(node);
+        }
+        else
+          link = &node->next;   // Due in a later turn of the wheel
+      }
+    }
+    tick = to;
+  }
+
+  // Sleeps until the next slot that holds a timer
+  void idle()
+  {
+    for (UInt32 d = 1; d <= SHT21_CORO_WHEEL_SLOTS; d++)
+    {
+      if (wheel[(tick + d) & wheel_mask] == nullptr)
+        continue;
+      UInt32 wait = tick + d - now();
+      if ((Int32)wait > 0)
+        clock->delay(clock->handle, wait);
+      return;
+    }
+  }
+};
+
+/********************************************************************************************
+ *  Coroutine returning a T. Starts when it is awaited, or when spawned on an executor,
+ *  and resumes the awaiting coroutine when it returns.
+ *******************************************************************************************/
+template <class T>
+class Sht21_Task
+{
+public:
+  struct promise_type;
+  typedef std::coroutine_handle<promise_type> handle_type;
+
+  struct Final_Awaiter
+  {
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(handle_type handle) noexcept
+    {
+      promise_type& promise = handle.promise();
+      if (promise.continuation)
+        return promise.continuation;
+      if (promise.executor != nullptr)
+      {
+        promise.executor->finished();
+        handle.destroy();
+      }
+      return std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+  };
+
+  struct promise_type
+  {
+    T value = T();
+    std::coroutine_handle<> continuation;
+    Sht21_Executor* executor = nullptr;
+    Sht21_Coro_Node node;
+
+    Sht21_Task get_return_object() { return Sht21_Task(handle_type::from_promise(*this)); }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    Final_Awaiter final_suspend() noexcept { return {}; }
+    void return_value(T result) { value = result; }
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  Sht21_Task(Sht21_Task&& other) noexcept : handle(other.release()) {}
+  Sht21_Task(const Sht21_Task&) = delete;
+  Sht21_Task& operator=(const Sht21_Task&) = delete;
+  ~Sht21_Task()
+  {
+    if (handle)
+      handle.destroy();
+  }
+
+  bool await_ready() { return false; }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller)
+  {
+    handle.promise().continuation = caller;
+    return handle;
+  }
+  T await_resume() { return handle.promise().value; }
+
+  handle_type release()
+  {
+    handle_type released = handle;
+    handle = nullptr;
+    return released;
+  }
+
+private:
+  handle_type handle;
+
+  explicit Sht21_Task(handle_type handle) : handle(handle) {}
+};
+
+/********************************************************************************************
+ *  Sensor on a bus with awaitable operations. Only one operation at a time per sensor.
+ *******************************************************************************************/
+class Sht21_Async
+{
+public:
+  Sht21_Async(Sht21_Executor* executor, SHT21_Bus_TypeDef* bus,
+              SHT21_Resolution_TypeDef resolution = SHT21_RES_RH12_T14)
+    : executor(executor), bus(bus), resolution(resolution) {}
+
+  SHT21_Resolution_TypeDef get_resolution() const { return resolution; }
+
+  /********************************************************************************************
+   *  Waits for the sensor to answer after power up or a soft reset, as SHT21_Ready_Wait,
+   *  and takes the resolution from the user register
+   *******************************************************************************************/
+  Sht21_Task<SHT21_Error_TypeDef> wait_ready(UInt32 window = SHT21_POWER_UP_TIME)
+  {
+    SHT21_Ready_TypeDef ready;
+    SHT21_Ready_Start(&ready, bus, window);
+
+    SHT21_Error_TypeDef status = SHT21_Ready_Poll(&ready);
+    while (status == SHT21_BUSY)
+    {
+      co_await executor->sleep(1);
+      status = SHT21_Ready_Poll(&ready);
+    }
+    if (status == SHT21_OK)
+      resolution = SHT21_Get_Resolution(ready.user_reg);
+    co_return status;
+  }
+
+  /********************************************************************************************
+   *  One no hold measurement, SHT21_TEMP_MEASURE or SHT21_RH_MEASURE
+   *******************************************************************************************/
+  Sht21_Task<SHT21_Error_TypeDef> measure(SHT21_Commands_TypeDef cmd, float* value)
+  {
+    SHT21_Measurement_TypeDef meas;
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(&meas, bus, cmd);
+    if (status == SHT21_OK)
+      status = co_await wait(&meas, SHT21_Conversion_Time(resolution, cmd));
+    if (status == SHT21_OK)
+      status = SHT21_Measure_Complete(&meas, value);
+    co_return status;
+  }
+
+  /********************************************************************************************
+   *  Temperature and humidity as SHT21_Measure_Both, the humidity conversion is started
+   *  before the temperature frame is checked
+   *******************************************************************************************/
+  Sht21_Task<SHT21_Sample_TypeDef> measure()
+  {
+    SHT21_Sample_TypeDef sample = {};
+    SHT21_Measurement_TypeDef temp_meas;
+    SHT21_Measurement_TypeDef rh_meas;
+
+    sample.status = SHT21_Measure_Start(&temp_meas, bus, SHT21_TEMP_MEASURE);
+    if (sample.status == SHT21_OK)
+      sample.status = co_await wait(&temp_meas, SHT21_Conversion_Time(resolution, SHT21_TEMP_MEASURE));
+    if (sample.status == SHT21_OK)
+      sample.status = SHT21_Measure_Start(&rh_meas, bus, SHT21_RH_MEASURE);
+    if (sample.status != SHT21_OK)
+      co_return sample;
+
+    SHT21_Error_TypeDef temp_status = SHT21_Measure_Complete(&temp_meas, &sample.temp);
+
+    sample.status = co_await wait(&rh_meas, SHT21_Conversion_Time(resolution, SHT21_RH_MEASURE));
+    if (sample.status == SHT21_OK)
+      sample.status = SHT21_Measure_Complete(&rh_meas, &sample.humidity);
+    if (sample.status == SHT21_OK && temp_status != SHT21_OK)
+      sample.status = temp_status;
+    co_return sample;
+  }
+
+  /********************************************************************************************
+   *  Heater selftest, see SHT21_Selftest_Step. Suspends between the steps.
+   *******************************************************************************************/
+  Sht21_Task<SHT21_Error_TypeDef> selftest(UInt32 deadline = SHT21_SELFTEST_DEADLINE)
+  {
+    SHT21_Selftest_TypeDef test;
+    SHT21_Selftest_Start(&test, bus, deadline);
+
+    SHT21_Error_TypeDef status = SHT21_Selftest_Step(&test);
+    while (status == SHT21_BUSY)
+    {
+      co_await executor->sleep(test.wait);
+      status = SHT21_Selftest_Step(&test);
+    }
+    co_return status;
+  }
+
+private:
+  Sht21_Executor* executor;
+  SHT21_Bus_TypeDef* bus;
+  SHT21_Resolution_TypeDef resolution;
+
+  // Sleeps until the end of the conversion time, then polls once per ms as SHT21_Measure_Wait
+  Sht21_Task<SHT21_Error_TypeDef> wait(SHT21_Measurement_TypeDef* meas, UInt32 conversion_time)
+  {
+    co_await executor->sleep_until(meas->start_tick + conversion_time);
+
+    SHT21_Error_TypeDef status = SHT21_Measure_Poll(meas);
+    while (status == SHT21_BUSY)
+    {
+      co_await executor->sleep(1);
+      status = SHT21_Measure_Poll(meas);
+    }
+    co_return status;
+  }
+};
+
+#endif // __SHT21_CORO__H
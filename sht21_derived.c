@@ -0,0 +1,174 @@
+/********************************************************************************************
+ *  Filename: sht21_derived.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 derived values
+ *
+ *******************************************************************************************/
+#include "sht21_derived.h"
+
+#define SHT21_LN2                   (0.69314718f)
+#define SHT21_LOG2E                 (1.44269504f)
+#define SHT21_SQRT2                 (1.41421356f)
+#define SHT21_KELVIN                (273.15f)
+
+typedef union
+{
+    float f;
+    UInt32 u;
+} SHT21_Float_Bits_TypeDef;
+
+// ln(1 + u) = u q(u) for u in [sqrt(0.5) - 1, sqrt(2) - 1], Chebyshev fit, error < 1e-7
+#define SHT21_LN_Q0                 (9.999999425e-01f)
+#define SHT21_LN_Q1                 (-5.000036309e-01f)
+#define SHT21_LN_Q2                 (3.333511414e-01f)
+#define SHT21_LN_Q3                 (-2.497007169e-01f)
+#define SHT21_LN_Q4                 (1.989856505e-01f)
+#define SHT21_LN_Q5                 (-1.724701330e-01f)
+#define SHT21_LN_Q6                 (1.623418980e-01f)
+#define SHT21_LN_Q7                 (-1.013405675e-01f)
+
+/********************************************************************************************
+ *  Natural logarithm of x > 0. x = 2^e * m with m in [sqrt(0.5), sqrt(2)), and ln(m)
+ *  is a polynomial in m - 1, so there is no division.
+ *******************************************************************************************/
+static inline float SHT21_Ln(float x)
+{
+    SHT21_Float_Bits_TypeDef bits = { x };
+    Int32 e = (Int32)((bits.u >> 23) & 0xFFU) - 127;
+
+    bits.u = (bits.u & 0x007FFFFFU) | 0x3F800000U; // m in [1, 2)
+    float big = (bits.f > SHT21_SQRT2) ? 1.0f : 0.0f;
+    float u = bits.f * (1.0f - 0.5f * big) - 1.0f;
+
+    float q = SHT21_LN_Q0 + u * (SHT21_LN_Q1 + u * (SHT21_LN_Q2 + u * (SHT21_LN_Q3 + u * (SHT21_LN_Q4 +
+              u * (SHT21_LN_Q5 + u * (SHT21_LN_Q6 + u * SHT21_LN_Q7))))));
+    return ((float)e + big) * SHT21_LN2 + u * q;
+}
+
+float SHT21_Fast_Ln(float x)
+{
+    return SHT21_Ln(x);
+}
+
+/********************************************************************************************
+ *  e^x for |x| < 87. x log2(e) = n + f with f in [-0.5, 0.5], 2^n is put in the exponent
+ *  bits and e^(f ln2) is the Taylor series to the 6th power.
+ *******************************************************************************************/
+static inline float SHT21_Exp(float x)
+{
+    float y = x * SHT21_LOG2E;
+    Int32 n = (Int32)(y + (y >= 0.0f ? 0.5f : -0.5f));
+    float r = (y - (float)n) * SHT21_LN2;
+
+    float p = 1.0f + r * (1.0f + r * (1.0f / 2.0f + r * (1.0f / 6.0f + r * (1.0f / 24.0f +
+              r * (1.0f / 120.0f + r * (1.0f / 720.0f))))));
+
+    SHT21_Float_Bits_TypeDef scale;
+    scale.u = (UInt32)(n + 127) << 23;
+    return p * scale.f;
+}
+
+float SHT21_Fast_Exp(float x)
+{
+    return SHT21_Exp(x);
+}
+
+static inline float SHT21_Clamp_RH(float humidity)
+{
+    if (humidity < 0.01f)
+        return 0.01f;
+    if (humidity > 100.0f)
+        return 100.0f;
+    return humidity;
+}
+
+// Magnus exponent m T / (Tn + T), ln(E / 6.112 hPa) of the saturation vapor pressure E
+static inline float SHT21_Magnus(float temp, float* tn, float* m)
+{
+    *tn = (temp < 0.0f) ? SHT21_MAGNUS_ICE_TN : SHT21_MAGNUS_WATER_TN;
+    *m = (temp < 0.0f) ? SHT21_MAGNUS_ICE_M : SHT21_MAGNUS_WATER_M;
+    return *m * temp / (*tn + temp);
+}
+
+// Partial pressure of the water vapor in hPa
+static inline float SHT21_Vapor_Pressure(float temp, float humidity)
+{
+    float tn, m;
+    float gamma = SHT21_Magnus(temp, &tn, &m);
+    return SHT21_Clamp_RH(humidity) * (SHT21_MAGNUS_A / 100.0f) * SHT21_Exp(gamma);
+}
+
+/********************************************************************************************
+ *  Dew point in C, the frost point below 0 C
+ *******************************************************************************************/
+float SHT21_Dew_Point(float temp, float humidity)
+{
+    float tn, m;
+    float gamma = SHT21_Magnus(temp, &tn, &m) + SHT21_Ln(SHT21_Clamp_RH(humidity) / 100.0f);
+    return tn * gamma / (m - gamma);
+}
+
+/********************************************************************************************
+ *  Absolute humidity in g/m3
+ *******************************************************************************************/
+float SHT21_Abs_Humidity(float temp, float humidity)
+{
+    return 216.7f * SHT21_Vapor_Pressure(temp, humidity) / (SHT21_KELVIN + temp);
+}
+
+/********************************************************************************************
+ *  Specific enthalpy in kJ/kg dry air at pressure in hPa
+ *******************************************************************************************/
+float SHT21_Enthalpy(float temp, float humidity, float pressure)
+{
+    float pw = SHT21_Vapor_Pressure(temp, humidity);
+    float mixing_ratio = 0.622f * pw / (pressure - pw);
+    return 1.006f * temp + mixing_ratio * (2501.0f + 1.86f * temp);
+}
+
+// All three values sharing the Magnus term, inlined into the scalar and batch functions
+static inline void SHT21_Derived_Compute(float temp, float humidity, SHT21_Derived_TypeDef* out)
+{
+    float tn, m;
+    float rh = SHT21_Clamp_RH(humidity);
+    float magnus = SHT21_Magnus(temp, &tn, &m);
+
+    float gamma = magnus + SHT21_Ln(rh * 0.01f);
+    out->dew_point = tn * gamma / (m - gamma);
+
+    float pw = rh * (SHT21_MAGNUS_A / 100.0f) * SHT21_Exp(magnus);
+    out->abs_humidity = 216.7f * pw / (SHT21_KELVIN + temp);
+
+    float mixing_ratio = 0.622f * pw / (SHT21_DERIVED_PRESSURE - pw);
+    out->enthalpy = 1.006f * temp + mixing_ratio * (2501.0f + 1.86f * temp);
+}
+
+/********************************************************************************************
+ *  All derived values of a sample. The enthalpy is at SHT21_DERIVED_PRESSURE.
+ *******************************************************************************************/
+SHT21_Derived_TypeDef SHT21_Derived(float temp, float humidity)
+{
+    SHT21_Derived_TypeDef out;
+    SHT21_Derived_Compute(temp, humidity, &out);
+    return out;
+}
+
+/********************************************************************************************
+ *  Derived values straight from the masked 16 bit readings of the parsers
+ *******************************************************************************************/
+SHT21_Derived_TypeDef SHT21_Derived_Ticks(UInt16 temp_reading, UInt16 rh_reading)
+{
+    return SHT21_Derived(SHT21_Convert_Temp(temp_reading), SHT21_Convert_RH(rh_reading));
+}
+
+/********************************************************************************************
+ *  Derived values of count samples
+ *******************************************************************************************/
+void SHT21_Derived_Batch(const float* temp, const float* humidity, UInt32 count, SHT21_Derived_TypeDef* out)
+{
+    for (UInt32 i = 0; i < count; i++)
+        SHT21_Derived_Compute(temp[i], humidity[i], &out[i]);
+}
@@ -0,0 +1,71 @@
+/********************************************************************************************
+ *  Filename: sht21_derived.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Dew point, absolute humidity and enthalpy from a temperature and humidity pair,
+ *  without libm. The Magnus formula of the Sensirion dew point application note is
+ *  used, over water at and above 0 C and over ice below. ln and exp are replaced by
+ *  range reduced polynomials without division, SHT21_Fast_Ln and SHT21_Fast_Exp,
+ *  accurate to a few float ulp.
+ *
+ *  Against the same formulas in double precision, from -40 to 125 C and 1 to 100 %RH:
+ *      Dew point           : < 0.0001 C
+ *      Absolute humidity   : < 5e-6 relative
+ *      Enthalpy            : < 5e-6 relative, up to 80 C
+ *  This is the error of logf/expf in float. See bench/sht21_bench_derived.c.
+ *
+ *  Humidity is clamped to 0.01 - 100 %RH, the SHT21 conversion can give values just
+ *  outside of it.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_DERIVED__H
+#define __SHT21_DERIVED__H
+
+#include "sht21_core.h"
+
+// Magnus coefficients, over water (0 to 50 C) and over ice (-45 to 0 C)
+#define SHT21_MAGNUS_WATER_TN       (243.12f)
+#define SHT21_MAGNUS_WATER_M        (17.62f)
+#define SHT21_MAGNUS_ICE_TN         (272.62f)
+#define SHT21_MAGNUS_ICE_M          (22.46f)
+#define SHT21_MAGNUS_A              (6.112f)    // Saturation vapor pressure at 0 C in hPa
+
+// Air pressure in hPa used by SHT21_Derived for the enthalpy
+#ifndef SHT21_DERIVED_PRESSURE
+#define SHT21_DERIVED_PRESSURE      (1013.25f)
+#endif
+
+/********************************************************************************************
+ *  Derived values of a sample
+ *
+ *  dew_point       : Dew point (frost point below 0 C) in C
+ *  abs_humidity    : Absolute humidity in g/m3
+ *  enthalpy        : Specific enthalpy of the moist air in kJ/kg dry air
+ *******************************************************************************************/
+typedef struct
+{
+    float dew_point;
+    float abs_humidity;
+    float enthalpy;
+} SHT21_Derived_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+float SHT21_Fast_Ln(float x);
+float SHT21_Fast_Exp(float x);
+float SHT21_Dew_Point(float temp, float humidity);
+float SHT21_Abs_Humidity(float temp, float humidity);
+float SHT21_Enthalpy(float temp, float humidity, float pressure);
+SHT21_Derived_TypeDef SHT21_Derived(float temp, float humidity);
+SHT21_Derived_TypeDef SHT21_Derived_Ticks(UInt16 temp_reading, UInt16 rh_reading);
+void SHT21_Derived_Batch(const float* temp, const float* humidity, UInt32 count, SHT21_Derived_TypeDef* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_DERIVED__H
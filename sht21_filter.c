@@ -0,0 +1,223 @@
+/********************************************************************************************
+ *  Filename: sht21_filter.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 reading filters
+ *
+ *******************************************************************************************/
+#include "sht21_filter.h"
+
+/********************************************************************************************
+ *  Sets up an EMA with alpha = 1 / 2^shift, shift 1 to SHT21_FILTER_EMA_MAX_SHIFT
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Ema_Init(SHT21_Ema_TypeDef* ema, UInt8 shift)
+{
+    if (shift == 0 || shift > SHT21_FILTER_EMA_MAX_SHIFT)
+        return SHT21_UNIT_ERROR;
+
+    ema->acc = 0;
+    ema->shift = shift;
+    ema->primed = 0;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Adds a reading and returns the average. acc += reading - round(acc / 2^shift), so
+ *  a constant input settles on exactly that reading.
+ *******************************************************************************************/
+UInt16 SHT21_Ema_Update(SHT21_Ema_TypeDef* ema, UInt16 reading)
+{
+    UInt32 half = 1UL << (ema->shift - 1U);
+
+    if (!ema->primed)
+    {
+        ema->acc = (UInt32)reading << ema->shift;
+        ema->primed = 1;
+    }
+    else
+        ema->acc = ema->acc + reading - ((ema->acc + half) >> ema->shift);
+
+    return (UInt16)((ema->acc + half) >> ema->shift);
+}
+
+/********************************************************************************************
+ *  Sets up a median over size readings, 1 to SHT21_FILTER_MEDIAN_MAX. Use an odd size,
+ *  an even one returns the lower of the two middle readings.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Median_Init(SHT21_Median_TypeDef* median, UInt8 size)
+{
+    if (size == 0 || size > SHT21_FILTER_MEDIAN_MAX)
+        return SHT21_UNIT_ERROR;
+
+    median->size = size;
+    median->count = 0;
+    median->next = 0;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Adds a reading and returns the median. The oldest reading is taken out of the sorted
+ *  copy and the new one inserted in place, no sort per sample. O(size), up to size
+ *  compares and moves for each of the two.
+ *******************************************************************************************/
+UInt16 SHT21_Median_Update(SHT21_Median_TypeDef* median, UInt16 reading)
+{
+    UInt8 i;
+    UInt8 count = median->count;
+
+    if (count == median->size)
+    {
+        UInt16 oldest = median->window[median->next];
+        for (i = 0; median->sorted[i] != oldest; i++)
+            ;
+        for (; i + 1U < count; i++)
+            median->sorted[i] = median->sorted[i + 1U];
+        count--;
+    }
+
+    for (i = count; i > 0 && median->sorted[i - 1U] > reading; i--)
+        median->sorted[i] = median->sorted[i - 1U];
+    median->sorted[i] = reading;
+    median->count = count + 1U;
+
+    median->window[median->next] = reading;
+    median->next = (median->next + 1U == median->size) ? 0 : median->next + 1U;
+
+    return median->sorted[(median->count - 1U) / 2U];
+}
+
+/********************************************************************************************
+ *  Sets up a decimator averaging factor readings, 1 to 65535
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Decimator_Init(SHT21_Decimator_TypeDef* decimator, UInt16 factor)
+{
+    if (factor == 0)
+        return SHT21_UNIT_ERROR;
+
+    decimator->sum = 0;
+    decimator->factor = factor;
+    decimator->count = 0;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Adds a reading. Returns 1 and writes the rounded mean to out on every factor-th
+ *  reading, 0 otherwise. The mean keeps the bits below the resolution that the
+ *  oversampling gained.
+ *******************************************************************************************/
+UInt8 SHT21_Decimator_Update(SHT21_Decimator_TypeDef* decimator, UInt16 reading, UInt16* out)
+{
+    decimator->sum += reading;
+    if (++decimator->count < decimator->factor)
+        return 0;
+
+    *out = (UInt16)((decimator->sum + decimator->factor / 2U) / decimator->factor);
+    decimator->sum = 0;
+    decimator->count = 0;
+    return 1;
+}
+
+void SHT21_Filter_Init(SHT21_Filter_TypeDef* filter)
+{
+    filter->count = 0;
+}
+
+static SHT21_Filter_Stage_TypeDef* SHT21_Filter_Next_Stage(SHT21_Filter_TypeDef* filter, SHT21_Filter_Kind_TypeDef kind)
+{
+    if (filter->count >= SHT21_FILTER_MAX_STAGES)
+        return 0;
+
+    filter->stages[filter->count].kind = kind;
+    return &filter->stages[filter->count];
+}
+
+/********************************************************************************************
+ *  Appends a stage to the chain. Returns SHT21_UNIT_ERROR if the chain is full or the
+ *  parameter is out of range.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Filter_Add_Ema(SHT21_Filter_TypeDef* filter, UInt8 shift)
+{
+    SHT21_Filter_Stage_TypeDef* stage = SHT21_Filter_Next_Stage(filter, SHT21_FILTER_EMA);
+    if (stage == 0 || SHT21_Ema_Init(&stage->data.ema, shift) != SHT21_OK)
+        return SHT21_UNIT_ERROR;
+
+    filter->count++;
+    return SHT21_OK;
+}
+
+SHT21_Error_TypeDef SHT21_Filter_Add_Median(SHT21_Filter_TypeDef* filter, UInt8 size)
+{
+    SHT21_Filter_Stage_TypeDef* stage = SHT21_Filter_Next_Stage(filter, SHT21_FILTER_MEDIAN);
+    if (stage == 0 || SHT21_Median_Init(&stage->data.median, size) != SHT21_OK)
+        return SHT21_UNIT_ERROR;
+
+    filter->count++;
+    return SHT21_OK;
+}
+
+SHT21_Error_TypeDef SHT21_Filter_Add_Decimator(SHT21_Filter_TypeDef* filter, UInt16 factor)
+{
+    SHT21_Filter_Stage_TypeDef* stage = SHT21_Filter_Next_Stage(filter, SHT21_FILTER_DECIMATOR);
+    if (stage == 0 || SHT21_Decimator_Init(&stage->data.decimator, factor) != SHT21_OK)
+        return SHT21_UNIT_ERROR;
+
+    filter->count++;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Runs a reading through the chain. Returns 1 and writes the filtered reading to out
+ *  when the last stage produced an output, convert it with SHT21_Convert_Temp or
+ *  SHT21_Convert_RH. An empty chain passes every reading through.
+ *******************************************************************************************/
+UInt8 SHT21_Filter_Update(SHT21_Filter_TypeDef* filter, UInt16 reading, UInt16* out)
+{
+    for (UInt8 i = 0; i < filter->count; i++)
+    {
+        SHT21_Filter_Stage_TypeDef* stage = &filter->stages[i];
+        switch (stage->kind)
+        {
+            case SHT21_FILTER_EMA:
+            reading = SHT21_Ema_Update(&stage->data.ema, reading);
+            break;
+            case SHT21_FILTER_MEDIAN:
+            reading = SHT21_Median_Update(&stage->data.median, reading);
+            break;
+            case SHT21_FILTER_DECIMATOR:
+            if (!SHT21_Decimator_Update(&stage->data.decimator, reading, &reading))
+                return 0;
+            break;
+        }
+    }
+
+    *out = reading;
+    return 1;
+}
+
+/********************************************************************************************
+ *  Drops the history of every stage and keeps the configuration, for example after
+ *  the sensor was reset or its resolution changed
+ *******************************************************************************************/
+void SHT21_Filter_Reset(SHT21_Filter_TypeDef* filter)
+{
+    for (UInt8 i = 0; i < filter->count; i++)
+    {
+        SHT21_Filter_Stage_TypeDef* stage = &filter->stages[i];
+        switch (stage->kind)
+        {
+            case SHT21_FILTER_EMA:
+            stage->data.ema.primed = 0;
+            break;
+            case SHT21_FILTER_MEDIAN:
+            stage->data.median.count = 0;
+            stage->data.median.next = 0;
+            break;
+            case SHT21_FILTER_DECIMATOR:
+            stage->data.decimator.sum = 0;
+            stage->data.decimator.count = 0;
+            break;
+        }
+    }
+}
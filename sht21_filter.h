@@ -0,0 +1,123 @@
+/********************************************************************************************
+ *  Filename: sht21_filter.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Filters on the masked 16 bit readings of SHT21_Parse_Reading, so a reading is only
+ *  converted to C or %RH once per filtered output instead of once per sample. Three
+ *  stages, usable on their own or chained in a SHT21_Filter_TypeDef:
+ *      EMA         : Exponential moving average with alpha = 1 / 2^shift, integer only
+ *      Median      : Median of the last size readings, rejects single spikes
+ *      Decimator   : Rounded mean of every factor readings, one output per factor inputs
+ *
+ *  EMA and decimator updates are O(1). A median update is O(size): the oldest reading
+ *  is found in the sorted window and shifted out, and the new one shifted in, up to
+ *  size compares and moves each. size is capped at SHT21_FILTER_MEDIAN_MAX, so the
+ *  worst case is bounded at compile time. Nothing is allocated, all state is in the
+ *  structs.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_FILTER__H
+#define __SHT21_FILTER__H
+
+#include "sht21_core.h"
+
+// Largest median window
+#ifndef SHT21_FILTER_MEDIAN_MAX
+#define SHT21_FILTER_MEDIAN_MAX     (9U)
+#endif
+
+// Largest number of stages in a SHT21_Filter_TypeDef
+#ifndef SHT21_FILTER_MAX_STAGES
+#define SHT21_FILTER_MAX_STAGES     (4U)
+#endif
+
+#define SHT21_FILTER_EMA_MAX_SHIFT  (15U)
+
+/********************************************************************************************
+ *  Exponential moving average. acc holds the average scaled by 2^shift, the first
+ *  reading sets it so there is no ramp up from 0.
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 acc;
+    UInt8 shift;
+    UInt8 primed;
+} SHT21_Ema_TypeDef;
+
+/********************************************************************************************
+ *  Running median. window holds the readings in arrival order with next the oldest,
+ *  sorted the same readings in order. Until the window is full the median is taken over
+ *  the readings so far.
+ *******************************************************************************************/
+typedef struct
+{
+    UInt16 window[SHT21_FILTER_MEDIAN_MAX];
+    UInt16 sorted[SHT21_FILTER_MEDIAN_MAX];
+    UInt8 size;
+    UInt8 count;
+    UInt8 next;
+} SHT21_Median_TypeDef;
+
+/********************************************************************************************
+ *  Oversampling decimator
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 sum;
+    UInt16 factor;
+    UInt16 count;
+} SHT21_Decimator_TypeDef;
+
+typedef enum
+{
+    SHT21_FILTER_EMA            = (0x00U),
+    SHT21_FILTER_MEDIAN         = (0x01U),
+    SHT21_FILTER_DECIMATOR      = (0x02U)
+} SHT21_Filter_Kind_TypeDef;
+
+typedef struct
+{
+    SHT21_Filter_Kind_TypeDef kind;
+    union
+    {
+        SHT21_Ema_TypeDef ema;
+        SHT21_Median_TypeDef median;
+        SHT21_Decimator_TypeDef decimator;
+    } data;
+} SHT21_Filter_Stage_TypeDef;
+
+/********************************************************************************************
+ *  Stages run in the order they were added, a reading only reaches the next stage when
+ *  the stage before produced an output. A typical chain is median, EMA, decimator.
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Filter_Stage_TypeDef stages[SHT21_FILTER_MAX_STAGES];
+    UInt8 count;
+} SHT21_Filter_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SHT21_Error_TypeDef SHT21_Ema_Init(SHT21_Ema_TypeDef* ema, UInt8 shift);
+UInt16 SHT21_Ema_Update(SHT21_Ema_TypeDef* ema, UInt16 reading);
+SHT21_Error_TypeDef SHT21_Median_Init(SHT21_Median_TypeDef* median, UInt8 size);
+UInt16 SHT21_Median_Update(SHT21_Median_TypeDef* median, UInt16 reading);
+SHT21_Error_TypeDef SHT21_Decimator_Init(SHT21_Decimator_TypeDef* decimator, UInt16 factor);
+UInt8 SHT21_Decimator_Update(SHT21_Decimator_TypeDef* decimator, UInt16 reading, UInt16* out);
+
+void SHT21_Filter_Init(SHT21_Filter_TypeDef* filter);
+SHT21_Error_TypeDef SHT21_Filter_Add_Ema(SHT21_Filter_TypeDef* filter, UInt8 shift);
+SHT21_Error_TypeDef SHT21_Filter_Add_Median(SHT21_Filter_TypeDef* filter, UInt8 size);
+SHT21_Error_TypeDef SHT21_Filter_Add_Decimator(SHT21_Filter_TypeDef* filter, UInt16 factor);
+UInt8 SHT21_Filter_Update(SHT21_Filter_TypeDef* filter, UInt16 reading, UInt16* out);
+void SHT21_Filter_Reset(SHT21_Filter_TypeDef* filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_FILTER__H
@@ -0,0 +1,99 @@
+/********************************************************************************************
+ *  Filename: sht21_fixed.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 integer conversions
+ *
+ *******************************************************************************************/
+#include "sht21_fixed.h"
+
+/*
+ *  Table generators. Each level expands the previous one 4 times, the argument is the
+ *  index of the first entry. f is called with the index of every entry.
+ */
+#define SHT21_LUT_4(f, i)           f(i) f((i) + 1) f((i) + 2) f((i) + 3)
+#define SHT21_LUT_16(f, i)          SHT21_LUT_4(f, i) SHT21_LUT_4(f, (i) + 4) SHT21_LUT_4(f, (i) + 8) SHT21_LUT_4(f, (i) + 12)
+#define SHT21_LUT_64(f, i)          SHT21_LUT_16(f, i) SHT21_LUT_16(f, (i) + 16) SHT21_LUT_16(f, (i) + 32) SHT21_LUT_16(f, (i) + 48)
+#define SHT21_LUT_256(f, i)         SHT21_LUT_64(f, i) SHT21_LUT_64(f, (i) + 64) SHT21_LUT_64(f, (i) + 128) SHT21_LUT_64(f, (i) + 192)
+#define SHT21_LUT_1024(f, i)        SHT21_LUT_256(f, i) SHT21_LUT_256(f, (i) + 256) SHT21_LUT_256(f, (i) + 512) SHT21_LUT_256(f, (i) + 768)
+#define SHT21_LUT_4096(f, i)        SHT21_LUT_1024(f, i) SHT21_LUT_1024(f, (i) + 1024) SHT21_LUT_1024(f, (i) + 2048) SHT21_LUT_1024(f, (i) + 3072)
+#define SHT21_LUT_16384(f, i)       SHT21_LUT_4096(f, i) SHT21_LUT_4096(f, (i) + 4096) SHT21_LUT_4096(f, (i) + 8192) SHT21_LUT_4096(f, (i) + 12288)
+#define SHT21_LUT_2048(f, i)        SHT21_LUT_1024(f, i) SHT21_LUT_1024(f, (i) + 1024)
+#define SHT21_LUT_8192(f, i)        SHT21_LUT_4096(f, i) SHT21_LUT_4096(f, (i) + 4096)
+
+#define SHT21_LUT_BITS_8(f)         SHT21_LUT_256(f, 0)
+#define SHT21_LUT_BITS_10(f)        SHT21_LUT_1024(f, 0)
+#define SHT21_LUT_BITS_11(f)        SHT21_LUT_2048(f, 0)
+#define SHT21_LUT_BITS_12(f)        SHT21_LUT_4096(f, 0)
+#define SHT21_LUT_BITS_13(f)        SHT21_LUT_8192(f, 0)
+#define SHT21_LUT_BITS_14(f)        SHT21_LUT_16384(f, 0)
+#define SHT21_LUT_BITS(bits, f)     SHT21_LUT_BITS_EXPAND(bits, f)
+#define SHT21_LUT_BITS_EXPAND(bits, f) SHT21_LUT_BITS_##bits(f)
+
+#ifdef SHT21_FIXED_TEMP_LUT_BITS
+#if SHT21_FIXED_TEMP_LUT_BITS < 11 || SHT21_FIXED_TEMP_LUT_BITS > 14
+#error "SHT21_FIXED_TEMP_LUT_BITS must be between 11 and 14"
+#endif
+#define SHT21_TEMP_LUT_ENTRY(i)     SHT21_TEMP_CENTI((UInt32)(i) << (16 - SHT21_FIXED_TEMP_LUT_BITS)),
+static const Int16 sht21_temp_lut[] = { SHT21_LUT_BITS(SHT21_FIXED_TEMP_LUT_BITS, SHT21_TEMP_LUT_ENTRY) };
+#endif
+
+#ifdef SHT21_FIXED_RH_LUT_BITS
+#if SHT21_FIXED_RH_LUT_BITS < 8 || SHT21_FIXED_RH_LUT_BITS > 12 || SHT21_FIXED_RH_LUT_BITS == 9
+#error "SHT21_FIXED_RH_LUT_BITS must be 8, 10, 11 or 12"
+#endif
+#define SHT21_RH_LUT_ENTRY(i)       SHT21_RH_CENTI((UInt32)(i) << (16 - SHT21_FIXED_RH_LUT_BITS)),
+static const Int16 sht21_rh_lut[] = { SHT21_LUT_BITS(SHT21_FIXED_RH_LUT_BITS, SHT21_RH_LUT_ENTRY) };
+#endif
+
+/********************************************************************************************
+ *  Converts a masked 16 bit temperature reading to centi-degrees Celsius
+ *******************************************************************************************/
+Int16 SHT21_Convert_Temp_Centi(UInt16 reading)
+{
+#ifdef SHT21_FIXED_TEMP_LUT_BITS
+    return sht21_temp_lut[reading >> (16 - SHT21_FIXED_TEMP_LUT_BITS)];
+#else
+    return SHT21_TEMP_CENTI(reading);
+#endif
+}
+
+/********************************************************************************************
+ *  Converts a masked 16 bit humidity reading to centi-%RH
+ *******************************************************************************************/
+Int16 SHT21_Convert_RH_Centi(UInt16 reading)
+{
+#ifdef SHT21_FIXED_RH_LUT_BITS
+    return sht21_rh_lut[reading >> (16 - SHT21_FIXED_RH_LUT_BITS)];
+#else
+    return SHT21_RH_CENTI(reading);
+#endif
+}
+
+/********************************************************************************************
+ *  Parses the 2 byte temp value received from SHT21 into centi-degrees Celsius. temp is
+ *  only written with SHT21_OK, a corrupt frame returns SHT21_CHECKSUM_ERROR.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Parse_Temp_Centi(UInt8* buf, Int16* temp)
+{
+    UInt16 reading;
+    SHT21_Error_TypeDef status = SHT21_Parse_Reading(buf, &reading);
+    if (status == SHT21_OK)
+        *temp = SHT21_Convert_Temp_Centi(reading);
+    return status;
+}
+
+/********************************************************************************************
+ *  Parses the 2 byte RH value received from SHT21 into centi-%RH, only written with
+ *  SHT21_OK.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Parse_RH_Centi(UInt8* buf, Int16* humidity)
+{
+    UInt16 reading;
+    SHT21_Error_TypeDef status = SHT21_Parse_Reading(buf, &reading);
+    if (status == SHT21_OK)
+        *humidity = SHT21_Convert_RH_Centi(reading);
+    return status;
+}
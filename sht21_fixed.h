@@ -0,0 +1,48 @@
+/********************************************************************************************
+ *  Filename: sht21_fixed.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Integer conversion of SHT21 readings for targets without an FPU. Temperature is
+ *  returned in centi-degrees Celsius and humidity in centi-%RH, using only a multiply
+ *  and a shift per reading.
+ *
+ *  Error bounds against SHT21_Parse_Temp/SHT21_Parse_RH, over every possible reading:
+ *      Temperature : |T_centi / 100 - T_float|   <= 0.0051 C
+ *      Humidity    : |RH_centi / 100 - RH_float| <= 0.0051 %RH
+ *  The integer result is the exact value rounded to nearest, the rest is the rounding
+ *  of the float path itself.
+ *
+ *  Optional lookup tables, generated at compile time by the preprocessor:
+ *      SHT21_FIXED_TEMP_LUT_BITS   : 11 to 14, temperature resolution in use
+ *      SHT21_FIXED_RH_LUT_BITS     : 8 to 12, humidity resolution in use
+ *  When defined the conversion is a single table read indexed by the reading shifted
+ *  down to the given resolution. The table holds 2^bits entries of 2 bytes, so only
+ *  enable it when flash is cheaper than multiply cycles (Cortex-M0 with the small
+ *  multiplier). Readings with bits below the configured resolution are truncated.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_FIXED__H
+#define __SHT21_FIXED__H
+
+#include "sht21_core.h"
+
+// Rounded integer conversion of a masked 16 bit reading
+#define SHT21_TEMP_CENTI(reading)   ((Int16)(-4685 + (Int32)((17572UL * (UInt32)(reading) + 32768UL) >> 16U)))
+#define SHT21_RH_CENTI(reading)     ((Int16)(-600 + (Int32)((12500UL * (UInt32)(reading) + 32768UL) >> 16U)))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+Int16 SHT21_Convert_Temp_Centi(UInt16 reading);
+Int16 SHT21_Convert_RH_Centi(UInt16 reading);
+SHT21_Error_TypeDef SHT21_Parse_Temp_Centi(UInt8* buf, Int16* temp);
+SHT21_Error_TypeDef SHT21_Parse_RH_Centi(UInt8* buf, Int16* humidity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_FIXED__H
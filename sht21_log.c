@@ -0,0 +1,276 @@
+/********************************************************************************************
+ *  Filename: sht21_log.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 log block encoding
+ *
+ *******************************************************************************************/
+#include "sht21_log.h"
+
+static void SHT21_Log_Put_U16(UInt8* buf, UInt16 value)
+{
+    buf[0] = (UInt8)value;
+    buf[1] = (UInt8)(value >> 8);
+}
+
+static void SHT21_Log_Put_U64(UInt8* buf, unsigned long long value)
+{
+    for (UInt8 i = 0; i < 8; i++)
+        buf[i] = (UInt8)(value >> (8U * i));
+}
+
+static UInt16 SHT21_Log_Get_U16(const UInt8* buf)
+{
+    return (UInt16)(buf[0] | (buf[1] << 8));
+}
+
+static unsigned long long SHT21_Log_Get_U64(const UInt8* buf)
+{
+    unsigned long long value = 0;
+    for (UInt8 i = 0; i < 8; i++)
+        value |= (unsigned long long)buf[i] << (8U * i);
+    return value;
+}
+
+// Maps signed deltas to unsigned so small magnitudes give short varints: 0, -1, 1, -2 ...
+static unsigned long long SHT21_Log_Zigzag(long long value)
+{
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+static long long SHT21_Log_Unzigzag(unsigned long long value)
+{
+    return (long long)(value >> 1) ^ -(long long)(value & 1U);
+}
+
+static UInt8 SHT21_Log_Put_Varint(UInt8* buf, unsigned long long value)
+{
+    UInt8 len = 0;
+    while (value >= 0x80U)
+    {
+        buf[len++] = (UInt8)(value | 0x80U);
+        value >>= 7;
+    }
+    buf[len++] = (UInt8)value;
+    return len;
+}
+
+// Returns the number of bytes read, 0 if the varint runs past end
+static UInt8 SHT21_Log_Get_Varint(const UInt8* buf, UInt16 end, UInt16 offset, unsigned long long* value)
+{
+    *value = 0;
+    for (UInt8 len = 0; len < 10 && offset + len < end; len++)
+    {
+        *value |= (unsigned long long)(buf[offset + len] & 0x7FU) << (7U * len);
+        if ((buf[offset + len] & 0x80U) == 0)
+            return (UInt8)(len + 1U);
+    }
+    return 0;
+}
+
+static void SHT21_Log_Write_Block_Header(UInt8* block, const SHT21_Log_Block_Header_TypeDef* header)
+{
+    SHT21_Log_Put_U64(&block[0], header->first_ms);
+    SHT21_Log_Put_U64(&block[8], header->last_ms);
+    SHT21_Log_Put_U16(&block[16], header->count);
+    SHT21_Log_Put_U16(&block[18], header->used);
+    SHT21_Log_Put_U16(&block[20], header->first_temp);
+    SHT21_Log_Put_U16(&block[22], header->first_rh);
+}
+
+/********************************************************************************************
+ *  Writes the SHT21_LOG_HEADER_SIZE byte file header to buf
+ *******************************************************************************************/
+void SHT21_Log_Write_Header(UInt8* buf)
+{
+    for (UInt8 i = 0; i < 8; i++)
+        buf[i] = (UInt8)SHT21_LOG_MAGIC[i];
+    SHT21_Log_Put_U16(&buf[8], SHT21_LOG_VERSION);
+    SHT21_Log_Put_U16(&buf[10], SHT21_LOG_BLOCK_SIZE);
+    SHT21_Log_Put_U16(&buf[12], 0);
+    SHT21_Log_Put_U16(&buf[14], 0);
+}
+
+/********************************************************************************************
+ *  Checks the file header. Returns SHT21_UNIT_ERROR if it is not a log of this version
+ *  and block size.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Log_Check_Header(const UInt8* buf)
+{
+    for (UInt8 i = 0; i < 8; i++)
+        if (buf[i] != (UInt8)SHT21_LOG_MAGIC[i])
+            return SHT21_UNIT_ERROR;
+
+    if (SHT21_Log_Get_U16(&buf[8]) != SHT21_LOG_VERSION || SHT21_Log_Get_U16(&buf[10]) != SHT21_LOG_BLOCK_SIZE)
+        return SHT21_UNIT_ERROR;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Reads the header of a block without decoding the samples
+ *******************************************************************************************/
+void SHT21_Log_Read_Block_Header(const UInt8* block, SHT21_Log_Block_Header_TypeDef* header)
+{
+    header->first_ms = SHT21_Log_Get_U64(&block[0]);
+    header->last_ms = SHT21_Log_Get_U64(&block[8]);
+    header->count = SHT21_Log_Get_U16(&block[16]);
+    header->used = SHT21_Log_Get_U16(&block[18]);
+    header->first_temp = SHT21_Log_Get_U16(&block[20]);
+    header->first_rh = SHT21_Log_Get_U16(&block[22]);
+}
+
+/********************************************************************************************
+ *  Starts a new empty block
+ *******************************************************************************************/
+void SHT21_Log_Writer_Begin(SHT21_Log_Writer_TypeDef* writer)
+{
+    for (UInt16 i = 0; i < SHT21_LOG_BLOCK_SIZE; i++)
+        writer->data[i] = 0;
+
+    writer->header = (SHT21_Log_Block_Header_TypeDef){0};
+    writer->header.used = SHT21_LOG_BLOCK_HEADER_SIZE;
+    writer->prev_interval = 0;
+    SHT21_Log_Write_Block_Header(writer->data, &writer->header);
+}
+
+/********************************************************************************************
+ *  Adds a sample to the block, data is always a complete block ready to be stored.
+ *  Returns 0 if the block is full, store it and begin a new one. Timestamps must not
+ *  go backwards.
+ *******************************************************************************************/
+UInt8 SHT21_Log_Writer_Append(SHT21_Log_Writer_TypeDef* writer, const SHT21_Log_Record_TypeDef* record)
+{
+    SHT21_Log_Block_Header_TypeDef* header = &writer->header;
+
+    if (header->count == 0)
+    {
+        header->first_ms = record->time_ms;
+        header->first_temp = record->temp_ticks;
+        header->first_rh = record->rh_ticks;
+    }
+    else
+    {
+        UInt8 encoded[SHT21_LOG_RECORD_MAX];
+        unsigned long long interval = record->time_ms - header->last_ms;
+        UInt8 len = SHT21_Log_Put_Varint(encoded, SHT21_Log_Zigzag((long long)(interval - writer->prev_interval)));
+        len += SHT21_Log_Put_Varint(&encoded[len], SHT21_Log_Zigzag((long long)record->temp_ticks - writer->prev_temp));
+        len += SHT21_Log_Put_Varint(&encoded[len], SHT21_Log_Zigzag((long long)record->rh_ticks - writer->prev_rh));
+
+        if (header->count == 0xFFFFU || header->used + len > SHT21_LOG_BLOCK_SIZE)
+            return 0;
+
+        for (UInt8 i = 0; i < len; i++)
+            writer->data[header->used + i] = encoded[i];
+        header->used += len;
+        writer->prev_interval = interval;
+    }
+
+    header->last_ms = record->time_ms;
+    header->count++;
+    writer->prev_temp = record->temp_ticks;
+    writer->prev_rh = record->rh_ticks;
+    SHT21_Log_Write_Block_Header(writer->data, header);
+    return 1;
+}
+
+/********************************************************************************************
+ *  Continues appending to a stored block that is not full, by decoding it to get the
+ *  state of the last sample. Returns SHT21_CHECKSUM_ERROR if the block is corrupt.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Log_Writer_Resume(SHT21_Log_Writer_TypeDef* writer, const UInt8* block)
+{
+    SHT21_Log_Decoder_TypeDef decoder;
+    SHT21_Log_Record_TypeDef record;
+
+    SHT21_Log_Decoder_Init(&decoder, block);
+    if (decoder.header.used < SHT21_LOG_BLOCK_HEADER_SIZE || decoder.header.used > SHT21_LOG_BLOCK_SIZE)
+        return SHT21_CHECKSUM_ERROR;
+
+    while (SHT21_Log_Decoder_Next(&decoder, &record))
+        ;
+    if (decoder.index != decoder.header.count || decoder.offset != decoder.header.used)
+        return SHT21_CHECKSUM_ERROR;
+
+    for (UInt16 i = 0; i < SHT21_LOG_BLOCK_SIZE; i++)
+        writer->data[i] = block[i];
+    writer->header = decoder.header;
+    writer->prev_interval = decoder.prev_interval;
+    writer->prev_temp = decoder.prev.temp_ticks;
+    writer->prev_rh = decoder.prev.rh_ticks;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Starts decoding a stored block
+ *******************************************************************************************/
+void SHT21_Log_Decoder_Init(SHT21_Log_Decoder_TypeDef* decoder, const UInt8* block)
+{
+    decoder->data = block;
+    SHT21_Log_Read_Block_Header(block, &decoder->header);
+    decoder->offset = SHT21_LOG_BLOCK_HEADER_SIZE;
+    decoder->index = 0;
+    decoder->prev_interval = 0;
+    decoder->prev = (SHT21_Log_Record_TypeDef){0};
+}
+
+/********************************************************************************************
+ *  Decodes the next sample of the block into record. Returns 0 at the end of the block
+ *  or if the block is corrupt.
+ *******************************************************************************************/
+UInt8 SHT21_Log_Decoder_Next(SHT21_Log_Decoder_TypeDef* decoder, SHT21_Log_Record_TypeDef* record)
+{
+    const SHT21_Log_Block_Header_TypeDef* header = &decoder->header;
+    UInt16 end = (header->used <= SHT21_LOG_BLOCK_SIZE) ? header->used : SHT21_LOG_BLOCK_SIZE;
+
+    if (decoder->index >= header->count)
+        return 0;
+
+    if (decoder->index == 0)
+    {
+        decoder->prev.time_ms = header->first_ms;
+        decoder->prev.temp_ticks = header->first_temp;
+        decoder->prev.rh_ticks = header->first_rh;
+    }
+    else
+    {
+        unsigned long long dod, temp, rh;
+        UInt8 len;
+
+        if ((len = SHT21_Log_Get_Varint(decoder->data, end, decoder->offset, &dod)) == 0)
+            return 0;
+        decoder->offset += len;
+        if ((len = SHT21_Log_Get_Varint(decoder->data, end, decoder->offset, &temp)) == 0)
+            return 0;
+        decoder->offset += len;
+        if ((len = SHT21_Log_Get_Varint(decoder->data, end, decoder->offset, &rh)) == 0)
+            return 0;
+        decoder->offset += len;
+
+        decoder->prev_interval += (unsigned long long)SHT21_Log_Unzigzag(dod);
+        decoder->prev.time_ms += decoder->prev_interval;
+        decoder->prev.temp_ticks = (UInt16)(decoder->prev.temp_ticks + SHT21_Log_Unzigzag(temp));
+        decoder->prev.rh_ticks = (UInt16)(decoder->prev.rh_ticks + SHT21_Log_Unzigzag(rh));
+    }
+
+    decoder->index++;
+    *record = decoder->prev;
+    return 1;
+}
+
+/********************************************************************************************
+ *  Converts the temperature ticks of a record to degrees Celsius
+ *******************************************************************************************/
+float SHT21_Log_Temp(const SHT21_Log_Record_TypeDef* record)
+{
+    return SHT21_Convert_Temp((UInt16)(record->temp_ticks << 2));
+}
+
+/********************************************************************************************
+ *  Converts the humidity ticks of a record to %RH
+ *******************************************************************************************/
+float SHT21_Log_RH(const SHT21_Log_Record_TypeDef* record)
+{
+    return SHT21_Convert_RH((UInt16)(record->rh_ticks << 4));
+}
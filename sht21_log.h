@@ -0,0 +1,116 @@
+/********************************************************************************************
+ *  Filename: sht21_log.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Compact binary format for long SHT21 sample logs. Stores the raw 14 bit temperature
+ *  and 12 bit humidity ticks with a millisecond timestamp. The temperature drops the 2
+ *  status bits, the humidity also the 2 bits below its highest resolution, which are
+ *  always 0, so a humidity step is a delta of 1.
+ *
+ *  A log is a header followed by blocks of SHT21_LOG_BLOCK_SIZE bytes. Each block
+ *  starts with the time span, the number of samples and the first sample in full, the
+ *  rest are varints of the deltas to the previous sample:
+ *      - timestamp     : zigzag delta of the interval, 1 byte for a steady rate
+ *      - temperature   : zigzag delta of the ticks
+ *      - humidity      : zigzag delta of the ticks
+ *  Blocks are independent and sit at fixed offsets, so a reader finds the block of a
+ *  time by binary search over the block headers without decoding the rest.
+ *
+ *  All fields are little endian. Only the encoding is done here, see the Linux example
+ *  for a file writer and a memory mapped reader.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_LOG__H
+#define __SHT21_LOG__H
+
+#include "sht21_core.h"
+
+#ifndef SHT21_LOG_BLOCK_SIZE
+#define SHT21_LOG_BLOCK_SIZE        (512U)
+#endif
+
+#define SHT21_LOG_MAGIC             "SHT21LOG"
+#define SHT21_LOG_VERSION           (2U)
+#define SHT21_LOG_HEADER_SIZE       (16U)
+#define SHT21_LOG_BLOCK_HEADER_SIZE (24U)
+#define SHT21_LOG_RECORD_MAX        (16U)   // Largest encoded sample
+
+// Ticks stored for a 3 byte temperature or humidity frame
+#define SHT21_LOG_TEMP_TICKS(frame) ((UInt16)((((UInt16)(frame)[0] << 8) | (frame)[1]) >> 2))
+#define SHT21_LOG_RH_TICKS(frame)   ((UInt16)((((UInt16)(frame)[0] << 8) | (frame)[1]) >> 4))
+
+/********************************************************************************************
+ *  A decoded sample. temp_ticks is the reading >> 2, rh_ticks the reading >> 4.
+ *******************************************************************************************/
+typedef struct
+{
+    unsigned long long time_ms;
+    UInt16 temp_ticks;
+    UInt16 rh_ticks;
+} SHT21_Log_Record_TypeDef;
+
+/********************************************************************************************
+ *  Block header, stored at the start of every block
+ *
+ *  first_ms, last_ms   : Time of the first and last sample
+ *  count               : Number of samples
+ *  used                : Bytes used including the header, the rest is zero
+ *  first               : First sample, in full
+ *******************************************************************************************/
+typedef struct
+{
+    unsigned long long first_ms;
+    unsigned long long last_ms;
+    UInt16 count;
+    UInt16 used;
+    UInt16 first_temp;
+    UInt16 first_rh;
+} SHT21_Log_Block_Header_TypeDef;
+
+/********************************************************************************************
+ *  Block being written
+ *******************************************************************************************/
+typedef struct
+{
+    UInt8 data[SHT21_LOG_BLOCK_SIZE];
+    SHT21_Log_Block_Header_TypeDef header;
+    unsigned long long prev_interval;
+    UInt16 prev_temp;
+    UInt16 prev_rh;
+} SHT21_Log_Writer_TypeDef;
+
+/********************************************************************************************
+ *  Position in a block being read
+ *******************************************************************************************/
+typedef struct
+{
+    const UInt8* data;
+    SHT21_Log_Block_Header_TypeDef header;
+    UInt16 offset;
+    UInt16 index;
+    SHT21_Log_Record_TypeDef prev;
+    unsigned long long prev_interval;
+} SHT21_Log_Decoder_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void SHT21_Log_Write_Header(UInt8* buf);
+SHT21_Error_TypeDef SHT21_Log_Check_Header(const UInt8* buf);
+void SHT21_Log_Read_Block_Header(const UInt8* block, SHT21_Log_Block_Header_TypeDef* header);
+void SHT21_Log_Writer_Begin(SHT21_Log_Writer_TypeDef* writer);
+UInt8 SHT21_Log_Writer_Append(SHT21_Log_Writer_TypeDef* writer, const SHT21_Log_Record_TypeDef* record);
+SHT21_Error_TypeDef SHT21_Log_Writer_Resume(SHT21_Log_Writer_TypeDef* writer, const UInt8* block);
+void SHT21_Log_Decoder_Init(SHT21_Log_Decoder_TypeDef* decoder, const UInt8* block);
+UInt8 SHT21_Log_Decoder_Next(SHT21_Log_Decoder_TypeDef* decoder, SHT21_Log_Record_TypeDef* record);
+float SHT21_Log_Temp(const SHT21_Log_Record_TypeDef* record);
+float SHT21_Log_RH(const SHT21_Log_Record_TypeDef* record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_LOG__H
@@ -0,0 +1,213 @@
+/********************************************************************************************
+ *  Filename: sht21_mux.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 multiplexer scheduler
+ *
+ *******************************************************************************************/
+#include "sht21_mux.h"
+
+/********************************************************************************************
+ *  Sets up the scheduler. All sensors start idle and are started on the first step.
+ *******************************************************************************************/
+void SHT21_Mux_Init(SHT21_Mux_Scheduler_TypeDef* sched, SHT21_Bus_TypeDef* bus,
+                    SHT21_Mux_Sensor_TypeDef* sensors, UInt8 count)
+{
+    sched->bus = bus;
+    sched->sensors = sensors;
+    sched->count = count;
+    sched->next = 0;
+    sched->selected_mux = SHT21_MUX_NONE;
+    sched->selected_channel = 0;
+    sched->on_sample = 0;
+    sched->ctx = 0;
+
+    for (UInt8 i = 0; i < count; i++)
+    {
+        sensors[i].phase = SHT21_MUX_IDLE;
+        sensors[i].meas.state = SHT21_MEASURE_IDLE;
+        sensors[i].samples = 0;
+        sensors[i].sample.status = SHT21_BUSY;
+#ifdef SHT21_STATS
+        sensors[i].stats = 0;
+#endif
+    }
+}
+
+/********************************************************************************************
+ *  Enables a single channel on the mux. If another mux has a channel enabled it is
+ *  disabled first, since every sensor answers on the same address. Nothing is written
+ *  if the channel is already selected.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Mux_Select(SHT21_Mux_Scheduler_TypeDef* sched, UInt8 mux_address, UInt8 channel)
+{
+    SHT21_Bus_TypeDef* bus = sched->bus;
+    SHT21_Error_TypeDef status = SHT21_OK;
+
+    if (sched->selected_mux == mux_address && sched->selected_channel == channel)
+        return SHT21_OK;
+
+    if (sched->selected_mux != SHT21_MUX_NONE && sched->selected_mux != mux_address)
+    {
+        UInt8 disable = 0;
+        status = bus->write(bus->handle, sched->selected_mux, &disable, 1);
+        if (status != SHT21_OK)
+            return status;
+        sched->selected_mux = SHT21_MUX_NONE;
+    }
+
+    UInt8 enable = (UInt8)(1U << channel);
+    status = bus->write(bus->handle, mux_address, &enable, 1);
+    if (status != SHT21_OK)
+    {
+        sched->selected_mux = SHT21_MUX_NONE;
+        return status;
+    }
+
+    sched->selected_mux = mux_address;
+    sched->selected_channel = channel;
+    return SHT21_OK;
+}
+
+/********************************************************************************************
+ *  Ends the cycle of a sensor and reports the sample
+ *******************************************************************************************/
+static void SHT21_Mux_Finish(SHT21_Mux_Scheduler_TypeDef* sched, UInt8 index, SHT21_Error_TypeDef status)
+{
+    SHT21_Mux_Sensor_TypeDef* sensor = &sched->sensors[index];
+
+    sensor->sample.status = status;
+    sensor->phase = SHT21_MUX_IDLE;
+    if (status == SHT21_OK)
+        sensor->samples++;
+
+    if (sched->on_sample != 0)
+        sched->on_sample(sched->ctx, index, &sensor->sample);
+}
+
+/********************************************************************************************
+ *  Starts the next conversion of a sensor
+ *******************************************************************************************/
+static SHT21_Error_TypeDef SHT21_Mux_Start(SHT21_Mux_Sensor_TypeDef* sensor, SHT21_Bus_TypeDef* bus,
+                                           SHT21_Commands_TypeDef cmd, UInt32 now)
+{
+    SHT21_Read_Mode_TypeDef mode = (cmd == SHT21_TEMP_MEASURE) ? sensor->temp_mode : sensor->rh_mode;
+    SHT21_Error_TypeDef status = SHT21_Measure_Start_Mode(&sensor->meas, bus, cmd, sensor->resolution, mode);
+    if (status == SHT21_OK)
+        sensor->due_tick = now + SHT21_Conversion_Time(sensor->resolution, cmd);
+    return status;
+}
+
+/********************************************************************************************
+ *  Runs the work of a sensor that is due. Returns SHT21_BUSY if the sensor is still
+ *  converting.
+ *******************************************************************************************/
+static SHT21_Error_TypeDef SHT21_Mux_Service_Sensor(SHT21_Mux_Scheduler_TypeDef* sched, UInt8 index, UInt32 now)
+{
+    SHT21_Mux_Sensor_TypeDef* sensor = &sched->sensors[index];
+    SHT21_Bus_TypeDef* bus = sched->bus;
+    SHT21_Error_TypeDef status = SHT21_Mux_Select(sched, sensor->mux_address, sensor->channel);
+    if (status != SHT21_OK)
+        return status;
+
+    switch (sensor->phase)
+    {
+        case SHT21_MUX_IDLE:
+        status = SHT21_Mux_Start(sensor, bus, SHT21_TEMP_MEASURE, now);
+        if (status == SHT21_OK)
+            sensor->phase = SHT21_MUX_TEMP;
+        return status;
+
+        case SHT21_MUX_TEMP:
+        status = SHT21_Measure_Poll(&sensor->meas);
+        if (status != SHT21_OK)
+            return status;
+
+        // Start the humidity conversion while the channel is still selected
+        status = SHT21_Measure_Complete(&sensor->meas, &sensor->sample.temp);
+        if (status != SHT21_OK)
+            return status;
+
+        status = SHT21_Mux_Start(sensor, bus, SHT21_RH_MEASURE, now);
+        if (status == SHT21_OK)
+            sensor->phase = SHT21_MUX_RH;
+        return status;
+
+        case SHT21_MUX_RH:
+        status = SHT21_Measure_Poll(&sensor->meas);
+        if (status != SHT21_OK)
+            return status;
+
+        status = SHT21_Measure_Complete(&sensor->meas, &sensor->sample.humidity);
+        SHT21_Mux_Finish(sched, index, status);
+        return SHT21_OK;
+
+        default:
+        return SHT21_OK;
+    }
+}
+
+// Services a sensor with the bus counting into its stats, the bus keeps its own after
+static SHT21_Error_TypeDef SHT21_Mux_Service(SHT21_Mux_Scheduler_TypeDef* sched, UInt8 index, UInt32 now)
+{
+#ifdef SHT21_STATS
+    SHT21_Bus_TypeDef* bus = sched->bus;
+    SHT21_Stats_TypeDef* bus_stats = bus->stats;
+    SHT21_STATS_ATTACH(bus, sched->sensors[index].stats);
+    SHT21_Error_TypeDef status = SHT21_Mux_Service_Sensor(sched, index, now);
+    SHT21_STATS_ATTACH(bus, bus_stats);
+    return status;
+#else
+    return SHT21_Mux_Service_Sensor(sched, index, now);
+#endif
+}
+
+/********************************************************************************************
+ *  Services every sensor that is due, starting after the sensor serviced last so all
+ *  sensors get their turn. Returns the number of ms until the next sensor is due, 0 if
+ *  there is more work to do right away.
+ *******************************************************************************************/
+UInt32 SHT21_Mux_Step(SHT21_Mux_Scheduler_TypeDef* sched)
+{
+    SHT21_Bus_TypeDef* bus = sched->bus;
+    UInt32 wait = 0xFFFFFFFFU;
+    UInt8 first = sched->next;
+
+    for (UInt8 n = 0; n < sched->count; n++)
+    {
+        UInt8 index = (UInt8)((first + n) % sched->count);
+        SHT21_Mux_Sensor_TypeDef* sensor = &sched->sensors[index];
+        UInt32 now = bus->get_tick(bus->handle);
+        Int32 remaining = (Int32)(sensor->due_tick - now);
+
+        if (sensor->phase != SHT21_MUX_IDLE && remaining > 0)
+        {
+            if ((UInt32)remaining < wait)
+                wait = (UInt32)remaining;
+            continue;
+        }
+
+        SHT21_Error_TypeDef status = SHT21_Mux_Service(sched, index, now);
+        if (status == SHT21_BUSY)
+        {
+            wait = 0; // Converting longer than expected, poll again next step
+            continue;
+        }
+        if (status != SHT21_OK)
+            SHT21_Mux_Finish(sched, index, status);
+
+        // Sensor just started a conversion or went idle
+        now = bus->get_tick(bus->handle);
+        remaining = (Int32)(sensor->due_tick - now);
+        if (sensor->phase == SHT21_MUX_IDLE || remaining <= 0)
+            wait = 0;
+        else if ((UInt32)remaining < wait)
+            wait = (UInt32)remaining;
+
+        sched->next = (UInt8)((index + 1U) % sched->count);
+    }
+
+    return (wait == 0xFFFFFFFFU) ? 0 : wait;
+}
@@ -0,0 +1,88 @@
+/********************************************************************************************
+ *  Filename: sht21_mux.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Scheduler for several SHT21 sensors behind TCA9548A style I2C multiplexers. All
+ *  sensors share the fixed SHT21 address, so only one mux channel is enabled at a time.
+ *  The scheduler uses no hold master measurements and collects the result of one
+ *  sensor while the others are converting, keeping the bus busy instead of waiting.
+ *
+ *  Call SHT21_Mux_Step from the main loop. It never blocks and returns the number of
+ *  ms until the next sensor is due, which can be used to sleep.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_MUX__H
+#define __SHT21_MUX__H
+
+#include "sht21_core.h"
+
+#define SHT21_MUX_BASE_ADDRESS      (0x70U)
+#define SHT21_MUX_CHANNELS          (8U)
+#define SHT21_MUX_NONE              (0x00U)
+
+/********************************************************************************************
+ *  Phase of a sensor in the scheduler
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_MUX_IDLE              = (0x00U),
+    SHT21_MUX_TEMP              = (0x01U),
+    SHT21_MUX_RH                = (0x02U)
+} SHT21_Mux_Phase_TypeDef;
+
+/********************************************************************************************
+ *  A sensor behind a mux channel. Set mux_address, channel and resolution, and optionally
+ *  temp_mode and rh_mode to read less of each result, the rest is handled by the
+ *  scheduler. sample holds the last finished sample. With SHT21_STATS the bus counts
+ *  into stats while the sensor is serviced, set it after SHT21_Mux_Init.
+ *******************************************************************************************/
+typedef struct
+{
+    UInt8 mux_address;
+    UInt8 channel;
+    SHT21_Resolution_TypeDef resolution;
+    SHT21_Read_Mode_TypeDef temp_mode;
+    SHT21_Read_Mode_TypeDef rh_mode;
+
+    SHT21_Mux_Phase_TypeDef phase;
+    SHT21_Measurement_TypeDef meas;
+    UInt32 due_tick;
+    SHT21_Sample_TypeDef sample;
+    UInt32 samples;
+#ifdef SHT21_STATS
+    SHT21_Stats_TypeDef* stats;
+#endif
+} SHT21_Mux_Sensor_TypeDef;
+
+/********************************************************************************************
+ *  Scheduler over count sensors. on_sample is called with every finished sample, it
+ *  can be left as 0.
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Bus_TypeDef* bus;
+    SHT21_Mux_Sensor_TypeDef* sensors;
+    UInt8 count;
+    UInt8 next;
+    UInt8 selected_mux;
+    UInt8 selected_channel;
+    void (*on_sample)(void* ctx, UInt8 index, SHT21_Sample_TypeDef* sample);
+    void* ctx;
+} SHT21_Mux_Scheduler_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void SHT21_Mux_Init(SHT21_Mux_Scheduler_TypeDef* sched, SHT21_Bus_TypeDef* bus,
+                    SHT21_Mux_Sensor_TypeDef* sensors, UInt8 count);
+SHT21_Error_TypeDef SHT21_Mux_Select(SHT21_Mux_Scheduler_TypeDef* sched, UInt8 mux_address, UInt8 channel);
+UInt32 SHT21_Mux_Step(SHT21_Mux_Scheduler_TypeDef* sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_MUX__H
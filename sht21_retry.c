@@ -0,0 +1,135 @@
+/********************************************************************************************
+ *  Filename: sht21_retry.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 retry policy
+ *
+ *******************************************************************************************/
+#include "sht21_retry.h"
+
+/********************************************************************************************
+ *  Sets up the retry engine on bus. Pass 0 as policy for SHT21_RETRY_POLICY_DEFAULT.
+ *******************************************************************************************/
+void SHT21_Retry_Init(SHT21_Retry_TypeDef* retry, SHT21_Bus_TypeDef* bus, const SHT21_Retry_Policy_TypeDef* policy)
+{
+    static const SHT21_Retry_Policy_TypeDef default_policy = SHT21_RETRY_POLICY_DEFAULT;
+
+    retry->bus = bus;
+    retry->policy = policy ? *policy : default_policy;
+    retry->stats = (SHT21_Retry_Stats_TypeDef){0};
+}
+
+static SHT21_Error_TypeDef SHT21_Retry_Parse(SHT21_Bus_TypeDef* bus, SHT21_Commands_TypeDef cmd, UInt8* frame,
+                                             float* value)
+{
+    (void)bus;
+    if (cmd == SHT21_TEMP_MEASURE)
+        return SHT21_STATS_PARSED(bus, SHT21_Parse_Temp_Checked(frame, value));
+    return SHT21_STATS_PARSED(bus, SHT21_Parse_RH_Checked(frame, value));
+}
+
+// Writes the measurement command, again if the sensor NACKs it
+static SHT21_Error_TypeDef SHT21_Retry_Start(SHT21_Retry_TypeDef* retry, SHT21_Measurement_TypeDef* meas,
+                                             SHT21_Commands_TypeDef cmd)
+{
+    SHT21_Bus_TypeDef* bus = retry->bus;
+    SHT21_Error_TypeDef status = SHT21_Measure_Start(meas, bus, cmd);
+
+    for (UInt8 i = 0; status == SHT21_ACK_ERROR && i < retry->policy.command_writes; i++)
+    {
+        retry->stats.command_writes++;
+        bus->delay(bus->handle, retry->policy.poll_interval);
+        status = SHT21_Measure_Start(meas, bus, cmd);
+    }
+    return status;
+}
+
+// Sleeps the conversion time, then polls until the sensor answers or the measurement times out
+static SHT21_Error_TypeDef SHT21_Retry_Wait(SHT21_Retry_TypeDef* retry, SHT21_Measurement_TypeDef* meas,
+                                            UInt32 conversion_time)
+{
+    SHT21_Bus_TypeDef* bus = retry->bus;
+    UInt32 elapsed = bus->get_tick(bus->handle) - meas->start_tick;
+
+    if (elapsed < conversion_time)
+        bus->delay(bus->handle, conversion_time - elapsed);
+
+    for (;;)
+    {
+        retry->stats.polls++;
+        SHT21_Error_TypeDef status = SHT21_Measure_Poll(meas);
+        if (status != SHT21_BUSY)
+            return status;
+        bus->delay(bus->handle, retry->policy.poll_interval);
+    }
+}
+
+/********************************************************************************************
+ *  Blocking no hold master measurement with recovery. cmd is SHT21_TEMP_MEASURE or
+ *  SHT21_RH_MEASURE, res the active resolution. value is only written with SHT21_OK.
+ *  Returns the last error if the policy is used up.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Retry_Measure(SHT21_Retry_TypeDef* retry, SHT21_Commands_TypeDef cmd,
+                                        SHT21_Resolution_TypeDef res, float* value)
+{
+    SHT21_Bus_TypeDef* bus = retry->bus;
+    SHT21_Measurement_TypeDef meas;
+    SHT21_Error_TypeDef status = SHT21_TIME_OUT_ERROR;
+
+    retry->stats.measurements++;
+
+    for (UInt8 run = 0; run <= retry->policy.measurements; run++)
+    {
+        if (run > 0)
+            retry->stats.restarts++;
+
+        status = SHT21_Retry_Start(retry, &meas, cmd);
+        if (status != SHT21_OK)
+            break;
+
+        // A time out means the conversion is lost, anything else but OK is a bus error
+        status = SHT21_Retry_Wait(retry, &meas, SHT21_Conversion_Time(res, cmd));
+        if (status == SHT21_TIME_OUT_ERROR)
+            continue;
+        if (status != SHT21_OK)
+            break;
+
+        status = SHT21_Retry_Parse(bus, cmd, meas.frame, value);
+        for (UInt8 i = 0; status == SHT21_CHECKSUM_ERROR && i < retry->policy.frame_reads; i++)
+        {
+            retry->stats.frame_reads++;
+            UInt32 read_start = SHT21_STATS_NOW(bus);
+            SHT21_Error_TypeDef read_status = bus->read(bus->handle, SHT21_I2C_ADDRESS, meas.frame, 3);
+            SHT21_STATS_TRANSFER(bus, SHT21_STATS_READBACK, read_status, read_start);
+            if (read_status != SHT21_OK)
+                break; // The result was not kept, measure again
+            status = SHT21_Retry_Parse(bus, cmd, meas.frame, value);
+        }
+
+        if (status != SHT21_CHECKSUM_ERROR)
+            break;
+    }
+
+    if (status != SHT21_OK)
+        retry->stats.failures++;
+    return status;
+}
+
+/********************************************************************************************
+ *  Measures temperature and humidity with recovery. Unlike SHT21_Measure_Both the
+ *  humidity is only started once the temperature frame is good, the next command would
+ *  replace the result a frame read is retried on.
+ *******************************************************************************************/
+SHT21_Sample_TypeDef SHT21_Retry_Measure_Both(SHT21_Retry_TypeDef* retry, SHT21_Resolution_TypeDef res)
+{
+    SHT21_Sample_TypeDef sample = {0};
+
+    sample.status = SHT21_Retry_Measure(retry, SHT21_TEMP_MEASURE, res, &sample.temp);
+    if (sample.status != SHT21_OK)
+        return sample;
+
+    sample.status = SHT21_Retry_Measure(retry, SHT21_RH_MEASURE, res, &sample.humidity);
+    return sample;
+}
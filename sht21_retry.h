@@ -0,0 +1,75 @@
+/********************************************************************************************
+ *  Filename: sht21_retry.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  No hold master measurements that recover from transfer errors with the cheapest
+ *  action that fixes each of them:
+ *      - CRC error         : Only the 3 byte frame is read again
+ *      - NACKed command    : The command is written again
+ *      - NACK while polling: Polled again, the sensor is still converting
+ *      - Time out          : The whole measurement is repeated
+ *
+ *  Whether the SHT21 answers a second read of the same result is not specified in the
+ *  datasheet. If the re-read of the frame is NACKed the measurement is repeated, so the
+ *  policy works either way.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_RETRY__H
+#define __SHT21_RETRY__H
+
+#include "sht21_core.h"
+
+/********************************************************************************************
+ *  How many times each action is tried before giving up.
+ *
+ *  frame_reads     : Reads of the frame after a CRC error
+ *  command_writes  : Writes of a NACKed measurement command
+ *  measurements    : Repeated measurements after a time out or a frame that stays corrupt
+ *  poll_interval   : Time in ms between polls and command writes
+ *******************************************************************************************/
+typedef struct
+{
+    UInt8 frame_reads;
+    UInt8 command_writes;
+    UInt8 measurements;
+    UInt8 poll_interval;
+} SHT21_Retry_Policy_TypeDef;
+
+#define SHT21_RETRY_POLICY_DEFAULT  { 3U, 2U, 1U, 1U }
+
+/********************************************************************************************
+ *  Counts of the measurements and of every recovery action taken
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 measurements;
+    UInt32 failures;
+    UInt32 polls;
+    UInt32 frame_reads;
+    UInt32 command_writes;
+    UInt32 restarts;
+} SHT21_Retry_Stats_TypeDef;
+
+typedef struct
+{
+    SHT21_Bus_TypeDef* bus;
+    SHT21_Retry_Policy_TypeDef policy;
+    SHT21_Retry_Stats_TypeDef stats;
+} SHT21_Retry_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void SHT21_Retry_Init(SHT21_Retry_TypeDef* retry, SHT21_Bus_TypeDef* bus, const SHT21_Retry_Policy_TypeDef* policy);
+SHT21_Error_TypeDef SHT21_Retry_Measure(SHT21_Retry_TypeDef* retry, SHT21_Commands_TypeDef cmd,
+                                        SHT21_Resolution_TypeDef res, float* value);
+SHT21_Sample_TypeDef SHT21_Retry_Measure_Both(SHT21_Retry_TypeDef* retry, SHT21_Resolution_TypeDef res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_RETRY__H
@@ -0,0 +1,120 @@
+/********************************************************************************************
+ *  Filename: sht21_ring.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 sample ring. head and tail run freely and wrap, the
+ *  entry index is the lower bits. Each side keeps a copy of the other side's index and
+ *  only reloads it when the ring looks full or empty.
+ *
+ *******************************************************************************************/
+#include "sht21_ring.h"
+
+#define SHT21_RING_MASK             (SHT21_RING_CAPACITY - 1U)
+
+/********************************************************************************************
+ *  Empties the ring and clears the overflow count. Not safe while the ring is in use.
+ *******************************************************************************************/
+void SHT21_Ring_Init(SHT21_Ring_TypeDef* ring)
+{
+    ring->head = 0;
+    ring->tail_cache = 0;
+    ring->overflows = 0;
+    ring->tail = 0;
+    ring->head_cache = 0;
+}
+
+/********************************************************************************************
+ *  Producer side. Copies entry into the ring, returns 1 on success and 0 if the ring is
+ *  full and the entry was dropped.
+ *******************************************************************************************/
+UInt8 SHT21_Ring_Push(SHT21_Ring_TypeDef* ring, const SHT21_Ring_Entry_TypeDef* entry)
+{
+    UInt32 head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+    if ((UInt32)(head - ring->tail_cache) >= SHT21_RING_CAPACITY)
+    {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if ((UInt32)(head - ring->tail_cache) >= SHT21_RING_CAPACITY)
+        {
+            __atomic_store_n(&ring->overflows, __atomic_load_n(&ring->overflows, __ATOMIC_RELAXED) + 1U,
+                             __ATOMIC_RELAXED);
+            return 0;
+        }
+    }
+
+    ring->entries[head & SHT21_RING_MASK] = *entry;
+    __atomic_store_n(&ring->head, head + 1U, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/********************************************************************************************
+ *  Producer side. Pushes the 3 byte frame of a cmd measurement read at tick.
+ *******************************************************************************************/
+UInt8 SHT21_Ring_Push_Frame(SHT21_Ring_TypeDef* ring, UInt32 tick, SHT21_Commands_TypeDef cmd, const UInt8* frame)
+{
+    SHT21_Ring_Entry_TypeDef entry;
+    entry.tick = tick;
+    entry.kind = SHT21_RING_FRAME;
+    entry.cmd = (UInt8)cmd;
+    entry.data.frame[0] = frame[0];
+    entry.data.frame[1] = frame[1];
+    entry.data.frame[2] = frame[2];
+    return SHT21_Ring_Push(ring, &entry);
+}
+
+/********************************************************************************************
+ *  Producer side. Pushes a decoded sample taken at tick.
+ *******************************************************************************************/
+UInt8 SHT21_Ring_Push_Sample(SHT21_Ring_TypeDef* ring, UInt32 tick, const SHT21_Sample_TypeDef* sample)
+{
+    SHT21_Ring_Entry_TypeDef entry;
+    entry.tick = tick;
+    entry.kind = SHT21_RING_SAMPLE;
+    entry.cmd = 0;
+    entry.data.sample = *sample;
+    return SHT21_Ring_Push(ring, &entry);
+}
+
+/********************************************************************************************
+ *  Consumer side. Moves up to max entries into out, oldest first, and returns how many.
+ *******************************************************************************************/
+UInt32 SHT21_Ring_Pop_Batch(SHT21_Ring_TypeDef* ring, SHT21_Ring_Entry_TypeDef* out, UInt32 max)
+{
+    UInt32 tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+
+    if (ring->head_cache == tail)
+    {
+        ring->head_cache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (ring->head_cache == tail)
+            return 0;
+    }
+
+    UInt32 count = ring->head_cache - tail;
+    if (count > max)
+        count = max;
+
+    for (UInt32 i = 0; i < count; i++)
+        out[i] = ring->entries[(tail + i) & SHT21_RING_MASK];
+
+    __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+/********************************************************************************************
+ *  Number of entries waiting. Exact from the consumer, a snapshot from anywhere else.
+ *******************************************************************************************/
+UInt32 SHT21_Ring_Count(SHT21_Ring_TypeDef* ring)
+{
+    UInt32 tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+}
+
+/********************************************************************************************
+ *  Number of entries dropped because the ring was full, can be read from any context
+ *******************************************************************************************/
+UInt32 SHT21_Ring_Overflows(SHT21_Ring_TypeDef* ring)
+{
+    return __atomic_load_n(&ring->overflows, __ATOMIC_RELAXED);
+}
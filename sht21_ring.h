@@ -0,0 +1,95 @@
+/********************************************************************************************
+ *  Filename: sht21_ring.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Lock-free single producer, single consumer ring of timestamped SHT21 results. The
+ *  producer is typically the I2C completion interrupt pushing raw frames, the consumer
+ *  the main loop draining them in batches. No locks and no heap, the capacity is fixed
+ *  at compile time with SHT21_RING_CAPACITY.
+ *
+ *  A push into a full ring is dropped and counted in overflows, the producer can not
+ *  drop the oldest entry without racing the consumer.
+ *
+ *  Only one context may push and only one may pop. Uses the GCC __atomic builtins.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_RING__H
+#define __SHT21_RING__H
+
+#include "sht21_core.h"
+
+// Number of entries, must be a power of two
+#ifndef SHT21_RING_CAPACITY
+#define SHT21_RING_CAPACITY         (32U)
+#endif
+
+// Producer and consumer indices are kept apart to avoid false sharing on multicore hosts
+#ifndef SHT21_RING_CACHE_LINE
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+#define SHT21_RING_CACHE_LINE       (64U)
+#else
+#define SHT21_RING_CACHE_LINE       (4U)
+#endif
+#endif
+
+typedef char SHT21_Ring_Capacity_Check[(SHT21_RING_CAPACITY & (SHT21_RING_CAPACITY - 1U)) == 0U ? 1 : -1];
+
+/********************************************************************************************
+ *  What an entry holds
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_RING_FRAME            = (0x00U),
+    SHT21_RING_SAMPLE           = (0x01U)
+} SHT21_Ring_Kind_TypeDef;
+
+/********************************************************************************************
+ *  An entry of the ring. tick is when the result was read. A raw frame keeps the
+ *  measurement command in cmd so the consumer knows which parser to use, a sample is
+ *  already decoded.
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 tick;
+    UInt8 kind;
+    UInt8 cmd;
+    union
+    {
+        UInt8 frame[3];
+        SHT21_Sample_TypeDef sample;
+    } data;
+} SHT21_Ring_Entry_TypeDef;
+
+typedef struct
+{
+    // Written by the producer
+    UInt32 head __attribute__((aligned(SHT21_RING_CACHE_LINE)));
+    UInt32 tail_cache;
+    UInt32 overflows;
+
+    // Written by the consumer
+    UInt32 tail __attribute__((aligned(SHT21_RING_CACHE_LINE)));
+    UInt32 head_cache;
+
+    SHT21_Ring_Entry_TypeDef entries[SHT21_RING_CAPACITY] __attribute__((aligned(SHT21_RING_CACHE_LINE)));
+} SHT21_Ring_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void SHT21_Ring_Init(SHT21_Ring_TypeDef* ring);
+UInt8 SHT21_Ring_Push(SHT21_Ring_TypeDef* ring, const SHT21_Ring_Entry_TypeDef* entry);
+UInt8 SHT21_Ring_Push_Frame(SHT21_Ring_TypeDef* ring, UInt32 tick, SHT21_Commands_TypeDef cmd, const UInt8* frame);
+UInt8 SHT21_Ring_Push_Sample(SHT21_Ring_TypeDef* ring, UInt32 tick, const SHT21_Sample_TypeDef* sample);
+UInt32 SHT21_Ring_Pop_Batch(SHT21_Ring_TypeDef* ring, SHT21_Ring_Entry_TypeDef* out, UInt32 max);
+UInt32 SHT21_Ring_Count(SHT21_Ring_TypeDef* ring);
+UInt32 SHT21_Ring_Overflows(SHT21_Ring_TypeDef* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_RING__H
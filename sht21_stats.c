@@ -0,0 +1,167 @@
+/********************************************************************************************
+ *  Filename: sht21_stats.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 transaction stats, empty without SHT21_STATS
+ *
+ *******************************************************************************************/
+#include "sht21_core.h"
+
+#ifdef SHT21_STATS
+
+/********************************************************************************************
+ *  Clears the stats. get_us returns a free running us counter, latencies are not
+ *  recorded when it is 0.
+ *******************************************************************************************/
+void SHT21_Stats_Init(SHT21_Stats_TypeDef* stats, UInt32 (*get_us)(void* handle), void* handle)
+{
+    stats->get_us = get_us;
+    stats->handle = handle;
+    stats->seq = 0;
+    stats->data = (SHT21_Stats_Snapshot_TypeDef){0};
+}
+
+UInt32 SHT21_Stats_Now(SHT21_Stats_TypeDef* stats)
+{
+    if (stats == 0 || stats->get_us == 0)
+        return 0;
+    return stats->get_us(stats->handle);
+}
+
+// An update is fenced by seq, odd while it runs
+static void SHT21_Stats_Begin(SHT21_Stats_TypeDef* stats)
+{
+    stats->seq++;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void SHT21_Stats_End(SHT21_Stats_TypeDef* stats)
+{
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    stats->seq++;
+}
+
+static UInt8 SHT21_Stats_Bucket(UInt32 us)
+{
+    UInt8 bucket = (us > 1U) ? (UInt8)(31 - __builtin_clz(us)) : 0;
+    return (bucket < SHT21_STATS_BUCKETS) ? bucket : SHT21_STATS_BUCKETS - 1U;
+}
+
+void SHT21_Stats_Count(SHT21_Stats_TypeDef* stats, SHT21_Stats_Counter_TypeDef counter)
+{
+    if (stats == 0)
+        return;
+
+    SHT21_Stats_Begin(stats);
+    stats->data.counters[counter]++;
+    SHT21_Stats_End(stats);
+}
+
+void SHT21_Stats_Latency(SHT21_Stats_TypeDef* stats, SHT21_Stats_Latency_TypeDef latency, UInt32 us)
+{
+    if (stats == 0 || stats->get_us == 0)
+        return;
+
+    SHT21_Stats_Begin(stats);
+    stats->data.histograms[latency][SHT21_Stats_Bucket(us)]++;
+    SHT21_Stats_End(stats);
+}
+
+/********************************************************************************************
+ *  Counts a transfer that started at start_us and ended now with status. The latency
+ *  is only recorded for a transfer that succeeded.
+ *******************************************************************************************/
+void SHT21_Stats_Transfer(SHT21_Stats_TypeDef* stats, SHT21_Stats_Latency_TypeDef latency,
+                          SHT21_Error_TypeDef status, UInt32 start_us)
+{
+    if (stats == 0)
+        return;
+
+    UInt32 now = SHT21_Stats_Now(stats);
+
+    SHT21_Stats_Begin(stats);
+    stats->data.counters[SHT21_STATS_TRANSACTIONS]++;
+    switch (status)
+    {
+        case SHT21_OK:
+        if (stats->get_us != 0)
+            stats->data.histograms[latency][SHT21_Stats_Bucket(now - start_us)]++;
+        break;
+        case SHT21_ACK_ERROR:
+        stats->data.counters[SHT21_STATS_NACKS]++;
+        break;
+        case SHT21_TIME_OUT_ERROR:
+        stats->data.counters[SHT21_STATS_TIMEOUTS]++;
+        break;
+        default:
+        stats->data.counters[SHT21_STATS_BUS_ERRORS]++;
+        break;
+    }
+    SHT21_Stats_End(stats);
+}
+
+/********************************************************************************************
+ *  Counts the status of a parsed result frame and passes it on
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Stats_Parsed(SHT21_Stats_TypeDef* stats, SHT21_Error_TypeDef status)
+{
+    if (status == SHT21_CHECKSUM_ERROR)
+        SHT21_Stats_Count(stats, SHT21_STATS_CRC_ERRORS);
+    return status;
+}
+
+/********************************************************************************************
+ *  Copies a consistent view of the stats, safe to call while measurements run in
+ *  another context
+ *******************************************************************************************/
+void SHT21_Stats_Snapshot(const SHT21_Stats_TypeDef* stats, SHT21_Stats_Snapshot_TypeDef* snapshot)
+{
+    UInt32 seq;
+    do
+    {
+        seq = __atomic_load_n(&stats->seq, __ATOMIC_ACQUIRE);
+        *snapshot = stats->data;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1U) != 0 || seq != __atomic_load_n(&stats->seq, __ATOMIC_RELAXED));
+}
+
+/********************************************************************************************
+ *  Clears the counters and histograms. Call it from the context doing the measurements,
+ *  or take a snapshot and report the difference to the previous one instead.
+ *******************************************************************************************/
+void SHT21_Stats_Reset(SHT21_Stats_TypeDef* stats)
+{
+    SHT21_Stats_Begin(stats);
+    stats->data = (SHT21_Stats_Snapshot_TypeDef){0};
+    SHT21_Stats_End(stats);
+}
+
+/********************************************************************************************
+ *  Upper bound in us of the bucket that holds the given percentile of a latency, 0 if
+ *  nothing was recorded and 0xFFFFFFFF for the open ended last bucket
+ *******************************************************************************************/
+UInt32 SHT21_Stats_Percentile(const SHT21_Stats_Snapshot_TypeDef* snapshot, SHT21_Stats_Latency_TypeDef latency,
+                              UInt8 percent)
+{
+    const UInt32* buckets = snapshot->histograms[latency];
+    UInt32 total = 0;
+    UInt32 seen = 0;
+    UInt8 i;
+
+    for (i = 0; i < SHT21_STATS_BUCKETS; i++)
+        total += buckets[i];
+    if (total == 0)
+        return 0;
+
+    for (i = 0; i < SHT21_STATS_BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if ((unsigned long long)seen * 100U >= (unsigned long long)total * percent)
+            break;
+    }
+    return (i < SHT21_STATS_BUCKETS - 1U) ? (2UL << i) - 1U : 0xFFFFFFFFU;
+}
+
+#endif // SHT21_STATS
@@ -0,0 +1,103 @@
+/********************************************************************************************
+ *  Filename: sht21_stats.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Opt-in counters and latency histograms of the bus transactions of a sensor. Only
+ *  built with SHT21_STATS defined for every file of the driver, without it the
+ *  instrumentation macros of sht21_core.h are empty and nothing is added to the bus or
+ *  measurement structs.
+ *
+ *  Attach a SHT21_Stats_TypeDef to the bus of a sensor with bus.stats, or to each
+ *  SHT21_Mux_Sensor_TypeDef behind a mux. A bus with stats set to 0 is not counted.
+ *
+ *  Latencies are in us from the get_us function passed to SHT21_Stats_Init, in log2
+ *  buckets: bucket 0 holds 0 and 1 us, bucket n holds 2^n to 2^(n+1) - 1 us and the
+ *  last bucket everything above.
+ *      Command write   : Writing a measurement command
+ *      Conversion      : End of the command write to the start of the read that got
+ *                        the result, including the NACKed polls
+ *      Readback        : The read of the result frame
+ *
+ *  The measurements update the stats from one context. SHT21_Stats_Snapshot can be
+ *  called from another, it retries while an update is in progress.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_STATS__H
+#define __SHT21_STATS__H
+
+#include "sht21_core.h"
+
+#define SHT21_STATS_BUCKETS         (20U)
+
+/********************************************************************************************
+ *  Counters
+ *
+ *  transactions    : Reads and writes on the bus
+ *  crc_errors      : Result frames with a bad checksum
+ *  nacks           : Transfers NACKed by the sensor, not counting the polls below
+ *  busy_polls      : Reads NACKed while the sensor was still converting
+ *  timeouts        : Measurements the sensor did not answer in time, and bus time outs
+ *  bus_errors      : Any other failed transfer
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_STATS_TRANSACTIONS    = (0x00U),
+    SHT21_STATS_CRC_ERRORS      = (0x01U),
+    SHT21_STATS_NACKS           = (0x02U),
+    SHT21_STATS_BUSY_POLLS      = (0x03U),
+    SHT21_STATS_TIMEOUTS        = (0x04U),
+    SHT21_STATS_BUS_ERRORS      = (0x05U),
+    SHT21_STATS_COUNTERS        = (0x06U)
+} SHT21_Stats_Counter_TypeDef;
+
+typedef enum
+{
+    SHT21_STATS_COMMAND_WRITE   = (0x00U),
+    SHT21_STATS_CONVERSION      = (0x01U),
+    SHT21_STATS_READBACK        = (0x02U),
+    SHT21_STATS_LATENCIES       = (0x03U)
+} SHT21_Stats_Latency_TypeDef;
+
+/********************************************************************************************
+ *  A copy of the counters and histograms, indexed by the enums above
+ *******************************************************************************************/
+typedef struct
+{
+    UInt32 counters[SHT21_STATS_COUNTERS];
+    UInt32 histograms[SHT21_STATS_LATENCIES][SHT21_STATS_BUCKETS];
+} SHT21_Stats_Snapshot_TypeDef;
+
+/********************************************************************************************
+ *  Stats of one sensor. seq is odd while an update is in progress.
+ *******************************************************************************************/
+typedef struct SHT21_Stats
+{
+    volatile UInt32 seq;
+    SHT21_Stats_Snapshot_TypeDef data;
+    UInt32 (*get_us)(void* handle);
+    void* handle;
+} SHT21_Stats_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void SHT21_Stats_Init(SHT21_Stats_TypeDef* stats, UInt32 (*get_us)(void* handle), void* handle);
+UInt32 SHT21_Stats_Now(SHT21_Stats_TypeDef* stats);
+void SHT21_Stats_Count(SHT21_Stats_TypeDef* stats, SHT21_Stats_Counter_TypeDef counter);
+void SHT21_Stats_Latency(SHT21_Stats_TypeDef* stats, SHT21_Stats_Latency_TypeDef latency, UInt32 us);
+void SHT21_Stats_Transfer(SHT21_Stats_TypeDef* stats, SHT21_Stats_Latency_TypeDef latency,
+                          SHT21_Error_TypeDef status, UInt32 start_us);
+SHT21_Error_TypeDef SHT21_Stats_Parsed(SHT21_Stats_TypeDef* stats, SHT21_Error_TypeDef status);
+void SHT21_Stats_Snapshot(const SHT21_Stats_TypeDef* stats, SHT21_Stats_Snapshot_TypeDef* snapshot);
+void SHT21_Stats_Reset(SHT21_Stats_TypeDef* stats);
+UInt32 SHT21_Stats_Percentile(const SHT21_Stats_Snapshot_TypeDef* snapshot, SHT21_Stats_Latency_TypeDef latency,
+                              UInt8 percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_STATS__H
@@ -0,0 +1,252 @@
+/********************************************************************************************
+ *  Filename: sht21_template.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Header only C++ driver for a SHT21 with a resolution fixed at compile time.
+ *  Sht21<Bus, Res> takes the conversion times, reading masks, frame length and
+ *  conversion constants of the resolution as constants, and calls the bus policy
+ *  directly instead of through the function pointers of SHT21_Bus_TypeDef, so the
+ *  compiler can inline the whole transaction.
+ *
+ *  A bus policy is any class with these members:
+ *      SHT21_Error_TypeDef write(UInt8 address, UInt8* buf, UInt8 len);
+ *      SHT21_Error_TypeDef read(UInt8 address, UInt8* buf, UInt8 len);
+ *      UInt32 get_tick();
+ *      void delay(UInt32 ms);
+ *  with the same meaning as in SHT21_Bus_TypeDef. Sht21_Bus_Policy runs on an existing
+ *  SHT21_Bus_TypeDef. Policies for the simulator, Arduino Wire, the STM32 HAL and Linux
+ *  are in sim/sht21_sim_bus.h and next to the examples.
+ *
+ *  Needs C++11 and sht21_core.c for the checksum. The transactions are not counted
+ *  with SHT21_STATS.
+ *
+ *      Sht21<Sht21_Sim_Bus, SHT21_RES_RH11_T11> sensor(Sht21_Sim_Bus(&sim));
+ *      sensor.configure();
+ *      SHT21_Sample_TypeDef sample = sensor.measure_both();
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_TEMPLATE__H
+#define __SHT21_TEMPLATE__H
+
+#include "sht21_core.h"
+
+/********************************************************************************************
+ *  Constants of a resolution. Bits are the resolution of the readings, the bits below
+ *  them and the two status bits are masked out of a reading.
+ *******************************************************************************************/
+template <SHT21_Resolution_TypeDef Res>
+struct Sht21_Resolution_Traits
+{
+  static constexpr UInt8 temp_bits = (Res == SHT21_RES_RH12_T14) ? 14U :
+                                     (Res == SHT21_RES_RH8_T12)  ? 12U :
+                                     (Res == SHT21_RES_RH10_T13) ? 13U : 11U;
+  static constexpr UInt8 rh_bits   = (Res == SHT21_RES_RH12_T14) ? 12U :
+                                     (Res == SHT21_RES_RH8_T12)  ? 8U :
+                                     (Res == SHT21_RES_RH10_T13) ? 10U : 11U;
+
+  // Datasheet maximum in ms, as SHT21_Conversion_Time
+  static constexpr UInt8 temp_time = (Res == SHT21_RES_RH12_T14) ? 85U :
+                                     (Res == SHT21_RES_RH8_T12)  ? 22U :
+                                     (Res == SHT21_RES_RH10_T13) ? 43U : 11U;
+  static constexpr UInt8 rh_time   = (Res == SHT21_RES_RH12_T14) ? 29U :
+                                     (Res == SHT21_RES_RH8_T12)  ? 4U :
+                                     (Res == SHT21_RES_RH10_T13) ? 9U : 15U;
+
+  static constexpr UInt16 temp_mask = (UInt16)((0xFFFFU << (16U - temp_bits)) & 0xFFFCU);
+  static constexpr UInt16 rh_mask   = (UInt16)((0xFFFFU << (16U - rh_bits)) & 0xFFFCU);
+
+  // Reading and checksum
+  static constexpr UInt8 frame_length = 3U;
+
+  // The resolution bits of the user register
+  static constexpr UInt8 user_reg_bits = ((Res & 0x2U) ? SHT21_MEAS_RESOLUTION_BIT1 : 0U) |
+                                         ((Res & 0x1U) ? SHT21_MEAS_RESOLUTION_BIT2 : 0U);
+};
+
+/********************************************************************************************
+ *  Bus policy on a SHT21_Bus_TypeDef, for platforms that only have the C glue. Keeps
+ *  the indirect calls of the C core.
+ *******************************************************************************************/
+class Sht21_Bus_Policy
+{
+public:
+  explicit Sht21_Bus_Policy(SHT21_Bus_TypeDef* bus) : bus(bus) {}
+
+  SHT21_Error_TypeDef write(UInt8 address, UInt8* buf, UInt8 len) { return bus->write(bus->handle, address, buf, len); }
+  SHT21_Error_TypeDef read(UInt8 address, UInt8* buf, UInt8 len) { return bus->read(bus->handle, address, buf, len); }
+  UInt32 get_tick() { return bus->get_tick(bus->handle); }
+  void delay(UInt32 ms) { bus->delay(bus->handle, ms); }
+
+private:
+  SHT21_Bus_TypeDef* bus;
+};
+
+template <class Bus, SHT21_Resolution_TypeDef Res = SHT21_RES_RH12_T14>
+class Sht21
+{
+public:
+  typedef Sht21_Resolution_Traits<Res> Traits;
+
+  explicit Sht21(const Bus& bus) : bus(bus) {}
+
+  Bus& get_bus() { return bus; }
+
+  /********************************************************************************************
+   *  Maximum conversion time in ms of a measurement command, 0 for other commands
+   *******************************************************************************************/
+  static constexpr UInt8 conversion_time(SHT21_Commands_TypeDef cmd)
+  {
+    return (cmd == SHT21_TEMP_MEASURE || cmd == SHT21_TEMP_MEASURE_HOLD) ? Traits::temp_time :
+           (cmd == SHT21_RH_MEASURE || cmd == SHT21_RH_MEASURE_HOLD)     ? Traits::rh_time : 0U;
+  }
+
+  /********************************************************************************************
+   *  Writes Res into the user register, keeping the other bits. Call it once after
+   *  power up or a reset, the readings are masked to Res.
+   *******************************************************************************************/
+  SHT21_Error_TypeDef configure()
+  {
+    UInt8 buf[2] = { SHT21_READ_USER_REG, 0 };
+    SHT21_Error_TypeDef status = bus.write(SHT21_I2C_ADDRESS, buf, 1);
+    if (status == SHT21_OK)
+      status = bus.read(SHT21_I2C_ADDRESS, &buf[1], 1);
+    if (status != SHT21_OK)
+      return status;
+
+    SHT21_User_Reg_TypeDef reg = SHT21_Parse_User_Reg(&buf[1]);
+    reg = SHT21_Update_User_Reg_Fields(reg, SHT21_MEAS_RESOLUTION_BIT1 | SHT21_MEAS_RESOLUTION_BIT2,
+                                       Traits::user_reg_bits);
+    buf[0] = SHT21_WRITE_USER_REG;
+    buf[1] = reg.reg;
+    return bus.write(SHT21_I2C_ADDRESS, buf, 2);
+  }
+
+  /********************************************************************************************
+   *  Sends a soft reset, the sensor is back at RH12/T14 after 15 ms
+   *******************************************************************************************/
+  SHT21_Error_TypeDef reset()
+  {
+    UInt8 cmd = SHT21_SOFT_RESET;
+    return bus.write(SHT21_I2C_ADDRESS, &cmd, 1);
+  }
+
+  /********************************************************************************************
+   *  Masked temperature and humidity readings, see SHT21_Parse_Reading
+   *******************************************************************************************/
+  SHT21_Error_TypeDef read_temp_reading(UInt16* reading) { return measure(SHT21_TEMP_MEASURE, Traits::temp_mask, reading); }
+  SHT21_Error_TypeDef read_rh_reading(UInt16* reading) { return measure(SHT21_RH_MEASURE, Traits::rh_mask, reading); }
+
+  SHT21_Error_TypeDef read_temp(float* temp)
+  {
+    UInt16 reading;
+    SHT21_Error_TypeDef status = read_temp_reading(&reading);
+    if (status == SHT21_OK)
+      *temp = convert_temp(reading);
+    return status;
+  }
+
+  SHT21_Error_TypeDef read_humidity(float* humidity)
+  {
+    UInt16 reading;
+    SHT21_Error_TypeDef status = read_rh_reading(&reading);
+    if (status == SHT21_OK)
+      *humidity = convert_rh(reading);
+    return status;
+  }
+
+  /********************************************************************************************
+   *  Measures temperature and humidity as SHT21_Measure_Both, the temperature frame is
+   *  checked and converted while the humidity conversion runs
+   *******************************************************************************************/
+  SHT21_Sample_TypeDef measure_both()
+  {
+    SHT21_Sample_TypeDef sample = SHT21_Sample_TypeDef();
+    UInt8 temp_frame[Traits::frame_length];
+    UInt8 rh_frame[Traits::frame_length];
+    UInt32 start;
+
+    sample.status = start_measurement(SHT21_TEMP_MEASURE, &start);
+    if (sample.status != SHT21_OK)
+      return sample;
+    sample.status = wait(start, Traits::temp_time, temp_frame);
+    if (sample.status != SHT21_OK)
+      return sample;
+
+    sample.status = start_measurement(SHT21_RH_MEASURE, &start);
+    if (sample.status != SHT21_OK)
+      return sample;
+
+    UInt16 reading;
+    SHT21_Error_TypeDef temp_status = parse(temp_frame, Traits::temp_mask, &reading);
+    if (temp_status == SHT21_OK)
+      sample.temp = convert_temp(reading);
+
+    sample.status = wait(start, Traits::rh_time, rh_frame);
+    if (sample.status != SHT21_OK)
+      return sample;
+
+    sample.status = parse(rh_frame, Traits::rh_mask, &reading);
+    if (sample.status == SHT21_OK)
+      sample.humidity = convert_rh(reading);
+    if (temp_status != SHT21_OK)
+      sample.status = temp_status;
+    return sample;
+  }
+
+  // Same results as SHT21_Convert_Temp and SHT21_Convert_RH, the scale is a power of 2
+  static float convert_temp(UInt16 reading) { return -46.85f + (175.72f / 65536.0f) * (float)reading; }
+  static float convert_rh(UInt16 reading) { return -6.0f + (125.0f / 65536.0f) * (float)reading; }
+
+private:
+  Bus bus;
+
+  SHT21_Error_TypeDef start_measurement(SHT21_Commands_TypeDef cmd, UInt32* start)
+  {
+    UInt8 tx_buf = (UInt8)cmd;
+    SHT21_Error_TypeDef status = bus.write(SHT21_I2C_ADDRESS, &tx_buf, 1);
+    *start = bus.get_tick();
+    return status;
+  }
+
+  // Sleeps for what is left of the conversion time, then polls once per ms
+  SHT21_Error_TypeDef wait(UInt32 start, UInt32 time, UInt8* frame)
+  {
+    UInt32 elapsed = bus.get_tick() - start;
+    if (elapsed < time)
+      bus.delay(time - elapsed);
+
+    for (;;)
+    {
+      SHT21_Error_TypeDef status = bus.read(SHT21_I2C_ADDRESS, frame, Traits::frame_length);
+      if (status != SHT21_ACK_ERROR)
+        return status;
+      if ((UInt32)(bus.get_tick() - start) > SHT21_MEASURE_TIMEOUT)
+        return SHT21_TIME_OUT_ERROR;
+      bus.delay(1);
+    }
+  }
+
+  static SHT21_Error_TypeDef parse(UInt8* frame, UInt16 mask, UInt16* reading)
+  {
+    if (SHT21_Check_Crc(frame, 2, frame[2]) != 0)
+      return SHT21_CHECKSUM_ERROR;
+    *reading = (UInt16)(((frame[0] << 8) | frame[1]) & mask);
+    return SHT21_OK;
+  }
+
+  SHT21_Error_TypeDef measure(SHT21_Commands_TypeDef cmd, UInt16 mask, UInt16* reading)
+  {
+    UInt8 frame[Traits::frame_length];
+    UInt32 start;
+    SHT21_Error_TypeDef status = start_measurement(cmd, &start);
+    if (status == SHT21_OK)
+      status = wait(start, conversion_time(cmd), frame);
+    if (status == SHT21_OK)
+      status = parse(frame, mask, reading);
+    return status;
+  }
+};
+
+#endif // __SHT21_TEMPLATE__H
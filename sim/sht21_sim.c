@@ -0,0 +1,397 @@
+/********************************************************************************************
+ *  Filename: sht21_sim.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Implementation of the SHT21 model
+ *
+ *******************************************************************************************/
+#include "sht21_sim.h"
+#include "sht21_mux.h"
+
+#include <math.h>
+
+#define SHT21_SIM_USER_REG_DEFAULT  (SHT21_DISABLE_OTP_RELOAD)
+#define SHT21_SIM_STATUS_RH         (0x02U)     // Bit 1 of the LSB is set for humidity
+
+// Resolution in bits for each SHT21_Resolution_TypeDef
+static const UInt8 sht21_sim_temp_bits[4] = { 14U, 12U, 13U, 11U };
+static const UInt8 sht21_sim_rh_bits[4]   = { 12U, 8U, 10U, 11U };
+
+/********************************************************************************************
+ *  Moves the virtual clock forward
+ *******************************************************************************************/
+void SHT21_Sim_Advance(SHT21_Sim_Clock_TypeDef* clock, unsigned long long us)
+{
+    clock->now_us += us;
+}
+
+/********************************************************************************************
+ *  Occupies the bus for a transfer of len data bytes: start, address, data and stop
+ *******************************************************************************************/
+static void SHT21_Sim_Transfer(SHT21_Sim_Clock_TypeDef* clock, UInt32 bit_time_us, UInt8 len)
+{
+    unsigned long long us = (2ULL + 9ULL * (1ULL + len)) * bit_time_us;
+    clock->now_us += us;
+    clock->bus_busy_us += us;
+}
+
+static UInt32 SHT21_Sim_Random(SHT21_Sim_TypeDef* sim)
+{
+    sim->seed = sim->seed * 1103515245U + 12345U;
+    return (sim->seed >> 8) & 0xFFFFU;
+}
+
+static UInt8 SHT21_Sim_Crc(UInt8* buf, UInt8 length)
+{
+    UInt8 crc = 0;
+    for (UInt8 i = 0; i < length; i++)
+    {
+        crc ^= buf[i];
+        for (UInt8 bit = 8; bit > 0; --bit)
+        {
+            if (crc & 0x80)
+                crc = (UInt8)((crc << 1) ^ SHT21_CRC_POLYNOMIAL);
+            else
+                crc = (UInt8)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/********************************************************************************************
+ *  Moves the heater temperature rise towards its target since the last access
+ *******************************************************************************************/
+static void SHT21_Sim_Update_Heater(SHT21_Sim_TypeDef* sim)
+{
+    unsigned long long now = sim->clock->now_us;
+    float target = (sim->user_reg & SHT21_ENABLE_CHIP_HEATER) ? sim->heater_max : 0.0f;
+    float dt = (float)(now - sim->heater_update_us);
+
+    sim->heater_rise += (target - sim->heater_rise) * (1.0f - expf(-dt / SHT21_SIM_HEATER_TAU_US));
+    sim->heater_update_us = now;
+}
+
+/********************************************************************************************
+ *  Returns the 16 bit reading the sensor would give now, quantized to the active
+ *  resolution and with the status bits set.
+ *******************************************************************************************/
+UInt16 SHT21_Sim_Reading(SHT21_Sim_TypeDef* sim, UInt8 humidity)
+{
+    SHT21_User_Reg_TypeDef reg;
+    reg.reg = sim->user_reg;
+    SHT21_Resolution_TypeDef res = SHT21_Get_Resolution(reg);
+
+    SHT21_Sim_Update_Heater(sim);
+
+    float ticks;
+    UInt8 bits;
+    if (humidity)
+    {
+        float rh = sim->humidity - SHT21_SIM_RH_PER_C * sim->heater_rise;
+        ticks = (rh + 6.0f) / 125.0f * 65536.0f;
+        bits = sht21_sim_rh_bits[res];
+    }
+    else
+    {
+        float temp = sim->temp + sim->heater_rise;
+        ticks = (temp + 46.85f) / 175.72f * 65536.0f;
+        bits = sht21_sim_temp_bits[res];
+    }
+
+    if (ticks < 0.0f)
+        ticks = 0.0f;
+    if (ticks > 65535.0f)
+        ticks = 65535.0f;
+
+    UInt16 reading = (UInt16)(ticks + 0.5f > 65535.0f ? 65535.0f : ticks + 0.5f);
+    reading &= (UInt16)(0xFFFFU << (16U - bits)) & 0xFFFCU;
+    if (humidity)
+        reading |= SHT21_SIM_STATUS_RH;
+    return reading;
+}
+
+/********************************************************************************************
+ *  Returns 1 if the sensor does not answer this transfer
+ *******************************************************************************************/
+static UInt8 SHT21_Sim_Nack(SHT21_Sim_TypeDef* sim, UInt8 address)
+{
+    if (address != SHT21_I2C_ADDRESS || sim->clock->now_us < sim->reset_until_us)
+        return 1;
+
+    if (sim->inject_nacks > 0)
+    {
+        sim->inject_nacks--;
+        return 1;
+    }
+    return 0;
+}
+
+/********************************************************************************************
+ *  Handles a write to the sensor, the first byte is the command
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Sim_Write(SHT21_Sim_TypeDef* sim, UInt8 address, UInt8* buf, UInt8 len)
+{
+    sim->transactions++;
+    UInt8 converting = sim->pending == SHT21_SIM_MEASURE && sim->clock->now_us < sim->ready_us;
+    if (len == 0 || SHT21_Sim_Nack(sim, address) || (sim->busy_write_nack && converting))
+    {
+        sim->nacks++;
+        SHT21_Sim_Transfer(sim->clock, sim->bit_time_us, 0);
+        return SHT21_ACK_ERROR;
+    }
+    SHT21_Sim_Transfer(sim->clock, sim->bit_time_us, len);
+    SHT21_Sim_Update_Heater(sim);
+
+    SHT21_User_Reg_TypeDef reg;
+    reg.reg = sim->user_reg;
+    unsigned long long conversion_us;
+
+    switch (buf[0])
+    {
+        case SHT21_TEMP_MEASURE_HOLD:
+        case SHT21_RH_MEASURE_HOLD:
+        case SHT21_TEMP_MEASURE:
+        case SHT21_RH_MEASURE:
+        conversion_us = 1000ULL * SHT21_Conversion_Time(SHT21_Get_Resolution(reg), (SHT21_Commands_TypeDef)buf[0]);
+        sim->cmd = buf[0];
+        sim->pending = SHT21_SIM_MEASURE;
+        sim->ready_us = sim->clock->now_us + conversion_us * sim->conversion_percent / 100U;
+        sim->conversions++;
+        return SHT21_OK;
+
+        case SHT21_READ_USER_REG:
+        sim->cmd = buf[0];
+        sim->pending = SHT21_SIM_USER_REG;
+        return SHT21_OK;
+
+        case SHT21_WRITE_USER_REG:
+        if (len < 2)
+            return SHT21_OK;
+        // Reserved and status bits are kept
+        sim->user_reg = (UInt8)((sim->user_reg & ~SHT21_USER_REG_WRITABLE) | (buf[1] & SHT21_USER_REG_WRITABLE));
+        sim->pending = SHT21_SIM_NONE;
+        return SHT21_OK;
+
+        case SHT21_SOFT_RESET:
+        // Everything but the heater bit goes back to default
+        sim->user_reg = (UInt8)(SHT21_SIM_USER_REG_DEFAULT | (sim->user_reg & SHT21_ENABLE_CHIP_HEATER));
+        sim->pending = SHT21_SIM_NONE;
+        sim->reset_until_us = sim->clock->now_us + sim->reset_time_us;
+        return SHT21_OK;
+
+        default:
+        sim->nacks++;
+        return SHT21_ACK_ERROR;
+    }
+}
+
+/********************************************************************************************
+ *  Handles a read from the sensor. A hold master measurement stretches the clock until
+ *  the conversion is done, a no hold measurement is NACKed until then.
+ *******************************************************************************************/
+SHT21_Error_TypeDef SHT21_Sim_Read(SHT21_Sim_TypeDef* sim, UInt8 address, UInt8* buf, UInt8 len)
+{
+    sim->transactions++;
+    if (SHT21_Sim_Nack(sim, address) || sim->pending == SHT21_SIM_NONE)
+    {
+        sim->nacks++;
+        SHT21_Sim_Transfer(sim->clock, sim->bit_time_us, 0);
+        return SHT21_ACK_ERROR;
+    }
+
+    if (sim->pending == SHT21_SIM_USER_REG)
+    {
+        SHT21_Sim_Transfer(sim->clock, sim->bit_time_us, len);
+        for (UInt8 i = 0; i < len; i++)
+            buf[i] = 0;
+        if (len > 0)
+            buf[0] = (UInt8)(sim->user_reg | (sim->vdd_low ? SHT21_STATUS : 0U));
+        sim->pending = SHT21_SIM_NONE;
+        return SHT21_OK;
+    }
+
+    if (sim->clock->now_us < sim->ready_us)
+    {
+        if (sim->cmd == SHT21_TEMP_MEASURE || sim->cmd == SHT21_RH_MEASURE)
+        {
+            sim->nacks++;
+            SHT21_Sim_Transfer(sim->clock, sim->bit_time_us, 0);
+            return SHT21_ACK_ERROR;
+        }
+
+        // Hold master, the SHT21 keeps SCL low until the conversion is done
+        sim->stretch_us += sim->ready_us - sim->clock->now_us;
+        sim->clock->bus_busy_us += sim->ready_us - sim->clock->now_us;
+        sim->clock->now_us = sim->ready_us;
+    }
+    SHT21_Sim_Transfer(sim->clock, sim->bit_time_us, len);
+
+    UInt8 humidity = (sim->cmd == SHT21_RH_MEASURE || sim->cmd == SHT21_RH_MEASURE_HOLD);
+    UInt16 reading = SHT21_Sim_Reading(sim, humidity);
+    UInt8 frame[3];
+    frame[0] = (UInt8)(reading >> 8);
+    frame[1] = (UInt8)(reading & 0xFFU);
+    frame[2] = SHT21_Sim_Crc(frame, 2);
+
+    // Flip one bit of the frame if an error is due
+    UInt8 flip = 0;
+    if (sim->inject_bit_errors > 0)
+    {
+        sim->inject_bit_errors--;
+        flip = 1;
+    }
+    else if (sim->bit_error_rate > 0 && SHT21_Sim_Random(sim) < sim->bit_error_rate)
+        flip = 1;
+
+    if (flip)
+    {
+        UInt32 bit = SHT21_Sim_Random(sim) % 24U;
+        frame[bit / 8U] ^= (UInt8)(1U << (bit % 8U));
+        sim->bit_errors++;
+    }
+
+    for (UInt8 i = 0; i < len; i++)
+        buf[i] = (i < 3) ? frame[i] : 0;
+
+    // Keep the result for another read until the next command if latched
+    if (!sim->latch_result)
+        sim->pending = SHT21_SIM_NONE;
+    return SHT21_OK;
+}
+
+static SHT21_Error_TypeDef SHT21_Sim_Bus_Write(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+    return SHT21_Sim_Write((SHT21_Sim_TypeDef*)handle, address, buf, len);
+}
+
+static SHT21_Error_TypeDef SHT21_Sim_Bus_Read(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+    return SHT21_Sim_Read((SHT21_Sim_TypeDef*)handle, address, buf, len);
+}
+
+static UInt32 SHT21_Sim_Bus_Get_Tick(void* handle)
+{
+    return (UInt32)(((SHT21_Sim_TypeDef*)handle)->clock->now_us / 1000U);
+}
+
+static void SHT21_Sim_Bus_Delay(void* handle, UInt32 ms)
+{
+    SHT21_Sim_Advance(((SHT21_Sim_TypeDef*)handle)->clock, 1000ULL * ms);
+}
+
+/********************************************************************************************
+ *  Sets up a sim at 25 C and 50 %RH with default configuration, ready to answer.
+ *******************************************************************************************/
+void SHT21_Sim_Init(SHT21_Sim_TypeDef* sim, SHT21_Sim_Clock_TypeDef* clock)
+{
+    *sim = (SHT21_Sim_TypeDef){0};
+    sim->clock = clock;
+    sim->temp = 25.0f;
+    sim->humidity = 50.0f;
+    sim->bit_time_us = SHT21_SIM_BIT_TIME_US;
+    sim->conversion_percent = 80U;
+    sim->reset_time_us = SHT21_SIM_RESET_TIME_US;
+    sim->heater_max = SHT21_SIM_HEATER_RISE;
+    sim->user_reg = SHT21_SIM_USER_REG_DEFAULT;
+    sim->heater_update_us = clock->now_us;
+    sim->seed = 1U;
+
+    sim->bus.write = SHT21_Sim_Bus_Write;
+    sim->bus.read = SHT21_Sim_Bus_Read;
+    sim->bus.get_tick = SHT21_Sim_Bus_Get_Tick;
+    sim->bus.delay = SHT21_Sim_Bus_Delay;
+    sim->bus.handle = sim;
+}
+
+/********************************************************************************************
+ *  Powers the sensor up. It does not answer until the power up time has passed.
+ *******************************************************************************************/
+void SHT21_Sim_Power_Up(SHT21_Sim_TypeDef* sim)
+{
+    sim->user_reg = SHT21_SIM_USER_REG_DEFAULT;
+    sim->pending = SHT21_SIM_NONE;
+    sim->heater_rise = 0.0f;
+    sim->heater_update_us = sim->clock->now_us;
+    sim->reset_until_us = sim->clock->now_us + sim->reset_time_us;
+}
+
+/********************************************************************************************
+ *  Returns the sim on the only enabled channel, 0 if none or more than one is enabled
+ *******************************************************************************************/
+static SHT21_Sim_TypeDef* SHT21_Sim_Mux_Selected(SHT21_Sim_Mux_TypeDef* mux)
+{
+    SHT21_Sim_TypeDef* selected = 0;
+    for (UInt8 i = 0; i < SHT21_SIM_MUX_COUNT; i++)
+    {
+        for (UInt8 ch = 0; ch < SHT21_SIM_MUX_CHANNELS; ch++)
+        {
+            if ((mux->channels[i] & (1U << ch)) == 0)
+                continue;
+            if (selected != 0)
+                return 0; // Address collision
+            selected = mux->sensors[i * SHT21_SIM_MUX_CHANNELS + ch];
+        }
+    }
+    return selected;
+}
+
+static SHT21_Error_TypeDef SHT21_Sim_Mux_Write(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+    SHT21_Sim_Mux_TypeDef* mux = (SHT21_Sim_Mux_TypeDef*)handle;
+
+    if (address >= SHT21_MUX_BASE_ADDRESS && address < SHT21_MUX_BASE_ADDRESS + SHT21_SIM_MUX_COUNT && len == 1)
+    {
+        mux->transactions++;
+        SHT21_Sim_Transfer(mux->clock, mux->bit_time_us, len);
+        mux->channels[address - SHT21_MUX_BASE_ADDRESS] = buf[0];
+        return SHT21_OK;
+    }
+
+    SHT21_Sim_TypeDef* sim = SHT21_Sim_Mux_Selected(mux);
+    if (sim == 0)
+    {
+        SHT21_Sim_Transfer(mux->clock, mux->bit_time_us, 0);
+        return SHT21_ACK_ERROR;
+    }
+    return SHT21_Sim_Write(sim, address, buf, len);
+}
+
+static SHT21_Error_TypeDef SHT21_Sim_Mux_Read(void* handle, UInt8 address, UInt8* buf, UInt8 len)
+{
+    SHT21_Sim_Mux_TypeDef* mux = (SHT21_Sim_Mux_TypeDef*)handle;
+    SHT21_Sim_TypeDef* sim = SHT21_Sim_Mux_Selected(mux);
+    if (sim == 0)
+    {
+        SHT21_Sim_Transfer(mux->clock, mux->bit_time_us, 0);
+        return SHT21_ACK_ERROR;
+    }
+    return SHT21_Sim_Read(sim, address, buf, len);
+}
+
+static UInt32 SHT21_Sim_Mux_Get_Tick(void* handle)
+{
+    return (UInt32)(((SHT21_Sim_Mux_TypeDef*)handle)->clock->now_us / 1000U);
+}
+
+static void SHT21_Sim_Mux_Delay(void* handle, UInt32 ms)
+{
+    SHT21_Sim_Advance(((SHT21_Sim_Mux_TypeDef*)handle)->clock, 1000ULL * ms);
+}
+
+/********************************************************************************************
+ *  Sets up a mux model with all channels off and no sensors
+ *******************************************************************************************/
+void SHT21_Sim_Mux_Init(SHT21_Sim_Mux_TypeDef* mux, SHT21_Sim_Clock_TypeDef* clock)
+{
+    *mux = (SHT21_Sim_Mux_TypeDef){0};
+    mux->clock = clock;
+    mux->bit_time_us = SHT21_SIM_BIT_TIME_US;
+
+    mux->bus.write = SHT21_Sim_Mux_Write;
+    mux->bus.read = SHT21_Sim_Mux_Read;
+    mux->bus.get_tick = SHT21_Sim_Mux_Get_Tick;
+    mux->bus.delay = SHT21_Sim_Mux_Delay;
+    mux->bus.handle = mux;
+}
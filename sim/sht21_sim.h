@@ -0,0 +1,140 @@
+/********************************************************************************************
+ *  Filename: sht21_sim.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Host side model of the SHT21 for testing and benchmarking the driver without a
+ *  sensor. Implements every command of SHT21_Commands_TypeDef with:
+ *      - Conversion times per resolution, a percentage of the datasheet maximum
+ *      - Clock stretching for the hold master commands, NACK until ready for no hold
+ *      - Readings quantized to the resolution, with status bits and CRC
+ *      - The on-chip heater raising the temperature and lowering the humidity
+ *      - Soft reset and power up times where the sensor does not answer
+ *      - Injectable bit errors and NACKs, optionally NACKed writes while converting
+ *      - Optionally a result that can be read again after a corrupt frame
+ *
+ *  Time is a virtual clock that only moves when the bus is used or the driver waits,
+ *  so runs are deterministic and much faster than real time. Several devices can share
+ *  one clock. Each transfer advances the clock by the time it occupies the bus.
+ *
+ *  SHT21_Sim_Mux_TypeDef models a TCA9548A style mux with a sim behind every channel.
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_SIM__H
+#define __SHT21_SIM__H
+
+#include "sht21_core.h"
+
+#define SHT21_SIM_BIT_TIME_US       (10U)       // 100 kHz
+#define SHT21_SIM_RESET_TIME_US     (15000U)    // Soft reset and power up, datasheet max
+#define SHT21_SIM_HEATER_RISE       (1.0f)      // Temperature rise in C with heater on
+#define SHT21_SIM_HEATER_TAU_US     (2000000.0f)
+#define SHT21_SIM_RH_PER_C          (3.0f)      // Humidity drop in %RH per C of heating
+#define SHT21_SIM_MUX_COUNT         (8U)
+#define SHT21_SIM_MUX_CHANNELS      (8U)
+
+/********************************************************************************************
+ *  Virtual clock, shared by all devices on a bus
+ *******************************************************************************************/
+typedef struct
+{
+    unsigned long long now_us;
+    unsigned long long bus_busy_us;
+} SHT21_Sim_Clock_TypeDef;
+
+/********************************************************************************************
+ *  What the next read returns
+ *******************************************************************************************/
+typedef enum
+{
+    SHT21_SIM_NONE              = (0x00U),
+    SHT21_SIM_USER_REG          = (0x01U),
+    SHT21_SIM_MEASURE           = (0x02U)
+} SHT21_Sim_Pending_TypeDef;
+
+/********************************************************************************************
+ *  Simulated SHT21. Set temp and humidity to the environment, and the configuration
+ *  fields after SHT21_Sim_Init.
+ *
+ *  conversion_percent  : Conversion time in % of the datasheet maximum, default 80
+ *  bit_error_rate      : Frames out of 65536 that get a flipped bit
+ *  inject_bit_errors   : The next frames read get a flipped bit
+ *  inject_nacks        : The next transfers are NACKed
+ *  vdd_low             : End of battery status bit
+ *  reset_time_us       : Time after power up or soft reset before the sensor answers,
+ *                        default SHT21_SIM_RESET_TIME_US
+ *  heater_max          : Temperature rise in C with the heater on, default
+ *                        SHT21_SIM_HEATER_RISE, 0 for a broken heater
+ *  latch_result        : A measurement result can be read again until the next command,
+ *                        instead of the reads being NACKed after the first one
+ *  busy_write_nack     : Writes are NACKed while a measurement is converting, as the
+ *                        reads are
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Sim_Clock_TypeDef* clock;
+    float temp;
+    float humidity;
+
+    UInt32 bit_time_us;
+    UInt8 conversion_percent;
+    UInt32 bit_error_rate;
+    UInt32 inject_bit_errors;
+    UInt32 inject_nacks;
+    UInt8 vdd_low;
+    UInt8 latch_result;
+    UInt8 busy_write_nack;
+    UInt32 reset_time_us;
+    float heater_max;
+
+    UInt8 user_reg;
+    UInt8 cmd;
+    SHT21_Sim_Pending_TypeDef pending;
+    unsigned long long ready_us;
+    unsigned long long reset_until_us;
+    unsigned long long heater_update_us;
+    float heater_rise;
+    UInt32 seed;
+
+    UInt32 transactions;
+    UInt32 nacks;
+    UInt32 conversions;
+    UInt32 bit_errors;
+    unsigned long long stretch_us;
+
+    SHT21_Bus_TypeDef bus;
+} SHT21_Sim_TypeDef;
+
+/********************************************************************************************
+ *  Simulated mux. Put a sim on a channel with sensors[mux * 8 + channel], the sims must
+ *  use the same clock as the mux.
+ *******************************************************************************************/
+typedef struct
+{
+    SHT21_Sim_Clock_TypeDef* clock;
+    UInt32 bit_time_us;
+    UInt8 channels[SHT21_SIM_MUX_COUNT];
+    SHT21_Sim_TypeDef* sensors[SHT21_SIM_MUX_COUNT * SHT21_SIM_MUX_CHANNELS];
+    UInt32 transactions;
+    SHT21_Bus_TypeDef bus;
+} SHT21_Sim_Mux_TypeDef;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void SHT21_Sim_Init(SHT21_Sim_TypeDef* sim, SHT21_Sim_Clock_TypeDef* clock);
+void SHT21_Sim_Power_Up(SHT21_Sim_TypeDef* sim);
+void SHT21_Sim_Advance(SHT21_Sim_Clock_TypeDef* clock, unsigned long long us);
+SHT21_Error_TypeDef SHT21_Sim_Write(SHT21_Sim_TypeDef* sim, UInt8 address, UInt8* buf, UInt8 len);
+SHT21_Error_TypeDef SHT21_Sim_Read(SHT21_Sim_TypeDef* sim, UInt8 address, UInt8* buf, UInt8 len);
+UInt16 SHT21_Sim_Reading(SHT21_Sim_TypeDef* sim, UInt8 humidity);
+
+void SHT21_Sim_Mux_Init(SHT21_Sim_Mux_TypeDef* mux, SHT21_Sim_Clock_TypeDef* clock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SHT21_SIM__H
@@ -0,0 +1,30 @@
+/********************************************************************************************
+ *  Filename: sht21_sim_bus.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Bus policy of Sht21<Bus, Res> on the simulator, calling the sim directly
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_SIM_BUS__H
+#define __SHT21_SIM_BUS__H
+
+#include "sht21_template.h"
+#include "sht21_sim.h"
+
+class Sht21_Sim_Bus
+{
+public:
+  explicit Sht21_Sim_Bus(SHT21_Sim_TypeDef* sim) : sim(sim) {}
+
+  SHT21_Error_TypeDef write(UInt8 address, UInt8* buf, UInt8 len) { return SHT21_Sim_Write(sim, address, buf, len); }
+  SHT21_Error_TypeDef read(UInt8 address, UInt8* buf, UInt8 len) { return SHT21_Sim_Read(sim, address, buf, len); }
+  UInt32 get_tick() { return (UInt32)(sim->clock->now_us / 1000U); }
+  void delay(UInt32 ms) { SHT21_Sim_Advance(sim->clock, 1000ULL * ms); }
+
+private:
+  SHT21_Sim_TypeDef* sim;
+};
+
+#endif // __SHT21_SIM_BUS__H
@@ -0,0 +1,93 @@
+/********************************************************************************************
+ *  Filename: sht21_test.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Test runner, runs every suite and prints the failed checks
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+
+#include <stdio.h>
+
+#define SHT21_TEST_MAX_REPORTS      (20U)   // Failures printed per suite, the rest are counted
+
+typedef struct
+{
+    const char* name;
+    void (*run)(void);
+} SHT21_Test_Suite_TypeDef;
+
+static const SHT21_Test_Suite_TypeDef sht21_test_suites[] =
+{
+    { "parse",      SHT21_Test_Parse },
+    { "batch",      SHT21_Test_Batch },
+    { "fixed",      SHT21_Test_Fixed },
+    { "measure",    SHT21_Test_Measure },
+    { "retry",      SHT21_Test_Retry },
+    { "selftest",   SHT21_Test_Selftest },
+    { "ready",      SHT21_Test_Ready },
+    { "ring",       SHT21_Test_Ring },
+    { "log",        SHT21_Test_Log },
+    { "filter",     SHT21_Test_Filter },
+    { "cache",      SHT21_Test_Cache },
+    { "linux",      SHT21_Test_Linux }
+};
+
+static UInt32 sht21_test_checks;
+static UInt32 sht21_test_failures;
+
+int SHT21_Test_Check(int ok, const char* expr, const char* file, int line)
+{
+    sht21_test_checks++;
+    if (!ok)
+    {
+        if (sht21_test_failures < SHT21_TEST_MAX_REPORTS)
+            printf("  %s:%d: %s\n", file, line, expr);
+        sht21_test_failures++;
+    }
+    return ok;
+}
+
+int SHT21_Test_Close(float value, float expected, float tolerance)
+{
+    return value >= expected - tolerance && value <= expected + tolerance;
+}
+
+/********************************************************************************************
+ *  Builds the 3 byte frame the sensor sends for reading. The CRC is computed here on its
+ *  own, so it also checks SHT21_Check_Crc.
+ *******************************************************************************************/
+void SHT21_Test_Frame(UInt16 reading, UInt8* frame)
+{
+    UInt16 crc = reading;
+    for (UInt8 bit = 16; bit > 0; --bit)
+        crc = (crc & 0x8000U) ? (UInt16)((crc << 1) ^ (SHT21_CRC_POLYNOMIAL << 8)) : (UInt16)(crc << 1);
+
+    frame[0] = (UInt8)(reading >> 8);
+    frame[1] = (UInt8)(reading & 0xFFU);
+    frame[2] = (UInt8)(crc >> 8);
+}
+
+int main(void)
+{
+    UInt32 failed = 0;
+
+    for (UInt32 i = 0; i < sizeof(sht21_test_suites) / sizeof(sht21_test_suites[0]); i++)
+    {
+        sht21_test_checks = 0;
+        sht21_test_failures = 0;
+        sht21_test_suites[i].run();
+        printf("%-10s %8u checks  %s\n", sht21_test_suites[i].name, sht21_test_checks,
+               sht21_test_failures ? "FAILED" : "ok");
+        if (sht21_test_failures)
+        {
+            printf("  %u failed\n", sht21_test_failures);
+            failed++;
+        }
+    }
+
+    printf("%s\n", failed ? "FAILED" : "OK");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+/********************************************************************************************
+ *  Filename: sht21_test.h
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Host tests of the driver. Every suite is a function making checks with
+ *  SHT21_TEST_CHECK, sht21_test.c runs them all and exits with 1 if a check failed.
+ *  The bus paths run against the simulator in sim/.
+ *
+ *      make test
+ *
+ *******************************************************************************************/
+#ifndef __SHT21_TEST__H
+#define __SHT21_TEST__H
+
+#include "sht21_core.h"
+
+#define SHT21_TEST_CHECK(cond)      SHT21_Test_Check((cond) != 0, #cond, __FILE__, __LINE__)
+
+int SHT21_Test_Check(int ok, const char* expr, const char* file, int line);
+int SHT21_Test_Close(float value, float expected, float tolerance);
+void SHT21_Test_Frame(UInt16 reading, UInt8* frame);
+
+void SHT21_Test_Parse(void);
+void SHT21_Test_Batch(void);
+void SHT21_Test_Fixed(void);
+void SHT21_Test_Measure(void);
+void SHT21_Test_Retry(void);
+void SHT21_Test_Selftest(void);
+void SHT21_Test_Ready(void);
+void SHT21_Test_Ring(void);
+void SHT21_Test_Log(void);
+void SHT21_Test_Filter(void);
+void SHT21_Test_Cache(void);
+void SHT21_Test_Linux(void);
+
+#endif // __SHT21_TEST__H
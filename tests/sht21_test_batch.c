@@ -0,0 +1,85 @@
+/********************************************************************************************
+ *  Filename: sht21_test_batch.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  The batch decoder against SHT21_Parse_Temp and SHT21_Parse_RH, bit for bit. Every
+ *  kernel the CPU supports is run on every reading, on corrupt frames and on counts that
+ *  leave a tail shorter than the vector width.
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_batch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SHT21_TEST_FRAMES           (65536U)
+
+static UInt8 sht21_test_frames[SHT21_TEST_FRAMES * SHT21_FRAME_SIZE];
+static float sht21_test_values[SHT21_TEST_FRAMES];
+static UInt8 sht21_test_status[SHT21_TEST_FRAMES];
+
+static const char* const sht21_test_kernels[] = { "auto", "scalar", "sse2", "avx2" };
+
+// Compares count decoded frames from first on against the single frame parser, values bit for bit
+static void SHT21_Test_Batch_Compare(UInt32 first, UInt32 count, int humidity)
+{
+    UInt8* frames = &sht21_test_frames[first * SHT21_FRAME_SIZE];
+    UInt32 errors = humidity ? SHT21_Parse_RH_Batch(frames, count, sht21_test_values, sht21_test_status)
+                             : SHT21_Parse_Temp_Batch(frames, count, sht21_test_values, sht21_test_status);
+    UInt32 expected_errors = 0;
+    UInt32 mismatches = 0;
+
+    for (UInt32 i = 0; i < count; i++)
+    {
+        UInt8* frame = &frames[i * SHT21_FRAME_SIZE];
+        float expected = humidity ? SHT21_Parse_RH(frame) : SHT21_Parse_Temp(frame);
+        UInt8 status = (SHT21_Check_Crc(frame, 2, frame[2]) != 0) ? SHT21_CHECKSUM_ERROR : SHT21_OK;
+
+        expected_errors += (status != SHT21_OK);
+        if (memcmp(&sht21_test_values[i], &expected, sizeof(float)) != 0 || sht21_test_status[i] != status)
+            mismatches++;
+    }
+    SHT21_TEST_CHECK(mismatches == 0);
+    SHT21_TEST_CHECK(errors == expected_errors);
+}
+
+static void SHT21_Test_Batch_Kernel(void)
+{
+    for (UInt32 r = 0; r < SHT21_TEST_FRAMES; r++)
+        SHT21_Test_Frame((UInt16)r, &sht21_test_frames[r * SHT21_FRAME_SIZE]);
+
+    SHT21_Test_Batch_Compare(0, SHT21_TEST_FRAMES, 0);
+    SHT21_Test_Batch_Compare(0, SHT21_TEST_FRAMES, 1);
+
+    // Every third frame with one flipped bit, somewhere in the 24
+    for (UInt32 r = 0; r < SHT21_TEST_FRAMES; r += 3U)
+    {
+        UInt32 bit = (r / 3U) % 24U;
+        sht21_test_frames[r * SHT21_FRAME_SIZE + bit / 8U] ^= (UInt8)(1U << (bit % 8U));
+    }
+    SHT21_Test_Batch_Compare(0, SHT21_TEST_FRAMES, 0);
+    SHT21_Test_Batch_Compare(0, SHT21_TEST_FRAMES, 1);
+
+    // Every count up to three blocks, from an odd start
+    for (UInt32 count = 0; count <= 48U; count++)
+    {
+        SHT21_Test_Batch_Compare(1001U, count, 0);
+        SHT21_Test_Batch_Compare(40000U + count, count, 1);
+    }
+}
+
+void SHT21_Test_Batch(void)
+{
+    for (UInt8 k = SHT21_BATCH_KERNEL_AUTO; k <= SHT21_BATCH_KERNEL_AVX2; k++)
+    {
+        // Kernels the CPU does not have fall back to scalar, which is then tested again
+        SHT21_Batch_Kernel_TypeDef selected = SHT21_Batch_Select_Kernel((SHT21_Batch_Kernel_TypeDef)k);
+        if (k != SHT21_BATCH_KERNEL_AUTO && selected != k)
+            printf("  %s not supported, ran %s\n", sht21_test_kernels[k], sht21_test_kernels[selected]);
+        SHT21_Test_Batch_Kernel();
+    }
+    SHT21_Batch_Select_Kernel(SHT21_BATCH_KERNEL_AUTO);
+}
@@ -0,0 +1,120 @@
+/********************************************************************************************
+ *  Filename: sht21_test_cache.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Max age cache hit and miss accounting, on its own and measuring on the simulator
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_cache.h"
+#include "sht21_sim.h"
+
+static void SHT21_Test_Cache_Get(void)
+{
+    SHT21_Cache_TypeDef cache;
+    float value = 0.0f;
+
+    // Empty cache misses
+    SHT21_Cache_Init(&cache, 0);
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_TEMP_MEASURE, 0, 1000U, &value) == 0);
+    SHT21_TEST_CHECK(cache.hits == 0 && cache.misses == 1);
+
+    // Fresh while younger than max age, hold and no hold commands share a value
+    SHT21_Cache_Put(&cache, SHT21_TEMP_MEASURE_HOLD, 100U, 21.5f);
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_TEMP_MEASURE, 100U, 1000U, &value) == 1 && value == 21.5f);
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_TEMP_MEASURE_HOLD, 1099U, 1000U, &value) == 1);
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_TEMP_MEASURE, 1100U, 1000U, &value) == 0);
+    SHT21_TEST_CHECK(cache.hits == 2 && cache.misses == 2);
+
+    // Max age 0 always misses, even right after the put
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_TEMP_MEASURE, 100U, 0, &value) == 0);
+    SHT21_TEST_CHECK(cache.misses == 3);
+
+    // Temperature and humidity are kept apart
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_RH_MEASURE, 100U, 1000U, &value) == 0);
+    SHT21_Cache_Put(&cache, SHT21_RH_MEASURE, 200U, 45.0f);
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_RH_MEASURE_HOLD, 200U, 1000U, &value) == 1 && value == 45.0f);
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_TEMP_MEASURE, 200U, 1000U, &value) == 1 && value == 21.5f);
+
+    // The age survives the tick wrapping
+    SHT21_Cache_Put(&cache, SHT21_TEMP_MEASURE, 0xFFFFFF00U, 22.0f);
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_TEMP_MEASURE, 0x10U, 1000U, &value) == 1 && value == 22.0f);
+
+    // Invalidate drops the values and keeps the counters
+    UInt32 hits = cache.hits;
+    UInt32 misses = cache.misses;
+    SHT21_Cache_Invalidate(&cache);
+    SHT21_TEST_CHECK(SHT21_Cache_Get(&cache, SHT21_TEMP_MEASURE, 0x10U, 1000U, &value) == 0);
+    SHT21_TEST_CHECK(cache.hits == hits && cache.misses == misses + 1U);
+}
+
+static void SHT21_Test_Cache_Read(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Cache_TypeDef cache;
+    float value = 0.0f;
+
+    SHT21_Sim_Init(&sim, &clock);
+    sim.temp = 21.5f;
+    sim.humidity = 40.0f;
+    SHT21_Cache_Init(&cache, &sim.bus);
+
+    // A miss measures, a hit does not touch the bus
+    SHT21_TEST_CHECK(SHT21_Cache_Read(&cache, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, 1000U, &value) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Test_Close(value, 21.5f, 0.02f));
+    UInt32 transactions = sim.transactions;
+    sim.temp = 30.0f;
+    SHT21_TEST_CHECK(SHT21_Cache_Read(&cache, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, 1000U, &value) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Test_Close(value, 21.5f, 0.02f) && sim.transactions == transactions);
+    SHT21_TEST_CHECK(cache.hits == 1 && cache.misses == 1);
+
+    // Max age 0 measures every time
+    SHT21_TEST_CHECK(SHT21_Cache_Read(&cache, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, 0, &value) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Test_Close(value, 30.0f, 0.02f) && sim.transactions > transactions);
+    SHT21_TEST_CHECK(cache.hits == 1 && cache.misses == 2);
+
+    // A failed measurement counts a miss and leaves the cached value
+    sim.inject_nacks = 1;
+    sim.temp = 10.0f;
+    SHT21_TEST_CHECK(SHT21_Cache_Read(&cache, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, 0, &value) == SHT21_ACK_ERROR);
+    SHT21_TEST_CHECK(cache.misses == 3 && cache.temp_valid && SHT21_Test_Close(cache.temp, 30.0f, 0.02f));
+
+    // Read_Both counts one hit or miss for the pair and measures both if either is stale
+    SHT21_Cache_Init(&cache, &sim.bus);
+    SHT21_Sample_TypeDef sample = SHT21_Cache_Read_Both(&cache, SHT21_RES_RH12_T14, 1000U);
+    SHT21_TEST_CHECK(sample.status == SHT21_OK && cache.hits == 0 && cache.misses == 1);
+    SHT21_TEST_CHECK(SHT21_Test_Close(sample.temp, 10.0f, 0.02f) && SHT21_Test_Close(sample.humidity, 40.0f, 0.05f));
+
+    // The temperature is stamped when its frame was read, a humidity conversion earlier
+    SHT21_TEST_CHECK(cache.temp_valid && cache.humidity_valid);
+    SHT21_TEST_CHECK(cache.humidity_tick > cache.temp_tick);
+    UInt32 rh_time = SHT21_Conversion_Time(SHT21_RES_RH12_T14, SHT21_RH_MEASURE);
+    SHT21_TEST_CHECK(cache.humidity_tick - cache.temp_tick >= rh_time * 8U / 10U);
+
+    transactions = sim.transactions;
+    sample = SHT21_Cache_Read_Both(&cache, SHT21_RES_RH12_T14, 1000U);
+    SHT21_TEST_CHECK(sample.status == SHT21_OK && cache.hits == 1 && cache.misses == 1);
+    SHT21_TEST_CHECK(sim.transactions == transactions);
+
+    // Only the humidity is fresh enough, both are measured again
+    SHT21_Cache_Put(&cache, SHT21_TEMP_MEASURE, cache.temp_tick - 2000U, cache.temp);
+    sample = SHT21_Cache_Read_Both(&cache, SHT21_RES_RH12_T14, 1000U);
+    SHT21_TEST_CHECK(sample.status == SHT21_OK && cache.hits == 1 && cache.misses == 2);
+    SHT21_TEST_CHECK(sim.transactions > transactions);
+
+    // A corrupt temperature frame still caches the humidity that parsed
+    SHT21_Cache_Invalidate(&cache);
+    sim.inject_bit_errors = 1;
+    sample = SHT21_Cache_Measure_Both(&cache, SHT21_RES_RH12_T14, SHT21_READ_FULL, SHT21_READ_FULL);
+    SHT21_TEST_CHECK(sample.status == SHT21_CHECKSUM_ERROR);
+    SHT21_TEST_CHECK(!cache.temp_valid && cache.humidity_valid);
+}
+
+void SHT21_Test_Cache(void)
+{
+    SHT21_Test_Cache_Get();
+    SHT21_Test_Cache_Read();
+}
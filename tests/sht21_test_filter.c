@@ -0,0 +1,139 @@
+/********************************************************************************************
+ *  Filename: sht21_test_filter.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Edge cases of the EMA, median and decimator and of a chain of them
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_filter.h"
+
+static void SHT21_Test_Ema(void)
+{
+    SHT21_Ema_TypeDef ema;
+
+    SHT21_TEST_CHECK(SHT21_Ema_Init(&ema, 0) == SHT21_UNIT_ERROR);
+    SHT21_TEST_CHECK(SHT21_Ema_Init(&ema, SHT21_FILTER_EMA_MAX_SHIFT + 1U) == SHT21_UNIT_ERROR);
+
+    // The first reading primes it, a constant input stays exact even at the top of the range
+    SHT21_TEST_CHECK(SHT21_Ema_Init(&ema, SHT21_FILTER_EMA_MAX_SHIFT) == SHT21_OK);
+    UInt32 exact = 1;
+    for (UInt32 i = 0; i < 1000U; i++)
+        exact &= SHT21_Ema_Update(&ema, 0xFFFCU) == 0xFFFCU;
+    SHT21_TEST_CHECK(exact);
+
+    // A step settles on exactly the new reading, rising and falling
+    SHT21_TEST_CHECK(SHT21_Ema_Init(&ema, 3) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Ema_Update(&ema, 1000U) == 1000U);
+    UInt16 out = SHT21_Ema_Update(&ema, 2000U);
+    SHT21_TEST_CHECK(out == 1125U);
+    for (UInt32 i = 0; i < 200U; i++)
+        out = SHT21_Ema_Update(&ema, 2000U);
+    SHT21_TEST_CHECK(out == 2000U);
+    for (UInt32 i = 0; i < 200U; i++)
+        out = SHT21_Ema_Update(&ema, 4U);
+    SHT21_TEST_CHECK(out == 4U);
+}
+
+static void SHT21_Test_Median(void)
+{
+    SHT21_Median_TypeDef median;
+
+    SHT21_TEST_CHECK(SHT21_Median_Init(&median, 0) == SHT21_UNIT_ERROR);
+    SHT21_TEST_CHECK(SHT21_Median_Init(&median, SHT21_FILTER_MEDIAN_MAX + 1U) == SHT21_UNIT_ERROR);
+
+    // Size 1 passes through
+    SHT21_TEST_CHECK(SHT21_Median_Init(&median, 1) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 7U) == 7U && SHT21_Median_Update(&median, 3U) == 3U);
+
+    // Until full the median is over the readings so far, the lower middle for an even count
+    SHT21_TEST_CHECK(SHT21_Median_Init(&median, 5) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 50U) == 50U);
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 10U) == 10U);
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 30U) == 30U);
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 20U) == 20U);
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 40U) == 30U);
+
+    // A single spike is rejected, the oldest reading leaves the window
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 0xFFFCU) == 30U);  // 10 20 30 40 spike
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 35U) == 35U);      // 20 30 35 40 spike
+    SHT21_TEST_CHECK(SHT21_Median_Update(&median, 36U) == 36U);      // 30 35 36 40 spike
+
+    // Repeated readings, the one removed is the oldest copy and the sorted copy stays right
+    SHT21_TEST_CHECK(SHT21_Median_Init(&median, 3) == SHT21_OK);
+    static const UInt16 input[] = { 5, 5, 9, 5, 9, 9, 1, 1, 9 };
+    static const UInt16 output[] = { 5, 5, 5, 5, 9, 9, 9, 1, 1 };
+    UInt32 matches = 1;
+    for (UInt32 i = 0; i < sizeof(input) / sizeof(input[0]); i++)
+        matches &= SHT21_Median_Update(&median, input[i]) == output[i];
+    SHT21_TEST_CHECK(matches);
+}
+
+static void SHT21_Test_Decimator(void)
+{
+    SHT21_Decimator_TypeDef decimator;
+    UInt16 out = 0;
+
+    SHT21_TEST_CHECK(SHT21_Decimator_Init(&decimator, 0) == SHT21_UNIT_ERROR);
+
+    // Factor 1 passes through
+    SHT21_TEST_CHECK(SHT21_Decimator_Init(&decimator, 1) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 123U, &out) == 1 && out == 123U);
+
+    // One output per factor inputs, the mean rounded half up
+    SHT21_TEST_CHECK(SHT21_Decimator_Init(&decimator, 4) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 10U, &out) == 0);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 10U, &out) == 0);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 11U, &out) == 0);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 11U, &out) == 1 && out == 11U);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 10U, &out) == 0);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 10U, &out) == 0);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 10U, &out) == 0);
+    SHT21_TEST_CHECK(SHT21_Decimator_Update(&decimator, 11U, &out) == 1 && out == 10U);
+
+    // The largest factor at the largest reading does not overflow the sum
+    SHT21_TEST_CHECK(SHT21_Decimator_Init(&decimator, 0xFFFFU) == SHT21_OK);
+    UInt32 outputs = 0;
+    for (UInt32 i = 0; i < 0xFFFFU; i++)
+        outputs += SHT21_Decimator_Update(&decimator, 0xFFFCU, &out);
+    SHT21_TEST_CHECK(outputs == 1 && out == 0xFFFCU);
+}
+
+static void SHT21_Test_Chain(void)
+{
+    SHT21_Filter_TypeDef filter;
+    UInt16 out = 0;
+
+    // An empty chain passes every reading through
+    SHT21_Filter_Init(&filter);
+    SHT21_TEST_CHECK(SHT21_Filter_Update(&filter, 0x6640U, &out) == 1 && out == 0x6640U);
+
+    // Bad parameters and a full chain are refused without adding a stage
+    SHT21_TEST_CHECK(SHT21_Filter_Add_Median(&filter, 0) == SHT21_UNIT_ERROR && filter.count == 0);
+    SHT21_TEST_CHECK(SHT21_Filter_Add_Median(&filter, 3) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Filter_Add_Ema(&filter, 1) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Filter_Add_Decimator(&filter, 2) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Filter_Add_Ema(&filter, 2) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Filter_Add_Ema(&filter, 2) == SHT21_UNIT_ERROR && filter.count == SHT21_FILTER_MAX_STAGES);
+
+    // Only every second reading gets past the decimator to the last stage
+    SHT21_TEST_CHECK(SHT21_Filter_Update(&filter, 100U, &out) == 0);
+    SHT21_TEST_CHECK(SHT21_Filter_Update(&filter, 100U, &out) == 1 && out == 100U);
+    SHT21_TEST_CHECK(SHT21_Filter_Update(&filter, 100U, &out) == 0);
+
+    // Reset drops the history and the half filled decimator, the stages stay
+    SHT21_Filter_Reset(&filter);
+    SHT21_TEST_CHECK(filter.count == SHT21_FILTER_MAX_STAGES);
+    SHT21_TEST_CHECK(SHT21_Filter_Update(&filter, 500U, &out) == 0);
+    SHT21_TEST_CHECK(SHT21_Filter_Update(&filter, 500U, &out) == 1 && out == 500U);
+}
+
+void SHT21_Test_Filter(void)
+{
+    SHT21_Test_Ema();
+    SHT21_Test_Median();
+    SHT21_Test_Decimator();
+    SHT21_Test_Chain();
+}
@@ -0,0 +1,89 @@
+/********************************************************************************************
+ *  Filename: sht21_test_fixed.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  The integer conversions against the error bounds documented in sht21_fixed.h, over
+ *  every masked reading. Built a second time with the lookup tables enabled, then the
+ *  bounds hold for the reading truncated to the table resolution.
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_fixed.h"
+
+#define SHT21_TEST_FIXED_BOUND      (0.0051)    // Against the float conversion
+#define SHT21_TEST_EXACT_BOUND      (0.005)     // Against the exact value, rounded to nearest
+
+#ifdef SHT21_FIXED_TEMP_LUT_BITS
+#define SHT21_TEST_TEMP_MASK        ((UInt16)(0xFFFFU << (16U - SHT21_FIXED_TEMP_LUT_BITS)))
+#else
+#define SHT21_TEST_TEMP_MASK        ((UInt16)0xFFFFU)
+#endif
+#ifdef SHT21_FIXED_RH_LUT_BITS
+#define SHT21_TEST_RH_MASK          ((UInt16)(0xFFFFU << (16U - SHT21_FIXED_RH_LUT_BITS)))
+#else
+#define SHT21_TEST_RH_MASK          ((UInt16)0xFFFFU)
+#endif
+
+static double SHT21_Test_Abs(double x)
+{
+    return x < 0.0 ? -x : x;
+}
+
+static void SHT21_Test_Bounds(void)
+{
+    UInt32 temp_out = 0;
+    UInt32 rh_out = 0;
+
+    for (UInt32 r = 0; r < 65536U; r += 4U)
+    {
+        UInt16 t = (UInt16)(r & SHT21_TEST_TEMP_MASK);
+        UInt16 h = (UInt16)(r & SHT21_TEST_RH_MASK);
+        double temp = SHT21_Convert_Temp_Centi((UInt16)r) / 100.0;
+        double humidity = SHT21_Convert_RH_Centi((UInt16)r) / 100.0;
+
+        temp_out += SHT21_Test_Abs(temp - SHT21_Convert_Temp(t)) > SHT21_TEST_FIXED_BOUND ||
+                    SHT21_Test_Abs(temp - (-46.85 + 175.72 * t / 65536.0)) > SHT21_TEST_EXACT_BOUND + 1e-9 ||
+                    SHT21_Convert_Temp_Centi((UInt16)r) != SHT21_TEMP_CENTI(t);
+        rh_out += SHT21_Test_Abs(humidity - SHT21_Convert_RH(h)) > SHT21_TEST_FIXED_BOUND ||
+                  SHT21_Test_Abs(humidity - (-6.0 + 125.0 * h / 65536.0)) > SHT21_TEST_EXACT_BOUND + 1e-9 ||
+                  SHT21_Convert_RH_Centi((UInt16)r) != SHT21_RH_CENTI(h);
+    }
+    SHT21_TEST_CHECK(temp_out == 0);
+    SHT21_TEST_CHECK(rh_out == 0);
+
+    // The macros are usable in constant expressions
+    static const Int16 table[2] = { SHT21_TEMP_CENTI(0), SHT21_RH_CENTI(0) };
+    SHT21_TEST_CHECK(table[0] == -4685 && table[1] == -600);
+}
+
+// A corrupt frame returns an error instead of a value, and leaves the result alone
+static void SHT21_Test_Parse_Centi(void)
+{
+    UInt32 wrong = 0;
+
+    for (UInt32 r = 0; r < 65536U; r += 4U)
+    {
+        UInt8 frame[3];
+        Int16 temp = 0x7FFF;
+        Int16 humidity = 0x7FFF;
+
+        SHT21_Test_Frame((UInt16)r, frame);
+        wrong += SHT21_Parse_Temp_Centi(frame, &temp) != SHT21_OK || temp != SHT21_Convert_Temp_Centi((UInt16)r);
+        wrong += SHT21_Parse_RH_Centi(frame, &humidity) != SHT21_OK || humidity != SHT21_Convert_RH_Centi((UInt16)r);
+
+        frame[2] ^= 0x01U;
+        temp = 0x7FFF;
+        humidity = 0x7FFF;
+        wrong += SHT21_Parse_Temp_Centi(frame, &temp) != SHT21_CHECKSUM_ERROR || temp != 0x7FFF;
+        wrong += SHT21_Parse_RH_Centi(frame, &humidity) != SHT21_CHECKSUM_ERROR || humidity != 0x7FFF;
+    }
+    SHT21_TEST_CHECK(wrong == 0);
+}
+
+void SHT21_Test_Fixed(void)
+{
+    SHT21_Test_Bounds();
+    SHT21_Test_Parse_Centi();
+}
@@ -0,0 +1,130 @@
+/********************************************************************************************
+ *  Filename: sht21_test_linux.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  The /dev/i2c-N backend on a stand-in ioctl that runs the messages on the simulator.
+ *  Checks that a combined transfer is one ioctl with a repeated start, the no hold
+ *  polling through the core, the transaction and syscall counters and the mapping of
+ *  errno to the driver errors.
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_linux.h"
+#include "sht21_sim.h"
+
+#include <errno.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+static SHT21_Sim_TypeDef* sht21_test_sim;
+static UInt32 sht21_test_ioctls;
+static UInt32 sht21_test_last_msgs;
+static int sht21_test_errno;            // errno of a NACK
+
+static int SHT21_Test_Ioctl(int fd, unsigned long request, void* arg)
+{
+    (void)fd;
+    sht21_test_ioctls++;
+    if (request != I2C_RDWR)
+        return -1;
+
+    struct i2c_rdwr_ioctl_data* data = (struct i2c_rdwr_ioctl_data*)arg;
+    sht21_test_last_msgs = data->nmsgs;
+    for (UInt32 i = 0; i < data->nmsgs; i++)
+    {
+        struct i2c_msg* msg = &data->msgs[i];
+        SHT21_Error_TypeDef status = (msg->flags & I2C_M_RD) ?
+            SHT21_Sim_Read(sht21_test_sim, (UInt8)msg->addr, msg->buf, (UInt8)msg->len) :
+            SHT21_Sim_Write(sht21_test_sim, (UInt8)msg->addr, msg->buf, (UInt8)msg->len);
+        if (status != SHT21_OK)
+        {
+            errno = sht21_test_errno;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// The core waits on the virtual clock of the sim instead of in real time
+static UInt32 SHT21_Test_Get_Tick(void* handle)
+{
+    (void)handle;
+    return (UInt32)(sht21_test_sim->clock->now_us / 1000U);
+}
+
+static void SHT21_Test_Delay(void* handle, UInt32 ms)
+{
+    (void)handle;
+    SHT21_Sim_Advance(sht21_test_sim->clock, 1000ULL * ms);
+}
+
+void SHT21_Test_Linux(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Linux_TypeDef dev;
+    UInt8 frame[3];
+    float value = 0.0f;
+
+    SHT21_Sim_Init(&sim, &clock);
+    sim.temp = 23.4f;
+    sht21_test_sim = &sim;
+    sht21_test_errno = EREMOTEIO;
+    SHT21_Linux_Attach(&dev, 3, SHT21_Test_Ioctl);
+    dev.bus.get_tick = SHT21_Test_Get_Tick;
+    dev.bus.delay = SHT21_Test_Delay;
+
+    // Hold master: command and stretched read in one ioctl
+    sht21_test_ioctls = 0;
+    SHT21_TEST_CHECK(SHT21_Linux_Transfer(&dev, SHT21_TEMP_MEASURE_HOLD, frame, 3) == SHT21_OK);
+    SHT21_TEST_CHECK(sht21_test_ioctls == 1U && sht21_test_last_msgs == 2U);
+    SHT21_TEST_CHECK(dev.transactions == 1U && dev.syscalls == 1U && dev.last_syscalls == 1U);
+    SHT21_TEST_CHECK(sim.transactions == 2U && sim.stretch_us > 0U);
+    SHT21_TEST_CHECK(SHT21_Parse_Temp_Checked(frame, &value) == SHT21_OK && SHT21_Test_Close(value, 23.4f, 0.02f));
+
+    SHT21_TEST_CHECK(SHT21_Linux_Transfer(&dev, SHT21_RH_MEASURE_HOLD, frame, 3) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Parse_RH_Checked(frame, &value) == SHT21_OK && SHT21_Test_Close(value, 50.0f, 0.05f));
+
+    UInt8 reg = 0;
+    SHT21_TEST_CHECK(SHT21_Linux_Transfer(&dev, SHT21_READ_USER_REG, &reg, 1) == SHT21_OK);
+    SHT21_TEST_CHECK(reg == sim.user_reg);
+    SHT21_TEST_CHECK(sht21_test_ioctls == 3U && dev.transactions == 3U && dev.syscalls == 3U);
+
+    // No hold through the core: one ioctl for the command and one per poll
+    sht21_test_ioctls = 0;
+    dev.transactions = 0;
+    dev.syscalls = 0;
+    UInt32 nacks = sim.nacks;
+    SHT21_Measurement_TypeDef meas;
+    SHT21_TEST_CHECK(SHT21_Measure_Start(&meas, &dev.bus, SHT21_TEMP_MEASURE) == SHT21_OK);
+    SHT21_TEST_CHECK(sht21_test_ioctls == 1U && sht21_test_last_msgs == 1U);
+    SHT21_TEST_CHECK(SHT21_Measure_Poll(&meas) == SHT21_BUSY);
+    SHT21_TEST_CHECK(SHT21_Measure_Wait(&meas, 60U) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Measure_Complete(&meas, &value) == SHT21_OK && SHT21_Test_Close(value, 23.4f, 0.02f));
+    SHT21_TEST_CHECK(sht21_test_ioctls == dev.syscalls && dev.transactions == dev.syscalls);
+    SHT21_TEST_CHECK(dev.syscalls == 2U + (sim.nacks - nacks));
+    SHT21_TEST_CHECK(sim.nacks - nacks >= 2U && sim.nacks - nacks <= 10U); // 80 % of 85 ms, polled every ms from 60
+
+    SHT21_Sample_TypeDef sample = SHT21_Measure_Both(&dev.bus, SHT21_RES_RH12_T14);
+    SHT21_TEST_CHECK(sample.status == SHT21_OK && SHT21_Test_Close(sample.humidity, 50.0f, 0.05f));
+
+    // Write and read back the user register, each a single message
+    UInt8 write[2] = { SHT21_WRITE_USER_REG, SHT21_DISABLE_OTP_RELOAD | SHT21_MEAS_RESOLUTION_BIT2 };
+    UInt8 read_cmd = SHT21_READ_USER_REG;
+    SHT21_TEST_CHECK(SHT21_Linux_Write(&dev, SHT21_I2C_ADDRESS, write, 2) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Linux_Write_Read(&dev, SHT21_I2C_ADDRESS, &read_cmd, 1, &reg, 1) == SHT21_OK);
+    SHT21_TEST_CHECK(reg == write[1]);
+
+    // A NACK is EREMOTEIO or ENXIO depending on the adapter, anything else a time out
+    sim.inject_nacks = 1;
+    SHT21_TEST_CHECK(SHT21_Linux_Transfer(&dev, SHT21_READ_USER_REG, &reg, 1) == SHT21_ACK_ERROR);
+    sht21_test_errno = ENXIO;
+    sim.inject_nacks = 1;
+    SHT21_TEST_CHECK(SHT21_Linux_Read(&dev, SHT21_I2C_ADDRESS, frame, 3) == SHT21_ACK_ERROR);
+    sht21_test_errno = ETIMEDOUT;
+    sim.inject_nacks = 1;
+    SHT21_TEST_CHECK(SHT21_Linux_Write(&dev, SHT21_I2C_ADDRESS, write, 2) == SHT21_TIME_OUT_ERROR);
+    SHT21_TEST_CHECK(dev.last_syscalls == 1U);
+}
@@ -0,0 +1,153 @@
+/********************************************************************************************
+ *  Filename: sht21_test_log.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Log block encoding: every sample decodes back exactly, a resumed block continues
+ *  byte for byte as if it was never stored, and corrupt blocks are rejected
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_log.h"
+
+#define SHT21_TEST_LOG_SAMPLES      (2000U)
+
+// Sample i, mostly a steady 1 Hz with small steps and now and then a large jump
+static void SHT21_Test_Log_Sample(UInt32 i, SHT21_Log_Record_TypeDef* record)
+{
+    record->time_ms = 1790000000000ULL + 1000ULL * i + (i % 7U);
+    record->temp_ticks = (UInt16)(0x1990U + (i % 5U) - 2U);
+    record->rh_ticks = (UInt16)(0x7B0U + (i % 3U));
+
+    if (i % 97U == 0U)
+    {
+        record->time_ms += 3600000ULL;
+        record->temp_ticks = 0x3FFFU;
+        record->rh_ticks = (i % 2U) ? 0xFFFU : 0;
+    }
+}
+
+static int SHT21_Test_Log_Same(const SHT21_Log_Record_TypeDef* a, const SHT21_Log_Record_TypeDef* b)
+{
+    return a->time_ms == b->time_ms && a->temp_ticks == b->temp_ticks && a->rh_ticks == b->rh_ticks;
+}
+
+void SHT21_Test_Log(void)
+{
+    static UInt8 blocks[64][SHT21_LOG_BLOCK_SIZE];
+    static SHT21_Log_Writer_TypeDef writer;
+    static SHT21_Log_Writer_TypeDef resumed;
+    SHT21_Log_Decoder_TypeDef decoder;
+    SHT21_Log_Record_TypeDef record, expected;
+    UInt8 header[SHT21_LOG_HEADER_SIZE];
+
+    // File header
+    SHT21_Log_Write_Header(header);
+    SHT21_TEST_CHECK(SHT21_Log_Check_Header(header) == SHT21_OK);
+    header[8]++;
+    SHT21_TEST_CHECK(SHT21_Log_Check_Header(header) == SHT21_UNIT_ERROR);
+    header[8]--;
+    header[0] = 'X';
+    SHT21_TEST_CHECK(SHT21_Log_Check_Header(header) == SHT21_UNIT_ERROR);
+
+    // An empty block decodes to nothing
+    SHT21_Log_Writer_Begin(&writer);
+    SHT21_Log_Decoder_Init(&decoder, writer.data);
+    SHT21_TEST_CHECK(SHT21_Log_Decoder_Next(&decoder, &record) == 0);
+
+    // Write into blocks, starting a new one whenever the last is full
+    UInt32 count = 0;
+    UInt32 appended = 0;
+    SHT21_Log_Writer_Begin(&writer);
+    for (UInt32 i = 0; i < SHT21_TEST_LOG_SAMPLES && count < 63U; i++)
+    {
+        SHT21_Test_Log_Sample(i, &record);
+        if (!SHT21_Log_Writer_Append(&writer, &record))
+        {
+            SHT21_TEST_CHECK(writer.header.count > 1U && writer.header.used <= SHT21_LOG_BLOCK_SIZE);
+            for (UInt16 b = 0; b < SHT21_LOG_BLOCK_SIZE; b++)
+                blocks[count][b] = writer.data[b];
+            count++;
+            SHT21_Log_Writer_Begin(&writer);
+            SHT21_Log_Writer_Append(&writer, &record);  // The first sample always fits
+        }
+        appended++;
+    }
+    for (UInt16 b = 0; b < SHT21_LOG_BLOCK_SIZE; b++)
+        blocks[count][b] = writer.data[b];
+    count++;
+    SHT21_TEST_CHECK(appended == SHT21_TEST_LOG_SAMPLES && count > 1U);
+
+    // Every sample reads back exactly, and the block headers match their samples
+    UInt32 decoded = 0;
+    UInt32 mismatches = 0;
+    for (UInt32 b = 0; b < count; b++)
+    {
+        SHT21_Log_Decoder_Init(&decoder, blocks[b]);
+        SHT21_Test_Log_Sample(decoded, &expected);
+        mismatches += decoder.header.first_ms != expected.time_ms;
+        while (SHT21_Log_Decoder_Next(&decoder, &record))
+        {
+            SHT21_Test_Log_Sample(decoded++, &expected);
+            mismatches += !SHT21_Test_Log_Same(&record, &expected);
+        }
+        mismatches += decoder.index != decoder.header.count || decoder.offset != decoder.header.used;
+        mismatches += decoder.header.last_ms != record.time_ms;
+    }
+    SHT21_TEST_CHECK(decoded == SHT21_TEST_LOG_SAMPLES);
+    SHT21_TEST_CHECK(mismatches == 0);
+
+    // Resume a stored partial block and continue, the bytes match an uninterrupted writer
+    SHT21_Log_Writer_Begin(&writer);
+    for (UInt32 i = 0; i < 10U; i++)
+    {
+        SHT21_Test_Log_Sample(i, &record);
+        SHT21_Log_Writer_Append(&writer, &record);
+    }
+    SHT21_TEST_CHECK(SHT21_Log_Writer_Resume(&resumed, writer.data) == SHT21_OK);
+    SHT21_TEST_CHECK(resumed.header.count == 10U && resumed.header.used == writer.header.used);
+    UInt32 same = 1;
+    for (UInt32 i = 10; i < 30U; i++)
+    {
+        SHT21_Test_Log_Sample(i, &record);
+        same &= SHT21_Log_Writer_Append(&writer, &record) == SHT21_Log_Writer_Append(&resumed, &record);
+    }
+    for (UInt16 b = 0; b < SHT21_LOG_BLOCK_SIZE; b++)
+        same &= writer.data[b] == resumed.data[b];
+    SHT21_TEST_CHECK(same);
+
+    // Resuming an empty block works like Begin
+    SHT21_Log_Writer_Begin(&writer);
+    SHT21_TEST_CHECK(SHT21_Log_Writer_Resume(&resumed, writer.data) == SHT21_OK && resumed.header.count == 0);
+
+    // A block whose samples do not fill used, or with used out of range, is corrupt
+    for (UInt16 b = 0; b < SHT21_LOG_BLOCK_SIZE; b++)
+        blocks[0][b] = blocks[1][b];
+    blocks[0][18]++;
+    SHT21_TEST_CHECK(SHT21_Log_Writer_Resume(&resumed, blocks[0]) == SHT21_CHECKSUM_ERROR);
+    blocks[0][18] = 0;
+    blocks[0][19] = 0;
+    SHT21_TEST_CHECK(SHT21_Log_Writer_Resume(&resumed, blocks[0]) == SHT21_CHECKSUM_ERROR);
+    blocks[0][19] = 0xFFU;
+    SHT21_TEST_CHECK(SHT21_Log_Writer_Resume(&resumed, blocks[0]) == SHT21_CHECKSUM_ERROR);
+
+    // A varint cut off at used stops the decoder before the last sample
+    for (UInt16 b = 0; b < SHT21_LOG_BLOCK_SIZE; b++)
+        blocks[0][b] = blocks[1][b];
+    SHT21_Log_Decoder_Init(&decoder, blocks[0]);
+    blocks[0][decoder.header.used - 1U] |= 0x80U;
+    while (SHT21_Log_Decoder_Next(&decoder, &record))
+        ;
+    SHT21_TEST_CHECK(decoder.index + 1U == decoder.header.count && decoder.offset <= decoder.header.used);
+    SHT21_TEST_CHECK(SHT21_Log_Writer_Resume(&resumed, blocks[0]) == SHT21_CHECKSUM_ERROR);
+
+    // Ticks convert like the frame they came from
+    UInt8 frame[3];
+    SHT21_Test_Frame(0x6640U, frame);
+    record.temp_ticks = SHT21_LOG_TEMP_TICKS(frame);
+    SHT21_TEST_CHECK(SHT21_Log_Temp(&record) == SHT21_Convert_Temp(0x6640U));
+    SHT21_Test_Frame(0x7B12U, frame);
+    record.rh_ticks = SHT21_LOG_RH_TICKS(frame);
+    SHT21_TEST_CHECK(SHT21_Log_RH(&record) == SHT21_Convert_RH(0x7B10U));
+}
@@ -0,0 +1,115 @@
+/********************************************************************************************
+ *  Filename: sht21_test_measure.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  The no hold measurement state machine and SHT21_Measure_Both against the simulator
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_sim.h"
+
+static void SHT21_Test_Sim(SHT21_Sim_TypeDef* sim, SHT21_Sim_Clock_TypeDef* clock, SHT21_Resolution_TypeDef res)
+{
+    SHT21_User_Reg_TypeDef reg = {0};
+    *clock = (SHT21_Sim_Clock_TypeDef){0, 0};
+    SHT21_Sim_Init(sim, clock);
+    sim->user_reg = SHT21_Set_Resolution(reg, res).reg | SHT21_DISABLE_OTP_RELOAD;
+}
+
+static void SHT21_Test_States(void)
+{
+    SHT21_Sim_Clock_TypeDef clock;
+    SHT21_Sim_TypeDef sim;
+    SHT21_Measurement_TypeDef meas = {0};
+    float value = 1234.0f;
+
+    SHT21_Test_Sim(&sim, &clock, SHT21_RES_RH12_T14);
+    sim.temp = 21.5f;
+
+    // Nothing started
+    SHT21_TEST_CHECK(SHT21_Measure_Poll(&meas) == SHT21_ACK_ERROR);
+    SHT21_TEST_CHECK(SHT21_Measure_Complete(&meas, &value) == SHT21_BUSY && value == 1234.0f);
+
+    SHT21_TEST_CHECK(SHT21_Measure_Start(&meas, &sim.bus, SHT21_TEMP_MEASURE) == SHT21_OK);
+    SHT21_TEST_CHECK(meas.state == SHT21_MEASURE_CONVERTING && meas.length == 3U);
+    SHT21_TEST_CHECK(SHT21_Measure_Poll(&meas) == SHT21_BUSY);
+    SHT21_TEST_CHECK(SHT21_Measure_Complete(&meas, &value) == SHT21_BUSY);
+
+    // The sim is done at 80 % of the 85 ms datasheet time
+    SHT21_Sim_Advance(&clock, 60000ULL);
+    SHT21_TEST_CHECK(SHT21_Measure_Poll(&meas) == SHT21_BUSY);
+    SHT21_Sim_Advance(&clock, 10000ULL);
+    SHT21_TEST_CHECK(SHT21_Measure_Poll(&meas) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Measure_Poll(&meas) == SHT21_OK); // Does not read again
+    SHT21_TEST_CHECK(SHT21_Measure_Complete(&meas, &value) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Test_Close(value, 21.5f, 0.02f));
+    SHT21_TEST_CHECK(meas.state == SHT21_MEASURE_IDLE);
+
+    // Wait sleeps the conversion time and polls
+    SHT21_TEST_CHECK(SHT21_Measure_Start(&meas, &sim.bus, SHT21_RH_MEASURE) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Measure_Wait(&meas, SHT21_Conversion_Time(SHT21_RES_RH12_T14, SHT21_RH_MEASURE)) ==
+                     SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Measure_Complete(&meas, &value) == SHT21_OK && SHT21_Test_Close(value, 50.0f, 0.05f));
+
+    // A corrupt frame
+    sim.inject_bit_errors = 1;
+    value = 1234.0f;
+    SHT21_TEST_CHECK(SHT21_Measure_Start(&meas, &sim.bus, SHT21_TEMP_MEASURE) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Measure_Wait(&meas, 85U) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Measure_Complete(&meas, &value) == SHT21_CHECKSUM_ERROR && value == 1234.0f);
+
+    // A NACKed command, and a sensor that never finishes
+    sim.inject_nacks = 1;
+    SHT21_TEST_CHECK(SHT21_Measure_Start(&meas, &sim.bus, SHT21_TEMP_MEASURE) == SHT21_ACK_ERROR);
+    SHT21_TEST_CHECK(meas.state == SHT21_MEASURE_IDLE);
+    sim.conversion_percent = 250U;
+    SHT21_TEST_CHECK(SHT21_Measure_Start(&meas, &sim.bus, SHT21_TEMP_MEASURE) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Measure_Wait(&meas, 85U) == SHT21_TIME_OUT_ERROR);
+    SHT21_TEST_CHECK(meas.state == SHT21_MEASURE_IDLE);
+    SHT21_TEST_CHECK(clock.now_us / 1000ULL >= SHT21_MEASURE_TIMEOUT);
+}
+
+static void SHT21_Test_Both(void)
+{
+    static const float temp_step[4] = { 0.011f, 0.043f, 0.022f, 0.086f };
+    static const float rh_step[4] = { 0.031f, 0.49f, 0.123f, 0.062f };
+
+    for (UInt8 r = 0; r < 4U; r++)
+    {
+        SHT21_Resolution_TypeDef res = (SHT21_Resolution_TypeDef)r;
+        SHT21_Sim_Clock_TypeDef clock;
+        SHT21_Sim_TypeDef sim;
+
+        SHT21_Test_Sim(&sim, &clock, res);
+        sim.temp = -12.3f;
+        sim.humidity = 77.7f;
+
+        SHT21_Sample_TypeDef sample = SHT21_Measure_Both(&sim.bus, res);
+        SHT21_TEST_CHECK(sample.status == SHT21_OK);
+        SHT21_TEST_CHECK(SHT21_Test_Close(sample.temp, sim.temp, temp_step[r]));
+        SHT21_TEST_CHECK(SHT21_Test_Close(sample.humidity, sim.humidity, rh_step[r]));
+        SHT21_TEST_CHECK(sim.conversions == 2U);
+
+        for (UInt8 mode = SHT21_READ_NO_CRC; mode <= SHT21_READ_MSB; mode++)
+        {
+            SHT21_Sample_TypeDef short_sample = SHT21_Measure_Both_Mode(&sim.bus, res, (SHT21_Read_Mode_TypeDef)mode,
+                                                                        (SHT21_Read_Mode_TypeDef)mode);
+            SHT21_TEST_CHECK(short_sample.status == SHT21_OK);
+            SHT21_TEST_CHECK(short_sample.temp == sample.temp && short_sample.humidity == sample.humidity);
+        }
+
+        // The first error is reported
+        sim.inject_bit_errors = 1;
+        SHT21_TEST_CHECK(SHT21_Measure_Both(&sim.bus, res).status == SHT21_CHECKSUM_ERROR);
+        sim.inject_nacks = 1;
+        SHT21_TEST_CHECK(SHT21_Measure_Both(&sim.bus, res).status == SHT21_ACK_ERROR);
+    }
+}
+
+void SHT21_Test_Measure(void)
+{
+    SHT21_Test_States();
+    SHT21_Test_Both();
+}
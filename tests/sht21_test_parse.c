@@ -0,0 +1,126 @@
+/********************************************************************************************
+ *  Filename: sht21_test_parse.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  CRC, frame parsers and user register helpers, over every possible reading
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+
+static void SHT21_Test_Crc(void)
+{
+    // Examples from the Sensirion CRC application note
+    UInt8 one[1] = { 0xDCU };
+    UInt8 temp[2] = { 0x68U, 0x3AU };
+    UInt8 rh[2] = { 0x4EU, 0x85U };
+
+    SHT21_TEST_CHECK(SHT21_Check_Crc(one, 1, 0x79U) == 0);
+    SHT21_TEST_CHECK(SHT21_Check_Crc(temp, 2, 0x7CU) == 0);
+    SHT21_TEST_CHECK(SHT21_Check_Crc(rh, 2, 0x6BU) == 0);
+    SHT21_TEST_CHECK(SHT21_Check_Crc(rh, 2, 0x6AU) == SHT21_CHECKSUM_ERROR);
+}
+
+// Every 16 bit value, status bits included, through every parser of a 3 byte frame
+static void SHT21_Test_Frames(void)
+{
+    for (UInt32 r = 0; r < 65536U; r++)
+    {
+        UInt16 masked = (UInt16)(r & ~0x3U);
+        UInt8 frame[3];
+        UInt16 reading = 0;
+        float temp = 0.0f;
+        float humidity = 0.0f;
+        float value = 0.0f;
+
+        SHT21_Test_Frame((UInt16)r, frame);
+        SHT21_TEST_CHECK(SHT21_Parse_Reading(frame, &reading) == SHT21_OK && reading == masked);
+        SHT21_TEST_CHECK(SHT21_Parse_Temp(frame) == SHT21_Convert_Temp(masked));
+        SHT21_TEST_CHECK(SHT21_Parse_RH(frame) == SHT21_Convert_RH(masked));
+        SHT21_TEST_CHECK(SHT21_Parse_Temp_Checked(frame, &temp) == SHT21_OK && temp == SHT21_Convert_Temp(masked));
+        SHT21_TEST_CHECK(SHT21_Parse_RH_Checked(frame, &humidity) == SHT21_OK &&
+                         humidity == SHT21_Convert_RH(masked));
+
+        // Parse_Frame also checks the status bit against the command
+        UInt8 is_rh = (r & SHT21_STATUS_RH) != 0U;
+        value = 1234.0f;
+        SHT21_Error_TypeDef status = SHT21_Parse_Frame(frame, 3, SHT21_TEMP_MEASURE, &value);
+        SHT21_TEST_CHECK(is_rh ? (status == SHT21_UNIT_ERROR && value == 1234.0f) : (status == SHT21_OK && value == temp));
+        value = 1234.0f;
+        status = SHT21_Parse_Frame(frame, 3, SHT21_RH_MEASURE_HOLD, &value);
+        SHT21_TEST_CHECK(is_rh ? (status == SHT21_OK && value == humidity) : (status == SHT21_UNIT_ERROR && value == 1234.0f));
+
+        // Any single flipped bit is caught, and nothing is written
+        UInt32 bit = r % 24U;
+        frame[bit / 8U] ^= (UInt8)(1U << (bit % 8U));
+        temp = 1234.0f;
+        humidity = 1234.0f;
+        SHT21_TEST_CHECK(SHT21_Parse_Temp(frame) == (float)SHT21_CHECKSUM_ERROR);
+        SHT21_TEST_CHECK(SHT21_Parse_RH(frame) == (float)SHT21_CHECKSUM_ERROR);
+        SHT21_TEST_CHECK(SHT21_Parse_Temp_Checked(frame, &temp) == SHT21_CHECKSUM_ERROR && temp == 1234.0f);
+        SHT21_TEST_CHECK(SHT21_Parse_RH_Checked(frame, &humidity) == SHT21_CHECKSUM_ERROR && humidity == 1234.0f);
+        SHT21_TEST_CHECK(SHT21_Parse_Frame(frame, 3, SHT21_RH_MEASURE, &humidity) == SHT21_CHECKSUM_ERROR &&
+                         humidity == 1234.0f);
+    }
+
+    SHT21_TEST_CHECK(SHT21_Convert_Temp(0) == -46.85f);
+    SHT21_TEST_CHECK(SHT21_Convert_RH(0) == -6.0f);
+    SHT21_TEST_CHECK(SHT21_Test_Close(SHT21_Convert_Temp(0x683AU & ~0x3U), 24.69f, 0.01f));
+    SHT21_TEST_CHECK(SHT21_Test_Close(SHT21_Convert_RH(0x4E85U & ~0x3U), 32.34f, 0.01f));
+}
+
+// Short frames: the status bit tells humidity from temperature, 1 byte is a RH8 MSB
+static void SHT21_Test_Short_Frames(void)
+{
+    UInt8 temp_frame[2] = { 0x68U, 0x38U };
+    UInt8 rh_frame[2] = { 0x4EU, 0x86U };
+    UInt8 msb[1] = { 0x4EU };
+    float value = 1234.0f;
+
+    SHT21_TEST_CHECK(SHT21_Parse_Frame(temp_frame, 2, SHT21_TEMP_MEASURE, &value) == SHT21_OK &&
+                     value == SHT21_Convert_Temp(0x6838U));
+    SHT21_TEST_CHECK(SHT21_Parse_Frame(rh_frame, 2, SHT21_RH_MEASURE, &value) == SHT21_OK &&
+                     value == SHT21_Convert_RH(0x4E84U));
+    SHT21_TEST_CHECK(SHT21_Parse_Frame(msb, 1, SHT21_RH_MEASURE, &value) == SHT21_OK &&
+                     value == SHT21_Convert_RH(0x4E00U));
+
+    value = 1234.0f;
+    SHT21_TEST_CHECK(SHT21_Parse_Frame(rh_frame, 2, SHT21_TEMP_MEASURE, &value) == SHT21_UNIT_ERROR && value == 1234.0f);
+    SHT21_TEST_CHECK(SHT21_Parse_Frame(temp_frame, 2, SHT21_RH_MEASURE_HOLD, &value) == SHT21_UNIT_ERROR && value == 1234.0f);
+    SHT21_TEST_CHECK(SHT21_Parse_Frame(msb, 0, SHT21_RH_MEASURE, &value) == SHT21_UNIT_ERROR && value == 1234.0f);
+
+    for (UInt8 res = 0; res < 4U; res++)
+    {
+        SHT21_Resolution_TypeDef r = (SHT21_Resolution_TypeDef)res;
+        SHT21_TEST_CHECK(SHT21_Read_Length(SHT21_READ_FULL, r, SHT21_RH_MEASURE) == 3U);
+        SHT21_TEST_CHECK(SHT21_Read_Length(SHT21_READ_NO_CRC, r, SHT21_RH_MEASURE) == 2U);
+        SHT21_TEST_CHECK(SHT21_Read_Length(SHT21_READ_MSB, r, SHT21_TEMP_MEASURE) == 2U);
+        SHT21_TEST_CHECK(SHT21_Read_Length(SHT21_READ_MSB, r, SHT21_RH_MEASURE) ==
+                         ((r == SHT21_RES_RH8_T12) ? 1U : 2U));
+    }
+}
+
+static void SHT21_Test_User_Reg(void)
+{
+    UInt8 buf[1] = { 0xFFU };
+    SHT21_User_Reg_TypeDef reg = SHT21_Parse_User_Reg(buf);
+
+    for (UInt8 res = 0; res < 4U; res++)
+        SHT21_TEST_CHECK(SHT21_Get_Resolution(SHT21_Set_Resolution(reg, (SHT21_Resolution_TypeDef)res)) == res);
+
+    // The end of battery bit is read only
+    SHT21_User_Reg_TypeDef updated = SHT21_Update_User_Reg_Fields(reg, 0xFFU, 0x00U);
+    SHT21_TEST_CHECK((updated.reg & SHT21_STATUS) == (reg.reg & SHT21_STATUS));
+    SHT21_TEST_CHECK((updated.reg & SHT21_ENABLE_CHIP_HEATER) == 0);
+    updated = SHT21_Update_User_Reg_Fields(updated, SHT21_ENABLE_CHIP_HEATER, SHT21_ENABLE_CHIP_HEATER);
+    SHT21_TEST_CHECK((updated.reg & SHT21_ENABLE_CHIP_HEATER) != 0);
+}
+
+void SHT21_Test_Parse(void)
+{
+    SHT21_Test_Crc();
+    SHT21_Test_Frames();
+    SHT21_Test_Short_Frames();
+    SHT21_Test_User_Reg();
+}
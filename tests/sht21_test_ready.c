@@ -0,0 +1,49 @@
+/********************************************************************************************
+ *  Filename: sht21_test_ready.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Readiness probing after power up and soft reset, against the simulator
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_sim.h"
+
+void SHT21_Test_Ready(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Ready_TypeDef ready;
+
+    // Ready as soon as the sensor answers, not after the whole window
+    SHT21_Sim_Init(&sim, &clock);
+    sim.reset_time_us = 6000U;
+    SHT21_Sim_Power_Up(&sim);
+    SHT21_Ready_Start(&ready, &sim.bus, SHT21_POWER_UP_TIME);
+    SHT21_TEST_CHECK(SHT21_Ready_Poll(&ready) == SHT21_BUSY && !ready.ready);
+    SHT21_TEST_CHECK(SHT21_Ready_Wait(&ready) == SHT21_OK && ready.ready);
+    SHT21_TEST_CHECK(ready.ready_ms >= 6U && ready.ready_ms <= 7U);
+    SHT21_TEST_CHECK(ready.user_reg.reg == SHT21_DISABLE_OTP_RELOAD);
+
+    // Once ready the bus is not touched
+    UInt32 transactions = sim.transactions;
+    UInt32 probes = ready.probes;
+    SHT21_TEST_CHECK(SHT21_Ready_Poll(&ready) == SHT21_OK);
+    SHT21_TEST_CHECK(sim.transactions == transactions && ready.probes == probes);
+
+    // Soft reset keeps the heater bit and resets the rest
+    sim.user_reg = SHT21_ENABLE_CHIP_HEATER | SHT21_MEAS_RESOLUTION_BIT1;
+    SHT21_TEST_CHECK(SHT21_Soft_Reset(&ready, &sim.bus) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Ready_Wait(&ready) == SHT21_OK);
+    SHT21_TEST_CHECK(ready.user_reg.reg == (SHT21_ENABLE_CHIP_HEATER | SHT21_DISABLE_OTP_RELOAD));
+
+    // A sensor that never answers is given up at twice the window
+    sim.reset_time_us = 1000000U;
+    SHT21_Sim_Power_Up(&sim);
+    unsigned long long start = clock.now_us;
+    SHT21_Ready_Start(&ready, &sim.bus, SHT21_POWER_UP_TIME);
+    SHT21_TEST_CHECK(SHT21_Ready_Wait(&ready) == SHT21_TIME_OUT_ERROR && !ready.ready);
+    SHT21_TEST_CHECK((clock.now_us - start) / 1000ULL > 2U * SHT21_POWER_UP_TIME);
+    SHT21_TEST_CHECK((clock.now_us - start) / 1000ULL <= 2U * SHT21_POWER_UP_TIME + 2U);
+}
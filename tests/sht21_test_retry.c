@@ -0,0 +1,65 @@
+/********************************************************************************************
+ *  Filename: sht21_test_retry.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  The recovery action of the retry policy for each kind of fault, against the simulator
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_retry.h"
+#include "sht21_sim.h"
+
+void SHT21_Test_Retry(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Retry_TypeDef retry;
+    float value = 0.0f;
+
+    SHT21_Sim_Init(&sim, &clock);
+    sim.temp = 30.0f;
+
+    // A corrupt frame is read again when the sensor keeps the result
+    sim.latch_result = 1;
+    sim.inject_bit_errors = 1;
+    SHT21_Retry_Init(&retry, &sim.bus, 0);
+    SHT21_TEST_CHECK(SHT21_Retry_Measure(&retry, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, &value) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Test_Close(value, 30.0f, 0.02f));
+    SHT21_TEST_CHECK(retry.stats.frame_reads == 1U && retry.stats.restarts == 0U && sim.conversions == 1U);
+
+    // and measured again when it does not
+    sim.latch_result = 0;
+    sim.inject_bit_errors = 1;
+    SHT21_Retry_Init(&retry, &sim.bus, 0);
+    SHT21_TEST_CHECK(SHT21_Retry_Measure(&retry, SHT21_RH_MEASURE, SHT21_RES_RH12_T14, &value) == SHT21_OK);
+    SHT21_TEST_CHECK(SHT21_Test_Close(value, 50.0f, 0.05f));
+    SHT21_TEST_CHECK(retry.stats.frame_reads == 1U && retry.stats.restarts == 1U && sim.conversions == 3U);
+
+    // A NACKed command is written again, up to command_writes times
+    sim.inject_nacks = 2;
+    SHT21_Retry_Init(&retry, &sim.bus, 0);
+    SHT21_TEST_CHECK(SHT21_Retry_Measure(&retry, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, &value) == SHT21_OK);
+    SHT21_TEST_CHECK(retry.stats.command_writes == 2U && retry.stats.failures == 0U);
+    sim.inject_nacks = 3;
+    SHT21_TEST_CHECK(SHT21_Retry_Measure(&retry, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, &value) == SHT21_ACK_ERROR);
+    SHT21_TEST_CHECK(retry.stats.failures == 1U && retry.stats.measurements == 2U);
+
+    // A lost conversion is measured again, then given up
+    sim.conversion_percent = 250U;
+    SHT21_Retry_Init(&retry, &sim.bus, 0);
+    value = 1234.0f;
+    SHT21_TEST_CHECK(SHT21_Retry_Measure(&retry, SHT21_TEMP_MEASURE, SHT21_RES_RH12_T14, &value) ==
+                     SHT21_TIME_OUT_ERROR);
+    SHT21_TEST_CHECK(retry.stats.restarts == 1U && retry.stats.failures == 1U && value == 1234.0f);
+
+    // Both, with a corrupt temperature frame on the way
+    sim.conversion_percent = 80U;
+    sim.latch_result = 1;
+    sim.inject_bit_errors = 1;
+    SHT21_Retry_Init(&retry, &sim.bus, 0);
+    SHT21_Sample_TypeDef sample = SHT21_Retry_Measure_Both(&retry, SHT21_RES_RH12_T14);
+    SHT21_TEST_CHECK(sample.status == SHT21_OK && retry.stats.frame_reads == 1U);
+    SHT21_TEST_CHECK(SHT21_Test_Close(sample.temp, 30.0f, 0.02f) && SHT21_Test_Close(sample.humidity, 50.0f, 0.05f));
+}
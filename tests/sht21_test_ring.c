@@ -0,0 +1,154 @@
+/********************************************************************************************
+ *  Filename: sht21_test_ring.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  Sample ring order, wrap and overflow accounting, on one thread and with the producer
+ *  and consumer on two
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_ring.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define SHT21_TEST_RING_ENTRIES     (200000U)
+
+typedef struct
+{
+    SHT21_Ring_TypeDef ring;
+    UInt32 attempts;
+    UInt32 pushed;
+    UInt32 received;
+    UInt32 missing;
+    UInt32 errors;
+    UInt8 producer_done;
+} SHT21_Test_Ring_State;
+
+static void SHT21_Test_Ring_Frame(UInt32 n, UInt8* frame)
+{
+    frame[0] = (UInt8)(n >> 8);
+    frame[1] = (UInt8)n;
+    frame[2] = (UInt8)(frame[0] ^ frame[1] ^ 0x5AU);
+}
+
+// Pushes numbered frames flat out, yielding now and then so both threads get to run
+static void* SHT21_Test_Ring_Producer(void* arg)
+{
+    SHT21_Test_Ring_State* state = (SHT21_Test_Ring_State*)arg;
+    UInt8 frame[3];
+
+    for (UInt32 n = 0; n < SHT21_TEST_RING_ENTRIES; n++)
+    {
+        SHT21_Test_Ring_Frame(n, frame);
+        state->attempts++;
+        state->pushed += SHT21_Ring_Push_Frame(&state->ring, n, SHT21_TEMP_MEASURE, frame);
+        if ((n & 0xFFU) == 0U)
+            sched_yield();
+    }
+    __atomic_store_n(&state->producer_done, 1U, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Entries must come in order and intact, a number is only skipped when its push overflowed
+static void* SHT21_Test_Ring_Consumer(void* arg)
+{
+    SHT21_Test_Ring_State* state = (SHT21_Test_Ring_State*)arg;
+    SHT21_Ring_Entry_TypeDef batch[8];
+    UInt32 expected = 0;
+    UInt8 frame[3];
+
+    for (;;)
+    {
+        UInt8 producer_done = __atomic_load_n(&state->producer_done, __ATOMIC_ACQUIRE);
+        UInt32 count = SHT21_Ring_Pop_Batch(&state->ring, batch, 8);
+        if (count == 0)
+        {
+            if (producer_done && SHT21_Ring_Count(&state->ring) == 0)
+                break;
+            sched_yield();
+            continue;
+        }
+
+        for (UInt32 i = 0; i < count; i++)
+        {
+            SHT21_Test_Ring_Frame(batch[i].tick, frame);
+            if (batch[i].tick < expected || batch[i].kind != SHT21_RING_FRAME ||
+                batch[i].data.frame[0] != frame[0] || batch[i].data.frame[1] != frame[1] ||
+                batch[i].data.frame[2] != frame[2])
+                state->errors++;
+            else
+                state->missing += batch[i].tick - expected;
+            expected = batch[i].tick + 1U;
+        }
+        state->received += count;
+    }
+    state->missing += SHT21_TEST_RING_ENTRIES - expected;
+    return 0;
+}
+
+void SHT21_Test_Ring(void)
+{
+    static SHT21_Ring_TypeDef ring;
+    static SHT21_Test_Ring_State state;
+    SHT21_Ring_Entry_TypeDef out[SHT21_RING_CAPACITY];
+    UInt8 frame[3] = { 0x66U, 0x54U, 0x00U };
+
+    // Empty ring pops nothing
+    SHT21_Ring_Init(&ring);
+    SHT21_TEST_CHECK(SHT21_Ring_Pop_Batch(&ring, out, SHT21_RING_CAPACITY) == 0);
+    SHT21_TEST_CHECK(SHT21_Ring_Count(&ring) == 0);
+
+    // Fills to capacity, the next push is dropped and counted
+    for (UInt32 i = 0; i < SHT21_RING_CAPACITY; i++)
+        SHT21_TEST_CHECK(SHT21_Ring_Push_Frame(&ring, i, SHT21_RH_MEASURE, frame) == 1);
+    SHT21_TEST_CHECK(SHT21_Ring_Push_Frame(&ring, 999U, SHT21_RH_MEASURE, frame) == 0);
+    SHT21_TEST_CHECK(SHT21_Ring_Count(&ring) == SHT21_RING_CAPACITY);
+    SHT21_TEST_CHECK(SHT21_Ring_Overflows(&ring) == 1);
+
+    // Batches come oldest first and never more than asked for
+    SHT21_TEST_CHECK(SHT21_Ring_Pop_Batch(&ring, out, 5) == 5);
+    SHT21_TEST_CHECK(out[0].tick == 0 && out[4].tick == 4);
+    SHT21_TEST_CHECK(out[0].kind == SHT21_RING_FRAME && out[0].cmd == SHT21_RH_MEASURE);
+    SHT21_TEST_CHECK(out[0].data.frame[0] == 0x66U && out[0].data.frame[1] == 0x54U);
+
+    // Room again after a pop, and the indices wrap past the end of the entries
+    for (UInt32 i = 0; i < 5; i++)
+        SHT21_TEST_CHECK(SHT21_Ring_Push_Frame(&ring, SHT21_RING_CAPACITY + i, SHT21_RH_MEASURE, frame) == 1);
+
+    // A batch may stop at the head the consumer last saw, the next one picks up the rest
+    UInt32 count = SHT21_Ring_Pop_Batch(&ring, out, SHT21_RING_CAPACITY);
+    count += SHT21_Ring_Pop_Batch(&ring, out + count, SHT21_RING_CAPACITY - count);
+    SHT21_TEST_CHECK(count == SHT21_RING_CAPACITY);
+    UInt32 ordered = 1;
+    for (UInt32 i = 0; i < SHT21_RING_CAPACITY; i++)
+        ordered &= out[i].tick == i + 5U;
+    SHT21_TEST_CHECK(ordered);
+    SHT21_TEST_CHECK(SHT21_Ring_Count(&ring) == 0 && SHT21_Ring_Overflows(&ring) == 1);
+
+    // Samples keep their values
+    SHT21_Sample_TypeDef sample = { 21.5f, 40.25f, SHT21_OK };
+    SHT21_TEST_CHECK(SHT21_Ring_Push_Sample(&ring, 77U, &sample) == 1);
+    SHT21_TEST_CHECK(SHT21_Ring_Pop_Batch(&ring, out, 1) == 1);
+    SHT21_TEST_CHECK(out[0].tick == 77U && out[0].kind == SHT21_RING_SAMPLE);
+    SHT21_TEST_CHECK(out[0].data.sample.temp == 21.5f && out[0].data.sample.humidity == 40.25f);
+
+    // Two threads: every push is either received once, in order, or counted as overflowed
+    state = (SHT21_Test_Ring_State){0};
+    SHT21_Ring_Init(&state.ring);
+    pthread_t producer, consumer;
+    SHT21_TEST_CHECK(pthread_create(&consumer, 0, SHT21_Test_Ring_Consumer, &state) == 0);
+    SHT21_TEST_CHECK(pthread_create(&producer, 0, SHT21_Test_Ring_Producer, &state) == 0);
+    pthread_join(producer, 0);
+    pthread_join(consumer, 0);
+
+    UInt32 overflows = SHT21_Ring_Overflows(&state.ring);
+    SHT21_TEST_CHECK(state.errors == 0);
+    SHT21_TEST_CHECK(state.attempts == SHT21_TEST_RING_ENTRIES);
+    SHT21_TEST_CHECK(state.received == state.pushed);
+    SHT21_TEST_CHECK(state.received + overflows == state.attempts);
+    SHT21_TEST_CHECK(state.missing == overflows);
+    SHT21_TEST_CHECK(state.received > 0);
+}
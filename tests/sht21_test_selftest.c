@@ -0,0 +1,106 @@
+/********************************************************************************************
+ *  Filename: sht21_test_selftest.c
+ *  Author: Erik Fagerland
+ *  Created On: 16/10/2026
+ *
+ *  Brief:
+ *  The step driven selftest against the simulator. Whatever the outcome, the heater
+ *  must be off at the end.
+ *
+ *******************************************************************************************/
+#include "sht21_test.h"
+#include "sht21_sim.h"
+
+/********************************************************************************************
+ *  Steps a started test to the end, advancing the clock by test->wait. abort_at aborts
+ *  the test at that reading with the heater on, 0 never.
+ *******************************************************************************************/
+static SHT21_Error_TypeDef SHT21_Test_Run(SHT21_Selftest_TypeDef* test, SHT21_Sim_TypeDef* sim, UInt32 abort_at)
+{
+    SHT21_Error_TypeDef status = SHT21_BUSY;
+    UInt32 steps = 0;
+
+    while (status == SHT21_BUSY && steps++ < 100000U)
+    {
+        if (abort_at != 0 && test->state == SHT21_SELFTEST_HEATING && test->readings == abort_at)
+        {
+            SHT21_Selftest_Abort(test);
+            abort_at = 0;
+        }
+        status = SHT21_Selftest_Step(test);
+        if (status == SHT21_BUSY)
+            SHT21_Sim_Advance(sim->clock, 1000ULL * test->wait);
+    }
+    return status;
+}
+
+void SHT21_Test_Selftest(void)
+{
+    SHT21_Sim_Clock_TypeDef clock = {0, 0};
+    SHT21_Sim_TypeDef sim;
+    SHT21_Selftest_TypeDef test;
+
+    // A healthy sensor passes early, well before the deadline
+    SHT21_Sim_Init(&sim, &clock);
+    sim.user_reg |= SHT21_MEAS_RESOLUTION_BIT2;
+    SHT21_Selftest_Start(&test, &sim.bus, 0);
+    SHT21_TEST_CHECK(SHT21_Test_Run(&test, &sim, 0) == SHT21_OK);
+    SHT21_TEST_CHECK(clock.now_us / 1000ULL < SHT21_SELFTEST_DEADLINE / 2U);
+    SHT21_TEST_CHECK(test.temp - test.temp_start > SHT21_SELFTEST_TEMP_THRESHOLD);
+    SHT21_TEST_CHECK(sim.user_reg == (SHT21_DISABLE_OTP_RELOAD | SHT21_MEAS_RESOLUTION_BIT2));
+
+    // A broken heater fails at the deadline
+    SHT21_Sim_Init(&sim, &clock);
+    sim.heater_max = 0.0f;
+    unsigned long long start = clock.now_us;
+    SHT21_Selftest_Start(&test, &sim.bus, 2000U);
+    SHT21_TEST_CHECK(SHT21_Test_Run(&test, &sim, 0) == SHT21_SELFTEST_FAILED);
+    SHT21_TEST_CHECK((clock.now_us - start) / 1000ULL >= 2000U && (clock.now_us - start) / 1000ULL < 2500U);
+    SHT21_TEST_CHECK((sim.user_reg & SHT21_ENABLE_CHIP_HEATER) == 0);
+
+    // A bus error with the heater on still restores the register
+    SHT21_Sim_Init(&sim, &clock);
+    SHT21_Selftest_Start(&test, &sim.bus, 0);
+    while (SHT21_Selftest_Step(&test) == SHT21_BUSY && !(test.state == SHT21_SELFTEST_HEATING && test.readings == 1U))
+        SHT21_Sim_Advance(&clock, 1000ULL * test.wait);
+    sim.inject_nacks = 2;
+    SHT21_TEST_CHECK(SHT21_Test_Run(&test, &sim, 0) == SHT21_ACK_ERROR);
+    SHT21_TEST_CHECK((sim.user_reg & SHT21_ENABLE_CHIP_HEATER) == 0);
+
+    // Aborted with the heater on
+    SHT21_Sim_Init(&sim, &clock);
+    sim.heater_max = 0.0f;
+    SHT21_Selftest_Start(&test, &sim.bus, 0);
+    SHT21_TEST_CHECK(SHT21_Test_Run(&test, &sim, 2U) == SHT21_SELFTEST_FAILED);
+    SHT21_TEST_CHECK((sim.user_reg & SHT21_ENABLE_CHIP_HEATER) == 0);
+
+    // Aborted during a conversion on a sensor that NACKs writes until it is done
+    SHT21_Sim_Init(&sim, &clock);
+    sim.heater_max = 0.0f;
+    sim.busy_write_nack = 1;
+    sim.conversion_percent = 100U;
+    SHT21_Selftest_Start(&test, &sim.bus, 0);
+    while (SHT21_Selftest_Step(&test) == SHT21_BUSY &&
+           !(test.state == SHT21_SELFTEST_HEATING && test.meas.state == SHT21_MEASURE_CONVERTING))
+        SHT21_Sim_Advance(&clock, 1000ULL * test.wait);
+    SHT21_Selftest_Abort(&test);
+    SHT21_TEST_CHECK(SHT21_Test_Run(&test, &sim, 0) == SHT21_SELFTEST_FAILED);
+    SHT21_TEST_CHECK((sim.user_reg & SHT21_ENABLE_CHIP_HEATER) == 0);
+
+    // Writes refused for longer than the first attempts are kept trying
+    SHT21_Sim_Init(&sim, &clock);
+    sim.heater_max = 0.0f;
+    SHT21_Selftest_Start(&test, &sim.bus, 0);
+    while (SHT21_Selftest_Step(&test) == SHT21_BUSY && !(test.state == SHT21_SELFTEST_HEATING && test.readings == 1U))
+        SHT21_Sim_Advance(&clock, 1000ULL * test.wait);
+    SHT21_Selftest_Abort(&test);
+    sim.inject_nacks = 20;
+    SHT21_TEST_CHECK(SHT21_Test_Run(&test, &sim, 0) == SHT21_SELFTEST_FAILED);
+    SHT21_TEST_CHECK((sim.user_reg & SHT21_ENABLE_CHIP_HEATER) == 0);
+
+    // Stepping a finished or never started test does nothing
+    UInt32 transactions = sim.transactions;
+    SHT21_TEST_CHECK(SHT21_Selftest_Step(&test) == SHT21_SELFTEST_FAILED && sim.transactions == transactions);
+    test.state = SHT21_SELFTEST_IDLE;
+    SHT21_TEST_CHECK(SHT21_Selftest_Step(&test) == SHT21_UNIT_ERROR && test.state == SHT21_SELFTEST_IDLE);
+}